@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# mex-http-loopback.py - Loopback HTTP server for socktest.mex's HTTP checks
+#
+# Usage:
+#   ./scripts/mex-http-loopback.py [port]      (default 7778)
+#
+# Then, on a node, run "scripts/socktest http 7778".
+#
+# Behavior:
+#   - Listens on 127.0.0.1 and speaks HTTP/1.1 with keep-alive
+#   - GET /conn          "conn=N", where N numbers the TCP connection, so the
+#                        script can tell whether a connection was reused
+#   - GET /chunked       a chunked body with a chunk extension and a trailer
+#   - GET /etag?...      "etag body #N" with an ETag and Cache-Control:
+#                        no-cache; answers If-None-Match with a 304
+#   - GET /dropget?...   closes the connection without answering the first
+#                        time each URL is asked for, and answers after that
+#   - POST /drop         reads the body and closes without answering
+#   - GET /stats/posts   number of POST /drop requests received
+#   - GET /stats/304     number of 304 responses sent
+#
+# Copyright (C) 2025 Kevin Morgan (Limping Ninja)
+# https://github.com/LimpingNinja
+
+from __future__ import annotations
+
+import sys
+import threading
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+ETAG = '"v1"'
+
+_lock = threading.Lock()
+_stats = {"conns": 0, "posts": 0, "304": 0, "etag_200": 0}
+_dropped: set[str] = set()
+
+
+def _bump(key: str) -> int:
+    with _lock:
+        _stats[key] += 1
+        return _stats[key]
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def setup(self) -> None:
+        super().setup()
+        self.conn_id = _bump("conns")
+
+    def log_message(self, format: str, *args) -> None:
+        sys.stderr.write("conn %d: %s\n" % (self.conn_id, format % args))
+
+    def _send(self, body: str, status: int = 200, headers: dict[str, str] | None = None) -> None:
+        data = body.encode()
+        self.send_response(status)
+        for name, value in (headers or {}).items():
+            self.send_header(name, value)
+        if status != 304:
+            self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        if status != 304:
+            self.wfile.write(data)
+
+    def _drop(self) -> None:
+        self.close_connection = True
+
+    def do_GET(self) -> None:
+        path = self.path.split("?", 1)[0]
+
+        if path == "/conn":
+            self._send("conn=%d" % self.conn_id)
+        elif path == "/chunked":
+            self.send_response(200)
+            self.send_header("Transfer-Encoding", "chunked")
+            self.send_header("Trailer", "X-Check")
+            self.end_headers()
+            for i, chunk in enumerate((b"Hello, ", b"chunked ", b"world")):
+                ext = b";n=%d" % i if i == 1 else b""
+                self.wfile.write(b"%x%s\r\n%s\r\n" % (len(chunk), ext, chunk))
+            self.wfile.write(b"0\r\nX-Check: done\r\n\r\n")
+        elif path == "/etag":
+            headers = {"ETag": ETAG, "Cache-Control": "no-cache"}
+            if self.headers.get("If-None-Match") == ETAG:
+                _bump("304")
+                self._send("", 304, headers)
+            else:
+                self._send("etag body #%d" % _bump("etag_200"), 200, headers)
+        elif path == "/dropget":
+            with _lock:
+                first = self.path not in _dropped
+                _dropped.add(self.path)
+            if first:
+                self._drop()
+            else:
+                self._send("answered")
+        elif path == "/stats/posts":
+            self._send(str(_stats["posts"]))
+        elif path == "/stats/304":
+            self._send(str(_stats["304"]))
+        else:
+            self._send("not found", 404)
+
+    def do_POST(self) -> None:
+        self.rfile.read(int(self.headers.get("Content-Length", 0)))
+
+        if self.path == "/drop":
+            _bump("posts")
+            self._drop()
+        else:
+            self._send("not found", 404)
+
+
+def main(argv: list[str]) -> int:
+    port = int(argv[1]) if len(argv) > 1 else 7778
+    server = ThreadingHTTPServer(("127.0.0.1", port), Handler)
+    server.daemon_threads = True
+    print("Listening on 127.0.0.1:%d" % port, file=sys.stderr)
+
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main(sys.argv))
@@ -0,0 +1,133 @@
+#!/bin/bash
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# mex-opt-check.sh - Check that "mex -O" and the pre-decoded VM engine
+#                    don't change what programs do
+#
+# Usage:
+#   ./scripts/mex-opt-check.sh [file.mex...]
+#
+# Behavior:
+#   - Compiles each program (default: resources/m/optimizer/*.mex) with
+#     and without -O, using build/bin/mex
+#   - Runs each build under build/bin/mexrun twice: with the pre-decoded
+#     engine (XRun) and with the quad interpreter (mexrun -x)
+#   - Fails if the output or exit status differ between engines or between
+#     builds
+#   - Runs both builds again with profiling on, and fails if the -O build
+#     executes more quads than the plain one
+#   - Prints the quads executed by each build
+#
+# MEX and MEXRUN may be set to use other binaries.
+#
+
+set -uo pipefail
+
+PROJECT_ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+MEX="${MEX:-$PROJECT_ROOT/build/bin/mex}"
+MEXRUN="${MEXRUN:-$PROJECT_ROOT/build/bin/mexrun}"
+
+export MEX_INCLUDE="$PROJECT_ROOT/resources/m"
+export LD_LIBRARY_PATH="$(dirname "$MEXRUN")/lib:${LD_LIBRARY_PATH:-}"
+export DYLD_LIBRARY_PATH="$(dirname "$MEXRUN")/lib:${DYLD_LIBRARY_PATH:-}"
+
+for bin in "$MEX" "$MEXRUN"; do
+  if [ ! -x "$bin" ]; then
+    echo "Error: not found or not executable: $bin"
+    exit 1
+  fi
+done
+
+if [ "$#" -gt 0 ]; then
+  FILES=("$@")
+else
+  FILES=("$PROJECT_ROOT"/resources/m/optimizer/*.mex)
+fi
+
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+# Compile $1 into directory $2 with extra compiler flags $3...
+compile() {
+  local src="$1" dir="$2"
+  shift 2
+  mkdir -p "$dir"
+  cp -f "$src" "$dir/"
+  (cd "$dir" && "$MEX" "$@" "$(basename "$src")" >"$dir/mex.log" 2>&1) &&
+    [ -f "$dir/$(basename "${src%.mex}").vm" ]
+}
+
+# Run $1.vm with mexrun flags $3..., leaving stdout and the exit status
+# in $1.$2.out
+run() {
+  local vm="$1" tag="$2"
+  shift 2
+  "$MEXRUN" "$@" "$vm" >"$vm.$tag.out" 2>"$vm.$tag.err"
+  echo "exit status $?" >>"$vm.$tag.out"
+}
+
+# Run both engines on $1.vm, and fail if they differ
+engines() {
+  run "$1" xrun
+  run "$1" quad -x
+
+  if ! cmp -s "$1.xrun.out" "$1.quad.out"; then
+    echo "FAILED: $2 output differs between XRun and the quad interpreter"
+    diff "$1.quad.out" "$1.xrun.out"
+    return 1
+  fi
+}
+
+quads() {
+  sed -n 's/.*, \([0-9]*\) quads executed.*/\1/p' "$1.prf" 2>/dev/null
+}
+
+failed=0
+printf "%-20s %12s %12s %8s\n" "program" "quads" "quads -O" "saved"
+
+for src in "${FILES[@]}"; do
+  name="$(basename "${src%.mex}")"
+
+  if ! compile "$src" "$WORK/plain" || ! compile "$src" "$WORK/opt" -O; then
+    echo "FAILED: $name does not compile"
+    cat "$WORK"/plain/mex.log "$WORK"/opt/mex.log
+    failed=1
+    continue
+  fi
+
+  if ! engines "$WORK/plain/$name" "$name" ||
+     ! engines "$WORK/opt/$name" "$name -O"; then
+    failed=1
+    continue
+  fi
+
+  if ! cmp -s "$WORK/plain/$name.xrun.out" "$WORK/opt/$name.xrun.out"; then
+    echo "FAILED: $name output differs with -O"
+    diff "$WORK/plain/$name.xrun.out" "$WORK/opt/$name.xrun.out"
+    failed=1
+    continue
+  fi
+
+  run "$WORK/plain/$name" prof -p
+  run "$WORK/opt/$name" prof -p
+
+  q0="$(quads "$WORK/plain/$name")"
+  q1="$(quads "$WORK/opt/$name")"
+
+  if [ -z "$q0" ] || [ -z "$q1" ]; then
+    echo "FAILED: $name wrote no profile"
+    cat "$WORK/plain/$name.prof.err"
+    failed=1
+    continue
+  fi
+
+  printf "%-20s %12s %12s %7s%%\n" "$name" "$q0" "$q1" \
+         "$(( q0 ? (q0 - q1) * 100 / q0 : 0 ))"
+
+  if [ "$q1" -gt "$q0" ]; then
+    echo "FAILED: $name executes more quads with -O"
+    failed=1
+  fi
+done
+
+exit $failed
@@ -50,7 +50,9 @@ static void near usage(void)
 
     "  -a       Show addresses instead of names in ASCII quad listing\n"
 /*  "  -c       Emit subscript checking code\n"*/
+    "  -g       Add line numbers to the .VM file, for the profiler\n"
     "  -h<size> Set heap size to <size> bytes\n"
+    "  -O       Optimize the generated code (-O0 to disable)\n"
     "  -s<size> Set stack size to <size> bytes\n"
     "  -q       Quad output instead of writing .VM file\n"
     "  -u       Disable UTF-8 to CP437 conversion in strings\n";
@@ -108,6 +110,10 @@ int _stdc main(int argc,char **argv)
             mdebug=TRUE;
           break;
 
+        case 'g':
+          line_info=TRUE;
+          break;
+
         case 'h':
           lHeapSize = atol(*av + 2);
           break;
@@ -116,6 +122,10 @@ int _stdc main(int argc,char **argv)
           lStackSize = atol(*av + 2);
           break;
 
+        case 'O':
+          optimize=((*av)[2] != '0');
+          break;
+
         case 'q':
           vm_output=FALSE;
           break;
@@ -0,0 +1,333 @@
+/*
+ * Maximus Version 3.02
+ * Copyright 1989, 2002 by Lanius Corporation.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/* mexrun - run a compiled MEX program outside of Maximus.                 *
+ *                                                                         *
+ * Only the intrinsics that don't need a caller are provided: print(),     *
+ * strlen(), itostr(), ltostr(), strtoi() and time().  That is enough for  *
+ * the test programs in resources/m/optimizer, which are run both with and *
+ * without "mex -O", and under both engines (pre-decoded and plain quads), *
+ * to check that neither changes what a program does.                      */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include "prog.h"
+#include "vm.h"
+
+typedef struct
+{
+  IADDR last;
+  word arg_size;
+} RUNARG;
+
+static short sRet;
+static int fRan=FALSE;       /* main() ran to completion */
+
+
+/* Argument fetching; these work like MexArgGet*() in Maximus */
+
+static void near ArgBegin(RUNARG *pra)
+{
+  pra->last.segment=SEG_AR;
+  pra->last.offset=(VMADDR)AR_CONTROL_DATA;
+  pra->arg_size=0;
+}
+
+static byte near ArgByte(RUNARG *pra)
+{
+  byte *pb;
+
+  pra->last.indirect=FALSE;
+  pra->arg_size += sizeof(byte);
+  pb=MexFetch(FormByte, &pra->last);
+  pra->last.offset += sizeof(byte);
+
+  return pb ? *pb : 0;
+}
+
+static word near ArgWord(RUNARG *pra)
+{
+  word *pw;
+
+  pra->last.indirect=FALSE;
+  pra->arg_size += sizeof(word);
+  pw=MexFetch(FormWord, &pra->last);
+  pra->last.offset += sizeof(word);
+
+  return pw ? *pw : 0;
+}
+
+static dword near ArgDword(RUNARG *pra)
+{
+  dword *pdw;
+
+  pra->last.indirect=FALSE;
+  pra->arg_size += sizeof(dword);
+  pdw=MexFetch(FormDword, &pra->last);
+  pra->last.offset += sizeof(dword);
+
+  return pdw ? *pdw : 0;
+}
+
+
+/* Get a pass-by-value string argument as a nul-terminated copy.  The     *
+ * MEX copy is freed, as the intrinsic is expected to do.                 */
+
+static char * near ArgString(RUNARG *pra)
+{
+  IADDR *pia, ia;
+  char *str, *rc;
+  word wLen=0;
+
+  pra->last.indirect=FALSE;
+  pra->arg_size += sizeof(IADDR);
+  pia=MexFetch(FormAddr, &pra->last);
+  ia=pra->last;
+  pra->last.offset += sizeof(IADDR);
+
+  str=pia ? MexFetch(FormString, pia) : NULL;
+
+  if (str)
+  {
+    wLen=*(word *)str;
+    str += sizeof(word);
+  }
+
+  if ((rc=malloc(wLen+1)) != NULL)
+  {
+    if (str)
+      memcpy(rc, str, wLen);
+
+    rc[wLen]='\0';
+  }
+
+  MexKillString(&ia);
+  return rc;
+}
+
+static void near ReturnString(char *s)
+{
+  *(IADDR *)&regs_6[0]=MexStoreHeapByteString(s, strlen(s));
+}
+
+
+
+/* The intrinsics */
+
+static word EXPENTRY run_printstring(void)
+{
+  RUNARG ra;
+  char *s;
+
+  ArgBegin(&ra);
+
+  if ((s=ArgString(&ra)) != NULL)
+  {
+    fputs(s, stdout);
+    free(s);
+  }
+
+  return ra.arg_size;
+}
+
+static word EXPENTRY run_printchar(void)
+{
+  RUNARG ra;
+
+  ArgBegin(&ra);
+  putchar(ArgByte(&ra));
+  return ra.arg_size;
+}
+
+static word EXPENTRY run_printint(void)
+{
+  RUNARG ra;
+
+  ArgBegin(&ra);
+  printf("%d", (int)(sword)ArgWord(&ra));
+  return ra.arg_size;
+}
+
+static word EXPENTRY run_printunsignedint(void)
+{
+  RUNARG ra;
+
+  ArgBegin(&ra);
+  printf("%u", (unsigned)ArgWord(&ra));
+  return ra.arg_size;
+}
+
+static word EXPENTRY run_printlong(void)
+{
+  RUNARG ra;
+
+  ArgBegin(&ra);
+  printf("%ld", (long)(sdword)ArgDword(&ra));
+  return ra.arg_size;
+}
+
+static word EXPENTRY run_printunsignedlong(void)
+{
+  RUNARG ra;
+
+  ArgBegin(&ra);
+  printf("%lu", (unsigned long)ArgDword(&ra));
+  return ra.arg_size;
+}
+
+static word EXPENTRY run_strlen(void)
+{
+  RUNARG ra;
+  char *s;
+
+  ArgBegin(&ra);
+  s=ArgString(&ra);
+  regs_2[0]=(word)(s ? strlen(s) : 0);
+  free(s);
+
+  return ra.arg_size;
+}
+
+static word EXPENTRY run_itostr(void)
+{
+  RUNARG ra;
+  char buf[10];
+
+  ArgBegin(&ra);
+  sprintf(buf, "%d", (sword)ArgWord(&ra));
+  ReturnString(buf);
+
+  return ra.arg_size;
+}
+
+static word EXPENTRY run_ltostr(void)
+{
+  RUNARG ra;
+  char buf[30];
+
+  ArgBegin(&ra);
+  sprintf(buf, "%ld", (long)(sdword)ArgDword(&ra));
+  ReturnString(buf);
+
+  return ra.arg_size;
+}
+
+static word EXPENTRY run_strtoi(void)
+{
+  RUNARG ra;
+  char *s;
+
+  ArgBegin(&ra);
+  s=ArgString(&ra);
+  regs_2[0]=(word)(s ? atoi(s) : 0);
+  free(s);
+
+  return ra.arg_size;
+}
+
+static word EXPENTRY run_time(void)
+{
+  regs_4[0]=(dword)time(NULL);
+  return 0;
+}
+
+
+static struct _usrfunc runfunc[]=
+{
+  {"__printCHAR",             run_printchar,          0},
+  {"__printINT",              run_printint,           0},
+  {"__printLONG",             run_printlong,          0},
+  {"__printSTRING",           run_printstring,        0},
+  {"__printUNSIGNED_CHAR",    run_printchar,          0},
+  {"__printUNSIGNED_INT",     run_printunsignedint,   0},
+  {"__printUNSIGNED_LONG",    run_printunsignedlong,  0},
+  {"itostr",                  run_itostr,             0},
+  {"ltostr",                  run_ltostr,             0},
+  {"strlen",                  run_strlen,             0},
+  {"strtoi",                  run_strtoi,             0},
+  {"time",                    run_time,               0},
+};
+
+#define N_RUNFUNC (sizeof(runfunc)/sizeof(runfunc[0]))
+
+
+static void EXPENTRY RunTerm(short *psRet)
+{
+  sRet=*psRet;
+  fRan=TRUE;
+}
+
+static void _stdc RunLog(char *szStr, ...)
+{
+  va_list va;
+
+  va_start(va, szStr);
+  vfprintf(stderr, szStr, va);
+  va_end(va);
+
+  fputc('\n', stderr);
+}
+
+
+static void near usage(void)
+{
+  fputs("Usage:\n\n"
+        "mexrun [-d] [-p] [-x] <filename> [<args>]\n\n"
+        "  -d  Check the heap after every allocation (VMF_DEBHEAP)\n"
+        "  -p  Profile the run, writing <filename>.prf (VMF_PROFILE)\n"
+        "  -x  Interpret the quads directly; don't pre-decode (VMF_NOXLATE)\n\n"
+        "The exit status is the value returned by main(), or 255 if the\n"
+        "program could not be run.\n", stderr);
+
+  exit(255);
+}
+
+
+int main(int argc, char *argv[])
+{
+  dword fFlag=0;
+  int i;
+
+  for (i=1; i < argc && *argv[i]=='-'; i++)
+  {
+    switch (argv[i][1])
+    {
+      case 'd':   fFlag |= VMF_DEBHEAP; break;
+      case 'p':   fFlag |= VMF_PROFILE; break;
+      case 'x':   fFlag |= VMF_NOXLATE; break;
+      default:    usage();
+    }
+  }
+
+  if (i >= argc)
+    usage();
+
+  setvbuf(stdout, NULL, _IONBF, 0);
+
+  /* MexExecute() only calls RunTerm() if the program ran to the end */
+
+  (void)MexExecute(argv[i], i+1 < argc ? argv[i+1] : "", fFlag,
+                   (unsigned short)N_RUNFUNC, runfunc, NULL, RunTerm,
+                   RunLog, NULL, NULL);
+
+  return fRan ? (byte)sRet : 255;
+}
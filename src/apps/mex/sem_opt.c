@@ -0,0 +1,689 @@
+/*
+ * Maximus Version 3.02
+ * Copyright 1989, 2002 by Lanius Corporation.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*# name=MEX compiler - quad optimizer (-O)
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "prog.h"
+#include "vm.h"
+
+/* The code generator uses a fresh temporary for every subexpression, and  *
+ * it reuses the same temporaries from one statement to the next.  This    *
+ * pass cleans up after it, working on the finished list of quads:         *
+ *                                                                         *
+ *  - arithmetic on two constants is folded into an assignment             *
+ *  - a constant or temporary copied into a temporary is used directly     *
+ *  - "op -> temp; temp -> var" is turned into "op -> var"                 *
+ *  - quads that set a temporary which is never read are removed           *
+ *  - jumps to jumps are threaded, and jumps to the next quad removed      *
+ *                                                                         *
+ * Only the byte/word/dword temporaries are touched.  Nothing is ever      *
+ * moved into the result of a quad if it needs a global fixup, since the   *
+ * .VM format can only patch the two arguments.                            *
+ *                                                                         *
+ * The generator never keeps a temporary alive across a jump, a label or a *
+ * function call (it pushes any live ones first).  Only the return value   *
+ * registers (Temp:x000) are read after a call or a jump.                  */
+
+#define MAX_OPT_PASS    8     /* Give up after this many passes */
+#define MAX_JMP_CHAIN   32    /* Longest jump-to-jump chain we'll follow */
+
+#define IsTempAddr(a)   ((a)->segment==SEG_TEMP && !(a)->indirect)
+
+#define IsOptTemp(a)    (IsTempAddr(a) && (a)->offset % 1000 != 0 &&       \
+                         (a)->offset < TEMP_BASE_ADDR)
+
+#define IsJump(op)      ((op)==QOP_JMP || (op)==QOP_JZ || (op)==QOP_JNZ)
+
+#define IsNumForm(f)    ((f)==FormByte || (f)==FormWord || (f)==FormDword)
+
+#define ARG_ADDR(n)     ((n)==1 ? FLAG_ARG1_ADDR : FLAG_ARG2_ADDR)
+#define ARG_LIT(n)      ((n)==1 ? FLAG_ARG1_LIT : FLAG_ARG2_LIT)
+
+static INST *pinQ;            /* Quads being optimized */
+static VMADDR n_q;            /* ...and how many there are */
+static byte *pfDead;          /* TRUE for each quad that has been removed */
+static byte *pfLeader;        /* TRUE for each quad which starts a block */
+
+
+/* Classify a quad by what it does with its operands */
+
+#define OK_OTHER    0         /* Anything we don't know about */
+#define OK_ARITH    1         /* arg1 op arg2 -> res.dest */
+#define OK_CONV     2         /* conv(arg1) -> res.dest */
+#define OK_ASSIGN   3         /* arg1 -> arg2 */
+#define OK_TEST     4         /* Reads arg1 only */
+#define OK_STRING   5         /* String op of arg1 and arg2 -> res.dest */
+
+static int near OpKind(QUADOP op)
+{
+  switch (op)
+  {
+    case QOP_ADD:       case QOP_SUBTRACT:  case QOP_MULTIPLY:
+    case QOP_DIVIDE:    case QOP_MODULUS:   case QOP_LE:
+    case QOP_LT:        case QOP_EQ:        case QOP_NE:
+    case QOP_GE:        case QOP_GT:        case QOP_LOR:
+    case QOP_LAND:      case QOP_SHR:       case QOP_SHL:
+    case QOP_BAND:      case QOP_BOR:
+      return OK_ARITH;
+
+    case QOP_BYTE2WORD: case QOP_BYTE2DWORD:  case QOP_WORD2BYTE:
+    case QOP_WORD2DWORD:case QOP_DWORD2BYTE:  case QOP_DWORD2WORD:
+      return OK_CONV;
+
+    case QOP_ASSIGN:
+      return OK_ASSIGN;
+
+    case QOP_JZ:        case QOP_JNZ:       case QOP_ARG_VAL:
+      return OK_TEST;
+
+    case QOP_SCAT:      case QOP_SLE:       case QOP_SLT:
+    case QOP_SEQ:       case QOP_SNE:       case QOP_SGE:
+    case QOP_SGT:       case QOP_SLVAL:     case QOP_SRVAL:
+      return OK_STRING;
+
+    default:
+      return OK_OTHER;
+  }
+}
+
+
+/* Return the form of the value that an OK_ARITH or OK_CONV quad stores */
+
+static FORM near ResultForm(INST *pi)
+{
+  switch (pi->opcode)
+  {
+    case QOP_LE:  case QOP_LT:  case QOP_EQ:  case QOP_NE:
+    case QOP_GE:  case QOP_GT:  case QOP_LOR: case QOP_LAND:
+    case QOP_BYTE2WORD: case QOP_DWORD2WORD:
+      return FormWord;
+
+    case QOP_BYTE2DWORD:
+    case QOP_WORD2DWORD:
+      return FormDword;
+
+    case QOP_WORD2BYTE:
+    case QOP_DWORD2BYTE:
+      return FormByte;
+
+    default:
+      return pi->opform;
+  }
+}
+
+
+/* Does argument 'n' of the quad refer to temporary 'ofs' in any way? */
+
+static int near ArgIsTemp(INST *pi, int n, VMADDR ofs)
+{
+  IADDR *pa=(n==1) ? &pi->arg1.addr : &pi->arg2.addr;
+
+  if (pi->flag & ARG_LIT(n))
+    return FALSE;
+
+  return (pa->segment==SEG_TEMP && pa->offset==ofs);
+}
+
+
+/* Does argument 'n' simply read the value of temporary 'ofs'? */
+
+static int near ArgReadsTemp(INST *pi, int n, VMADDR ofs)
+{
+  IADDR *pa=(n==1) ? &pi->arg1.addr : &pi->arg2.addr;
+
+  return (ArgIsTemp(pi, n, ofs) && !pa->indirect &&
+          (pi->flag & ARG_ADDR(n))==0);
+}
+
+
+/* Returns TRUE if the quad might read temporary 'ofs' */
+
+static int near QuadUses(INST *pi, VMADDR ofs)
+{
+  IADDR *pd=&pi->res.dest;
+
+  switch (OpKind(pi->opcode))
+  {
+    case OK_ARITH:
+    case OK_STRING:
+      return (ArgIsTemp(pi, 1, ofs) || ArgIsTemp(pi, 2, ofs) ||
+              (pd->segment==SEG_TEMP && pd->indirect && pd->offset==ofs));
+
+    case OK_CONV:
+      return (ArgIsTemp(pi, 1, ofs) ||
+              (pd->segment==SEG_TEMP && pd->indirect && pd->offset==ofs));
+
+    case OK_ASSIGN:
+      return (ArgIsTemp(pi, 1, ofs) ||
+              (ArgIsTemp(pi, 2, ofs) && pi->arg2.addr.indirect));
+
+    case OK_TEST:
+      return ArgIsTemp(pi, 1, ofs);
+  }
+
+  switch (pi->opcode)
+  {
+    case QOP_SCOPY:
+      return (ArgIsTemp(pi, 1, ofs) ||
+              (ArgIsTemp(pi, 2, ofs) && pi->arg2.addr.indirect));
+
+    case QOP_PUSH:
+    case QOP_SKILL:
+      return (pi->arg1.addr.segment==SEG_TEMP && pi->arg1.addr.offset==ofs);
+
+    case QOP_JMP:
+    case QOP_POP:
+    case QOP_FUNCSTART:
+    case QOP_FUNCJUMP:
+    case QOP_FUNCRET:
+    case QOP_NOP:
+      return FALSE;
+
+    default:
+      return TRUE;
+  }
+}
+
+
+/* Returns TRUE if the quad overwrites temporary 'ofs' */
+
+static int near QuadSets(INST *pi, VMADDR ofs)
+{
+  IADDR *pa;
+
+  switch (OpKind(pi->opcode))
+  {
+    case OK_ARITH:
+    case OK_CONV:
+    case OK_STRING:
+      pa=&pi->res.dest;
+      break;
+
+    case OK_ASSIGN:
+      pa=&pi->arg2.addr;
+      break;
+
+    default:
+      if (pi->opcode==QOP_SCOPY)
+        pa=&pi->arg2.addr;
+      else if (pi->opcode==QOP_POP)
+        pa=&pi->arg1.addr;
+      else return (pi->opcode==QOP_FUNCJUMP && ofs % 1000==0);
+  }
+
+  return (IsTempAddr(pa) && pa->offset==ofs);
+}
+
+
+/* Returns TRUE if control can't fall through to the next quad normally */
+
+static int near EndsBlock(INST *pi)
+{
+  return (IsJump(pi->opcode) || pi->opcode==QOP_FUNCRET);
+}
+
+
+/* Find the first live quad at or after 'q' */
+
+static VMADDR near NextLive(VMADDR q)
+{
+  while (q < n_q && pfDead[q])
+    q++;
+
+  return q;
+}
+
+
+/* Work out which quads start a basic block */
+
+static void near FindLeaders(void)
+{
+  VMADDR q, t;
+
+  memset(pfLeader, '\0', (size_t)n_q+1);
+  pfLeader[NextLive(0)]=TRUE;
+
+  for (q=0; q < n_q; q++)
+  {
+    if (pfDead[q])
+      continue;
+
+    if (pinQ[q].opcode==QOP_FUNCSTART)
+      pfLeader[q]=TRUE;
+
+    if (IsJump(pinQ[q].opcode) && (t=pinQ[q].res.jump_label) <= n_q)
+      pfLeader[NextLive(t)]=TRUE;
+
+    if (EndsBlock(pinQ + q))
+      pfLeader[NextLive(q+1)]=TRUE;
+  }
+}
+
+
+/* Returns TRUE if temporary 'ofs' isn't read again after quad 'q' */
+
+static int near DeadAfter(VMADDR q, VMADDR ofs)
+{
+  INST *pi;
+
+  for (q=NextLive(q+1); q < n_q; q=NextLive(q+1))
+  {
+    pi=pinQ + q;
+
+    if (pfLeader[q])
+      return TRUE;
+
+    if (QuadUses(pi, ofs))
+      return FALSE;
+
+    if (QuadSets(pi, ofs) || EndsBlock(pi) || pi->opcode==QOP_FUNCJUMP)
+      return TRUE;
+  }
+
+  return TRUE;
+}
+
+
+/* Get a literal argument as a dword */
+
+static dword near LitValue(union _lit_or_addr *pl, FORM form)
+{
+  switch (form)
+  {
+    case FormByte:  return pl->litbyte;
+    case FormWord:  return pl->litword;
+    default:        return pl->litdword;
+  }
+}
+
+
+/* Sign-extend a value of the given form */
+
+static sdword near SignExtend(dword v, FORM form)
+{
+  switch (form)
+  {
+    case FormByte:  return (sbyte)v;
+    case FormWord:  return (sword)v;
+    default:        return (sdword)v;
+  }
+}
+
+
+/* Fold an arithmetic quad with two constant arguments into an assignment *
+ * of the result.  This does the same sums as the VM does at run-time.    */
+
+static int near FoldQuad(INST *pi)
+{
+  FORM form=pi->opform, rform;
+  int sgn=(pi->flag & (FLAG_ARG1_SIGNED|FLAG_ARG2_SIGNED)) != 0;
+  unsigned bits;
+  dword a, b, r;
+  sdword sa, sb;
+  IADDR dest;
+
+  if (OpKind(pi->opcode) != OK_ARITH || !IsNumForm(form) ||
+      (pi->flag & (FLAG_ARG1_LIT|FLAG_ARG2_LIT)) != (FLAG_ARG1_LIT|FLAG_ARG2_LIT) ||
+      (pi->flag & (FLAG_ARG1_ADDR|FLAG_ARG2_ADDR)))
+  {
+    return FALSE;
+  }
+
+  bits=(form==FormByte ? sizeof(byte) : form==FormWord ? sizeof(word) :
+        sizeof(dword)) * 8;
+
+  a=LitValue(&pi->arg1, form);
+  b=LitValue(&pi->arg2, form);
+  sa=SignExtend(a, form);
+  sb=SignExtend(b, form);
+  rform=ResultForm(pi);
+
+  switch (pi->opcode)
+  {
+    case QOP_ADD:       r=a+b;  break;
+    case QOP_SUBTRACT:  r=a-b;  break;
+    case QOP_MULTIPLY:  r=a*b;  break;
+    case QOP_BAND:      r=a&b;  break;
+    case QOP_BOR:       r=a|b;  break;
+
+    case QOP_SHL:
+      if (b >= bits)
+        return FALSE;
+
+      r=a << b;
+      break;
+
+    case QOP_SHR:
+      if (b >= bits)
+        return FALSE;
+
+      r=(pi->flag & FLAG_ARG1_SIGNED) ? (dword)(sa >> b) : a >> b;
+      break;
+
+    case QOP_DIVIDE:
+    case QOP_MODULUS:
+      if (b==0 || (sgn && sb==-1))
+        return FALSE;
+
+      if (pi->opcode==QOP_DIVIDE)
+        r=sgn ? (dword)(sa / sb) : a / b;
+      else r=sgn ? (dword)(sa % sb) : a % b;
+      break;
+
+    case QOP_LE:  r=sgn ? (sa <= sb) : (a <= b);  break;
+    case QOP_LT:  r=sgn ? (sa <  sb) : (a <  b);  break;
+    case QOP_EQ:  r=(a == b);                     break;
+    case QOP_NE:  r=(a != b);                     break;
+    case QOP_GE:  r=sgn ? (sa >= sb) : (a >= b);  break;
+    case QOP_GT:  r=sgn ? (sa >  sb) : (a >  b);  break;
+    case QOP_LAND:r=(a && b);                     break;
+    case QOP_LOR: r=(a || b);                     break;
+
+    default:
+      return FALSE;
+  }
+
+  /* Turn it into "r -> dest" */
+
+  dest=pi->res.dest;
+
+  memset(&pi->arg1, '\0', sizeof pi->arg1);
+  memset(&pi->arg2, '\0', sizeof pi->arg2);
+  memset(&pi->res, '\0', sizeof pi->res);
+
+  switch (rform)
+  {
+    case FormByte:  pi->arg1.litbyte=(byte)r;   break;
+    case FormWord:  pi->arg1.litword=(word)r;   break;
+    default:        pi->arg1.litdword=r;        break;
+  }
+
+  pi->opcode=QOP_ASSIGN;
+  pi->opform=rform;
+  pi->flag=FLAG_ARG1_LIT;
+  pi->arg2.addr=dest;
+
+  return TRUE;
+}
+
+
+/* Replace argument 'n' of 'pi' with the source of assignment 'pa' */
+
+static void near SubstArg(INST *pi, int n, INST *pa)
+{
+  union _lit_or_addr *pl=(n==1) ? &pi->arg1 : &pi->arg2;
+
+  *pl=pa->arg1;
+
+  if (pa->flag & FLAG_ARG1_LIT)
+    pi->flag |= ARG_LIT(n);
+  else pi->flag &= ~ARG_LIT(n);
+}
+
+
+/* Forward "src -> temp" into the quads which read the temporary, where   *
+ * src is a constant or another temporary.  Returns TRUE if the           *
+ * assignment could be removed.                                           */
+
+static int near Propagate(VMADDR q)
+{
+  INST *pa=pinQ + q, *pi;
+  VMADDR t, s=0, j;
+  int fLit, fBlocked=FALSE, n, k;
+
+  if (pa->opcode != QOP_ASSIGN || !IsNumForm(pa->opform) ||
+      (pa->flag & (FLAG_ARG1_ADDR|FLAG_ARG2_ADDR)) ||
+      !IsOptTemp(&pa->arg2.addr))
+  {
+    return FALSE;
+  }
+
+  t=pa->arg2.addr.offset;
+  fLit=(pa->flag & FLAG_ARG1_LIT) != 0;
+
+  if (!fLit)
+  {
+    if (!IsTempAddr(&pa->arg1.addr) || pa->arg1.addr.offset >= TEMP_BASE_ADDR ||
+        (s=pa->arg1.addr.offset)==t)
+      return FALSE;
+  }
+
+  for (j=NextLive(q+1); j < n_q && !pfLeader[j]; j=NextLive(j+1))
+  {
+    pi=pinQ + j;
+    k=OpKind(pi->opcode);
+
+    /* Substitute the simple reads of the same width */
+
+    for (n=1; n <= 2; n++)
+    {
+      if (!ArgReadsTemp(pi, n, t))
+        continue;
+
+      if (pi->opform==pa->opform &&
+          (k==OK_ARITH || ((k==OK_CONV || k==OK_ASSIGN || k==OK_TEST) && n==1)))
+      {
+        SubstArg(pi, n, pa);
+      }
+    }
+
+    if (QuadUses(pi, t))
+      fBlocked=TRUE;
+
+    if (QuadSets(pi, t))
+      return !fBlocked;
+
+    if (EndsBlock(pi) || pi->opcode==QOP_FUNCJUMP)
+      return !fBlocked;
+
+    /* Stop once the source changes */
+
+    if (!fLit && QuadSets(pi, s))
+      return (!fBlocked && DeadAfter(j, t));
+  }
+
+  return !fBlocked;
+}
+
+
+/* Turn "op -> temp; temp -> x" into "op -> x" */
+
+static int near Forward(VMADDR q)
+{
+  INST *pi=pinQ + q, *pa;
+  VMADDR j;
+  int k=OpKind(pi->opcode);
+
+  if ((k != OK_ARITH && k != OK_CONV) || !IsNumForm(pi->opform) ||
+      !IsOptTemp(&pi->res.dest))
+  {
+    return FALSE;
+  }
+
+  if ((j=NextLive(q+1)) >= n_q || pfLeader[j])
+    return FALSE;
+
+  pa=pinQ + j;
+
+  if (pa->opcode != QOP_ASSIGN || pa->opform != ResultForm(pi) ||
+      (pa->flag & (FLAG_ARG1_ADDR|FLAG_ARG2_ADDR|FLAG_ARG1_LIT)) ||
+      !IsTempAddr(&pa->arg1.addr) ||
+      pa->arg1.addr.offset != pi->res.dest.offset ||
+      pa->arg2.addr.segment==SEG_GLOBAL ||
+      !DeadAfter(j, pi->res.dest.offset))
+  {
+    return FALSE;
+  }
+
+  pi->res.dest=pa->arg2.addr;
+  pfDead[j]=TRUE;
+  return TRUE;
+}
+
+
+/* Remove a quad which only sets a temporary that nobody reads */
+
+static int near DeadStore(VMADDR q)
+{
+  INST *pi=pinQ + q;
+  IADDR *pd;
+
+  switch (OpKind(pi->opcode))
+  {
+    case OK_ARITH:
+      if (pi->opcode==QOP_DIVIDE || pi->opcode==QOP_MODULUS)
+        return FALSE;
+      /* fall through */
+
+    case OK_CONV:
+      pd=&pi->res.dest;
+      break;
+
+    case OK_ASSIGN:
+      pd=&pi->arg2.addr;
+      break;
+
+    default:
+      return FALSE;
+  }
+
+  if (!IsNumForm(pi->opform) || !IsOptTemp(pd) || !DeadAfter(q, pd->offset))
+    return FALSE;
+
+  pfDead[q]=TRUE;
+  return TRUE;
+}
+
+
+/* Thread jumps to jumps, and remove jumps to the next quad */
+
+static int near ThreadJump(VMADDR q)
+{
+  INST *pi=pinQ + q;
+  VMADDR t;
+  int n, fChanged=FALSE;
+
+  if (!IsJump(pi->opcode) || pi->res.jump_label > n_q)
+    return FALSE;
+
+  for (n=0, t=NextLive(pi->res.jump_label);
+       n < MAX_JMP_CHAIN && t < n_q && t != q && pinQ[t].opcode==QOP_JMP &&
+         pinQ[t].res.jump_label <= n_q;
+       n++)
+  {
+    t=NextLive(pinQ[t].res.jump_label);
+  }
+
+  if (t != pi->res.jump_label)
+  {
+    pi->res.jump_label=t;
+    fChanged=TRUE;
+  }
+
+  if (t==NextLive(q+1))
+  {
+    pfDead[q]=TRUE;
+    fChanged=TRUE;
+  }
+
+  return fChanged;
+}
+
+
+/* Optimize the 'n_inst' quads in 'pin'.  Quads which are no longer        *
+ * needed are removed, and the rest are moved down to fill the gaps.       *
+ * pvaMap[n_inst+1] receives the new number of each old quad; a quad that  *
+ * was removed gets the same number as the quad after it.  Returns the     *
+ * new number of quads.                                                   */
+
+VMADDR OptimizeQuads(INST *pin, VMADDR n_inst, VMADDR *pvaMap)
+{
+  VMADDR q, n;
+  int pass, fChanged;
+
+  pinQ=pin;
+  n_q=n_inst;
+  pfDead=smalloc((size_t)n_inst+1);
+  pfLeader=smalloc((size_t)n_inst+1);
+
+  memset(pfDead, '\0', (size_t)n_inst+1);
+
+  for (pass=0, fChanged=TRUE; fChanged && pass < MAX_OPT_PASS; pass++)
+  {
+    fChanged=FALSE;
+
+    for (q=0; q < n_q; q++)
+      if (!pfDead[q] && FoldQuad(pinQ + q))
+        fChanged=TRUE;
+
+    FindLeaders();
+
+    for (q=0; q < n_q; q++)
+      if (!pfDead[q] && Propagate(q))
+      {
+        pfDead[q]=TRUE;
+        fChanged=TRUE;
+      }
+
+    FindLeaders();
+
+    for (q=0; q < n_q; q++)
+      if (!pfDead[q] && (Forward(q) || DeadStore(q)))
+        fChanged=TRUE;
+
+    FindLeaders();
+
+    for (q=0; q < n_q; q++)
+      if (!pfDead[q] && ThreadJump(q))
+      {
+        fChanged=TRUE;
+        FindLeaders();
+      }
+  }
+
+  /* Squeeze out the dead quads and renumber the jumps */
+
+  for (q=n=0; q < n_q; q++)
+  {
+    pvaMap[q]=n;
+
+    if (!pfDead[q])
+      n++;
+  }
+
+  pvaMap[n_q]=n;
+
+  for (q=0; q < n_q; q++)
+    if (!pfDead[q])
+    {
+      pinQ[pvaMap[q]]=pinQ[q];
+
+      if (IsJump(pinQ[q].opcode) && pinQ[q].res.jump_label <= n_q)
+        pinQ[pvaMap[q]].res.jump_label=pvaMap[pinQ[q].res.jump_label];
+    }
+
+  free(pfLeader);
+  free(pfDead);
+
+  return n;
+}
+
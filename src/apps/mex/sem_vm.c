@@ -40,12 +40,21 @@ static struct _implist *ilist=NULL; /* LList of global variables            */
 static struct _fcall *fclist=NULL;  /* LList of functions we CALL           */
 static struct _funcdef *fdlist=NULL;/* LList of functions we DEFINED        */
 
+static INST *pinQuads=NULL;         /* Quads generated so far               */
+static VMADDR n_quad_alloc=0;       /* Number of slots allocated in pinQuads*/
+
+static struct _dline *pdlQuads=NULL;/* Source line of each quad (-g)        */
+static char **ppszFiles=NULL;       /* Source files named in pdlQuads       */
+static word n_files=0;
+
 static int near copy_arg(union _lit_or_addr *arg, DATAOBJ *obj, word argn);
 static int near WriteQuad(INST *quad);
 static void near add_global(char *name, VMADDR size, struct _conval *init, word argn);
 static void near add_funccall(ATTRIBUTES *f);
 static void near add_funcdef(ATTRIBUTES *f);
 static void near handle_func_arg(INST *inst, QUADOP op, DATAOBJ *o, DATAOBJ *o2);
+static void near OptimizeVM(void);
+static int near WriteLineTable(void);
 
 #define VM_BUFSIZE  16384
 
@@ -100,9 +109,25 @@ int close_vm(void)
   struct _fcall *fc, *fcnext;
   int n_imp, n_fdef, n_fcall; 
 
-  /* Append to the end of the file */
+  if (optimize)
+    OptimizeVM();
+
+  /* The quads are kept in memory until now, so write them out right        *
+   * after the header.                                                      */
+
+  Bseek(bVm, (long)sizeof(struct _vmh), BSEEK_SET);
 
-  Bseek(bVm, 0L, BSEEK_END);
+  if (this_quad && Bwrite(bVm, (char *)pinQuads, sizeof(INST) * this_quad)
+                                          != (int)(sizeof(INST) * this_quad))
+  {
+    return -1;
+  }
+
+  if (pinQuads)
+    free(pinQuads);
+
+  pinQuads=NULL;
+  n_quad_alloc=0;
 
   /* Scan the linked list of symbol names, and output any import symbols */
   
@@ -211,6 +236,9 @@ int close_vm(void)
       free(fc->name);
   }
 
+  if (pdlQuads && WriteLineTable()==-1)
+    return -1;
+
   
   
   Bseek(bVm, 0L, BSEEK_SET);
@@ -440,15 +468,57 @@ static int near copy_arg(union _lit_or_addr *arg, DATAOBJ *obj, word argn)
 }
 
 
-/* Write a quadruple to the .VM file. */
+/* Return the index of the current source file in ppszFiles */
+
+static word near LineFile(void)
+{
+  static word last=0;
+  word f;
+
+  if (last < n_files && eqstr(ppszFiles[last], filename))
+    return last;
+
+  for (f=0; f < n_files; f++)
+    if (eqstr(ppszFiles[f], filename))
+      return (last=f);
+
+  ppszFiles=realloc(ppszFiles, sizeof(char *) * (n_files+1));
+
+  if (ppszFiles==NULL)
+    NoMem();
+
+  ppszFiles[n_files]=sstrdup(filename);
+  return (last=n_files++);
+}
+
+
+/* Add a quadruple to the list that will be written to the .VM file */
 
 static int near WriteQuad(INST *quad)
 {
-  if (Bwrite(bVm, (char *)quad, sizeof(INST)) != sizeof(INST))
-    return -1;
-  
+  if (this_quad >= n_quad_alloc)
+  {
+    n_quad_alloc=n_quad_alloc ? n_quad_alloc*2 : 1024;
+
+    if ((pinQuads=realloc(pinQuads, sizeof(INST) * n_quad_alloc))==NULL)
+      NoMem();
+
+    if (line_info &&
+        (pdlQuads=realloc(pdlQuads, sizeof(struct _dline) * n_quad_alloc))==NULL)
+      NoMem();
+  }
+
+  pinQuads[this_quad]=*quad;
+
+  if (pdlQuads)
+  {
+    pdlQuads[this_quad].quad=this_quad;
+    pdlQuads[this_quad].line=(dword)linenum;
+    pdlQuads[this_quad].file=LineFile();
+  }
+
   #ifdef DEBUG
-  printf("t=%d, %ld\n", this_quad, Btell(bVm));
+  printf("t=%d\n", this_quad);
   #endif
 
   this_quad++;
@@ -456,46 +526,149 @@ static int near WriteQuad(INST *quad)
 }
 
 
-/* Backpatch a series of quadruples in the .VM file, setting them to        *
- * jump to the quad 'to_where'.                                            */
+/* Backpatch a series of quadruples, setting them to jump to the quad       *
+ * 'to_where'.                                                              */
 
 int BackPatchVM(PATCH *pat, VMADDR to_where)
 {
-  INST inst;
   PATCH *p;
 
-  /* Scan the linked list of quads */
-
   for (p=pat; p; p=p->next)
   {
-    /* Seek to the offset of this quad */
+    if (p->quad >= this_quad)
+      return -1;
 
-    Bseek(bVm, sizeof(struct _vmh)+(sizeof(INST)*(long)p->quad), BSEEK_SET);
+    pinQuads[p->quad].res.jump_label=to_where;
+  }
 
-    /* Read it in */
+  return 0;
+}
+
+
+/* Run the optimizer over the quads, and then renumber everything that     *
+ * refers to a quad by number: function entry points, function calls and   *
+ * the places where globals are patched.                                   */
+
+static void near OptimizeVM(void)
+{
+  struct _implist *gp, *gpnext, *gplast;
+  struct _ipatlist *pl, *plnext, *pllast;
+  struct _funcdef *fd;
+  struct _fcall *fc;
+  VMADDR *pvaMap, q, n_old;
+
+  if (!this_quad)
+    return;
+
+  pvaMap=smalloc(sizeof(VMADDR) * ((size_t)this_quad+1));
+
+  n_old=this_quad;
+  this_quad=OptimizeQuads(pinQuads, this_quad, pvaMap);
+
+  /* A quad which was removed maps to the same number as the one after it */
+
+  if (pdlQuads)
+    for (q=0; q < n_old; q++)
+      if (pvaMap[q] != pvaMap[q+1])
+      {
+        pdlQuads[pvaMap[q]]=pdlQuads[q];
+        pdlQuads[pvaMap[q]].quad=pvaMap[q];
+      }
+
+  for (fd=fdlist; fd; fd=fd->next)
+    fd->quad=pvaMap[fd->quad];
+
+  for (fc=fclist; fc; fc=fc->next)
+    fc->quad=pvaMap[fc->quad];
+
+  for (gp=ilist, gplast=NULL; gp; gp=gpnext)
+  {
+    gpnext=gp->next;
+
+    for (pl=gp->pat, pllast=NULL; pl; pl=plnext)
+    {
+      plnext=pl->next;
+
+      if (pvaMap[pl->pat.ip]==pvaMap[pl->pat.ip+1])
+      {
+        if (pllast)
+          pllast->next=plnext;
+        else gp->pat=plnext;
+
+        free(pl);
+        gp->ref.n_patch--;
+      }
+      else
+      {
+        pl->pat.ip=pvaMap[pl->pat.ip];
+        pllast=pl;
+      }
+    }
+
+    /* Drop constants which are no longer referenced at all */
+
+    if (!gp->ref.n_patch && !*gp->ref.name)
+    {
+      if (gplast)
+        gplast->next=gpnext;
+      else ilist=gpnext;
+
+      vmh.lGlobSize -= gp->ref.size;
+      free(gp);
+    }
+    else gplast=gp;
+  }
+
+  free(pvaMap);
+}
 
-    if (Bread(bVm, (char *)&inst, sizeof(INST)) != sizeof(INST))
-      return -1;
 
-    /* Seek back to the start of the quad, so we can later write
-     * over it.
-     */
+/* Append the line number table.  Only the quads where the line changes  *
+ * are written; the VM looks up the last entry at or before a given quad.  */
 
-    Bseek(bVm, -(long)sizeof(INST), BSEEK_CUR);
+static int near WriteLineTable(void)
+{
+  struct _dltrail dlt;
+  struct _dlfile dlf;
+  struct _dline *pdl;
+  word f;
+
+  memset(&dlt, '\0', sizeof dlt);
 
-    inst.res.jump_label=to_where;
+  for (pdl=pdlQuads; pdl < pdlQuads+this_quad; pdl++)
+    if (pdl==pdlQuads || pdl->line != pdl[-1].line || pdl->file != pdl[-1].file)
+    {
+      if (Bwrite(bVm, (char *)pdl, sizeof *pdl) != sizeof *pdl)
+        return -1;
 
-    if (Bwrite(bVm, (char *)&inst, sizeof(INST)) != sizeof(INST))
+      dlt.n_line++;
+    }
+
+  for (f=0; f < n_files; f++)
+  {
+    memset(&dlf, '\0', sizeof dlf);
+    strncpy(dlf.name, ppszFiles[f], DL_PATHLEN-1);
+
+    if (Bwrite(bVm, (char *)&dlf, sizeof dlf) != sizeof dlf)
       return -1;
+
+    free(ppszFiles[f]);
   }
 
-  /* Seek back to the end of the file, for appending more quadruples to     *
-   * the end of the file.                                                   */
+  dlt.n_file=n_files;
+  memmove(dlt.id, DL_ID, sizeof dlt.id);
 
-  Bseek(bVm, 0L, BSEEK_END);
-  return 0;
-}
+  free(pdlQuads);
+
+  if (ppszFiles)
+    free(ppszFiles);
 
+  pdlQuads=NULL;
+  ppszFiles=NULL;
+  n_files=0;
+
+  return (Bwrite(bVm, (char *)&dlt, sizeof dlt)==sizeof dlt) ? 0 : -1;
+}
 
 
 /* Creates a record which will cause VM to allocate space for this symbol   *
@@ -560,7 +733,21 @@ static void near add_global(char *name, VMADDR size, struct _conval *init, word
 
   gp=NULL;
 
-  if (name)
+  /* When optimizing, identical string constants share one copy */
+
+  if (optimize && !name && init)
+  {
+    for (gp=ilist; gp; gp=gp->next)
+      if (gp->ref.init && !*gp->ref.name && gp->ref.size==size &&
+          memcmp(gp->init->buf, init->buf, (size_t)size)==0)
+      {
+        newpat->next=gp->pat;
+        gp->pat=newpat;
+        gp->ref.n_patch++;
+        break;
+      }
+  }
+  else if (name)
   {
     for (gp=ilist; gp; gp=gp->next)
     {
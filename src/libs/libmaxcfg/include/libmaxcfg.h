@@ -77,7 +77,8 @@ typedef enum MaxCfgStatus {
     MAXCFG_ERR_NOT_DIR,
     MAXCFG_ERR_IO,
     MAXCFG_ERR_PATH_TOO_LONG,
-    MAXCFG_ERR_DUPLICATE           /**< Key/namespace already exists */
+    MAXCFG_ERR_DUPLICATE,          /**< Key/namespace already exists */
+    MAXCFG_ERR_STALE               /**< Snapshot doesn't match its sources */
 } MaxCfgStatus;
 
 /**
@@ -735,6 +736,19 @@ MaxCfgStatus maxcfg_toml_init(MaxCfgToml **out_toml);
 /** @brief Free a TOML store handle and all loaded data. */
 void maxcfg_toml_free(MaxCfgToml *toml);
 
+/**
+ * @brief Return the store's generation number.
+ *
+ * The number changes whenever a file is loaded or an override is set,
+ * unset or persisted, and is never reused, even by another store. Callers
+ * that cache values returned by maxcfg_toml_get() (whose strings point into
+ * the store) can keep them for as long as the generation is unchanged.
+ *
+ * @param toml  TOML store handle.
+ * @return Generation number, or 0 if @p toml is NULL.
+ */
+unsigned long maxcfg_toml_generation(const MaxCfgToml *toml);
+
 /**
  * @brief Load a TOML file into the store under an optional dotted prefix.
  *
@@ -745,6 +759,50 @@ void maxcfg_toml_free(MaxCfgToml *toml);
  */
 MaxCfgStatus maxcfg_toml_load_file(MaxCfgToml *toml, const char *path, const char *prefix);
 
+/**
+ * @brief Record a file or directory that the store's contents depend on.
+ *
+ * Files read by maxcfg_toml_load_file() are recorded automatically (even
+ * ones that don't exist).  Use this for anything else that decided what
+ * was loaded, such as a directory that was scanned for files.
+ *
+ * @param toml  TOML store handle.
+ * @param path  Filesystem path.
+ * @return MAXCFG_OK on success, or an error status.
+ */
+MaxCfgStatus maxcfg_toml_add_dependency(MaxCfgToml *toml, const char *path);
+
+/**
+ * @brief Write the store's loaded tree to a compiled snapshot file.
+ *
+ * The snapshot holds the merged tree (not overrides), the list of loaded
+ * files and the state of every dependency.  It is only readable by the
+ * same build of libmaxcfg.  The file is replaced atomically.
+ *
+ * @param toml  TOML store handle.
+ * @param path  Snapshot file to write.
+ * @return MAXCFG_OK on success, MAXCFG_ERR_STALE if a dependency changed
+ *         after it was read, or another error status.
+ */
+MaxCfgStatus maxcfg_toml_snapshot_write(const MaxCfgToml *toml, const char *path);
+
+/**
+ * @brief Map a compiled snapshot into a newly initialized store.
+ *
+ * The tree is used in place from a private read-only mapping, so string
+ * and table data is shared with every other process using the same file.
+ * Loading a file or persisting an override afterwards gives the store a
+ * private copy of the tree first.
+ *
+ * @param toml  TOML store handle, with nothing loaded yet.
+ * @param path  Snapshot file written by maxcfg_toml_snapshot_write().
+ * @return MAXCFG_OK on success, MAXCFG_ERR_NOT_FOUND if there is no
+ *         snapshot, MAXCFG_ERR_STALE if it was written by another build or
+ *         any dependency has changed, or another error status.  On failure
+ *         the store is left empty.
+ */
+MaxCfgStatus maxcfg_toml_snapshot_load(MaxCfgToml *toml, const char *path);
+
 /**
  * @brief Retrieve a value from the TOML store by dotted path.
  *
@@ -807,6 +865,19 @@ MaxCfgStatus maxcfg_toml_persist_overrides_and_save(MaxCfgToml *toml);
  */
 MaxCfgStatus maxcfg_toml_table_get(const MaxCfgVar *table, const char *key, MaxCfgVar *out);
 
+/**
+ * @brief Access a table's entries by index, in file order.
+ *
+ * Use maxcfg_var_count() for the number of entries.
+ *
+ * @param table    Table variable.
+ * @param index    Zero-based entry index.
+ * @param out_key  Receives the entry's key.
+ * @param out      Receives the entry's value.
+ * @return MAXCFG_OK on success, MAXCFG_ERR_NOT_FOUND if out of range.
+ */
+MaxCfgStatus maxcfg_toml_table_entry(const MaxCfgVar *table, size_t index, const char **out_key, MaxCfgVar *out);
+
 /**
  * @brief Access an element by index within an array-type MaxCfgVar.
  *
@@ -38,12 +38,26 @@ typedef struct {
     int count;               /**< Number of bound parameters */
 } MaxLangParams;
 
+/** Metadata for one of a string's parameters (params = [...] in the TOML) */
+typedef struct {
+    const char *name;        /**< Parameter name */
+    const char *type;        /**< Declared type, e.g. "string" */
+    const char *desc;        /**< Description */
+    const char *def;         /**< Default (sample) value */
+} MaxLangParamInfo;
+
 /* ========================================================================== */
 /* Lifecycle                                                                   */
 /* ========================================================================== */
 
 /**
- * @brief Load a language file from TOML.
+ * @brief Load a language file.
+ *
+ * If a compiled table (the same path with .mlc in place of .toml) was
+ * built from the current .toml, it is mapped read-only and shared with
+ * every other process using it.  Otherwise the .toml is parsed and
+ * compiled in memory, and the .mlc is (re)written if the directory is
+ * writable.
  *
  * @param toml_path  Full path to the language .toml file.
  * @param out_lang   Receives the loaded language handle.
@@ -51,6 +65,15 @@ typedef struct {
  */
 MaxCfgStatus maxlang_open(const char *toml_path, MaxLang **out_lang);
 
+/**
+ * @brief Compile a language .toml file into a binary string table.
+ *
+ * @param toml_path  Full path to the language .toml file.
+ * @param out_path   Output file, or NULL for the .mlc next to toml_path.
+ * @return MAXCFG_OK on success, or an error status.
+ */
+MaxCfgStatus maxlang_compile(const char *toml_path, const char *out_path);
+
 /**
  * @brief Free a loaded language handle and all associated memory.
  */
@@ -89,6 +112,18 @@ const char *maxlang_get_rip(MaxLang *lang, const char *key);
  */
 bool maxlang_has_flag(MaxLang *lang, const char *key, const char *flag);
 
+/**
+ * @brief Get the metadata of one of a string's parameters.
+ *
+ * @param lang   Language handle.
+ * @param key    Dotted key.
+ * @param index  Zero-based parameter index (|!1 is 0).
+ * @param out    Receives the metadata; strings are valid until
+ *               maxlang_close().
+ * @return true if the string has that parameter.
+ */
+bool maxlang_get_param(MaxLang *lang, const char *key, int index, MaxLangParamInfo *out);
+
 /* ========================================================================== */
 /* Backward-compatible numeric access                                          */
 /* ========================================================================== */
@@ -107,7 +142,7 @@ const char *maxlang_get_by_id(MaxLang *lang, int strn);
 /**
  * @brief Resolve a legacy heap-relative string ID to a TOML string.
  *
- * Scans the [_legacy_map] to find the base ID for the named heap,
+ * Looks up the base ID for the named heap (its first [_legacy_map] ID),
  * then delegates to maxlang_get_by_id(lang, base + strn).
  *
  * @param lang       Language handle.
@@ -27,6 +27,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 /** @brief Case-insensitive string comparison (NULL-safe). */
@@ -317,10 +321,20 @@ typedef struct {
     TomlNode *value;
 } TomlTableEntry;
 
+/*
+ * Tables keep their entries in insertion order (the writers depend on it).
+ * Once a table reaches TOML_HASH_MIN entries it also gets an open-addressed
+ * hash of the keys, so lookups in large tables (areas, language strings)
+ * don't scan every entry.
+ */
+#define TOML_HASH_MIN 8u
+
 typedef struct {
     TomlTableEntry *items;
     size_t count;
     size_t capacity;
+    size_t *hash;       /* Bucket -> entry index + 1, 0 = empty; NULL if small */
+    size_t hash_size;   /* Number of buckets (power of two) */
 } TomlTable;
 
 typedef struct {
@@ -334,6 +348,15 @@ typedef struct {
     char *prefix;
 } TomlLoadedFile;
 
+/* A file (or directory) the tree was built from, as it was when read */
+typedef struct {
+    char *path;
+    int64_t mtime;
+    int64_t size;
+    uint64_t ino;
+    bool exists;
+} TomlSource;
+
 struct TomlNode {
     MaxCfgVarType type;
     union {
@@ -360,8 +383,27 @@ struct MaxCfgToml {
     TomlLoadedFile *loaded_files;
     size_t loaded_file_count;
     size_t loaded_file_capacity;
+    unsigned long generation;   /* See maxcfg_toml_generation() */
+    TomlSource *sources;        /* Inputs, for validating snapshots */
+    size_t source_count;
+    size_t source_capacity;
+    void *snap_base;            /* Mapped snapshot, or NULL */
+    size_t snap_size;
+    bool root_mapped;           /* root lives in snap_base (read-only) */
 };
 
+/* Source of generation numbers, shared by all stores so that a freed and
+ * re-created store never repeats one. */
+static unsigned long g_toml_generation = 0;
+
+/** @brief Give a store a new generation number after it has been changed. */
+static void toml_touch(MaxCfgToml *toml)
+{
+    if (toml != NULL) {
+        toml->generation = ++g_toml_generation;
+    }
+}
+
 static MaxCfgStatus parse_segment(const char *seg, char *name_out, size_t name_out_sz, bool *has_index, size_t *index_out);
 static TomlNode *toml_node_clone(const TomlNode *src);
 static void toml_kv_string(FILE *fp, const char *key, const char *value);
@@ -427,6 +469,84 @@ static MaxCfgStatus maxcfg_loaded_files_ensure_capacity(MaxCfgToml *toml, size_t
     return MAXCFG_OK;
 }
 
+/** @brief Free the source-file tracking array in a TOML handle. */
+static void maxcfg_free_sources(MaxCfgToml *toml)
+{
+    for (size_t i = 0; i < toml->source_count; i++) {
+        free(toml->sources[i].path);
+    }
+    free(toml->sources);
+    toml->sources = NULL;
+    toml->source_count = 0;
+    toml->source_capacity = 0;
+}
+
+/** @brief Fill in the current state of a source file. */
+static void toml_source_stat(TomlSource *src, const char *path)
+{
+    struct stat sb;
+
+    src->exists = (stat(path, &sb) == 0);
+    src->mtime = src->exists ? (int64_t)sb.st_mtime : 0;
+    src->size = src->exists ? (int64_t)sb.st_size : 0;
+    src->ino = src->exists ? (uint64_t)sb.st_ino : 0u;
+}
+
+/**
+ * @brief Record that the tree depends on a path, and what the path looked
+ *        like at the time.  Missing files are recorded too, since creating
+ *        one later changes what a fresh load would see.
+ */
+static MaxCfgStatus toml_note_source(MaxCfgToml *toml, const char *path)
+{
+    for (size_t i = 0; i < toml->source_count; i++) {
+        if (strcmp(toml->sources[i].path, path) == 0) {
+            toml_source_stat(&toml->sources[i], path);
+            return MAXCFG_OK;
+        }
+    }
+
+    if (toml->source_count == toml->source_capacity) {
+        size_t newcap = toml->source_capacity ? toml->source_capacity * 2u : 32u;
+        TomlSource *p = (TomlSource *)realloc(toml->sources, newcap * sizeof(*p));
+        if (p == NULL) {
+            return MAXCFG_ERR_OOM;
+        }
+        toml->sources = p;
+        toml->source_capacity = newcap;
+    }
+
+    TomlSource *src = &toml->sources[toml->source_count];
+    src->path = strdup(path);
+    if (src->path == NULL) {
+        return MAXCFG_ERR_OOM;
+    }
+    toml_source_stat(src, path);
+    toml->source_count++;
+    return MAXCFG_OK;
+}
+
+/**
+ * @brief Give the store a heap copy of a tree that was mapped from a
+ *        snapshot, so that it can be modified.  The mapping itself stays
+ *        until the store is freed, since callers may hold strings from it.
+ */
+static MaxCfgStatus toml_root_thaw(MaxCfgToml *toml)
+{
+    if (!toml->root_mapped) {
+        return MAXCFG_OK;
+    }
+
+    TomlNode *copy = toml_node_clone(toml->root);
+    if (copy == NULL) {
+        return MAXCFG_ERR_OOM;
+    }
+
+    toml->root = copy;
+    toml->root_mapped = false;
+    return MAXCFG_OK;
+}
+
 /** @brief Check whether a filesystem path is absolute. */
 static bool maxcfg_path_is_absolute(const char *path)
 {
@@ -1891,6 +2011,7 @@ static void toml_table_free(TomlTable *t);
 static void toml_array_free(TomlArray *a);
 static void toml_table_clear(TomlTable *t);
 static MaxCfgStatus toml_table_unset_node(TomlTable *t, const char *key);
+static void toml_table_rehash(TomlTable *t);
 
 /** @brief Recursively free a TOML node and all child data. */
 static void toml_node_free(TomlNode *n)
@@ -1941,6 +2062,7 @@ static void toml_table_free(TomlTable *t)
         toml_node_free(t->items[i].value);
     }
     free(t->items);
+    free(t->hash);
     free(t);
 }
 
@@ -1959,6 +2081,9 @@ static void toml_table_clear(TomlTable *t)
     t->items = NULL;
     t->count = 0;
     t->capacity = 0;
+    free(t->hash);
+    t->hash = NULL;
+    t->hash_size = 0;
 }
 
 /** @brief Remove a single entry from a TOML table by key. */
@@ -1979,6 +2104,9 @@ static MaxCfgStatus toml_table_unset_node(TomlTable *t, const char *key)
                 t->items[j - 1] = t->items[j];
             }
             t->count--;
+
+            /* Later entries moved down, so their buckets are stale */
+            toml_table_rehash(t);
             return MAXCFG_OK;
         }
     }
@@ -2156,20 +2284,107 @@ static MaxCfgStatus toml_array_ensure_capacity(TomlArray *a, size_t want)
     return MAXCFG_OK;
 }
 
-/** @brief Look up a node in a TOML table by key (linear scan). */
-static TomlNode *toml_table_get_node(const TomlTable *t, const char *key)
+/** @brief FNV-1a hash of the first len bytes of a key. */
+static size_t toml_key_hash(const char *key, size_t len)
 {
-    if (t == NULL || key == NULL) {
-        return NULL;
+    unsigned int h = 2166136261u;
+
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)key[i]) * 16777619u;
     }
+    return (size_t)h;
+}
+
+/** @brief Add entry idx of a table to its hash (the bucket array must have room). */
+static void toml_table_hash_insert(TomlTable *t, size_t idx)
+{
+    const char *key = t->items[idx].key;
+    size_t mask = t->hash_size - 1u;
+    size_t b = toml_key_hash(key, strlen(key)) & mask;
+
+    while (t->hash[b] != 0u) {
+        b = (b + 1u) & mask;
+    }
+    t->hash[b] = idx + 1u;
+}
+
+/**
+ * @brief Rebuild a table's key hash from its entries.
+ *
+ * Small tables don't get one. If memory runs short the table is left
+ * without a hash, which only makes lookups fall back to a linear scan.
+ */
+static void toml_table_rehash(TomlTable *t)
+{
+    size_t want = 16u;
+
+    free(t->hash);
+    t->hash = NULL;
+    t->hash_size = 0u;
+
+    if (t->count < TOML_HASH_MIN) {
+        return;
+    }
+
+    while (want < t->count * 2u) {
+        want *= 2u;
+    }
+
+    t->hash = (size_t *)calloc(want, sizeof(*t->hash));
+    if (t->hash == NULL) {
+        return;
+    }
+    t->hash_size = want;
 
     for (size_t i = 0; i < t->count; i++) {
-        if (t->items[i].key != NULL && strcmp(t->items[i].key, key) == 0) {
-            return t->items[i].value;
+        toml_table_hash_insert(t, i);
+    }
+}
+
+/** @brief Find the entry index for a key of length len, or return (size_t)-1. */
+static size_t toml_table_find(const TomlTable *t, const char *key, size_t len)
+{
+    if (t->hash != NULL) {
+        size_t mask = t->hash_size - 1u;
+
+        for (size_t b = toml_key_hash(key, len) & mask; t->hash[b] != 0u; b = (b + 1u) & mask) {
+            const char *k = t->items[t->hash[b] - 1u].key;
+            if (strncmp(k, key, len) == 0 && k[len] == '\0') {
+                return t->hash[b] - 1u;
+            }
         }
+        return (size_t)-1;
     }
 
-    return NULL;
+    for (size_t i = 0; i < t->count; i++) {
+        const char *k = t->items[i].key;
+        if (k != NULL && strncmp(k, key, len) == 0 && k[len] == '\0') {
+            return i;
+        }
+    }
+
+    return (size_t)-1;
+}
+
+/** @brief Look up a node by the first len characters of key. */
+static TomlNode *toml_table_get_node_n(const TomlTable *t, const char *key, size_t len)
+{
+    if (t == NULL || key == NULL) {
+        return NULL;
+    }
+
+    size_t i = toml_table_find(t, key, len);
+    return (i == (size_t)-1) ? NULL : t->items[i].value;
+}
+
+/** @brief Look up a node in a TOML table by key. */
+static TomlNode *toml_table_get_node(const TomlTable *t, const char *key)
+{
+    if (key == NULL) {
+        return NULL;
+    }
+
+    return toml_table_get_node_n(t, key, strlen(key));
 }
 
 /** @brief Insert or replace a key/value node in a TOML table. */
@@ -2179,12 +2394,11 @@ static MaxCfgStatus toml_table_set_node(TomlTable *t, const char *key, TomlNode
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
 
-    for (size_t i = 0; i < t->count; i++) {
-        if (t->items[i].key != NULL && strcmp(t->items[i].key, key) == 0) {
-            toml_node_free(t->items[i].value);
-            t->items[i].value = value;
-            return MAXCFG_OK;
-        }
+    size_t i = toml_table_find(t, key, strlen(key));
+    if (i != (size_t)-1) {
+        toml_node_free(t->items[i].value);
+        t->items[i].value = value;
+        return MAXCFG_OK;
     }
 
     MaxCfgStatus st = toml_table_ensure_capacity(t, t->count + 1u);
@@ -2198,6 +2412,13 @@ static MaxCfgStatus toml_table_set_node(TomlTable *t, const char *key, TomlNode
     }
     t->items[t->count].value = value;
     t->count++;
+
+    /* Keep the load factor at or below one half */
+    if (t->count * 2u > t->hash_size) {
+        toml_table_rehash(t);
+    } else {
+        toml_table_hash_insert(t, t->count - 1u);
+    }
     return MAXCFG_OK;
 }
 
@@ -3021,11 +3242,18 @@ MaxCfgStatus maxcfg_toml_init(MaxCfgToml **out_toml)
     t->loaded_files = NULL;
     t->loaded_file_count = 0;
     t->loaded_file_capacity = 0;
+    toml_touch(t);
 
     *out_toml = t;
     return MAXCFG_OK;
 }
 
+/** @brief Return a number that changes whenever the store's contents do. */
+unsigned long maxcfg_toml_generation(const MaxCfgToml *toml)
+{
+    return (toml != NULL) ? toml->generation : 0u;
+}
+
 /** @brief Free a TOML store handle and all loaded data. */
 void maxcfg_toml_free(MaxCfgToml *toml)
 {
@@ -3033,15 +3261,23 @@ void maxcfg_toml_free(MaxCfgToml *toml)
         return;
     }
 
-    toml_node_free(toml->root);
+    if (!toml->root_mapped) {
+        toml_node_free(toml->root);
+    }
+    if (toml->snap_base != NULL) {
+        munmap(toml->snap_base, toml->snap_size);
+    }
     toml_table_free(toml->overrides);
     maxcfg_free_loaded_files(toml);
+    maxcfg_free_sources(toml);
     free(toml);
 }
 
 /** @brief Load a TOML file into the store under an optional dotted prefix. */
 MaxCfgStatus maxcfg_toml_load_file(MaxCfgToml *toml, const char *path, const char *prefix)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->root == NULL || toml->root->type != MAXCFG_VAR_TABLE || path == NULL) {
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
@@ -3049,8 +3285,18 @@ MaxCfgStatus maxcfg_toml_load_file(MaxCfgToml *toml, const char *path, const cha
     const char *used_path = path;
     char alt_path[1024];
 
+    MaxCfgStatus st = toml_root_thaw(toml);
+    if (st != MAXCFG_OK) {
+        return st;
+    }
+
+    st = toml_note_source(toml, path);
+    if (st != MAXCFG_OK) {
+        return st;
+    }
+
     TomlTable *file_root = NULL;
-    MaxCfgStatus st = file_parse_into_table(path, &file_root);
+    st = file_parse_into_table(path, &file_root);
     if (st == MAXCFG_ERR_NOT_FOUND) {
         size_t n = strlen(path);
         bool has_toml_ext = false;
@@ -3070,6 +3316,10 @@ MaxCfgStatus maxcfg_toml_load_file(MaxCfgToml *toml, const char *path, const cha
             }
             memcpy(alt_path, path, n);
             memcpy(alt_path + n, ".toml", 6u);
+            st = toml_note_source(toml, alt_path);
+            if (st != MAXCFG_OK) {
+                return st;
+            }
             file_root = NULL;
             st = file_parse_into_table(alt_path, &file_root);
             if (st == MAXCFG_OK) {
@@ -3130,6 +3380,678 @@ MaxCfgStatus maxcfg_toml_load_file(MaxCfgToml *toml, const char *path, const cha
     return MAXCFG_OK;
 }
 
+/** @brief Record a file or directory the store's contents depend on. */
+MaxCfgStatus maxcfg_toml_add_dependency(MaxCfgToml *toml, const char *path)
+{
+    if (toml == NULL || path == NULL) {
+        return MAXCFG_ERR_INVALID_ARGUMENT;
+    }
+
+    return toml_note_source(toml, path);
+}
+
+/*
+ * Compiled snapshots.
+ *
+ * A snapshot is the store's merged tree written out in exactly the layout
+ * of the in-memory TomlNode/TomlTable/TomlArray structures, with every
+ * pointer stored as an offset from the start of the file.  Loading one is
+ * an mmap() and a pass over the list of pointer fields, instead of parsing
+ * every source file again.
+ *
+ * The file is [header][structures][pool][relocations].  Everything that
+ * holds a pointer is in the structures section.  Strings (one copy of each
+ * distinct key or value), hash buckets and int arrays are in the pool,
+ * which nothing ever writes to, so the pool pages of a privately mapped
+ * snapshot stay shared in the page cache by every node that maps it.
+ *
+ * The layout is only good for the build that wrote it, so the header
+ * records the pointer and structure sizes.  It also lists every source
+ * file with the mtime, size and inode it had when it was parsed; if any of
+ * them have changed, the snapshot is refused and the caller parses the
+ * text again.
+ */
+
+#define TOML_SNAP_MAGIC   "MAXSNAP"
+#define TOML_SNAP_VERSION 1u
+#define TOML_SNAP_NONE    ((size_t)-1)
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint16_t ptr_size;
+    uint16_t node_size;
+    uint16_t table_size;
+    uint16_t entry_size;
+    uint16_t array_size;
+    uint16_t reserved;
+    uint64_t file_size;
+    uint64_t root;              /* Offset of the root TomlNode */
+    uint64_t relocs;            /* Offset of the pointer field offsets */
+    uint64_t reloc_count;
+    uint64_t sources;           /* Offset of the TomlSnapSource array */
+    uint64_t source_count;
+    uint64_t files;             /* Offset of the TomlSnapFile array */
+    uint64_t file_count;
+} TomlSnapHeader;
+
+typedef struct {
+    uint64_t path;              /* Offset of the path string */
+    int64_t mtime;
+    int64_t size;
+    uint64_t ino;
+    uint64_t exists;
+} TomlSnapSource;
+
+typedef struct {
+    uint64_t path;
+    uint64_t prefix;
+} TomlSnapFile;
+
+/* One section of a snapshot being written */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} TomlSnapSection;
+
+/* A pointer field in the structures section, and what it points at */
+typedef struct {
+    size_t field;
+    size_t target;
+    bool in_pool;
+} TomlSnapRef;
+
+typedef struct {
+    TomlSnapSection obj;
+    TomlSnapSection pool;
+    TomlSnapRef *refs;
+    size_t ref_count;
+    size_t ref_cap;
+    size_t *strings;            /* Pool offset + 1 of each string, hashed */
+    size_t string_count;
+    size_t string_cap;          /* Power of two */
+    bool oom;
+} TomlSnapWriter;
+
+/** @brief Round up to a multiple of align (a power of two). */
+static size_t snap_align(size_t n, size_t align)
+{
+    return (n + align - 1u) & ~(align - 1u);
+}
+
+/** @brief Reserve zeroed, aligned space in a section; returns its offset. */
+static size_t snap_alloc(TomlSnapWriter *w, TomlSnapSection *sec, size_t size, size_t align)
+{
+    if (w->oom) {
+        return TOML_SNAP_NONE;
+    }
+
+    size_t off = snap_align(sec->len, align);
+    if (off + size > sec->cap) {
+        size_t newcap = sec->cap ? sec->cap : 65536u;
+        while (off + size > newcap) {
+            newcap *= 2u;
+        }
+        char *p = (char *)realloc(sec->data, newcap);
+        if (p == NULL) {
+            w->oom = true;
+            return TOML_SNAP_NONE;
+        }
+        sec->data = p;
+        sec->cap = newcap;
+    }
+
+    memset(sec->data + sec->len, 0, off + size - sec->len);
+    sec->len = off + size;
+    return off;
+}
+
+/** @brief Note that the pointer at obj offset field must point at target. */
+static void snap_ref(TomlSnapWriter *w, size_t field, size_t target, bool in_pool)
+{
+    if (w->oom || target == TOML_SNAP_NONE) {
+        return;
+    }
+
+    if (w->ref_count == w->ref_cap) {
+        size_t newcap = w->ref_cap ? w->ref_cap * 2u : 4096u;
+        TomlSnapRef *p = (TomlSnapRef *)realloc(w->refs, newcap * sizeof(*p));
+        if (p == NULL) {
+            w->oom = true;
+            return;
+        }
+        w->refs = p;
+        w->ref_cap = newcap;
+    }
+
+    w->refs[w->ref_count].field = field;
+    w->refs[w->ref_count].target = target;
+    w->refs[w->ref_count].in_pool = in_pool;
+    w->ref_count++;
+}
+
+/** @brief Add a string to the pool (once); returns its pool offset. */
+static size_t snap_string(TomlSnapWriter *w, const char *s)
+{
+    if (w->oom) {
+        return TOML_SNAP_NONE;
+    }
+
+    if ((w->string_count + 1u) * 2u > w->string_cap) {
+        size_t newcap = w->string_cap ? w->string_cap * 2u : 1024u;
+        size_t *p = (size_t *)calloc(newcap, sizeof(*p));
+        if (p == NULL) {
+            w->oom = true;
+            return TOML_SNAP_NONE;
+        }
+        for (size_t i = 0; i < w->string_cap; i++) {
+            if (w->strings[i] != 0u) {
+                const char *k = w->pool.data + w->strings[i] - 1u;
+                size_t b = toml_key_hash(k, strlen(k)) & (newcap - 1u);
+                while (p[b] != 0u) {
+                    b = (b + 1u) & (newcap - 1u);
+                }
+                p[b] = w->strings[i];
+            }
+        }
+        free(w->strings);
+        w->strings = p;
+        w->string_cap = newcap;
+    }
+
+    size_t len = strlen(s);
+    size_t mask = w->string_cap - 1u;
+    size_t b = toml_key_hash(s, len) & mask;
+
+    for (; w->strings[b] != 0u; b = (b + 1u) & mask) {
+        if (strcmp(w->pool.data + w->strings[b] - 1u, s) == 0) {
+            return w->strings[b] - 1u;
+        }
+    }
+
+    size_t off = snap_alloc(w, &w->pool, len + 1u, 1u);
+    if (off == TOML_SNAP_NONE) {
+        return TOML_SNAP_NONE;
+    }
+    memcpy(w->pool.data + off, s, len + 1u);
+    w->strings[b] = off + 1u;
+    w->string_count++;
+    return off;
+}
+
+static size_t snap_node(TomlSnapWriter *w, const TomlNode *n);
+
+/** @brief Write a table and its entries; returns its obj offset. */
+static size_t snap_table(TomlSnapWriter *w, const TomlTable *t)
+{
+    if (t == NULL) {
+        return TOML_SNAP_NONE;
+    }
+
+    size_t off = snap_alloc(w, &w->obj, sizeof(TomlTable), sizeof(void *));
+    if (off == TOML_SNAP_NONE) {
+        return TOML_SNAP_NONE;
+    }
+
+    TomlTable tmp;
+    memset(&tmp, 0, sizeof(tmp));
+    tmp.count = t->count;
+    tmp.capacity = t->count;
+
+    if (t->count > 0) {
+        size_t items = snap_alloc(w, &w->obj, t->count * sizeof(TomlTableEntry), sizeof(void *));
+        for (size_t i = 0; i < t->count && !w->oom; i++) {
+            size_t e = items + i * sizeof(TomlTableEntry);
+            const char *key = t->items[i].key;
+            snap_ref(w, e + offsetof(TomlTableEntry, key), snap_string(w, key ? key : ""), true);
+            snap_ref(w, e + offsetof(TomlTableEntry, value), snap_node(w, t->items[i].value), false);
+        }
+        snap_ref(w, off + offsetof(TomlTable, items), items, false);
+    }
+
+    if (t->hash != NULL) {
+        size_t hash = snap_alloc(w, &w->pool, t->hash_size * sizeof(t->hash[0]), sizeof(t->hash[0]));
+        if (hash != TOML_SNAP_NONE) {
+            memcpy(w->pool.data + hash, t->hash, t->hash_size * sizeof(t->hash[0]));
+            tmp.hash_size = t->hash_size;
+        }
+        snap_ref(w, off + offsetof(TomlTable, hash), hash, true);
+    }
+
+    if (!w->oom) {
+        memcpy(w->obj.data + off, &tmp, sizeof(tmp));
+    }
+    return off;
+}
+
+/** @brief Write a table array and its elements; returns its obj offset. */
+static size_t snap_array(TomlSnapWriter *w, const TomlArray *a)
+{
+    if (a == NULL) {
+        return TOML_SNAP_NONE;
+    }
+
+    size_t off = snap_alloc(w, &w->obj, sizeof(TomlArray), sizeof(void *));
+    if (off == TOML_SNAP_NONE) {
+        return TOML_SNAP_NONE;
+    }
+
+    TomlArray tmp;
+    memset(&tmp, 0, sizeof(tmp));
+    tmp.count = a->count;
+    tmp.capacity = a->count;
+
+    if (a->count > 0) {
+        size_t items = snap_alloc(w, &w->obj, a->count * sizeof(TomlNode *), sizeof(void *));
+        for (size_t i = 0; i < a->count && !w->oom; i++) {
+            snap_ref(w, items + i * sizeof(TomlNode *), snap_node(w, a->items[i]), false);
+        }
+        snap_ref(w, off + offsetof(TomlArray, items), items, false);
+    }
+
+    if (!w->oom) {
+        memcpy(w->obj.data + off, &tmp, sizeof(tmp));
+    }
+    return off;
+}
+
+/** @brief Write a node and everything under it; returns its obj offset. */
+static size_t snap_node(TomlSnapWriter *w, const TomlNode *n)
+{
+    if (n == NULL) {
+        return TOML_SNAP_NONE;
+    }
+
+    size_t off = snap_alloc(w, &w->obj, sizeof(TomlNode), sizeof(void *));
+    if (off == TOML_SNAP_NONE) {
+        return TOML_SNAP_NONE;
+    }
+
+    size_t field = off + offsetof(TomlNode, v);
+    TomlNode tmp;
+    memset(&tmp, 0, sizeof(tmp));
+    tmp.type = n->type;
+
+    switch (n->type) {
+    case MAXCFG_VAR_INT:
+        tmp.v.i = n->v.i;
+        break;
+    case MAXCFG_VAR_UINT:
+        tmp.v.u = n->v.u;
+        break;
+    case MAXCFG_VAR_BOOL:
+        tmp.v.b = n->v.b;
+        break;
+    case MAXCFG_VAR_STRING:
+        snap_ref(w, field, snap_string(w, n->v.s ? n->v.s : ""), true);
+        break;
+    case MAXCFG_VAR_STRING_ARRAY:
+        tmp.v.strv.count = n->v.strv.count;
+        if (n->v.strv.count > 0) {
+            size_t items = snap_alloc(w, &w->obj, n->v.strv.count * sizeof(char *), sizeof(char *));
+            for (size_t i = 0; i < n->v.strv.count && !w->oom; i++) {
+                const char *s = n->v.strv.items[i];
+                snap_ref(w, items + i * sizeof(char *), snap_string(w, s ? s : ""), true);
+            }
+            snap_ref(w, field, items, false);
+        }
+        break;
+    case MAXCFG_VAR_INT_ARRAY:
+        tmp.v.intv.count = n->v.intv.count;
+        if (n->v.intv.count > 0) {
+            size_t items = snap_alloc(w, &w->pool, n->v.intv.count * sizeof(int), sizeof(int));
+            if (items != TOML_SNAP_NONE) {
+                memcpy(w->pool.data + items, n->v.intv.items, n->v.intv.count * sizeof(int));
+            }
+            snap_ref(w, field, items, true);
+        }
+        break;
+    case MAXCFG_VAR_TABLE:
+        snap_ref(w, field, snap_table(w, n->v.table), false);
+        break;
+    case MAXCFG_VAR_TABLE_ARRAY:
+        snap_ref(w, field, snap_array(w, n->v.array), false);
+        break;
+    default:
+        break;
+    }
+
+    if (!w->oom) {
+        memcpy(w->obj.data + off, &tmp, sizeof(tmp));
+    }
+    return off;
+}
+
+/** @brief Write the store's tree to a snapshot file. */
+MaxCfgStatus maxcfg_toml_snapshot_write(const MaxCfgToml *toml, const char *path)
+{
+    if (toml == NULL || toml->root == NULL || toml->root->type != MAXCFG_VAR_TABLE || path == NULL) {
+        return MAXCFG_ERR_INVALID_ARGUMENT;
+    }
+
+    /* Don't record a tree whose sources have changed since they were read */
+    for (size_t i = 0; i < toml->source_count; i++) {
+        const TomlSource *src = &toml->sources[i];
+        TomlSource now;
+
+        toml_source_stat(&now, src->path);
+        if (now.exists != src->exists || now.mtime != src->mtime ||
+            now.size != src->size || now.ino != src->ino) {
+            return MAXCFG_ERR_STALE;
+        }
+    }
+
+    TomlSnapWriter w;
+    memset(&w, 0, sizeof(w));
+
+    size_t root = snap_node(&w, toml->root);
+
+    /* The structures section is complete, so pool offsets are now known */
+    size_t hdr_size = snap_align(sizeof(TomlSnapHeader), 16u);
+    size_t pool_base = hdr_size + snap_align(w.obj.len, 16u);
+
+    size_t sources = snap_alloc(&w, &w.pool, toml->source_count * sizeof(TomlSnapSource), 8u);
+    for (size_t i = 0; i < toml->source_count && !w.oom; i++) {
+        TomlSnapSource ss;
+        size_t str = snap_string(&w, toml->sources[i].path);
+
+        memset(&ss, 0, sizeof(ss));
+        ss.path = (uint64_t)(pool_base + str);
+        ss.mtime = toml->sources[i].mtime;
+        ss.size = toml->sources[i].size;
+        ss.ino = toml->sources[i].ino;
+        ss.exists = toml->sources[i].exists ? 1u : 0u;
+        if (!w.oom) {
+            memcpy(w.pool.data + sources + i * sizeof(ss), &ss, sizeof(ss));
+        }
+    }
+
+    size_t files = snap_alloc(&w, &w.pool, toml->loaded_file_count * sizeof(TomlSnapFile), 8u);
+    for (size_t i = 0; i < toml->loaded_file_count && !w.oom; i++) {
+        TomlSnapFile sf;
+        size_t p = snap_string(&w, toml->loaded_files[i].path);
+        size_t x = snap_string(&w, toml->loaded_files[i].prefix);
+
+        sf.path = (uint64_t)(pool_base + p);
+        sf.prefix = (uint64_t)(pool_base + x);
+        if (!w.oom) {
+            memcpy(w.pool.data + files + i * sizeof(sf), &sf, sizeof(sf));
+        }
+    }
+
+    size_t relocs = snap_align(pool_base + w.pool.len, 16u);
+    size_t file_size = relocs + w.ref_count * sizeof(uint64_t);
+    char *image = w.oom ? NULL : (char *)calloc(1, file_size);
+    MaxCfgStatus st = MAXCFG_OK;
+
+    if (image == NULL) {
+        st = MAXCFG_ERR_OOM;
+    } else {
+        TomlSnapHeader hdr;
+
+        for (size_t i = 0; i < w.ref_count; i++) {
+            const TomlSnapRef *r = &w.refs[i];
+            uintptr_t v = (uintptr_t)(r->target + (r->in_pool ? pool_base : hdr_size));
+            uint64_t field = (uint64_t)(hdr_size + r->field);
+
+            memcpy(w.obj.data + r->field, &v, sizeof(v));
+            memcpy(image + relocs + i * sizeof(field), &field, sizeof(field));
+        }
+
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, TOML_SNAP_MAGIC, sizeof(TOML_SNAP_MAGIC));
+        hdr.version = TOML_SNAP_VERSION;
+        hdr.ptr_size = (uint16_t)sizeof(void *);
+        hdr.node_size = (uint16_t)sizeof(TomlNode);
+        hdr.table_size = (uint16_t)sizeof(TomlTable);
+        hdr.entry_size = (uint16_t)sizeof(TomlTableEntry);
+        hdr.array_size = (uint16_t)sizeof(TomlArray);
+        hdr.file_size = file_size;
+        hdr.root = hdr_size + root;
+        hdr.relocs = relocs;
+        hdr.reloc_count = w.ref_count;
+        hdr.sources = pool_base + sources;
+        hdr.source_count = toml->source_count;
+        hdr.files = pool_base + files;
+        hdr.file_count = toml->loaded_file_count;
+
+        memcpy(image, &hdr, sizeof(hdr));
+        memcpy(image + hdr_size, w.obj.data, w.obj.len);
+        memcpy(image + pool_base, w.pool.data, w.pool.len);
+    }
+
+    free(w.obj.data);
+    free(w.pool.data);
+    free(w.refs);
+    free(w.strings);
+
+    if (st != MAXCFG_OK) {
+        return st;
+    }
+
+    /* Each writer gets its own temporary, since several nodes may be
+     * rebuilding the same snapshot at once; the rename is atomic. */
+    size_t tmp_len = strlen(path) + 32u;
+    char *tmp_path = (char *)malloc(tmp_len);
+    if (tmp_path == NULL) {
+        free(image);
+        return MAXCFG_ERR_OOM;
+    }
+    snprintf(tmp_path, tmp_len, "%s.%ld.tmp", path, (long)getpid());
+
+    FILE *fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        st = MAXCFG_ERR_IO;
+    } else {
+        if (fwrite(image, 1, file_size, fp) != file_size) {
+            st = MAXCFG_ERR_IO;
+        }
+        if (fclose(fp) != 0) {
+            st = MAXCFG_ERR_IO;
+        }
+        if (st == MAXCFG_OK && rename(tmp_path, path) != 0) {
+            st = MAXCFG_ERR_IO;
+        }
+        if (st != MAXCFG_OK) {
+            remove(tmp_path);
+        }
+    }
+
+    free(tmp_path);
+    free(image);
+    return st;
+}
+
+/** @brief Return the string at offset off in a mapped snapshot, or NULL. */
+static const char *snap_str(const char *base, size_t size, uint64_t off)
+{
+    if (off >= size || memchr(base + off, '\0', size - (size_t)off) == NULL) {
+        return NULL;
+    }
+    return base + off;
+}
+
+/** @brief Check that count elements of elem_size bytes at off lie in the file. */
+static bool snap_range_ok(size_t size, uint64_t off, uint64_t count, size_t elem_size)
+{
+    return off <= size && count <= (size - (size_t)off) / elem_size;
+}
+
+/** @brief Validate a mapped snapshot's header and compare its sources. */
+static MaxCfgStatus snap_check(const char *base, size_t size)
+{
+    const TomlSnapHeader *hdr = (const TomlSnapHeader *)base;
+
+    if (memcmp(hdr->magic, TOML_SNAP_MAGIC, sizeof(TOML_SNAP_MAGIC)) != 0 ||
+        hdr->version != TOML_SNAP_VERSION ||
+        hdr->ptr_size != sizeof(void *) ||
+        hdr->node_size != sizeof(TomlNode) ||
+        hdr->table_size != sizeof(TomlTable) ||
+        hdr->entry_size != sizeof(TomlTableEntry) ||
+        hdr->array_size != sizeof(TomlArray)) {
+        return MAXCFG_ERR_STALE;
+    }
+
+    if (hdr->file_size != size ||
+        hdr->root % sizeof(void *) != 0u || !snap_range_ok(size, hdr->root, 1u, sizeof(TomlNode)) ||
+        hdr->relocs % sizeof(uint64_t) != 0u || !snap_range_ok(size, hdr->relocs, hdr->reloc_count, sizeof(uint64_t)) ||
+        hdr->sources % 8u != 0u || !snap_range_ok(size, hdr->sources, hdr->source_count, sizeof(TomlSnapSource)) ||
+        hdr->files % 8u != 0u || !snap_range_ok(size, hdr->files, hdr->file_count, sizeof(TomlSnapFile))) {
+        return MAXCFG_ERR_IO;
+    }
+
+    const TomlSnapSource *ss = (const TomlSnapSource *)(base + hdr->sources);
+    for (uint64_t i = 0; i < hdr->source_count; i++) {
+        const char *path = snap_str(base, size, ss[i].path);
+        TomlSource now;
+
+        if (path == NULL) {
+            return MAXCFG_ERR_IO;
+        }
+
+        toml_source_stat(&now, path);
+        if (now.exists != (ss[i].exists != 0u) || now.mtime != ss[i].mtime ||
+            now.size != ss[i].size || now.ino != ss[i].ino) {
+            return MAXCFG_ERR_STALE;
+        }
+    }
+
+    return MAXCFG_OK;
+}
+
+/** @brief Copy a snapshot's source and loaded-file lists into the store. */
+static MaxCfgStatus snap_copy_lists(MaxCfgToml *toml, const char *base, size_t size)
+{
+    const TomlSnapHeader *hdr = (const TomlSnapHeader *)base;
+    const TomlSnapSource *ss = (const TomlSnapSource *)(base + hdr->sources);
+    const TomlSnapFile *sf = (const TomlSnapFile *)(base + hdr->files);
+
+    for (uint64_t i = 0; i < hdr->source_count; i++) {
+        MaxCfgStatus st = toml_note_source(toml, base + ss[i].path);
+        if (st != MAXCFG_OK) {
+            return st;
+        }
+    }
+
+    MaxCfgStatus st = maxcfg_loaded_files_ensure_capacity(toml, (size_t)hdr->file_count);
+    if (st != MAXCFG_OK) {
+        return st;
+    }
+
+    for (uint64_t i = 0; i < hdr->file_count; i++) {
+        const char *path = snap_str(base, size, sf[i].path);
+        const char *prefix = snap_str(base, size, sf[i].prefix);
+        TomlLoadedFile *lf = &toml->loaded_files[toml->loaded_file_count];
+
+        if (path == NULL || prefix == NULL) {
+            return MAXCFG_ERR_IO;
+        }
+
+        lf->path = strdup(path);
+        lf->prefix = strdup(prefix);
+        if (lf->path == NULL || lf->prefix == NULL) {
+            free(lf->path);
+            free(lf->prefix);
+            return MAXCFG_ERR_OOM;
+        }
+        toml->loaded_file_count++;
+    }
+
+    return MAXCFG_OK;
+}
+
+/** @brief Turn the offsets in a mapped snapshot back into pointers. */
+static MaxCfgStatus snap_relocate(char *base, size_t size)
+{
+    const TomlSnapHeader *hdr = (const TomlSnapHeader *)base;
+    const uint64_t *relocs = (const uint64_t *)(base + hdr->relocs);
+    uint64_t count = hdr->reloc_count;
+
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t field = relocs[i];
+        uintptr_t v;
+
+        if (field % sizeof(void *) != 0u || field >= hdr->relocs ||
+            hdr->relocs - field < sizeof(v)) {
+            return MAXCFG_ERR_IO;
+        }
+
+        memcpy(&v, base + field, sizeof(v));
+        if (v == 0u || v >= size) {
+            return MAXCFG_ERR_IO;
+        }
+
+        v += (uintptr_t)base;
+        memcpy(base + field, &v, sizeof(v));
+    }
+
+    return MAXCFG_OK;
+}
+
+/** @brief Replace an empty store's tree with a mapped snapshot. */
+MaxCfgStatus maxcfg_toml_snapshot_load(MaxCfgToml *toml, const char *path)
+{
+    if (toml == NULL || path == NULL || toml->snap_base != NULL ||
+        toml->root == NULL || toml->root->type != MAXCFG_VAR_TABLE ||
+        toml->root->v.table->count != 0 || toml->loaded_file_count != 0 ||
+        toml->source_count != 0) {
+        return MAXCFG_ERR_INVALID_ARGUMENT;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return (errno == ENOENT) ? MAXCFG_ERR_NOT_FOUND : MAXCFG_ERR_IO;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || sb.st_size < (off_t)sizeof(TomlSnapHeader)) {
+        close(fd);
+        return MAXCFG_ERR_IO;
+    }
+
+    size_t size = (size_t)sb.st_size;
+    char *base = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == (char *)MAP_FAILED) {
+        return MAXCFG_ERR_IO;
+    }
+
+    MaxCfgStatus st = snap_check(base, size);
+    if (st == MAXCFG_OK) {
+        st = snap_copy_lists(toml, base, size);
+    }
+    if (st == MAXCFG_OK) {
+        st = snap_relocate(base, size);
+    }
+
+    TomlNode *root = NULL;
+    if (st == MAXCFG_OK) {
+        root = (TomlNode *)(base + ((const TomlSnapHeader *)base)->root);
+        if (root->type != MAXCFG_VAR_TABLE || root->v.table == NULL) {
+            st = MAXCFG_ERR_IO;
+        }
+    }
+
+    if (st != MAXCFG_OK) {
+        maxcfg_free_loaded_files(toml);
+        maxcfg_free_sources(toml);
+        munmap(base, size);
+        return st;
+    }
+
+    /* Any stray write into the tree should fault rather than go unnoticed */
+    (void)mprotect(base, size, PROT_READ);
+
+    toml_node_free(toml->root);
+    toml->root = root;
+    toml->root_mapped = true;
+    toml->snap_base = base;
+    toml->snap_size = size;
+    toml_touch(toml);
+    return MAXCFG_OK;
+}
+
 /** @brief Walk a dotted path from a root node, returning the target. */
 static const TomlNode *toml_get_node_base(const TomlNode *root, const char *path)
 {
@@ -3153,6 +4075,19 @@ static const TomlNode *toml_get_node_base(const TomlNode *root, const char *path
         if (slen == 0u || slen >= sizeof(segbuf)) {
             return NULL;
         }
+
+        /* Plain key: look it up in place, no copying or segment parsing */
+        if (memchr(start, '[', slen) == NULL) {
+            if (cur->type != MAXCFG_VAR_TABLE ||
+                (cur = toml_table_get_node_n(cur->v.table, start, slen)) == NULL) {
+                return NULL;
+            }
+            if (*p == '.') {
+                p++;
+            }
+            continue;
+        }
+
         memcpy(segbuf, start, slen);
         segbuf[slen] = '\0';
 
@@ -3675,6 +4610,8 @@ MaxCfgStatus maxcfg_toml_save_prefix(const MaxCfgToml *toml, const char *prefix)
 /** @brief Persist a single override into the base TOML data. */
 MaxCfgStatus maxcfg_toml_persist_override(MaxCfgToml *toml, const char *path)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->root == NULL || toml->root->type != MAXCFG_VAR_TABLE || toml->overrides == NULL || path == NULL) {
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
@@ -3684,12 +4621,17 @@ MaxCfgStatus maxcfg_toml_persist_override(MaxCfgToml *toml, const char *path)
         return MAXCFG_ERR_NOT_FOUND;
     }
 
+    MaxCfgStatus st = toml_root_thaw(toml);
+    if (st != MAXCFG_OK) {
+        return st;
+    }
+
     TomlNode *cl = toml_node_clone(ov);
     if (cl == NULL) {
         return MAXCFG_ERR_OOM;
     }
 
-    MaxCfgStatus st = toml_set_path_node(toml->root->v.table, path, cl);
+    st = toml_set_path_node(toml->root->v.table, path, cl);
     if (st != MAXCFG_OK) {
         toml_node_free(cl);
         return st;
@@ -3733,6 +4675,8 @@ static int cmp_keys(const void *a, const void *b)
 /** @brief Persist all pending overrides into the base TOML data. */
 MaxCfgStatus maxcfg_toml_persist_overrides(MaxCfgToml *toml)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->overrides == NULL) {
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
@@ -3899,6 +4843,19 @@ MaxCfgStatus maxcfg_toml_get(const MaxCfgToml *toml, const char *path, MaxCfgVar
         if (slen == 0u || slen >= sizeof(segbuf)) {
             return MAXCFG_ERR_INVALID_ARGUMENT;
         }
+
+        /* Plain key: look it up in place, no copying or segment parsing */
+        if (memchr(start, '[', slen) == NULL) {
+            if (cur->type != MAXCFG_VAR_TABLE ||
+                (cur = toml_table_get_node_n(cur->v.table, start, slen)) == NULL) {
+                return MAXCFG_ERR_NOT_FOUND;
+            }
+            if (*p == '.') {
+                p++;
+            }
+            continue;
+        }
+
         memcpy(segbuf, start, slen);
         segbuf[slen] = '\0';
 
@@ -3956,6 +4913,8 @@ MaxCfgStatus maxcfg_toml_get(const MaxCfgToml *toml, const char *path, MaxCfgVar
 /** @brief Set an integer override in the TOML store. */
 MaxCfgStatus maxcfg_toml_override_set_int(MaxCfgToml *toml, const char *path, int v)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->overrides == NULL || path == NULL) {
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
@@ -3976,6 +4935,8 @@ MaxCfgStatus maxcfg_toml_override_set_int(MaxCfgToml *toml, const char *path, in
 /** @brief Set an unsigned integer override in the TOML store. */
 MaxCfgStatus maxcfg_toml_override_set_uint(MaxCfgToml *toml, const char *path, unsigned int v)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->overrides == NULL || path == NULL) {
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
@@ -3996,6 +4957,8 @@ MaxCfgStatus maxcfg_toml_override_set_uint(MaxCfgToml *toml, const char *path, u
 /** @brief Set a boolean override in the TOML store. */
 MaxCfgStatus maxcfg_toml_override_set_bool(MaxCfgToml *toml, const char *path, bool v)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->overrides == NULL || path == NULL) {
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
@@ -4016,6 +4979,8 @@ MaxCfgStatus maxcfg_toml_override_set_bool(MaxCfgToml *toml, const char *path, b
 /** @brief Set a string override in the TOML store. */
 MaxCfgStatus maxcfg_toml_override_set_string(MaxCfgToml *toml, const char *path, const char *v)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->overrides == NULL || path == NULL) {
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
@@ -4041,6 +5006,8 @@ MaxCfgStatus maxcfg_toml_override_set_string(MaxCfgToml *toml, const char *path,
 /** @brief Set a string array override in the TOML store. */
 MaxCfgStatus maxcfg_toml_override_set_string_array(MaxCfgToml *toml, const char *path, const char **items, size_t count)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->overrides == NULL || path == NULL) {
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
@@ -4076,6 +5043,8 @@ MaxCfgStatus maxcfg_toml_override_set_string_array(MaxCfgToml *toml, const char
 /** @brief Set an empty table array override in the TOML store. */
 MaxCfgStatus maxcfg_toml_override_set_table_array_empty(MaxCfgToml *toml, const char *path)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->overrides == NULL || path == NULL) {
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
@@ -4100,6 +5069,8 @@ MaxCfgStatus maxcfg_toml_override_set_table_array_empty(MaxCfgToml *toml, const
 /** @brief Remove an override at the given path. */
 MaxCfgStatus maxcfg_toml_override_unset(MaxCfgToml *toml, const char *path)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->overrides == NULL || path == NULL) {
         return MAXCFG_ERR_INVALID_ARGUMENT;
     }
@@ -4110,6 +5081,8 @@ MaxCfgStatus maxcfg_toml_override_unset(MaxCfgToml *toml, const char *path)
 /** @brief Clear all overrides from the TOML store. */
 void maxcfg_toml_override_clear(MaxCfgToml *toml)
 {
+    toml_touch(toml);
+
     if (toml == NULL || toml->overrides == NULL) {
         return;
     }
@@ -4135,6 +5108,25 @@ MaxCfgStatus maxcfg_toml_table_get(const MaxCfgVar *table, const char *key, MaxC
     return var_from_node(n, out);
 }
 
+/** @brief Access a table's entries in order by index. */
+MaxCfgStatus maxcfg_toml_table_entry(const MaxCfgVar *table, size_t index, const char **out_key, MaxCfgVar *out)
+{
+    if (table == NULL || out_key == NULL || out == NULL) {
+        return MAXCFG_ERR_INVALID_ARGUMENT;
+    }
+    if (table->type != MAXCFG_VAR_TABLE || table->v.opaque == NULL) {
+        return MAXCFG_ERR_INVALID_ARGUMENT;
+    }
+
+    TomlTable *t = (TomlTable *)table->v.opaque;
+    if (index >= t->count) {
+        return MAXCFG_ERR_NOT_FOUND;
+    }
+
+    *out_key = t->items[index].key;
+    return var_from_node(t->items[index].value, out);
+}
+
 /** @brief Access an element by index within an array-type MaxCfgVar. */
 MaxCfgStatus maxcfg_toml_array_get(const MaxCfgVar *array, size_t index, MaxCfgVar *out)
 {
@@ -4449,6 +5441,8 @@ const char *maxcfg_status_string(MaxCfgStatus st)
         return "I/O error";
     case MAXCFG_ERR_PATH_TOO_LONG:
         return "Path too long";
+    case MAXCFG_ERR_STALE:
+        return "Out of date";
     default:
         return "Unknown error";
     }
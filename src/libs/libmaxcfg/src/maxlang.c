@@ -22,6 +22,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "maxlang.h"
 
 /* ========================================================================== */
@@ -30,15 +36,89 @@
 
 #define ML_MAX_PATH       1024
 #define ML_MAX_KEY        256
-#define ML_MAX_LEGACY_MAP 2048   /**< Maximum legacy ID → key mappings */
 #define ML_MAX_RUNTIME_NS 32    /**< Maximum runtime namespaces */
 #define ML_MAX_RT_STRINGS 256   /**< Maximum strings per runtime namespace */
+#define ML_MAX_LEGACY_ID  0xffff /**< Highest legacy ID a compiled table holds */
+
+#define MLC_MAGIC   "MAXLANG"   /**< Compiled table signature */
+#define MLC_VERSION 1u
+#define MLC_NONE    0xffffffffu /**< "No string" / "no entry" */
 
 /* ========================================================================== */
 /* Internal structures                                                         */
 /* ========================================================================== */
 
-/* MlLegacyEntry removed — legacy_keys[] is now a direct-index array. */
+/*
+ * Compiled string table.
+ *
+ * A language file is compiled into one flat image with no pointers in it:
+ *
+ *   header | entries | key hash | legacy ids | heaps | heap hash |
+ *   params | flags | string pool
+ *
+ * Strings are offsets into the pool (each distinct string stored once),
+ * everything else is an array index, so the image works wherever it is
+ * mapped and is never written.  maxlang_open() maps <lang>.mlc read-only
+ * when it was compiled from the current <lang>.toml, and every node
+ * shares the one copy; otherwise it compiles the TOML in memory (and
+ * saves the result for next time).  Either way a lookup is one hash
+ * probe, and a legacy ID is one array index.
+ *
+ * There is an entry for every string or table in the file (other than
+ * [_legacy_map]) under its full dotted key, so that anything the TOML
+ * store would have found, the table finds too.
+ */
+
+/** Header of a compiled table; all offsets are from the start */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t file_size;
+    int64_t src_mtime;                 /**< The .toml it was compiled from */
+    int64_t src_size;
+    uint64_t src_ino;
+    uint32_t entry_count;
+    uint32_t entries;                  /**< MlcEntry[entry_count] */
+    uint32_t hash_size;                /**< Power of two */
+    uint32_t hash;                     /**< uint32_t[hash_size]: entry + 1 */
+    uint32_t legacy_count;
+    uint32_t legacy;                   /**< uint32_t[legacy_count]: entry or NONE */
+    uint32_t heap_count;
+    uint32_t heaps;                    /**< MlcHeap[heap_count] */
+    uint32_t heap_hash_size;           /**< Power of two */
+    uint32_t heap_hash;                /**< uint32_t[heap_hash_size]: heap + 1 */
+    uint32_t param_count;
+    uint32_t params;                   /**< MlcParam[param_count] */
+    uint32_t flag_count;
+    uint32_t flags;                    /**< uint32_t[flag_count]: strings */
+    uint32_t pool_size;
+    uint32_t pool;                     /**< NUL-terminated strings */
+} MlcHeader;
+
+/** One string (or table) in the language file */
+typedef struct {
+    uint32_t key;                      /**< Full dotted key */
+    uint32_t text;                     /**< Primary text, or MLC_NONE */
+    uint32_t rip;                      /**< RIP alternate, or MLC_NONE */
+    uint32_t first_flag;
+    uint32_t first_param;
+    uint16_t flag_count;
+    uint16_t param_count;
+} MlcEntry;
+
+/** A top-level table, and the first legacy ID that belongs to it */
+typedef struct {
+    uint32_t name;
+    uint32_t base_id;                  /**< Or MLC_NONE */
+} MlcHeap;
+
+/** Parameter metadata from a string's params = [...] */
+typedef struct {
+    uint32_t name;
+    uint32_t type;
+    uint32_t desc;
+    uint32_t def;
+} MlcParam;
 
 /** A single runtime-registered string */
 typedef struct {
@@ -55,14 +135,16 @@ typedef struct {
 
 /** Main language handle */
 struct MaxLang {
-    MaxCfgToml *toml;                  /**< Underlying TOML data store */
-    bool owns_toml;                    /**< true if we allocated the toml handle */
+    const char *tbl;                   /**< Compiled table (MlcHeader first) */
+    size_t tbl_size;
+    bool tbl_mapped;                   /**< tbl is an mmap() of a .mlc file */
 
-    char *legacy_keys[ML_MAX_LEGACY_MAP]; /**< Direct-index: legacy_keys[id] → dotted key */
-    int legacy_max_id;                     /**< Highest populated ID + 1 */
+    MaxCfgToml *toml;                  /**< Extension files, or NULL if none */
 
     MlRtNamespace rt_ns[ML_MAX_RUNTIME_NS];
     int rt_ns_count;
+    uint32_t *rt_hash;                 /**< (ns << 8 | string) + 1, by full key */
+    size_t rt_hash_size;               /**< Power of two, or 0 */
 
     bool use_rip;                      /**< Prefer RIP alternates when available */
 };
@@ -71,39 +153,81 @@ struct MaxLang {
 /* Helpers                                                                     */
 /* ========================================================================== */
 
-/**
- * @brief Parse the [_legacy_map] table from the loaded TOML into the
- *        direct-index legacy_keys array.
- *
- * The TOML legacy map has entries like:
- *   "0x0000" = "global.left_x"
- *
- * IDs may be sparse (gaps between heap sections), so we skip missing
- * entries rather than stopping at the first gap.
- */
-static void ml_load_legacy_map(MaxLang *lang)
+/** @brief FNV-1a hash of the first len bytes of s. */
+static uint32_t ml_hash(const char *s, size_t len)
 {
-    memset(lang->legacy_keys, 0, sizeof(lang->legacy_keys));
-    lang->legacy_max_id = 0;
+    uint32_t h = 2166136261u;
 
-    for (int id = 0; id < ML_MAX_LEGACY_MAP; id++) {
-        char probe_key[ML_MAX_KEY];
-        snprintf(probe_key, sizeof(probe_key), "_legacy_map.\"0x%04x\"", id);
+    while (len--) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
 
-        MaxCfgVar v;
-        if (maxcfg_toml_get(lang->toml, probe_key, &v) != MAXCFG_OK)
-            continue;   /* skip gaps between heap sections */
+/** @brief The compiled table's header. */
+static const MlcHeader *ml_hdr(const MaxLang *lang)
+{
+    return (const MlcHeader *)lang->tbl;
+}
 
-        if (v.type != MAXCFG_VAR_STRING || v.v.s == NULL)
-            continue;
+/** @brief A string in the compiled table's pool. */
+static const char *ml_str(const MaxLang *lang, uint32_t off)
+{
+    return lang->tbl + ml_hdr(lang)->pool + off;
+}
+
+/** @brief An entry in the compiled table. */
+static const MlcEntry *ml_entry(const MaxLang *lang, uint32_t idx)
+{
+    return (const MlcEntry *)(lang->tbl + ml_hdr(lang)->entries) + idx;
+}
+
+/** @brief Find the compiled entry for a full dotted key. */
+static const MlcEntry *ml_find(const MaxLang *lang, const char *key)
+{
+    const MlcHeader *h = ml_hdr(lang);
+    const uint32_t *slots = (const uint32_t *)(lang->tbl + h->hash);
+    uint32_t mask = h->hash_size - 1u;
+
+    for (uint32_t b = ml_hash(key, strlen(key)) & mask; slots[b] != 0u; b = (b + 1u) & mask) {
+        const MlcEntry *e = ml_entry(lang, slots[b] - 1u);
+        if (strcmp(ml_str(lang, e->key), key) == 0)
+            return e;
+    }
+    return NULL;
+}
 
-        lang->legacy_keys[id] = strdup(v.v.s);
-        lang->legacy_max_id = id + 1;
+/** @brief Find a top-level table (heap) in the compiled table. */
+static const MlcHeap *ml_find_heap(const MaxLang *lang, const char *name)
+{
+    const MlcHeader *h = ml_hdr(lang);
+    const uint32_t *slots = (const uint32_t *)(lang->tbl + h->heap_hash);
+    const MlcHeap *heaps = (const MlcHeap *)(lang->tbl + h->heaps);
+    uint32_t mask = h->heap_hash_size - 1u;
+
+    for (uint32_t b = ml_hash(name, strlen(name)) & mask; slots[b] != 0u; b = (b + 1u) & mask) {
+        const MlcHeap *hp = &heaps[slots[b] - 1u];
+        if (strcmp(ml_str(lang, hp->name), name) == 0)
+            return hp;
     }
+    return NULL;
 }
 
 /**
- * @brief Retrieve a raw string value from the TOML store.
+ * @brief Resolve a compiled entry to the string maxlang_get() returns,
+ *        honouring RIP mode, or NULL if it has no text.
+ */
+static const char *ml_entry_text(const MaxLang *lang, const MlcEntry *e)
+{
+    if (lang->use_rip && e->rip != MLC_NONE)
+        return ml_str(lang, e->rip);
+
+    return (e->text != MLC_NONE) ? ml_str(lang, e->text) : NULL;
+}
+
+/**
+ * @brief Retrieve a raw string value from the extension TOML store.
  *
  * Handles both simple string values and inline-table values where
  * the text is in the "text" sub-key.
@@ -123,10 +247,8 @@ static const char *ml_get_raw(MaxLang *lang, const char *key)
 
     /* Inline table: key = { text = "value", ... } */
     if (v.type == MAXCFG_VAR_TABLE) {
-        char text_key[ML_MAX_KEY];
-        snprintf(text_key, sizeof(text_key), "%s.text", key);
         MaxCfgVar tv;
-        if (maxcfg_toml_get(lang->toml, text_key, &tv) == MAXCFG_OK &&
+        if (maxcfg_toml_table_get(&v, "text", &tv) == MAXCFG_OK &&
             tv.type == MAXCFG_VAR_STRING) {
             return tv.v.s;
         }
@@ -136,7 +258,7 @@ static const char *ml_get_raw(MaxLang *lang, const char *key)
 }
 
 /**
- * @brief Retrieve the RIP alternate from the TOML store.
+ * @brief Retrieve the RIP alternate from the extension TOML store.
  */
 static const char *ml_get_rip_raw(MaxLang *lang, const char *key)
 {
@@ -155,12 +277,64 @@ static const char *ml_get_rip_raw(MaxLang *lang, const char *key)
     return NULL;
 }
 
+/**
+ * @brief Rebuild the hash of runtime strings by full "ns.symbol" key.
+ *
+ * Registration is rare and lookups are not, so the index is simply rebuilt
+ * after every change.  If it can't be allocated, lookups find nothing.
+ */
+static void ml_rt_rehash(MaxLang *lang)
+{
+    size_t total = 0;
+    for (int i = 0; i < lang->rt_ns_count; i++)
+        total += (size_t)lang->rt_ns[i].count;
+
+    size_t want = 16u;
+    while (want < total * 2u)
+        want *= 2u;
+
+    if (want != lang->rt_hash_size) {
+        free(lang->rt_hash);
+        lang->rt_hash = calloc(want, sizeof(lang->rt_hash[0]));
+        lang->rt_hash_size = lang->rt_hash ? want : 0u;
+    } else {
+        memset(lang->rt_hash, 0, want * sizeof(lang->rt_hash[0]));
+    }
+
+    if (!lang->rt_hash)
+        return;
+
+    for (int i = 0; i < lang->rt_ns_count; i++) {
+        MlRtNamespace *ns = &lang->rt_ns[i];
+        size_t ns_len = strlen(ns->ns);
+
+        for (int j = 0; j < ns->count; j++) {
+            /* Hash "ns.symbol" without building it */
+            uint32_t h = ml_hash(ns->ns, ns_len);
+            const char *p = ns->strings[j].key;
+
+            h ^= (unsigned char)'.';
+            h *= 16777619u;
+            for (; *p; p++) {
+                h ^= (unsigned char)*p;
+                h *= 16777619u;
+            }
+
+            size_t mask = lang->rt_hash_size - 1u;
+            size_t b = h & mask;
+            while (lang->rt_hash[b] != 0u)
+                b = (b + 1u) & mask;
+            lang->rt_hash[b] = ((uint32_t)i << 8 | (uint32_t)j) + 1u;
+        }
+    }
+}
+
 /**
  * @brief Search runtime namespaces for a dotted key "ns.symbol".
  */
 static const char *ml_get_runtime(MaxLang *lang, const char *key)
 {
-    if (!lang || !key)
+    if (!lang || !key || !lang->rt_hash)
         return NULL;
 
     /* Split key into namespace.symbol */
@@ -170,18 +344,611 @@ static const char *ml_get_runtime(MaxLang *lang, const char *key)
 
     size_t ns_len = (size_t)(dot - key);
     const char *symbol = dot + 1;
+    size_t mask = lang->rt_hash_size - 1u;
 
-    for (int i = 0; i < lang->rt_ns_count; i++) {
-        MlRtNamespace *ns = &lang->rt_ns[i];
-        if (strlen(ns->ns) == ns_len && strncmp(ns->ns, key, ns_len) == 0) {
-            for (int j = 0; j < ns->count; j++) {
-                if (strcmp(ns->strings[j].key, symbol) == 0)
-                    return ns->strings[j].value;
+    for (size_t b = ml_hash(key, strlen(key)) & mask; lang->rt_hash[b] != 0u; b = (b + 1u) & mask) {
+        uint32_t v = lang->rt_hash[b] - 1u;
+        MlRtNamespace *ns = &lang->rt_ns[v >> 8];
+        MlRtString *str = &ns->strings[v & 0xffu];
+
+        if (strncmp(ns->ns, key, ns_len) == 0 && ns->ns[ns_len] == '\0' &&
+            strcmp(str->key, symbol) == 0)
+            return str->value;
+    }
+    return NULL;
+}
+
+/* ========================================================================== */
+/* Compiler                                                                    */
+/* ========================================================================== */
+
+/** State for building a compiled table */
+typedef struct {
+    MlcEntry *entries;
+    size_t entry_count, entry_cap;
+    MlcParam *params;
+    size_t param_count, param_cap;
+    uint32_t *flags;
+    size_t flag_count, flag_cap;
+    MlcHeap *heaps;
+    size_t heap_count, heap_cap;
+    uint32_t *legacy;                  /**< Entry key string per ID, or NONE */
+    size_t legacy_count, legacy_cap;
+    char *pool;
+    size_t pool_len, pool_cap;
+    uint32_t *strings;                 /**< Pool offset + 1, hashed */
+    size_t string_count, string_cap;
+    bool oom;
+} MlcBuilder;
+
+/** @brief Make room for want elements of elem bytes in a builder array. */
+static bool mlb_reserve(MlcBuilder *b, void **arr, size_t *cap, size_t want, size_t elem)
+{
+    if (b->oom)
+        return false;
+    if (want <= *cap)
+        return true;
+
+    size_t newcap = *cap ? *cap : 256u;
+    while (newcap < want)
+        newcap *= 2u;
+
+    void *p = realloc(*arr, newcap * elem);
+    if (!p) {
+        b->oom = true;
+        return false;
+    }
+    *arr = p;
+    *cap = newcap;
+    return true;
+}
+
+/** @brief Add a string to the pool (once); returns its offset. */
+static uint32_t mlb_str(MlcBuilder *b, const char *s)
+{
+    size_t len = strlen(s);
+
+    if ((b->string_count + 1u) * 2u > b->string_cap) {
+        size_t newcap = b->string_cap ? b->string_cap * 2u : 4096u;
+        uint32_t *p = calloc(newcap, sizeof(*p));
+        if (!p) {
+            b->oom = true;
+            return MLC_NONE;
+        }
+        for (size_t i = 0; i < b->string_cap; i++) {
+            if (b->strings[i] != 0u) {
+                const char *k = b->pool + b->strings[i] - 1u;
+                size_t j = ml_hash(k, strlen(k)) & (newcap - 1u);
+                while (p[j] != 0u)
+                    j = (j + 1u) & (newcap - 1u);
+                p[j] = b->strings[i];
             }
-            return NULL;
         }
+        free(b->strings);
+        b->strings = p;
+        b->string_cap = newcap;
     }
-    return NULL;
+
+    size_t mask = b->string_cap - 1u;
+    size_t j = ml_hash(s, len) & mask;
+    for (; b->strings[j] != 0u; j = (j + 1u) & mask) {
+        if (strcmp(b->pool + b->strings[j] - 1u, s) == 0)
+            return b->strings[j] - 1u;
+    }
+
+    if (!mlb_reserve(b, (void **)&b->pool, &b->pool_cap, b->pool_len + len + 1u, 1u))
+        return MLC_NONE;
+
+    uint32_t off = (uint32_t)b->pool_len;
+    memcpy(b->pool + off, s, len + 1u);
+    b->pool_len += len + 1u;
+    b->strings[j] = off + 1u;
+    b->string_count++;
+    return off;
+}
+
+/** @brief Intern a string member of a table, or return MLC_NONE. */
+static uint32_t mlb_member_str(MlcBuilder *b, const MaxCfgVar *tbl, const char *name)
+{
+    MaxCfgVar v;
+
+    if (maxcfg_toml_table_get(tbl, name, &v) != MAXCFG_OK ||
+        v.type != MAXCFG_VAR_STRING || !v.v.s)
+        return MLC_NONE;
+
+    return mlb_str(b, v.v.s);
+}
+
+/** @brief Find or add a heap record. */
+static MlcHeap *mlb_heap(MlcBuilder *b, const char *name, size_t len)
+{
+    for (size_t i = 0; i < b->heap_count; i++) {
+        const char *k = b->pool + b->heaps[i].name;
+        if (strncmp(k, name, len) == 0 && k[len] == '\0')
+            return &b->heaps[i];
+    }
+
+    char buf[ML_MAX_KEY];
+    if (len >= sizeof(buf) ||
+        !mlb_reserve(b, (void **)&b->heaps, &b->heap_cap, b->heap_count + 1u, sizeof(MlcHeap)))
+        return NULL;
+
+    memcpy(buf, name, len);
+    buf[len] = '\0';
+
+    MlcHeap *hp = &b->heaps[b->heap_count];
+    hp->name = mlb_str(b, buf);
+    hp->base_id = MLC_NONE;
+    if (b->oom)
+        return NULL;
+    b->heap_count++;
+    return hp;
+}
+
+/**
+ * @brief Add an entry for a string or table value under key, and entries
+ *        for everything nested in a table.
+ */
+static void mlb_add(MlcBuilder *b, char *key, size_t key_len, const MaxCfgVar *v)
+{
+    if (v->type != MAXCFG_VAR_STRING && v->type != MAXCFG_VAR_TABLE)
+        return;
+
+    if (!mlb_reserve(b, (void **)&b->entries, &b->entry_cap, b->entry_count + 1u, sizeof(MlcEntry)))
+        return;
+
+    MlcEntry e;
+    memset(&e, 0, sizeof(e));
+    e.key = mlb_str(b, key);
+    e.text = MLC_NONE;
+    e.rip = MLC_NONE;
+    e.first_flag = (uint32_t)b->flag_count;
+    e.first_param = (uint32_t)b->param_count;
+
+    if (v->type == MAXCFG_VAR_STRING) {
+        e.text = mlb_str(b, v->v.s ? v->v.s : "");
+    } else {
+        MaxCfgVar sub;
+
+        e.text = mlb_member_str(b, v, "text");
+        e.rip = mlb_member_str(b, v, "rip");
+
+        if (maxcfg_toml_table_get(v, "flags", &sub) == MAXCFG_OK &&
+            sub.type == MAXCFG_VAR_STRING_ARRAY) {
+            for (size_t i = 0; i < sub.v.strv.count && e.flag_count < 0xffffu; i++) {
+                if (!sub.v.strv.items[i] ||
+                    !mlb_reserve(b, (void **)&b->flags, &b->flag_cap, b->flag_count + 1u, sizeof(uint32_t)))
+                    continue;
+                b->flags[b->flag_count++] = mlb_str(b, sub.v.strv.items[i]);
+                e.flag_count++;
+            }
+        }
+
+        size_t np = 0;
+        if (maxcfg_toml_table_get(v, "params", &sub) == MAXCFG_OK &&
+            sub.type == MAXCFG_VAR_TABLE_ARRAY &&
+            maxcfg_var_count(&sub, &np) == MAXCFG_OK) {
+            for (size_t i = 0; i < np && e.param_count < 0xffffu; i++) {
+                MaxCfgVar pt;
+                if (maxcfg_toml_array_get(&sub, i, &pt) != MAXCFG_OK || pt.type != MAXCFG_VAR_TABLE ||
+                    !mlb_reserve(b, (void **)&b->params, &b->param_cap, b->param_count + 1u, sizeof(MlcParam)))
+                    continue;
+
+                MlcParam *mp = &b->params[b->param_count++];
+                mp->name = mlb_member_str(b, &pt, "name");
+                mp->type = mlb_member_str(b, &pt, "type");
+                mp->desc = mlb_member_str(b, &pt, "desc");
+                mp->def = mlb_member_str(b, &pt, "default");
+                e.param_count++;
+            }
+        }
+    }
+
+    if (b->oom)
+        return;
+    b->entries[b->entry_count++] = e;
+
+    if (v->type != MAXCFG_VAR_TABLE)
+        return;
+
+    /* Everything inside the table is reachable by its own dotted key */
+    size_t n = 0;
+    (void)maxcfg_var_count(v, &n);
+    for (size_t i = 0; i < n && !b->oom; i++) {
+        const char *k;
+        MaxCfgVar child;
+        size_t klen;
+
+        if (maxcfg_toml_table_entry(v, i, &k, &child) != MAXCFG_OK || !k)
+            continue;
+
+        klen = strlen(k);
+        if (key_len + 1u + klen >= ML_MAX_KEY)
+            continue;
+
+        key[key_len] = '.';
+        memcpy(key + key_len + 1u, k, klen + 1u);
+        mlb_add(b, key, key_len + 1u + klen, &child);
+        key[key_len] = '\0';
+    }
+}
+
+/** @brief Record the [_legacy_map] table's "0xNNNN" = "heap.key" entries. */
+static void mlb_add_legacy_map(MlcBuilder *b, const MaxCfgVar *map)
+{
+    size_t n = 0;
+    (void)maxcfg_var_count(map, &n);
+
+    for (size_t i = 0; i < n && !b->oom; i++) {
+        const char *k;
+        MaxCfgVar v;
+
+        if (maxcfg_toml_table_entry(map, i, &k, &v) != MAXCFG_OK || !k ||
+            v.type != MAXCFG_VAR_STRING || !v.v.s)
+            continue;
+
+        if (*k == '"')
+            k++;
+
+        char *end;
+        unsigned long id = strtoul(k, &end, 16);
+        if (end == k || id > ML_MAX_LEGACY_ID)
+            continue;
+
+        if (id >= b->legacy_count) {
+            if (!mlb_reserve(b, (void **)&b->legacy, &b->legacy_cap, id + 1u, sizeof(uint32_t)))
+                return;
+            while (b->legacy_count <= id)
+                b->legacy[b->legacy_count++] = MLC_NONE;
+        }
+        b->legacy[id] = mlb_str(b, v.v.s);
+    }
+}
+
+/** @brief Append a section to the image being assembled; returns its offset. */
+static uint32_t mlb_section(char *img, size_t *len, const void *data, size_t size)
+{
+    size_t off = (*len + 7u) & ~(size_t)7u;
+
+    if (img && size)
+        memcpy(img + off, data, size);
+    *len = off + size;
+    return (uint32_t)off;
+}
+
+/** @brief Build an open-addressed hash of n keys; slots hold index + 1. */
+static uint32_t *mlb_hash_keys(const MlcBuilder *b, const uint32_t *keys, size_t stride,
+                               size_t n, uint32_t *out_size)
+{
+    uint32_t size = 16u;
+    while (size < n * 2u)
+        size *= 2u;
+
+    uint32_t *slots = calloc(size, sizeof(*slots));
+    if (!slots)
+        return NULL;
+
+    for (size_t i = 0; i < n; i++) {
+        const char *k = b->pool + *(const uint32_t *)((const char *)keys + i * stride);
+        uint32_t j = ml_hash(k, strlen(k)) & (size - 1u);
+        while (slots[j] != 0u)
+            j = (j + 1u) & (size - 1u);
+        slots[j] = (uint32_t)i + 1u;
+    }
+
+    *out_size = size;
+    return slots;
+}
+
+/**
+ * @brief Compile a loaded language store into a table image.
+ *
+ * @param toml      Store holding the language file at its root.
+ * @param src       stat() of the .toml file, recorded for validation.
+ * @param out_img   Receives the malloc()ed image.
+ * @param out_size  Receives its size.
+ */
+static MaxCfgStatus ml_build(const MaxCfgToml *toml, const struct stat *src,
+                             char **out_img, size_t *out_size)
+{
+    MlcBuilder b;
+    MaxCfgVar root;
+    size_t n = 0;
+    char key[ML_MAX_KEY];
+
+    memset(&b, 0, sizeof(b));
+    (void)mlb_str(&b, "");
+
+    if (maxcfg_toml_get(toml, "", &root) != MAXCFG_OK || root.type != MAXCFG_VAR_TABLE)
+        return MAXCFG_ERR_INVALID_ARGUMENT;
+
+    (void)maxcfg_var_count(&root, &n);
+    for (size_t i = 0; i < n && !b.oom; i++) {
+        const char *k;
+        MaxCfgVar v;
+
+        if (maxcfg_toml_table_entry(&root, i, &k, &v) != MAXCFG_OK || !k ||
+            strlen(k) >= sizeof(key))
+            continue;
+
+        if (strcmp(k, "_legacy_map") == 0 && v.type == MAXCFG_VAR_TABLE) {
+            mlb_add_legacy_map(&b, &v);
+            continue;
+        }
+
+        (void)mlb_heap(&b, k, strlen(k));
+        strcpy(key, k);
+        mlb_add(&b, key, strlen(key), &v);
+    }
+
+    /* Key hash, then turn legacy IDs from key strings into entries */
+    uint32_t hash_size = 0, heap_hash_size = 0;
+    uint32_t *hash = b.oom ? NULL : mlb_hash_keys(&b, b.entries ? &b.entries[0].key : NULL,
+                                                  sizeof(MlcEntry), b.entry_count, &hash_size);
+    MaxCfgStatus st = MAXCFG_OK;
+
+    for (size_t id = 0; hash && id < b.legacy_count; id++) {
+        if (b.legacy[id] == MLC_NONE)
+            continue;
+
+        const char *k = b.pool + b.legacy[id];
+        uint32_t j = ml_hash(k, strlen(k)) & (hash_size - 1u);
+        uint32_t found = MLC_NONE;
+
+        for (; hash[j] != 0u; j = (j + 1u) & (hash_size - 1u)) {
+            if (strcmp(b.pool + b.entries[hash[j] - 1u].key, k) == 0) {
+                found = hash[j] - 1u;
+                break;
+            }
+        }
+
+        /* The first ID of each heap is its base for maxlang_get_by_heap_id() */
+        const char *dot = strchr(k, '.');
+        if (dot) {
+            MlcHeap *hp = mlb_heap(&b, k, (size_t)(dot - k));
+            if (hp && hp->base_id == MLC_NONE)
+                hp->base_id = (uint32_t)id;
+        }
+
+        b.legacy[id] = found;
+    }
+
+    uint32_t *heap_hash = (b.oom || !hash) ? NULL : mlb_hash_keys(&b, b.heaps ? &b.heaps[0].name : NULL,
+                                                                  sizeof(MlcHeap), b.heap_count, &heap_hash_size);
+    char *img = NULL;
+    size_t len = 0;
+
+    if (!heap_hash) {
+        st = MAXCFG_ERR_OOM;
+    } else {
+        /* Two passes: measure, then copy */
+        for (int pass = 0; pass < 2; pass++) {
+            MlcHeader h;
+
+            memset(&h, 0, sizeof(h));
+            len = sizeof(h);
+            h.entry_count = (uint32_t)b.entry_count;
+            h.entries = mlb_section(img, &len, b.entries, b.entry_count * sizeof(MlcEntry));
+            h.hash_size = hash_size;
+            h.hash = mlb_section(img, &len, hash, hash_size * sizeof(uint32_t));
+            h.legacy_count = (uint32_t)b.legacy_count;
+            h.legacy = mlb_section(img, &len, b.legacy, b.legacy_count * sizeof(uint32_t));
+            h.heap_count = (uint32_t)b.heap_count;
+            h.heaps = mlb_section(img, &len, b.heaps, b.heap_count * sizeof(MlcHeap));
+            h.heap_hash_size = heap_hash_size;
+            h.heap_hash = mlb_section(img, &len, heap_hash, heap_hash_size * sizeof(uint32_t));
+            h.param_count = (uint32_t)b.param_count;
+            h.params = mlb_section(img, &len, b.params, b.param_count * sizeof(MlcParam));
+            h.flag_count = (uint32_t)b.flag_count;
+            h.flags = mlb_section(img, &len, b.flags, b.flag_count * sizeof(uint32_t));
+            h.pool_size = (uint32_t)b.pool_len;
+            h.pool = mlb_section(img, &len, b.pool, b.pool_len);
+
+            if (pass == 0) {
+                if (len > 0xffffffffu || (img = calloc(1, len)) == NULL) {
+                    st = (len > 0xffffffffu) ? MAXCFG_ERR_INVALID_ARGUMENT : MAXCFG_ERR_OOM;
+                    break;
+                }
+                continue;
+            }
+
+            memcpy(h.magic, MLC_MAGIC, sizeof(MLC_MAGIC));
+            h.version = MLC_VERSION;
+            h.file_size = (uint32_t)len;
+            h.src_mtime = (int64_t)src->st_mtime;
+            h.src_size = (int64_t)src->st_size;
+            h.src_ino = (uint64_t)src->st_ino;
+            memcpy(img, &h, sizeof(h));
+        }
+    }
+
+    free(hash);
+    free(heap_hash);
+    free(b.entries);
+    free(b.params);
+    free(b.flags);
+    free(b.heaps);
+    free(b.legacy);
+    free(b.pool);
+    free(b.strings);
+
+    if (st != MAXCFG_OK) {
+        free(img);
+        return st;
+    }
+
+    *out_img = img;
+    *out_size = len;
+    return MAXCFG_OK;
+}
+
+/** @brief Check that an array of n elem-byte items at off is in the image. */
+static bool ml_range_ok(size_t size, uint32_t off, uint32_t n, size_t elem)
+{
+    return off <= size && off % 4u == 0u && n <= (size - off) / elem;
+}
+
+/**
+ * @brief Check a compiled table read from disk before trusting it: every
+ *        offset and index must stay inside the image.
+ */
+static bool ml_check_image(const char *img, size_t size)
+{
+    const MlcHeader *h = (const MlcHeader *)img;
+
+    if (size < sizeof(*h) || memcmp(h->magic, MLC_MAGIC, sizeof(MLC_MAGIC)) != 0 ||
+        h->version != MLC_VERSION || h->file_size != size)
+        return false;
+
+    if (!ml_range_ok(size, h->entries, h->entry_count, sizeof(MlcEntry)) ||
+        !ml_range_ok(size, h->hash, h->hash_size, sizeof(uint32_t)) ||
+        !ml_range_ok(size, h->legacy, h->legacy_count, sizeof(uint32_t)) ||
+        !ml_range_ok(size, h->heaps, h->heap_count, sizeof(MlcHeap)) ||
+        !ml_range_ok(size, h->heap_hash, h->heap_hash_size, sizeof(uint32_t)) ||
+        !ml_range_ok(size, h->params, h->param_count, sizeof(MlcParam)) ||
+        !ml_range_ok(size, h->flags, h->flag_count, sizeof(uint32_t)) ||
+        h->pool > size || h->pool_size > size - h->pool ||
+        h->pool_size == 0u || img[h->pool + h->pool_size - 1u] != '\0')
+        return false;
+
+    /* Hash sizes must be nonzero powers of two with an empty slot */
+    if (h->hash_size == 0u || (h->hash_size & (h->hash_size - 1u)) != 0u || h->hash_size <= h->entry_count ||
+        h->heap_hash_size == 0u || (h->heap_hash_size & (h->heap_hash_size - 1u)) != 0u ||
+        h->heap_hash_size <= h->heap_count)
+        return false;
+
+#define ML_STR_OK(o) ((o) < h->pool_size)
+#define ML_OPT_OK(o) ((o) == MLC_NONE || ML_STR_OK(o))
+
+    const MlcEntry *e = (const MlcEntry *)(img + h->entries);
+    for (uint32_t i = 0; i < h->entry_count; i++) {
+        if (!ML_STR_OK(e[i].key) || !ML_OPT_OK(e[i].text) || !ML_OPT_OK(e[i].rip) ||
+            e[i].first_flag > h->flag_count || e[i].flag_count > h->flag_count - e[i].first_flag ||
+            e[i].first_param > h->param_count || e[i].param_count > h->param_count - e[i].first_param)
+            return false;
+    }
+
+    const uint32_t *u = (const uint32_t *)(img + h->hash);
+    for (uint32_t i = 0; i < h->hash_size; i++)
+        if (u[i] > h->entry_count)
+            return false;
+
+    u = (const uint32_t *)(img + h->legacy);
+    for (uint32_t i = 0; i < h->legacy_count; i++)
+        if (u[i] != MLC_NONE && u[i] >= h->entry_count)
+            return false;
+
+    const MlcHeap *hp = (const MlcHeap *)(img + h->heaps);
+    for (uint32_t i = 0; i < h->heap_count; i++)
+        if (!ML_STR_OK(hp[i].name))
+            return false;
+
+    u = (const uint32_t *)(img + h->heap_hash);
+    for (uint32_t i = 0; i < h->heap_hash_size; i++)
+        if (u[i] > h->heap_count)
+            return false;
+
+    const MlcParam *mp = (const MlcParam *)(img + h->params);
+    for (uint32_t i = 0; i < h->param_count; i++)
+        if (!ML_OPT_OK(mp[i].name) || !ML_OPT_OK(mp[i].type) ||
+            !ML_OPT_OK(mp[i].desc) || !ML_OPT_OK(mp[i].def))
+            return false;
+
+    u = (const uint32_t *)(img + h->flags);
+    for (uint32_t i = 0; i < h->flag_count; i++)
+        if (!ML_STR_OK(u[i]))
+            return false;
+
+#undef ML_STR_OK
+#undef ML_OPT_OK
+
+    return true;
+}
+
+/** @brief Build the .mlc path that goes with a .toml language file. */
+static bool ml_compiled_path(const char *toml_path, char *out, size_t out_sz)
+{
+    size_t n = strlen(toml_path);
+
+    if (n >= 5u && strcasecmp(toml_path + n - 5u, ".toml") == 0)
+        n -= 5u;
+
+    return snprintf(out, out_sz, "%.*s.mlc", (int)n, toml_path) < (int)out_sz;
+}
+
+/**
+ * @brief Map a compiled table, if it exists, is intact and was compiled
+ *        from the file described by src.
+ */
+static bool ml_map_compiled(const char *path, const struct stat *src,
+                            const char **out_img, size_t *out_size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || sb.st_size < (off_t)sizeof(MlcHeader)) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)sb.st_size;
+    void *img = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (img == MAP_FAILED)
+        return false;
+
+    const MlcHeader *h = img;
+    if (h->src_mtime != (int64_t)src->st_mtime || h->src_size != (int64_t)src->st_size ||
+        h->src_ino != (uint64_t)src->st_ino || !ml_check_image(img, size)) {
+        munmap(img, size);
+        return false;
+    }
+
+    *out_img = img;
+    *out_size = size;
+    return true;
+}
+
+/** @brief Write an image to path, replacing any old file atomically. */
+static MaxCfgStatus ml_write_image(const char *path, const char *img, size_t size)
+{
+    char tmp[ML_MAX_PATH];
+
+    if (snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid()) >= (int)sizeof(tmp))
+        return MAXCFG_ERR_PATH_TOO_LONG;
+
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp)
+        return MAXCFG_ERR_IO;
+
+    bool ok = (fwrite(img, 1, size, fp) == size);
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return MAXCFG_ERR_IO;
+    }
+    return MAXCFG_OK;
+}
+
+/**
+ * @brief Parse a language .toml and compile it.
+ */
+static MaxCfgStatus ml_compile_toml(const char *toml_path, const struct stat *src,
+                                    char **out_img, size_t *out_size)
+{
+    MaxCfgToml *toml = NULL;
+    MaxCfgStatus st = maxcfg_toml_init(&toml);
+    if (st != MAXCFG_OK)
+        return st;
+
+    st = maxcfg_toml_load_file(toml, toml_path, "");
+    if (st == MAXCFG_OK)
+        st = ml_build(toml, src, out_img, out_size);
+
+    maxcfg_toml_free(toml);
+    return st;
 }
 
 /* ========================================================================== */
@@ -195,41 +962,75 @@ MaxCfgStatus maxlang_open(const char *toml_path, MaxLang **out_lang)
 
     *out_lang = NULL;
 
+    struct stat src;
+    if (stat(toml_path, &src) != 0)
+        return MAXCFG_ERR_NOT_FOUND;
+
     /* Allocate language handle */
     MaxLang *lang = calloc(1, sizeof(MaxLang));
     if (!lang)
         return MAXCFG_ERR_OOM;
 
-    /* Initialize TOML store and load the language file */
-    MaxCfgStatus st = maxcfg_toml_init(&lang->toml);
-    if (st != MAXCFG_OK) {
-        free(lang);
-        return st;
-    }
-    lang->owns_toml = true;
+    /* Use the compiled table if it's current; otherwise compile the TOML
+     * and save the result so that the next open can map it. */
+    char mlc_path[ML_MAX_PATH];
+    bool have_mlc = ml_compiled_path(toml_path, mlc_path, sizeof(mlc_path));
+
+    if (have_mlc && ml_map_compiled(mlc_path, &src, &lang->tbl, &lang->tbl_size)) {
+        lang->tbl_mapped = true;
+    } else {
+        char *img = NULL;
+        MaxCfgStatus st = ml_compile_toml(toml_path, &src, &img, &lang->tbl_size);
+        if (st != MAXCFG_OK) {
+            free(lang);
+            return st;
+        }
+        lang->tbl = img;
 
-    st = maxcfg_toml_load_file(lang->toml, toml_path, "");
-    if (st != MAXCFG_OK) {
-        maxcfg_toml_free(lang->toml);
-        free(lang);
-        return st;
+        if (have_mlc)
+            (void)ml_write_image(mlc_path, img, lang->tbl_size);
     }
 
-    /* Build legacy map from [_legacy_map] table */
-    ml_load_legacy_map(lang);
-
     *out_lang = lang;
     return MAXCFG_OK;
 }
 
+MaxCfgStatus maxlang_compile(const char *toml_path, const char *out_path)
+{
+    if (!toml_path)
+        return MAXCFG_ERR_INVALID_ARGUMENT;
+
+    char mlc_path[ML_MAX_PATH];
+    if (!out_path) {
+        if (!ml_compiled_path(toml_path, mlc_path, sizeof(mlc_path)))
+            return MAXCFG_ERR_PATH_TOO_LONG;
+        out_path = mlc_path;
+    }
+
+    struct stat src;
+    if (stat(toml_path, &src) != 0)
+        return MAXCFG_ERR_NOT_FOUND;
+
+    char *img = NULL;
+    size_t size = 0;
+    MaxCfgStatus st = ml_compile_toml(toml_path, &src, &img, &size);
+    if (st != MAXCFG_OK)
+        return st;
+
+    st = ml_write_image(out_path, img, size);
+    free(img);
+    return st;
+}
+
 void maxlang_close(MaxLang *lang)
 {
     if (!lang)
         return;
 
-    /* Free legacy map keys */
-    for (int i = 0; i < lang->legacy_max_id; i++)
-        free(lang->legacy_keys[i]);  /* free(NULL) is safe */
+    if (lang->tbl_mapped)
+        munmap((void *)lang->tbl, lang->tbl_size);
+    else
+        free((void *)lang->tbl);
 
     /* Free runtime namespaces */
     for (int i = 0; i < lang->rt_ns_count; i++) {
@@ -240,8 +1041,9 @@ void maxlang_close(MaxLang *lang)
             free(ns->strings[j].value);
         }
     }
+    free(lang->rt_hash);
 
-    if (lang->owns_toml && lang->toml)
+    if (lang->toml)
         maxcfg_toml_free(lang->toml);
 
     free(lang);
@@ -256,17 +1058,26 @@ const char *maxlang_get(MaxLang *lang, const char *key)
     if (!lang || !key)
         return "";
 
-    /* If RIP mode, try RIP alternate first */
-    if (lang->use_rip) {
-        const char *rip = ml_get_rip_raw(lang, key);
-        if (rip)
-            return rip;
+    /* Compiled table (RIP alternate first, when in RIP mode) */
+    const MlcEntry *e = ml_find(lang, key);
+    if (e) {
+        const char *text = ml_entry_text(lang, e);
+        if (text)
+            return text;
     }
 
-    /* Try TOML store */
-    const char *text = ml_get_raw(lang, key);
-    if (text)
-        return text;
+    /* Extension files */
+    if (lang->toml) {
+        if (lang->use_rip) {
+            const char *rip = ml_get_rip_raw(lang, key);
+            if (rip)
+                return rip;
+        }
+
+        const char *text = ml_get_raw(lang, key);
+        if (text)
+            return text;
+    }
 
     /* Try runtime registered strings */
     const char *rt = ml_get_runtime(lang, key);
@@ -281,12 +1092,29 @@ const char *maxlang_get_rip(MaxLang *lang, const char *key)
     if (!lang || !key)
         return NULL;
 
+    const MlcEntry *e = ml_find(lang, key);
+    if (e && e->rip != MLC_NONE)
+        return ml_str(lang, e->rip);
+
     return ml_get_rip_raw(lang, key);
 }
 
 bool maxlang_has_flag(MaxLang *lang, const char *key, const char *flag)
 {
-    if (!lang || !lang->toml || !key || !flag)
+    if (!lang || !key || !flag)
+        return false;
+
+    const MlcEntry *e = ml_find(lang, key);
+    if (e) {
+        const uint32_t *flags = (const uint32_t *)(lang->tbl + ml_hdr(lang)->flags);
+        for (uint32_t i = 0; i < e->flag_count; i++) {
+            if (strcasecmp(ml_str(lang, flags[e->first_flag + i]), flag) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    if (!lang->toml)
         return false;
 
     char flags_key[ML_MAX_KEY];
@@ -306,20 +1134,43 @@ bool maxlang_has_flag(MaxLang *lang, const char *key, const char *flag)
     return false;
 }
 
+bool maxlang_get_param(MaxLang *lang, const char *key, int index, MaxLangParamInfo *out)
+{
+    if (!lang || !key || index < 0 || !out)
+        return false;
+
+    const MlcEntry *e = ml_find(lang, key);
+    if (!e || (uint32_t)index >= e->param_count)
+        return false;
+
+    const MlcParam *p = (const MlcParam *)(lang->tbl + ml_hdr(lang)->params) + e->first_param + index;
+    out->name = (p->name != MLC_NONE) ? ml_str(lang, p->name) : "";
+    out->type = (p->type != MLC_NONE) ? ml_str(lang, p->type) : "";
+    out->desc = (p->desc != MLC_NONE) ? ml_str(lang, p->desc) : "";
+    out->def = (p->def != MLC_NONE) ? ml_str(lang, p->def) : "";
+    return true;
+}
+
 /* ========================================================================== */
 /* Public API: Legacy numeric access                                           */
 /* ========================================================================== */
 
 const char *maxlang_get_by_id(MaxLang *lang, int strn)
 {
-    if (!lang || strn < 0 || strn >= ML_MAX_LEGACY_MAP)
+    if (!lang || strn < 0 || (uint32_t)strn >= ml_hdr(lang)->legacy_count)
         return "";
 
-    const char *key = lang->legacy_keys[strn];
-    if (!key)
+    uint32_t idx = ((const uint32_t *)(lang->tbl + ml_hdr(lang)->legacy))[strn];
+    if (idx == MLC_NONE)
         return "";
 
-    return maxlang_get(lang, key);
+    const MlcEntry *e = ml_entry(lang, idx);
+    const char *text = ml_entry_text(lang, e);
+    if (text)
+        return text;
+
+    /* No text of its own: the same fallbacks as by name */
+    return maxlang_get(lang, ml_str(lang, e->key));
 }
 
 const char *maxlang_get_by_heap_id(MaxLang *lang, const char *heap_name, int strn)
@@ -327,23 +1178,12 @@ const char *maxlang_get_by_heap_id(MaxLang *lang, const char *heap_name, int str
     if (!lang || !heap_name || strn < 0)
         return "";
 
-    /* Find the base ID for this heap by scanning legacy_keys for the first
-     * entry whose dotted key starts with "heap_name." */
-    size_t prefix_len = strlen(heap_name);
-    int base_id = -1;
-
-    for (int id = 0; id < lang->legacy_max_id; id++) {
-        const char *k = lang->legacy_keys[id];
-        if (k && strncmp(k, heap_name, prefix_len) == 0 && k[prefix_len] == '.') {
-            base_id = id;
-            break;
-        }
-    }
-
-    if (base_id < 0)
+    /* The compiler recorded the first legacy ID belonging to each heap */
+    const MlcHeap *hp = ml_find_heap(lang, heap_name);
+    if (!hp || hp->base_id == MLC_NONE)
         return "";
 
-    return maxlang_get_by_id(lang, base_id + strn);
+    return maxlang_get_by_id(lang, (int)hp->base_id + strn);
 }
 
 const char *maxlang_get_name(MaxLang *lang)
@@ -351,8 +1191,8 @@ const char *maxlang_get_name(MaxLang *lang)
     if (!lang)
         return "";
 
-    const char *name = ml_get_raw(lang, "meta.name");
-    return name ? name : "";
+    const MlcEntry *e = ml_find(lang, "meta.name");
+    return (e && e->text != MLC_NONE) ? ml_str(lang, e->text) : "";
 }
 
 /* ========================================================================== */
@@ -371,11 +1211,12 @@ void maxlang_set_use_rip(MaxLang *lang, bool use_rip)
 
 MaxCfgStatus maxlang_load_extension(MaxLang *lang, const char *path)
 {
-    if (!lang || !lang->toml || !path)
+    if (!lang || !path)
         return MAXCFG_ERR_INVALID_ARGUMENT;
 
     /* Pre-scan the TOML file for [heap_name] section headers and check each
-     * against the existing store.  Abort if any heap name already exists. */
+     * against the compiled table and earlier extensions.  Abort if any heap
+     * name already exists. */
     FILE *fp = fopen(path, "r");
     if (!fp)
         return MAXCFG_ERR_NOT_FOUND;
@@ -407,16 +1248,23 @@ MaxCfgStatus maxlang_load_extension(MaxLang *lang, const char *path)
         if (!*p || *p == '_')
             continue;
 
-        /* Check if this heap already exists in the main store */
+        /* Check if this heap already exists */
         MaxCfgVar probe;
-        if (maxcfg_toml_get(lang->toml, p, &probe) == MAXCFG_OK) {
+        if (ml_find_heap(lang, p) || ml_find(lang, p) ||
+            (lang->toml && maxcfg_toml_get(lang->toml, p, &probe) == MAXCFG_OK)) {
             fclose(fp);
             return MAXCFG_ERR_DUPLICATE;  /* Heap name conflicts */
         }
     }
     fclose(fp);
 
-    /* No conflicts — merge into the main TOML store */
+    /* No conflicts — merge into the extension TOML store */
+    if (!lang->toml) {
+        MaxCfgStatus st = maxcfg_toml_init(&lang->toml);
+        if (st != MAXCFG_OK)
+            return st;
+    }
+
     return maxcfg_toml_load_file(lang->toml, path, "");
 }
 
@@ -424,12 +1272,14 @@ MaxCfgStatus maxlang_load_extension(MaxLang *lang, const char *path)
 /* Public API: Runtime string registration                                     */
 /* ========================================================================== */
 
-MaxCfgStatus maxlang_register(MaxLang *lang, const char *ns,
-                              const char **keys, const char **values,
-                              int count)
+/**
+ * @brief Add or update one namespace's strings (maxlang_register() without
+ *        the index rebuild).
+ */
+static MaxCfgStatus ml_register_strings(MaxLang *lang, const char *ns,
+                                        const char **keys, const char **values,
+                                        int count)
 {
-    if (!lang || !ns || !keys || !values || count <= 0)
-        return MAXCFG_ERR_INVALID_ARGUMENT;
 
     /* Find or create the namespace */
     MlRtNamespace *target = NULL;
@@ -484,6 +1334,18 @@ MaxCfgStatus maxlang_register(MaxLang *lang, const char *ns,
     return MAXCFG_OK;
 }
 
+MaxCfgStatus maxlang_register(MaxLang *lang, const char *ns,
+                              const char **keys, const char **values,
+                              int count)
+{
+    if (!lang || !ns || !keys || !values || count <= 0)
+        return MAXCFG_ERR_INVALID_ARGUMENT;
+
+    MaxCfgStatus st = ml_register_strings(lang, ns, keys, values, count);
+    ml_rt_rehash(lang);
+    return st;
+}
+
 void maxlang_unregister(MaxLang *lang, const char *ns)
 {
     if (!lang || !ns)
@@ -507,6 +1369,7 @@ void maxlang_unregister(MaxLang *lang, const char *ns)
                     (size_t)(lang->rt_ns_count - i - 1) * sizeof(MlRtNamespace));
         }
         lang->rt_ns_count--;
+        ml_rt_rehash(lang);
         return;
     }
 }
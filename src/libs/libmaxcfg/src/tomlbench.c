@@ -0,0 +1,423 @@
+/*
+ * tomlbench.c — Benchmark for TOML store startup and lookups
+ *
+ * Copyright 2026 by Kevin Morgan.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * Loads a Maximus configuration tree the way Read_Cfg() does, both from
+ * the TOML files and from a snapshot of them, and reports how long each
+ * takes.  It then collects the dotted path of every value in the tree and
+ * times maxcfg_toml_get() on all of them in both stores.  Every lookup
+ * must succeed and the two stores must agree, so the run also checks
+ * that the snapshot holds the same tree.
+ *
+ * Usage: tomlbench [-a areas] [-l loads] [-r rounds] <install dir>
+ *
+ *   -a  Replace the message areas with this many generated ones, to see
+ *       how startup and lookups scale with large tables
+ *   -l  Number of times to load each way (default 20)
+ *   -r  Number of passes over the collected paths (default 200)
+ */
+
+#include "libmaxcfg.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/** @brief Files loaded by Read_Cfg(), as path and prefix pairs. */
+static const char *const bench_files[][2] = {
+    { "config/maximus", "maximus" },
+    { "config/general/session", "general.session" },
+    { "config/general/display_files", "general.display_files" },
+    { "config/general/equipment", "general.equipment" },
+    { "config/general/colors", "general.colors" },
+    { "config/general/display", "general.display" },
+    { "config/general/reader", "general.reader" },
+    { "config/general/protocol", "general.protocol" },
+    { "config/general/language", "general.language" },
+    { "config/general/mex", "mex" },
+    { "config/general/theme", "general.theme" },
+    { "config/security/access_levels", "security.access_levels" },
+    { "config/areas/msg/areas", "areas.msg" },
+    { "config/areas/file/areas", "areas.file" },
+    { "config/matrix", "matrix" },
+};
+
+#define N_BENCH_FILES (sizeof(bench_files) / sizeof(bench_files[0]))
+
+typedef struct {
+    char **v;
+    size_t n;
+    size_t cap;
+} PathList;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void path_add(PathList *pl, const char *path)
+{
+    if (pl->n == pl->cap) {
+        pl->cap = pl->cap ? pl->cap * 2u : 1024u;
+        pl->v = realloc(pl->v, pl->cap * sizeof(*pl->v));
+        if (pl->v == NULL) {
+            perror("tomlbench");
+            exit(1);
+        }
+    }
+
+    pl->v[pl->n++] = strdup(path);
+}
+
+/** @brief Add @p path and, for tables, the path of everything under it. */
+static void collect(PathList *pl, const char *path, const MaxCfgVar *var)
+{
+    char sub[512];
+    size_t count = 0;
+    size_t i;
+
+    path_add(pl, path);
+
+    if (maxcfg_var_count(var, &count) != MAXCFG_OK) {
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        const char *key = NULL;
+        MaxCfgVar child;
+
+        if (var->type == MAXCFG_VAR_TABLE) {
+            if (maxcfg_toml_table_entry(var, i, &key, &child) != MAXCFG_OK) {
+                continue;
+            }
+
+            /* Keys the dotted syntax can't address */
+            if (strpbrk(key, ".[") != NULL) {
+                continue;
+            }
+
+            snprintf(sub, sizeof(sub), "%s.%s", path, key);
+        } else if (var->type == MAXCFG_VAR_TABLE_ARRAY) {
+            if (maxcfg_toml_array_get(var, i, &child) != MAXCFG_OK) {
+                continue;
+            }
+
+            snprintf(sub, sizeof(sub), "%s[%zu]", path, i);
+        } else {
+            return;
+        }
+
+        collect(pl, sub, &child);
+    }
+}
+
+/** @brief Write @p n message areas to a temporary file. */
+static char *make_areas(int n)
+{
+    static char name[] = "/tmp/tomlbenchXXXXXX";
+    FILE *fp;
+    int fd;
+    int i;
+
+    if ((fd = mkstemp(name)) < 0) {
+        return NULL;
+    }
+
+    if ((fp = fdopen(fd, "w")) == NULL) {
+        close(fd);
+        unlink(name);
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++) {
+        fprintf(fp,
+                "[[area]]\n"
+                "name = \"A%d\"\n"
+                "description = \"Area %d\"\n"
+                "acs = \"Transient\"\n"
+                "division = \"Div %d\"\n"
+                "tag = \"TAG%d\"\n"
+                "path = \"data/msgbase/a%d\"\n"
+                "style = [\"Squish\", \"Local\"]\n"
+                "renum_max = 500\n\n",
+                i, i, i % 50, i, i);
+    }
+
+    fclose(fp);
+    return name;
+}
+
+static void load_menus(MaxCfgToml *toml)
+{
+    DIR *d;
+    struct dirent *de;
+
+    if ((d = opendir("config/menus")) == NULL) {
+        return;
+    }
+
+    while ((de = readdir(d)) != NULL) {
+        char path[512];
+        char prefix[256];
+        const char *ext = strrchr(de->d_name, '.');
+        size_t n;
+
+        if (de->d_name[0] == '.' || ext == NULL || strcmp(ext, ".toml") != 0) {
+            continue;
+        }
+
+        n = (size_t)(ext - de->d_name);
+        snprintf(path, sizeof(path), "config/menus/%s", de->d_name);
+        snprintf(prefix, sizeof(prefix), "menus.%.*s", (int)n, de->d_name);
+        (void)maxcfg_toml_load_file(toml, path, prefix);
+    }
+
+    closedir(d);
+}
+
+/** @brief Load the configuration, as Read_Cfg() does. */
+static MaxCfgToml *load_config(const char *areas)
+{
+    MaxCfgToml *toml = NULL;
+    size_t i;
+
+    if (maxcfg_toml_init(&toml) != MAXCFG_OK) {
+        return NULL;
+    }
+
+    for (i = 0; i < N_BENCH_FILES; i++) {
+        const char *path = bench_files[i][0];
+
+        if (areas && strcmp(bench_files[i][1], "areas.msg") == 0) {
+            path = areas;
+        }
+
+        (void)maxcfg_toml_load_file(toml, path, bench_files[i][1]);
+    }
+
+    load_menus(toml);
+    return toml;
+}
+
+/** @brief Time maxcfg_toml_get() on every path; returns ns per lookup. */
+static double time_lookups(const MaxCfgToml *toml, const PathList *pl, int rounds, size_t *missed)
+{
+    double t0 = now_sec();
+    size_t i;
+    int r;
+
+    *missed = 0;
+
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < pl->n; i++) {
+            MaxCfgVar v;
+
+            if (maxcfg_toml_get(toml, pl->v[i], &v) != MAXCFG_OK) {
+                (*missed)++;
+            }
+        }
+    }
+
+    *missed /= (size_t)rounds;
+    return (now_sec() - t0) * 1e9 / ((double)pl->n * rounds);
+}
+
+/** @brief Count the paths whose value differs in type between two stores. */
+static size_t compare_stores(const MaxCfgToml *a, const MaxCfgToml *b, const PathList *pl)
+{
+    size_t bad = 0;
+    size_t i;
+
+    for (i = 0; i < pl->n; i++) {
+        MaxCfgVar va;
+        MaxCfgVar vb;
+
+        if (maxcfg_toml_get(a, pl->v[i], &va) != MAXCFG_OK ||
+            maxcfg_toml_get(b, pl->v[i], &vb) != MAXCFG_OK ||
+            va.type != vb.type) {
+            bad++;
+        }
+    }
+
+    return bad;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: tomlbench [-a areas] [-l loads] [-r rounds] <install dir>\n");
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *const roots[] = {
+        "maximus", "general", "mex", "security", "areas", "matrix", "menus"
+    };
+    static char snap[] = "/tmp/tomlbenchsnapXXXXXX";
+    PathList pl = { NULL, 0, 0 };
+    MaxCfgToml *toml = NULL;
+    MaxCfgToml *mapped = NULL;
+    MaxCfgStatus st;
+    char *areas = NULL;
+    int rounds = 200;
+    int loads = 20;
+    int n_areas = 0;
+    size_t missed, missed_mapped, differ;
+    size_t i;
+    double t0, t_load, t_snap, t_get, t_get_mapped;
+    int failed = 0;
+    int opt;
+    int fd;
+    int l;
+
+    while ((opt = getopt(argc, argv, "a:l:r:")) != -1) {
+        switch (opt) {
+        case 'a':
+            n_areas = atoi(optarg);
+            break;
+        case 'l':
+            loads = atoi(optarg);
+            break;
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        default:
+            usage();
+        }
+    }
+
+    if (optind != argc - 1 || rounds < 1 || loads < 1) {
+        usage();
+    }
+
+    if (chdir(argv[optind]) != 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    if (n_areas > 0 && (areas = make_areas(n_areas)) == NULL) {
+        perror("tomlbench");
+        return 1;
+    }
+
+    /* Startup from the TOML files */
+
+    t0 = now_sec();
+
+    for (l = 0; l < loads; l++) {
+        maxcfg_toml_free(toml);
+
+        if ((toml = load_config(areas)) == NULL) {
+            fprintf(stderr, "tomlbench: out of memory\n");
+            return 1;
+        }
+    }
+
+    t_load = (now_sec() - t0) / loads;
+
+    /* Startup from a snapshot of the same tree */
+
+    if ((fd = mkstemp(snap)) < 0) {
+        perror("tomlbench");
+        return 1;
+    }
+
+    close(fd);
+
+    if ((st = maxcfg_toml_snapshot_write(toml, snap)) != MAXCFG_OK) {
+        fprintf(stderr, "tomlbench: can't write snapshot: %s\n", maxcfg_status_string(st));
+        unlink(snap);
+        return 1;
+    }
+
+    t0 = now_sec();
+
+    for (l = 0; l < loads; l++) {
+        maxcfg_toml_free(mapped);
+        mapped = NULL;
+
+        if (maxcfg_toml_init(&mapped) != MAXCFG_OK ||
+            (st = maxcfg_toml_snapshot_load(mapped, snap)) != MAXCFG_OK) {
+            fprintf(stderr, "tomlbench: can't load snapshot: %s\n", maxcfg_status_string(st));
+            unlink(snap);
+            return 1;
+        }
+    }
+
+    t_snap = (now_sec() - t0) / loads;
+
+    unlink(snap);
+
+    if (areas) {
+        unlink(areas);
+    }
+
+    /* Lookups on both */
+
+    for (i = 0; i < sizeof(roots) / sizeof(roots[0]); i++) {
+        MaxCfgVar v;
+
+        if (maxcfg_toml_get(toml, roots[i], &v) == MAXCFG_OK) {
+            collect(&pl, roots[i], &v);
+        }
+    }
+
+    if (pl.n == 0) {
+        fprintf(stderr, "tomlbench: no configuration found in %s\n", argv[optind]);
+        return 1;
+    }
+
+    t_get = time_lookups(toml, &pl, rounds, &missed);
+    t_get_mapped = time_lookups(mapped, &pl, rounds, &missed_mapped);
+    differ = compare_stores(toml, mapped, &pl);
+
+    printf("startup:  %.2f ms from TOML, %.2f ms from snapshot (%d loads)\n",
+           t_load * 1e3, t_snap * 1e3, loads);
+    printf("lookups:  %zu paths x %d rounds, %.1f ns per maxcfg_toml_get() "
+           "(%.1f ns from snapshot)\n",
+           pl.n, rounds, t_get, t_get_mapped);
+
+    if (missed || missed_mapped) {
+        printf("FAILED: %zu lookups did not find their path (%zu from snapshot)\n",
+               missed, missed_mapped);
+        failed = 1;
+    }
+
+    if (differ) {
+        printf("FAILED: %zu paths differ between TOML and snapshot\n", differ);
+        failed = 1;
+    }
+
+    maxcfg_toml_free(mapped);
+    maxcfg_toml_free(toml);
+
+    for (i = 0; i < pl.n; i++) {
+        free(pl.v[i]);
+    }
+
+    free(pl.v);
+    return failed;
+}
@@ -212,6 +212,8 @@ typedef struct _tlistlist TLLIST;
 struct _patch;
 typedef struct _patch PATCH;
 
+struct _vm_quad;
+
 
 
 /**************************************************************************
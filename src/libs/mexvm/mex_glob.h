@@ -32,6 +32,8 @@ mex_extern char filename[PATHLEN];  /* Name of file we're processing        */
 mex_extern char yytext[MAX_ID_LEN]; /* The current token                    */
 mex_extern char vm_output equ(TRUE);/* Generate *.vm output file (vs txt)   */
 mex_extern char show_addr equ(FALSE);/* Show addresses for quad output      */
+mex_extern char optimize equ(FALSE);/* Optimize the quads before writing    */
+mex_extern char line_info equ(FALSE);/* Write a line number table (-g)      */
 mex_extern long linenum;            /* Current line number of input file    */
 mex_extern char check_subs;         /* Check subscript bounds               */
 mex_extern unsigned n_errors;       /* number of errors in compile          */
@@ -77,6 +77,7 @@ int BackPatchTXT(PATCH *pat, VMADDR to_where);
 int BackPatchVM(PATCH *pat, VMADDR to_where);
 int open_vm(char *name, long lStackSize, long lHeapSize, char *outfile);
 int close_vm(void);
+VMADDR OptimizeQuads(struct _vm_quad *pin, VMADDR n_inst, VMADDR *pvaMap);
 void WhileTest(WHILETYPE *w, DATAOBJ *obj);
 void GenWhileOut(WHILETYPE *w);
 void GenDoWhileOut(WHILETYPE *w, DATAOBJ *obj);
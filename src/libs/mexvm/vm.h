@@ -45,6 +45,8 @@
 struct _vm_quad;
 typedef struct _vm_quad INST;
 
+struct _vmprof;
+
 
 /*****************************************************************************
                           Macro definitions
@@ -98,6 +100,8 @@ typedef struct _vm_quad INST;
 
 #define VMF_DEBEXE    0x0001  /* VM flags used to indicate what type of   */
 #define VMF_DEBHEAP   0x0002  /* debugging support is requested.          */
+#define VMF_NOXLATE   0x0004  /* Run the quads directly; don't pre-decode */
+#define VMF_PROFILE   0x0008  /* Profile the program (see vm_prof.c)      */
 
 
 #define MAX_REGS      100     /* Max number of registers of each size */
@@ -133,30 +137,103 @@ struct _opproc
 } /* no packed - contains function pointer that needs alignment on ARM64 */;
 
 
+/* _xinst - a pre-decoded instruction.  When a program is loaded, each
+ * quad is translated into one of these, so that the interpreter doesn't
+ * need to work out the form and location of its operands every time the
+ * instruction is executed.  Operands which are known at load time are
+ * stored directly in 'arg'; the others are described by a kind (k1/k2)
+ * and either a resolved pointer, an offset from the activation record,
+ * or the original address to be passed to fetch().
+ */
+
+union _xopnd
+{
+  void *p;
+  VMADDR ofs;
+  IADDR ia;
+};
+
+typedef struct _xinst
+{
+  int (*op_proc)(INST *inst, struct _args *arg);
+  union _xopnd o1, o2;
+  byte k1, k2;
+  struct _args arg;
+} XINST;
+
+
 /* _rtsym - Run-time symbol table (for global references only) */
 
 struct _rtsym
 {
   char name[MAX_GLOB_LEN];
   VMADDR offset;
+  VMADDR hash;          /* VmHashName(name) */
+  VMADDR next;          /* Next entry in the same hash chain */
+  VMADDR n_ref;         /* Number of references to it in the code */
 } __attribute__((packed));
 
-/* _dsheap - head of the data segment heap.  This structure is used to
- * track information about used and free blocks in the MEX program heap.
+#define RTSYM_NONE  ((VMADDR)-1L)   /* End of an rtsym hash chain */
+
+/* _dsheap - head of the data segment heap.  This lives at the start of
+ * the heap area and holds the free lists, so saving pdshDheap (and the
+ * data segment) saves the whole heap.
+ *
+ * Free blocks are kept on segregated lists by size: one list for each
+ * multiple of DSH_ALIGN below DSH_SMALL, and then one list for each
+ * power of two.  Neighbouring free blocks are always merged.
  */
 
+#define DSH_ALIGN     8       /* Block sizes are a multiple of this */
+#define DSH_SMALL     128     /* Exact-size free lists below this size */
+#define DSH_NBIN      (DSH_SMALL/DSH_ALIGN + 12)
+
 struct _dsheap
+{
+  VMADDR bin[DSH_NBIN]; /* Free lists, by size class */
+  VMADDR first;         /* Offset of the first block */
+  VMADDR end;           /* Offset just past the last block */
+  VMADDR cb_used;       /* Bytes currently allocated */
+  VMADDR cb_peak;       /* ...and the most ever allocated at once */
+  dword n_alloc;        /* Number of successful hpalloc() calls */
+  dword n_fail;         /* Number of failed hpalloc() calls */
+} __attribute__((packed));
+
+/* _dsblk - header of a used or free block in the data segment heap */
+
+struct _dsblk
 {
 #ifdef HEAP_SIGNATURE
   #define DSHEAP_SIG 0x6566
   word sig;
 #endif
-  VMADDR size;
-  VMADDR next;
+  VMADDR size;          /* Bytes of data following this header */
+  VMADDR prev;          /* Physically preceding block, or END_HEAP */
   byte free;
   byte rsvd;
 } __attribute__((packed));
 
+/* _dsfree - free list links, kept in the data area of a free block */
+
+struct _dsfree
+{
+  VMADDR next;
+  VMADDR prev;
+} __attribute__((packed));
+
+/* _hpstat - heap statistics, as returned by hpstat() */
+
+struct _hpstat
+{
+  dword n_alloc;        /* Number of successful hpalloc() calls */
+  dword n_fail;         /* Number of failed hpalloc() calls */
+  VMADDR cb_heap;       /* Size of the heap */
+  VMADDR cb_used;       /* Bytes allocated now */
+  VMADDR cb_peak;       /* Most bytes ever allocated at once */
+  VMADDR cb_free;       /* Bytes in free blocks */
+  VMADDR cb_largest;    /* Size of the largest free block */
+};
+
 /* _usrfunc - this is used as part of an array of structures to define
  * all of the application-specific functions which can be called
  * by MEX programs.
@@ -182,6 +259,7 @@ vm_extern struct _usrfunc
   struct _imp[vmh.n_imp]  { struct _ipat[imp.n_patch] }
   struct _funcdef[vmh.n_fdef];
   struct _funccall[vmh.n_fcall] { VMADDR[dfc.n_quads] };
+  [line number table - see struct _dltrail]
 }
 
 */
@@ -266,6 +344,37 @@ struct _dfcall
 } __attribute__((packed));
 
 
+/* Optional line number table, written by "mex -g".  It follows everything *
+ * else in the .VM file, so older VMs never see it.  The trailer at the very *
+ * end of the file says how big it is:                                      *
+ *                                                                          *
+ *   struct _dline[n_line];    Quads at which the source line changes       *
+ *   struct _dlfile[n_file];   Source file names, indexed by dline.file     *
+ *   struct _dltrail;                                                       */
+
+#define DL_ID       "MEXL"
+#define DL_PATHLEN  64
+
+struct _dline
+{
+  VMADDR quad;          /* First quad generated for this line */
+  dword line;           /* Line number in the source file */
+  word file;            /* Index of the source file name */
+} __attribute__((packed));
+
+struct _dlfile
+{
+  char name[DL_PATHLEN];
+} __attribute__((packed));
+
+struct _dltrail
+{
+  VMADDR n_line;
+  VMADDR n_file;
+  char id[4];           /* DL_ID */
+} __attribute__((packed));
+
+
 /* Linked list of all declared functions in this file, plus their starting
  * quad numbers.
  */
@@ -296,6 +405,7 @@ struct _fcall
 #ifdef COMPILING_MEX_VM  /* Only define if we're compiling the VM */
   vm_extern void (_stdc *pfnLogger)(char *szStr, ...);
   vm_extern INST *pinCs;           /* The code segment - array of quadruples */
+  vm_extern XINST *pxiCs;          /* Pre-decoded copy of the code segment */
 
   vm_extern byte *pbDs;              /* Data segment.  For global vars only! */
   vm_extern byte *pbSp;              /* Stack pointer */
@@ -312,9 +422,14 @@ struct _fcall
 
   vm_extern struct _funcdef *fdlist VM_IS(NULL);
 
+  vm_extern VMADDR n_usrfn;         /* Number of intrinsics in usrfn[] */
+  vm_extern dword *pdwUsrCalls;     /* Call count for each intrinsic */
+
   vm_extern int deb VM_IS(FALSE);
   vm_extern int debheap VM_IS(FALSE);
 
+  vm_extern struct _vmprof *pvmp VM_IS(NULL);  /* Profiler, if VMF_PROFILE */
+
   /***************************************************************************
                               Error messages
    ***************************************************************************/
@@ -339,17 +454,31 @@ struct _fcall
 
 #ifdef COMPILING_MEX_VM
   int init_symtab(int cRtSym);
+  VMADDR VmHashName(char *name);
+  struct _rtsym *VmFindSymtab(char *name);
   void hpinit(void);
   VMADDR hpalloc(word len);
   void hpfree(VMADDR ofs);
+  int hpcheck(void);
+  void hpstat(struct _hpstat *phs);
   void hpdbug(void);
   void *fetch(FORM form, IADDR *where);
   int store(IADDR *dest, FORM form, void *val);
   void _stdc vm_err(char *format,...);
   int VmRead(char *name);
+  void NoMem(void);
+  int VmCacheLoad(char *path, time_t mtime, long size);
+  void VmCacheStore(char *path, time_t mtime, long size);
   void kill_str(IADDR *strptr, IADDR *ptrptr);
   VMADDR MexGetLastAssigned(void);
   void MexSetLastAssigned(VMADDR val);
+  int ProfInit(char *name);
+  void ProfTerm(void);
+  void ProfStep(VMADDR q);
+  void ProfEnter(VMADDR func);
+  void ProfEnterIntrinsic(VMADDR iuf);
+  void ProfLeave(void);
+  void ProfReport(void);
 #endif
 
 /*****************************************************************************
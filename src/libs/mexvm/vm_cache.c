@@ -0,0 +1,272 @@
+/*
+ * Maximus Version 3.02
+ * Copyright 1989, 2002 by Lanius Corporation.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*# name=MEX virtual machine - cache of loaded .vm images
+*/
+
+#define COMPILING_MEX_VM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "prog.h"
+#include "vm.h"
+
+/* Loading a .vm file means reading it, building the run-time symbol      *
+ * table, initializing the globals and patching every reference to a     *
+ * global or a function.  Menus run the same handful of programs over     *
+ * and over, so the result of all that is kept here after the first load. *
+ * A later run of an unchanged file just copies the image into a fresh    *
+ * data segment and code segment.                                         *
+ *                                                                        *
+ * Calls to intrinsics are patched with quad numbers from the caller's    *
+ * intrinsic table, so an image is only reused with the same table.       */
+
+#define VMC_MAX   16          /* Max number of images to keep */
+
+struct _vmcache
+{
+  char *path;                 /* Key: file name, as opened */
+  time_t mtime;               /* ...modification time */
+  long size;                  /* ...and size of the .vm file */
+  struct _usrfunc *usrfn;     /* ...and the intrinsic table */
+  VMADDR n_usrfn;
+
+  dword last_use;             /* For discarding the least recently used */
+
+  struct _vmh vmh;            /* Header, with lGlobSize already adjusted */
+  INST *pinCs;                /* Patched code segment */
+  byte *pbGlob;               /* Initialized globals */
+  VMADDR vaGlob;              /* Number of bytes in pbGlob */
+  struct _rtsym *rtsym;       /* Symbol table, including hash buckets */
+  VMADDR n_rtsym, n_entry;
+  struct _dfuncdef *pdfd;     /* Exported functions, in file order */
+};
+
+static struct _vmcache vmc[VMC_MAX];
+static dword dwUse=0;
+static dword dwHits=0, dwMisses=0;
+
+
+#define RtsymSize(n)  ((sizeof(struct _rtsym) + sizeof(VMADDR)) * (n))
+
+
+/* Release one cache entry */
+
+static void near VmCacheFree(struct _vmcache *pvc)
+{
+  if (pvc->path)
+    free(pvc->path);
+
+  if (pvc->pinCs)
+    free(pvc->pinCs);
+
+  if (pvc->pbGlob)
+    free(pvc->pbGlob);
+
+  if (pvc->rtsym)
+    free(pvc->rtsym);
+
+  if (pvc->pdfd)
+    free(pvc->pdfd);
+
+  memset(pvc, 0, sizeof *pvc);
+}
+
+
+/* Find the image for 'path', or return NULL if it isn't cached */
+
+static struct _vmcache * near VmCacheFind(char *path, time_t mtime,
+                                          long size)
+{
+  struct _vmcache *pvc;
+
+  for (pvc=vmc; pvc < vmc+VMC_MAX; pvc++)
+    if (pvc->path && eqstr(pvc->path, path))
+    {
+      /* Throw it away if the program has been recompiled since */
+
+      if (pvc->mtime != mtime || pvc->size != size)
+      {
+        VmCacheFree(pvc);
+        return NULL;
+      }
+
+      return (pvc->usrfn==usrfn && pvc->n_usrfn==n_usrfn) ? pvc : NULL;
+    }
+
+  return NULL;
+}
+
+
+/* Set up the VM from the cached image of 'path'.  Returns 0 if the       *
+ * program was loaded, 1 if it isn't in the cache or -1 on error.         */
+
+int VmCacheLoad(char *path, time_t mtime, long size)
+{
+  struct _vmcache *pvc;
+  VMADDR i;
+
+  if ((pvc=VmCacheFind(path, mtime, size))==NULL)
+  {
+    dwMisses++;
+    return 1;
+  }
+
+  dwHits++;
+  pvc->last_use=++dwUse;
+
+  vmh=pvc->vmh;
+  high_cs=vmh.n_inst;
+
+  if ((pbDs=malloc(vmh.lGlobSize + vmh.lStackSize + vmh.lHeapSize))==NULL ||
+      (pinCs=malloc(sizeof(INST) * (high_cs ? high_cs : 1)))==NULL ||
+      (rtsym=malloc(RtsymSize(pvc->n_rtsym)))==NULL)
+  {
+    NoMem();
+    return -1;
+  }
+
+  hpinit();
+
+  memcpy(pbDs, pvc->pbGlob, pvc->vaGlob);
+  memcpy(pinCs, pvc->pinCs, sizeof(INST) * high_cs);
+  memcpy(rtsym, pvc->rtsym, RtsymSize(pvc->n_rtsym));
+
+  n_rtsym=pvc->n_rtsym;
+  n_entry=pvc->n_entry;
+  MexSetLastAssigned(pvc->vaGlob);
+
+  /* Add the exported functions to the head of fdlist, in the same order  *
+   * as VmRead() does.                                                    */
+
+  for (i=0; i < vmh.n_fdef; i++)
+  {
+    struct _funcdef *pfd;
+
+    if ((pfd=malloc(sizeof(struct _funcdef)))==NULL ||
+        (pfd->name=strdup(pvc->pdfd[i].name))==NULL)
+    {
+      if (pfd)
+        free(pfd);
+
+      NoMem();
+      return -1;
+    }
+
+    pfd->quad=pvc->pdfd[i].quad;
+    pfd->next=fdlist;
+    fdlist=pfd;
+  }
+
+  return 0;
+}
+
+
+/* Save the program that VmRead() has just loaded from 'path' */
+
+void VmCacheStore(char *path, time_t mtime, long size)
+{
+  struct _vmcache *pvc, *pvcOld;
+  struct _funcdef *pfd;
+  VMADDR i;
+
+  /* Use an empty slot, or else the one which was used longest ago */
+
+  for (pvc=pvcOld=vmc; pvc < vmc+VMC_MAX; pvc++)
+  {
+    if (pvc->path && eqstr(pvc->path, path))
+      break;
+
+    if (!pvc->path || (pvcOld->path && pvc->last_use < pvcOld->last_use))
+      pvcOld=pvc;
+  }
+
+  if (pvc==vmc+VMC_MAX)
+    pvc=pvcOld;
+
+  VmCacheFree(pvc);
+
+  pvc->vaGlob=MexGetLastAssigned();
+
+  if ((pvc->path=strdup(path))==NULL ||
+      (pvc->pinCs=malloc(sizeof(INST) * (high_cs ? high_cs : 1)))==NULL ||
+      (pvc->pbGlob=malloc(pvc->vaGlob ? pvc->vaGlob : 1))==NULL ||
+      (pvc->rtsym=malloc(RtsymSize(n_rtsym)))==NULL ||
+      (pvc->pdfd=malloc(sizeof(struct _dfuncdef) *
+                        (vmh.n_fdef ? vmh.n_fdef : 1)))==NULL)
+  {
+    VmCacheFree(pvc);
+    return;
+  }
+
+  /* VmRead() pushed the exports onto the front of fdlist, so the first   *
+   * n_fdef entries are the file's exports in reverse order.              */
+
+  for (pfd=fdlist, i=vmh.n_fdef; i && pfd; pfd=pfd->next)
+  {
+    i--;
+    strnncpy(pvc->pdfd[i].name, pfd->name, MAX_GLOB_LEN);
+    pvc->pdfd[i].quad=pfd->quad;
+  }
+
+  if (i)
+  {
+    VmCacheFree(pvc);
+    return;
+  }
+
+  memcpy(pvc->pinCs, pinCs, sizeof(INST) * high_cs);
+  memcpy(pvc->pbGlob, pbDs, pvc->vaGlob);
+  memcpy(pvc->rtsym, rtsym, RtsymSize(n_rtsym));
+
+  pvc->mtime=mtime;
+  pvc->size=size;
+  pvc->usrfn=usrfn;
+  pvc->n_usrfn=n_usrfn;
+  pvc->vmh=vmh;
+  pvc->n_rtsym=n_rtsym;
+  pvc->n_entry=n_entry;
+  pvc->last_use=++dwUse;
+}
+
+
+/* Return the number of loads satisfied from (and missed by) the cache */
+
+void EXPENTRY MexCacheStats(dword *pdwHits, dword *pdwMisses)
+{
+  if (pdwHits)
+    *pdwHits=dwHits;
+
+  if (pdwMisses)
+    *pdwMisses=dwMisses;
+}
+
+
+/* Discard all cached images */
+
+void EXPENTRY MexCacheFlush(void)
+{
+  struct _vmcache *pvc;
+
+  for (pvc=vmc; pvc < vmc+VMC_MAX; pvc++)
+    VmCacheFree(pvc);
+}
+
@@ -23,7 +23,6 @@ static char rcs_id[]="$Id: vm_heap.c,v 1.6 2005/10/19 10:57:10 paltas Exp $";
 #pragma on(unreferenced)
 #endif
 
-#define HEAP_PROBLEMS
 #define HEAP_SIGNATURE
 #define COMPILING_MEX_VM
 
@@ -33,220 +32,356 @@ static char rcs_id[]="$Id: vm_heap.c,v 1.6 2005/10/19 10:57:10 paltas Exp $";
 #include "prog.h"
 #include "vm.h"
 
-/* Forward declaration for heap check function */
-#ifdef HEAP_PROBLEMS
-int hpcheck(void);
-#endif
+/* The heap is a run of blocks, each with a _dsblk header, following the  *
+ * _dsheap head.  Every free block is on the free list for its size       *
+ * class, and the free list links live in the block's data area, so a     *
+ * block always has room for at least a _dsfree.                          */
 
+#define DSH_MINDATA   ((sizeof(struct _dsfree) + DSH_ALIGN-1) & ~(DSH_ALIGN-1))
 
-void hpinit(void)
+#define Blk(ofs)      ((struct _dsblk *)(pbDs+(ofs)))
+#define BlkOfs(b)     ((VMADDR)((byte *)(b)-pbDs))
+#define BlkNext(b)    (BlkOfs(b) + sizeof(struct _dsblk) + (b)->size)
+#define BlkLinks(b)   ((struct _dsfree *)((b)+1))
+
+
+/* Return the free list to use for a block of 'size' bytes */
+
+static int near HpBin(VMADDR size)
+{
+  int bin;
+
+  if (size < DSH_SMALL)
+    return (int)(size / DSH_ALIGN);
+
+  for (bin=DSH_SMALL/DSH_ALIGN, size /= DSH_SMALL;
+       size > 1 && bin < DSH_NBIN-1;
+       size >>= 1)
+  {
+    bin++;
+  }
+
+  return bin;
+}
+
+
+/* Mark a block as free and add it to the front of its free list */
+
+static void near HpLink(struct _dsblk *b)
+{
+  struct _dsfree *pf=BlkLinks(b);
+  VMADDR *pvaBin=pdshDheap->bin + HpBin(b->size);
+
+  b->free=TRUE;
+  pf->prev=END_HEAP;
+  pf->next=*pvaBin;
+
+  if (*pvaBin != END_HEAP)
+    BlkLinks(Blk(*pvaBin))->prev=BlkOfs(b);
+
+  *pvaBin=BlkOfs(b);
+}
+
+
+/* Take a free block off its free list */
+
+static void near HpUnlink(struct _dsblk *b)
+{
+  struct _dsfree *pf=BlkLinks(b);
+
+  if (pf->prev != END_HEAP)
+    BlkLinks(Blk(pf->prev))->next=pf->next;
+  else pdshDheap->bin[HpBin(b->size)]=pf->next;
+
+  if (pf->next != END_HEAP)
+    BlkLinks(Blk(pf->next))->prev=pf->prev;
+
+  b->free=FALSE;
+}
+
+
+/* Set up a new block header at 'ofs' */
+
+static struct _dsblk * near HpMakeBlk(VMADDR ofs, VMADDR size, VMADDR prev)
 {
-  pdshDheap=(struct _dsheap *)(pbDs + vmh.lGlobSize + vmh.lStackSize);
+  struct _dsblk *b=Blk(ofs);
+
 #ifdef HEAP_SIGNATURE
-  pdshDheap->sig = DSHEAP_SIG;
+  b->sig=DSHEAP_SIG;
 #endif
-  pdshDheap->size=vmh.lHeapSize - sizeof(struct _dsheap);
-  pdshDheap->next=END_HEAP;
-  pdshDheap->free=TRUE;
-  pdshDheap->rsvd=0;
+  b->size=size;
+  b->prev=prev;
+  b->free=FALSE;
+  b->rsvd=0;
+
+  /* Let the following block know where we start */
+
+  if (BlkNext(b) < pdshDheap->end)
+    Blk(BlkNext(b))->prev=ofs;
+
+  return b;
 }
 
-VMADDR hpalloc(word len)
+
+void hpinit(void)
 {
-  struct _dsheap *dh, *fp, *new;
-  VMADDR size;
-  
-#ifdef HEAP_PROBLEMS
-  debheap=1;
-  if (len >= 6000)
+  VMADDR ofs=vmh.lGlobSize + vmh.lStackSize;
+
+  if (vmh.lHeapSize < sizeof(struct _dsheap))
+    vm_err(err_cdata_ovfl);
+
+  pdshDheap=(struct _dsheap *)(pbDs + ofs);
+  memset(pdshDheap, '\0', sizeof(struct _dsheap));
+
+  pdshDheap->first=ofs + sizeof(struct _dsheap);
+  pdshDheap->end=ofs + vmh.lHeapSize;
+
+  /* The rest of the heap starts out as one big free block */
+
+  if (pdshDheap->end - pdshDheap->first < sizeof(struct _dsblk) + DSH_MINDATA)
+    pdshDheap->end=pdshDheap->first;
+  else
   {
-    printf("asdf\n");
+    HpLink(HpMakeBlk(pdshDheap->first,
+                     pdshDheap->end - pdshDheap->first - sizeof(struct _dsblk),
+                     END_HEAP));
   }
+}
+
+
+/* Find a free block with at least 'size' bytes.  Blocks on the larger    *
+ * lists are always big enough, so only the first list has to be searched. */
 
-  if (hpcheck() != 0)
+static struct _dsblk * near HpFind(VMADDR size)
+{
+  struct _dsblk *b;
+  VMADDR va;
+  int bin=HpBin(size);
+
+  for (va=pdshDheap->bin[bin]; va != END_HEAP; va=BlkLinks(b)->next)
+    if ((b=Blk(va))->size >= size)
+      return b;
+
+  while (++bin < DSH_NBIN)
+    if (pdshDheap->bin[bin] != END_HEAP)
+      return Blk(pdshDheap->bin[bin]);
+
+  return NULL;
+}
+
+
+VMADDR hpalloc(word len)
+{
+  struct _dsblk *b;
+  VMADDR size;
+
+  if (debheap && hpcheck() != 0)
+    vm_err("Heap corrupted (hpalloc)");
+
+  size=((VMADDR)len + DSH_ALIGN-1) & ~(VMADDR)(DSH_ALIGN-1);
+
+  if (size < DSH_MINDATA)
+    size=DSH_MINDATA;
+
+  if ((b=HpFind(size))==NULL)
   {
-    printf("%s bar\n", __FUNCTION__);
+    pdshDheap->n_fail++;
+    return END_HEAP;
   }
-#endif
 
-  for (dh=pdshDheap;
-       dh;
-       dh=(struct _dsheap *)(pbDs+dh->next))
+  HpUnlink(b);
+
+  /* If there's enough left over, split off the tail as a new free block. *
+   * Its neighbours are both in use, since free blocks are always merged.  */
+
+  if (b->size >= size + sizeof(struct _dsblk) + DSH_MINDATA)
   {
-    /* Only work on free blocks */
-    
-    if (dh->free)
-    {
-      /* If this block is smaller than the one we need, see if we can join  *
-       * any following blocks to make up for it.                            */
-         
-      if (dh->size < len)
-      {
-        size=dh->size;
-        fp=dh;
-
-        if (dh->next==END_HEAP)
-          break;
-
-        /* Walk the list of blocks following this one in the heap, and      *
-         * count how much space they have free.                             */
-           
-        while (fp &&
-               fp->next != END_HEAP &&
-               ((struct _dsheap *)(pbDs+fp->next))->free &&
-               size < len)
-        {
-          fp=(struct _dsheap *)(pbDs+fp->next);
-
-          /* Increment the amount of space we received by the length of   *
-           * this block, including the _dsheap header chunk.              */
-
-          size += fp->size+sizeof(struct _dsheap);
-        }
-            
-        /* If we have enough space, merge these blocks together */
-          
-        if (size < len)
-          continue;
-        else
-        {
-          dh->size=size;
-          dh->next=fp->next;
-        }
-      }
-
-      /* If there's enough space here to consider lumping this block into   *
-       * two pieces...                                                      */
-
-      if (dh->size >= len+sizeof(struct _dsheap)+8)
-      {
-        /* The new block is located after this header, and after the data   *
-         * which follows this header.                                       */
-
-        new=(struct _dsheap *)((byte *)dh + sizeof(struct _dsheap) + len);
-        
-        
-        /* Subtract the size that we're using */
-        
-        new->size=(dh->size-len-sizeof(struct _dsheap));
-        new->next=dh->next;
-        new->rsvd=0;
-        new->free=TRUE;
-#ifdef HEAP_SIGNATURE
-        new->sig=DSHEAP_SIG;
-#endif
+    VMADDR tail=b->size - size - sizeof(struct _dsblk);
 
-        dh->size=len;
-        dh->next=((byte *)new-pbDs);
-      }
+    b->size=size;
+    HpLink(HpMakeBlk(BlkNext(b), tail, BlkOfs(b)));
+  }
 
-      dh->free=FALSE;
-      dh->rsvd=0;
-#ifdef HEAP_SIGNATURE
-      dh->sig = DSHEAP_SIG;
-#endif
+  pdshDheap->n_alloc++;
+  pdshDheap->cb_used += b->size;
 
-      /* Return the number of the dataseg location which immediately        *
-       * follows the block header.                                          */
+  if (pdshDheap->cb_used > pdshDheap->cb_peak)
+    pdshDheap->cb_peak=pdshDheap->cb_used;
 
-      #ifdef DEBUGVM
-      if (debheap)
-        printf("%08lx - hpalloc(%d) from %lx\n",
-               (long)((byte *)(dh+1)-pbDs),
-               len,
-               (long)vaIp);
-      #endif
+  /* Return the number of the dataseg location which immediately          *
+   * follows the block header.                                            */
 
-      return ((byte *)(dh+1)-pbDs);
-    }
-    
-    if (dh->next==END_HEAP)
-      break;
-  }
-    
-  return END_HEAP;
+  #ifdef DEBUGVM
+  if (debheap)
+    printf("%08lx - hpalloc(%d) from %lx\n",
+           (long)((byte *)(b+1)-pbDs),
+           len,
+           (long)vaIp);
+  #endif
+
+  return ((byte *)(b+1)-pbDs);
 }
 
 
 
 void hpfree(VMADDR ofs)
 {
-  struct _dsheap *dh;
-  
-#ifdef HEAP_PROBLEMS
-  if (hpcheck() != 0)
-  {
-    printf("%s foo\n", __FUNCTION__);
-  }
-#endif
+  struct _dsblk *b, *n;
 
-  dh=(struct _dsheap *)(pbDs+ofs)-1;
-  
-  if (dh->free || dh->size==0
+  if (debheap && hpcheck() != 0)
+    vm_err("Heap corrupted (hpfree)");
+
+  if (ofs < pdshDheap->first + sizeof(struct _dsblk) || ofs >= pdshDheap->end)
+    vm_err("Invalid hpfree(%08lx)", (long)ofs);
+
+  b=(struct _dsblk *)(pbDs+ofs)-1;
+
+  if (b->free || b->size==0
 #ifdef HEAP_SIGNATURE
-   || dh->sig != DSHEAP_SIG
+   || b->sig != DSHEAP_SIG
 #endif
     )
-    vm_err("Invalid hpfree(%08lx)", ofs);
-  
-  dh->free=TRUE;
+    vm_err("Invalid hpfree(%08lx)", (long)ofs);
 
   #ifdef DEBUGVM
   if (debheap)
     printf("%08lx - hpfree() from %" UINT32_XFORMAT ")\n", ofs, (long)vaIp);
   #endif
+
+  pdshDheap->cb_used -= b->size;
+
+  /* Merge with the following block... */
+
+  if (BlkNext(b) < pdshDheap->end && (n=Blk(BlkNext(b)))->free)
+  {
+    HpUnlink(n);
+    HpMakeBlk(BlkOfs(b), b->size + sizeof(struct _dsblk) + n->size, b->prev);
+  }
+
+  /* ...and with the preceding one */
+
+  if (b->prev != END_HEAP && (n=Blk(b->prev))->free)
+  {
+    HpUnlink(n);
+    b=HpMakeBlk(BlkOfs(n), n->size + sizeof(struct _dsblk) + b->size, n->prev);
+  }
+
+  HpLink(b);
 }
 
 
-#ifdef HEAP_PROBLEMS
+/* Check the heap for damage.  Returns 0 if it's okay, or a negative      *
+ * number which says what went wrong.                                     */
 
 int hpcheck(void)
 {
-  struct _dsheap *dh;
-  
-  for (dh=pdshDheap;
-       dh;
-       dh=(struct _dsheap *)(pbDs+dh->next))
+  struct _dsblk *b;
+  VMADDR va, prev=END_HEAP;
+  dword n_free=0, n_linked=0;
+  int bin;
+
+  /* Walk the blocks in address order */
+
+  for (va=pdshDheap->first; va < pdshDheap->end; va=BlkNext(b))
   {
-    /* If pointer out of the heap */
+    b=Blk(va);
 
-    if ((byte *)dh - pbDs >= vmh.lGlobSize + vmh.lStackSize + vmh.lHeapSize)
+    if (pdshDheap->end - va < sizeof(struct _dsblk) ||
+        b->size > pdshDheap->end - va - sizeof(struct _dsblk))
       return -1;
 
 #ifdef HEAP_SIGNATURE
-    if (dh->sig != DSHEAP_SIG)
+    if (b->sig != DSHEAP_SIG)
       return -2;
 #endif
 
-    if (dh->next==END_HEAP)
-      break;
+    if (b->prev != prev)
+      return -3;
+
+    /* Two free blocks in a row should have been merged */
+
+    if (b->free && prev != END_HEAP && Blk(prev)->free)
+      return -4;
+
+    if (b->free)
+      n_free++;
+
+    prev=va;
+  }
+
+  if (va != pdshDheap->end)
+    return -1;
+
+  /* Now make sure that the free lists hold exactly the free blocks */
+
+  for (bin=0; bin < DSH_NBIN; bin++)
+  {
+    prev=END_HEAP;
+
+    for (va=pdshDheap->bin[bin]; va != END_HEAP; va=BlkLinks(b)->next)
+    {
+      if (va < pdshDheap->first || va >= pdshDheap->end ||
+          ++n_linked > n_free)
+        return -5;
+
+      b=Blk(va);
+
+      if (!b->free || HpBin(b->size) != bin || BlkLinks(b)->prev != prev)
+        return -5;
+
+      prev=va;
+    }
   }
 
-  return 0;
+  return (n_linked==n_free) ? 0 : -5;
+}
+
+
+/* Return statistics about the heap */
+
+void hpstat(struct _hpstat *phs)
+{
+  struct _dsblk *b;
+  VMADDR va;
+
+  memset(phs, '\0', sizeof *phs);
+
+  phs->n_alloc=pdshDheap->n_alloc;
+  phs->n_fail=pdshDheap->n_fail;
+  phs->cb_heap=pdshDheap->end - pdshDheap->first;
+  phs->cb_used=pdshDheap->cb_used;
+  phs->cb_peak=pdshDheap->cb_peak;
+
+  for (va=pdshDheap->first; va < pdshDheap->end; va=BlkNext(b))
+    if ((b=Blk(va))->free)
+    {
+      phs->cb_free += b->size;
+
+      if (b->size > phs->cb_largest)
+        phs->cb_largest=b->size;
+    }
 }
-#endif
 
 
 #ifdef DEBUGVM
 void hpdbug(void)
 {
-  struct _dsheap *dh;
+  struct _dsblk *b;
+  VMADDR va;
   int first=TRUE;
   
-  for (dh=pdshDheap;
-       dh;
-       dh=(struct _dsheap *)(pbDs+dh->next))
+  for (va=pdshDheap->first; va < pdshDheap->end; va=BlkNext(b))
   {
-    if (!dh->free)
+    b=Blk(va);
+
+    if (!b->free)
     {
       if (first)
         printf("\n\n");
 
-      printf("heap ofs=%08" UINT32_XFORMAT " (size=%d)\n", (long)((byte *)(dh+1)-pbDs), dh->size);
+      first=FALSE;
+      printf("heap ofs=%08" UINT32_XFORMAT " (size=%d)\n", (long)((byte *)(b+1)-pbDs), (int)b->size);
     }
-
-    if (dh->next==END_HEAP)
-      break;
   }
 }
 #endif
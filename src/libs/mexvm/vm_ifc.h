@@ -59,6 +59,7 @@ struct _mex_vm_state
 {
   /* Code segment */
   INST *pinCs;
+  struct _xinst *pxiCs;
   VMADDR high_cs;
 
   /* Data segment (globals + stack + heap) */
@@ -82,6 +83,8 @@ struct _mex_vm_state
   /* Function definitions */
   struct _funcdef *fdlist;
   struct _usrfunc *usrfn;
+  VMADDR n_usrfn;
+  dword *pdwUsrCalls;
 
   /* Registers */
   byte  regs_1[MAX_REGS];
@@ -92,6 +95,7 @@ struct _mex_vm_state
   /* Debug flags */
   int deb;
   int debheap;
+  struct _vmprof *pvmp;
 
   /* Logger and hooks (static in vm_run.c) */
   void (_stdc *pfnLogger)(char *szStr, ...);
@@ -124,6 +128,9 @@ VMADDR EXPENTRY MexStoreByteStringAt(VMADDR vmaDesc, char *str, int len);
 VMADDR EXPENTRY MexIaddrToVM(IADDR *pia);
 IADDR  EXPENTRY MexStoreHeapByteString(char *str, int len);
 void   EXPENTRY MexRTError(char *szMsg);
+void   EXPENTRY MexCacheStats(dword *pdwHits, dword *pdwMisses);
+void   EXPENTRY MexCacheFlush(void);
+int    EXPENTRY MexSymbolUsed(char *name);
 
 /* VM state save/restore for nested MEX execution */
 void   EXPENTRY MexSaveVmState(struct _mex_vm_state *pState);
@@ -0,0 +1,741 @@
+/*
+ * Maximus Version 3.02
+ * Copyright 1989, 2002 by Lanius Corporation.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*# name=MEX virtual machine - execution profiler (VMF_PROFILE)
+*/
+
+#define COMPILING_MEX_VM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(UNIX)
+#include <sys/time.h>
+#endif
+#include "prog.h"
+#include "bfile.h"
+#include "vm.h"
+
+/* When VMF_PROFILE is set, VmRun() calls ProfStep() before each quad and  *
+ * ProfEnter()/ProfLeave() around each intrinsic.  We keep:                *
+ *                                                                         *
+ *  - an execution count for every quad                                    *
+ *  - a call tree, with the quads executed and the wall time spent in      *
+ *    each node (not counting its children)                                *
+ *  - the calls, and the time including callees, for every function        *
+ *                                                                         *
+ * When the program ends, ProfReport() writes a report to <file>.prf and   *
+ * the call tree to <file>.fld, one "main;foo;bar <usecs>" line per node,  *
+ * which is the "folded stack" format read by flamegraph.pl.  If the       *
+ * program was compiled with "mex -g", the quad counts are also added up   *
+ * by source line.                                                         */
+
+#define PROF_MAX_NODE   65536 /* Deeper call paths are charged to the parent */
+#define PROF_TOP        25    /* Number of lines/quads in the hot spot list */
+
+#define NO_NODE         ((VMADDR)-1L)
+
+struct _pfunc
+{
+  char *name;
+  VMADDR quad;                /* FUNCSTART quad, or the intrinsic's quad */
+  dword n_call;
+  unsigned n_active;          /* Number of calls currently on the stack */
+  uint64_t us_total;          /* Time including callees */
+};
+
+struct _pnode
+{
+  VMADDR func;                /* Index into pf[] */
+  VMADDR parent, child, sibling;
+  uint64_t n_inst;            /* Quads executed in this node */
+  uint64_t us_self;           /* Time spent in this node */
+};
+
+struct _pframe
+{
+  VMADDR node_prev;           /* Node to go back to on return */
+  VMADDR func;
+  uint64_t us_enter;
+};
+
+struct _vmprof
+{
+  char path[PATHLEN];         /* The .vm file, without the extension */
+
+  struct _pfunc *pf;          /* Functions in quad order, then intrinsics */
+  VMADDR n_func;              /* ...number of functions */
+  VMADDR n_pf;                /* ...total, including the "(unknown)" slot */
+
+  uint64_t *pqwHits;          /* Execution count for each quad */
+
+  struct _pnode *pn;          /* Call tree.  pn[0] is the root */
+  VMADDR n_node, n_node_alloc;
+  VMADDR node;                /* Node we're executing in */
+
+  struct _pframe *pfr;        /* Call stack */
+  VMADDR n_frame, n_frame_alloc;
+
+  struct _dline *pdl;         /* Line number table, if any */
+  struct _dlfile *pdlf;
+  VMADDR n_line, n_file;
+
+  uint64_t us_start, us_last;
+};
+
+
+/* Return the time in microseconds */
+
+static uint64_t near ProfNow(void)
+{
+#if defined(UNIX)
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (uint64_t)tv.tv_sec * 1000000u + (uint64_t)tv.tv_usec;
+#else
+  return (uint64_t)clock() * 1000000u / CLOCKS_PER_SEC;
+#endif
+}
+
+
+/* Sort functions by starting quad */
+
+static int _stdc PfuncCmp(const void *p1, const void *p2)
+{
+  VMADDR q1=((const struct _pfunc *)p1)->quad;
+  VMADDR q2=((const struct _pfunc *)p2)->quad;
+
+  return (q1 < q2) ? -1 : (q1 > q2) ? 1 : 0;
+}
+
+
+/* Return the index of the function containing quad 'q' */
+
+static VMADDR near ProfFuncAt(struct _vmprof *p, VMADDR q)
+{
+  VMADDR lo=0, hi=p->n_func, mid;
+
+  while (lo < hi)
+  {
+    mid=lo + (hi-lo)/2;
+
+    if (p->pf[mid].quad <= q)
+      lo=mid+1;
+    else hi=mid;
+  }
+
+  return lo ? lo-1 : p->n_pf-1;
+}
+
+
+/* Return the index of the line table entry covering quad 'q' */
+
+static VMADDR near ProfLineAt(struct _vmprof *p, VMADDR q)
+{
+  VMADDR lo=0, hi=p->n_line, mid;
+
+  while (lo < hi)
+  {
+    mid=lo + (hi-lo)/2;
+
+    if (p->pdl[mid].quad <= q)
+      lo=mid+1;
+    else hi=mid;
+  }
+
+  return lo ? lo-1 : NO_NODE;
+}
+
+
+/* Read the line number table from the end of the .vm file, if the        *
+ * compiler wrote one.                                                    */
+
+static void near ProfReadLines(struct _vmprof *p, char *name)
+{
+  struct _dltrail dlt;
+  long cb;
+  VMADDR i;
+  BFILE b;
+
+  if ((b=Bopen(name, BO_RDONLY | BO_BINARY, BSH_DENYNO, 4096))==NULL)
+    return;
+
+  if (Bseek(b, -(long)sizeof dlt, BSEEK_END) < 0 ||
+      Bread(b, (char *)&dlt, sizeof dlt) != sizeof dlt ||
+      memcmp(dlt.id, DL_ID, sizeof dlt.id) != 0 ||
+      dlt.n_line > high_cs || dlt.n_file > 0xffffu)
+  {
+    Bclose(b);
+    return;
+  }
+
+  cb=(long)(sizeof(struct _dline) * dlt.n_line +
+            sizeof(struct _dlfile) * dlt.n_file + sizeof dlt);
+
+  p->pdl=malloc(sizeof(struct _dline) * (dlt.n_line ? dlt.n_line : 1));
+  p->pdlf=malloc(sizeof(struct _dlfile) * (dlt.n_file ? dlt.n_file : 1));
+
+  if (!p->pdl || !p->pdlf || Bseek(b, -cb, BSEEK_END) < 0 ||
+      Bread(b, (char *)p->pdl, sizeof(struct _dline) * dlt.n_line) !=
+        (int)(sizeof(struct _dline) * dlt.n_line) ||
+      Bread(b, (char *)p->pdlf, sizeof(struct _dlfile) * dlt.n_file) !=
+        (int)(sizeof(struct _dlfile) * dlt.n_file))
+  {
+    Bclose(b);
+    return;
+  }
+
+  Bclose(b);
+
+  /* Don't trust a table that doesn't match the code */
+
+  for (i=0; i < dlt.n_line; i++)
+    if (p->pdl[i].file >= dlt.n_file ||
+        (i && p->pdl[i].quad <= p->pdl[i-1].quad))
+      return;
+
+  for (i=0; i < dlt.n_file; i++)
+    p->pdlf[i].name[DL_PATHLEN-1]='\0';
+
+  p->n_line=dlt.n_line;
+  p->n_file=dlt.n_file;
+}
+
+
+/* Free the profiler's data */
+
+void ProfTerm(void)
+{
+  struct _vmprof *p=pvmp;
+
+  if (!p)
+    return;
+
+  if (p->pf)      free(p->pf);
+  if (p->pqwHits) free(p->pqwHits);
+  if (p->pn)      free(p->pn);
+  if (p->pfr)     free(p->pfr);
+  if (p->pdl)     free(p->pdl);
+  if (p->pdlf)    free(p->pdlf);
+
+  free(p);
+  pvmp=NULL;
+}
+
+
+/* Start profiling the program just loaded from 'name'.  Returns FALSE if  *
+ * there isn't enough memory, in which case the program runs unprofiled.  */
+
+int ProfInit(char *name)
+{
+  char temp[PATHLEN];
+  struct _funcdef *fd;
+  struct _vmprof *p;
+  struct stat st;
+  VMADDR i;
+  char *dot;
+
+  if ((p=pvmp=calloc(1, sizeof *p))==NULL)
+    return FALSE;
+
+  for (fd=fdlist; fd; fd=fd->next)
+    if (fd->quad < high_cs)
+      p->n_func++;
+
+  p->n_pf=p->n_func + n_usrfn + 1;
+  p->n_node_alloc=256;
+  p->n_frame_alloc=64;
+
+  if ((p->pf=calloc(p->n_pf, sizeof(struct _pfunc)))==NULL ||
+      (p->pqwHits=calloc(high_cs ? high_cs : 1, sizeof(uint64_t)))==NULL ||
+      (p->pn=malloc(sizeof(struct _pnode) * p->n_node_alloc))==NULL ||
+      (p->pfr=malloc(sizeof(struct _pframe) * p->n_frame_alloc))==NULL)
+  {
+    ProfTerm();
+    return FALSE;
+  }
+
+  for (fd=fdlist, i=0; fd; fd=fd->next)
+    if (fd->quad < high_cs)
+    {
+      p->pf[i].name=fd->name;
+      p->pf[i++].quad=fd->quad;
+    }
+
+  qsort(p->pf, p->n_func, sizeof(struct _pfunc), PfuncCmp);
+
+  for (i=0; i < n_usrfn; i++)
+  {
+    p->pf[p->n_func+i].name=usrfn[i].name;
+    p->pf[p->n_func+i].quad=usrfn[i].quad;
+  }
+
+  p->pf[p->n_pf-1].name="(unknown)";
+
+  /* The root of the call tree is the VM itself */
+
+  p->pn[0].func=NO_NODE;
+  p->pn[0].parent=p->pn[0].child=p->pn[0].sibling=NO_NODE;
+  p->pn[0].n_inst=p->pn[0].us_self=0;
+  p->n_node=1;
+  p->node=0;
+
+  /* Find the file the same way that VmRead() did */
+
+  strnncpy(temp, name, PATHLEN-3);
+
+  if (stat(temp, &st) != 0)
+    strcat(temp, ".vm");
+
+  ProfReadLines(p, temp);
+
+  if ((dot=strrchr(temp, '.')) != NULL && eqstri(dot, ".vm"))
+    *dot='\0';
+
+  strnncpy(p->path, temp, PATHLEN-4);
+
+  p->us_start=p->us_last=ProfNow();
+  return TRUE;
+}
+
+
+/* Find or add the child of 'parent' for function 'func' */
+
+static VMADDR near ProfChild(struct _vmprof *p, VMADDR parent, VMADDR func)
+{
+  struct _pnode *pn;
+  VMADDR n;
+
+  for (n=p->pn[parent].child; n != NO_NODE; n=p->pn[n].sibling)
+    if (p->pn[n].func==func)
+      return n;
+
+  if (p->n_node==p->n_node_alloc)
+  {
+    if (p->n_node_alloc >= PROF_MAX_NODE ||
+        (pn=realloc(p->pn, sizeof(struct _pnode) * p->n_node_alloc*2))==NULL)
+    {
+      return parent;
+    }
+
+    p->pn=pn;
+    p->n_node_alloc *= 2;
+  }
+
+  n=p->n_node++;
+  pn=p->pn + n;
+
+  pn->func=func;
+  pn->parent=parent;
+  pn->child=NO_NODE;
+  pn->sibling=p->pn[parent].child;
+  pn->n_inst=pn->us_self=0;
+  p->pn[parent].child=n;
+
+  return n;
+}
+
+
+/* Charge the time since the last call to the current node */
+
+static uint64_t near ProfTick(struct _vmprof *p)
+{
+  uint64_t now=ProfNow();
+
+  p->pn[p->node].us_self += now - p->us_last;
+  p->us_last=now;
+
+  return now;
+}
+
+
+/* Enter function 'func' (an index into pf[]) */
+
+void ProfEnter(VMADDR func)
+{
+  struct _vmprof *p=pvmp;
+  struct _pframe *pfr;
+
+  if (p->n_frame==p->n_frame_alloc)
+  {
+    if ((pfr=realloc(p->pfr, sizeof(struct _pframe) *
+                             p->n_frame_alloc*2))==NULL)
+      vm_err("Out of memory for profiling");
+
+    p->pfr=pfr;
+    p->n_frame_alloc *= 2;
+  }
+
+  pfr=p->pfr + p->n_frame++;
+
+  pfr->us_enter=ProfTick(p);
+  pfr->node_prev=p->node;
+  pfr->func=func;
+
+  p->node=ProfChild(p, p->node, func);
+  p->pf[func].n_call++;
+  p->pf[func].n_active++;
+}
+
+
+/* Leave the function entered most recently */
+
+void ProfLeave(void)
+{
+  struct _vmprof *p=pvmp;
+  struct _pframe *pfr;
+  uint64_t now;
+
+  if (!p->n_frame)
+    return;
+
+  now=ProfTick(p);
+  pfr=p->pfr + --p->n_frame;
+
+  /* Only the outermost call of a recursive function counts */
+
+  if (--p->pf[pfr->func].n_active==0)
+    p->pf[pfr->func].us_total += now - pfr->us_enter;
+
+  p->node=pfr->node_prev;
+}
+
+
+/* Enter intrinsic number 'iuf' */
+
+void ProfEnterIntrinsic(VMADDR iuf)
+{
+  ProfEnter(pvmp->n_func + iuf);
+}
+
+
+/* Count quad 'q', which is about to be executed */
+
+void ProfStep(VMADDR q)
+{
+  struct _vmprof *p=pvmp;
+  QUADOP op=pinCs[q].opcode;
+
+  if (op==QOP_FUNCSTART)
+    ProfEnter(ProfFuncAt(p, q));
+
+  p->pqwHits[q]++;
+  p->pn[p->node].n_inst++;
+
+  if (op==QOP_FUNCRET)
+    ProfLeave();
+}
+
+
+
+/*****************************************************************************
+                               The report
+ *****************************************************************************/
+
+struct _pline
+{
+  VMADDR file;
+  dword line;
+  uint64_t hits;
+};
+
+struct _psum
+{
+  VMADDR func;
+  uint64_t n_inst;
+  uint64_t us_self;
+};
+
+static struct _vmprof *pvmpSort;
+
+
+/* Sort functions by descending self time, then by quads executed */
+
+static int _stdc PsumCmp(const void *p1, const void *p2)
+{
+  const struct _psum *s1=p1, *s2=p2;
+
+  if (s1->us_self != s2->us_self)
+    return (s1->us_self < s2->us_self) ? 1 : -1;
+
+  if (s1->n_inst != s2->n_inst)
+    return (s1->n_inst < s2->n_inst) ? 1 : -1;
+
+  return (s1->func < s2->func) ? -1 : (s1->func > s2->func) ? 1 : 0;
+}
+
+
+/* Sort source lines by file and line number */
+
+static int _stdc PlineCmp(const void *p1, const void *p2)
+{
+  const struct _pline *l1=p1, *l2=p2;
+
+  if (l1->file != l2->file)
+    return (l1->file < l2->file) ? -1 : 1;
+
+  return (l1->line < l2->line) ? -1 : (l1->line > l2->line) ? 1 : 0;
+}
+
+
+/* Sort source lines by descending count */
+
+static int _stdc PlineHitCmp(const void *p1, const void *p2)
+{
+  const struct _pline *l1=p1, *l2=p2;
+
+  if (l1->hits != l2->hits)
+    return (l1->hits < l2->hits) ? 1 : -1;
+
+  return PlineCmp(p1, p2);
+}
+
+
+/* Sort quad numbers by descending count */
+
+static int _stdc QuadHitCmp(const void *p1, const void *p2)
+{
+  uint64_t h1=pvmpSort->pqwHits[*(const VMADDR *)p1];
+  uint64_t h2=pvmpSort->pqwHits[*(const VMADDR *)p2];
+
+  if (h1 != h2)
+    return (h1 < h2) ? 1 : -1;
+
+  return (*(const VMADDR *)p1 < *(const VMADDR *)p2) ? -1 : 1;
+}
+
+
+/* Print microseconds as milliseconds */
+
+static char * near UsToMs(uint64_t us, char *buf)
+{
+  sprintf(buf, "%llu.%03u", (unsigned long long)(us / 1000),
+          (unsigned)(us % 1000));
+  return buf;
+}
+
+
+/* Write the hottest source lines, or the hottest quads if the program    *
+ * doesn't have a line number table.                                      */
+
+static void near ProfHotSpots(struct _vmprof *p, FILE *fp)
+{
+  struct _pline *ppl;
+  VMADDR *pva, i, n, q;
+
+  if (p->n_line)
+  {
+    if ((ppl=malloc(sizeof(struct _pline) * p->n_line))==NULL)
+      return;
+
+    for (i=0; i < p->n_line; i++)
+    {
+      ppl[i].file=p->pdl[i].file;
+      ppl[i].line=p->pdl[i].line;
+      ppl[i].hits=0;
+    }
+
+    for (q=0; q < high_cs; q++)
+      if (p->pqwHits[q] && (i=ProfLineAt(p, q)) != NO_NODE)
+        ppl[i].hits += p->pqwHits[q];
+
+    /* The same line may have generated code in several places */
+
+    qsort(ppl, p->n_line, sizeof *ppl, PlineCmp);
+
+    for (i=n=0; i < p->n_line; i++)
+      if (n && ppl[n-1].file==ppl[i].file && ppl[n-1].line==ppl[i].line)
+        ppl[n-1].hits += ppl[i].hits;
+      else ppl[n++]=ppl[i];
+
+    qsort(ppl, n, sizeof *ppl, PlineHitCmp);
+
+    fprintf(fp, "\n%-50s %12s\n", "Hottest lines", "quads");
+
+    for (i=0; i < n && i < PROF_TOP && ppl[i].hits; i++)
+    {
+      char where[DL_PATHLEN+16];
+
+      snprintf(where, sizeof where, "%s:%lu", p->pdlf[ppl[i].file].name,
+               (unsigned long)ppl[i].line);
+
+      fprintf(fp, "  %-48s %12llu\n", where, (unsigned long long)ppl[i].hits);
+    }
+
+    free(ppl);
+    return;
+  }
+
+  if ((pva=malloc(sizeof(VMADDR) * (high_cs ? high_cs : 1)))==NULL)
+    return;
+
+  for (q=n=0; q < high_cs; q++)
+    if (p->pqwHits[q])
+      pva[n++]=q;
+
+  pvmpSort=p;
+  qsort(pva, n, sizeof(VMADDR), QuadHitCmp);
+
+  fprintf(fp, "\n%-50s %12s\n",
+          "Hottest quads (compile with \"mex -g\" for lines)", "count");
+
+  for (i=0; i < n && i < PROF_TOP; i++)
+  {
+    char where[MAX_GLOB_LEN+32];
+    struct _pfunc *pf=p->pf + ProfFuncAt(p, pva[i]);
+
+    snprintf(where, sizeof where, "%s+%lu", pf->name,
+             (unsigned long)(pva[i] - pf->quad));
+
+    fprintf(fp, "  %-48s %12llu\n", where,
+            (unsigned long long)p->pqwHits[pva[i]]);
+  }
+
+  free(pva);
+}
+
+
+/* Write one folded stack for each node of the call tree that used time */
+
+static void near ProfFolded(struct _vmprof *p, FILE *fp)
+{
+  VMADDR *pva, n, i, d;
+
+  if ((pva=malloc(sizeof(VMADDR) * p->n_node))==NULL)
+    return;
+
+  for (n=1; n < p->n_node; n++)
+  {
+    if (!p->pn[n].us_self)
+      continue;
+
+    for (d=0, i=n; i && i != NO_NODE; i=p->pn[i].parent)
+      pva[d++]=i;
+
+    while (d--)
+      fprintf(fp, "%s%c", p->pf[p->pn[pva[d]].func].name, d ? ';' : ' ');
+
+    fprintf(fp, "%llu\n", (unsigned long long)p->pn[n].us_self);
+  }
+
+  free(pva);
+}
+
+
+/* Write the profile for the program that just finished */
+
+void ProfReport(void)
+{
+  struct _vmprof *p=pvmp;
+  struct _psum *ps;
+  struct _hpstat hs;
+  uint64_t n_inst=0, us_run;
+  char fname[PATHLEN+8], b1[32], b2[32];
+  VMADDR i;
+  FILE *fp;
+
+  if (!p)
+    return;
+
+  ProfTick(p);
+  us_run=p->us_last - p->us_start;
+
+  if ((ps=calloc(p->n_pf, sizeof(struct _psum)))==NULL)
+    return;
+
+  for (i=0; i < p->n_pf; i++)
+    ps[i].func=i;
+
+  for (i=1; i < p->n_node; i++)
+  {
+    ps[p->pn[i].func].n_inst += p->pn[i].n_inst;
+    ps[p->pn[i].func].us_self += p->pn[i].us_self;
+    n_inst += p->pn[i].n_inst;
+  }
+
+  qsort(ps, p->n_pf, sizeof(struct _psum), PsumCmp);
+
+  snprintf(fname, sizeof fname, "%s.prf", p->path);
+
+  if ((fp=fopen(fname, "w"))==NULL)
+  {
+    (*pfnLogger)("!MEX:  can't write profile '%s'", fname);
+    free(ps);
+    return;
+  }
+
+  fprintf(fp, "MEX profile of %s.vm\n\n", p->path);
+  fprintf(fp, "Run time %s ms, %llu quads executed\n\n", UsToMs(us_run, b1),
+          (unsigned long long)n_inst);
+
+  fprintf(fp, "%-28s %10s %14s %12s %12s\n",
+          "Function", "calls", "quads", "self ms", "total ms");
+
+  for (i=0; i < p->n_pf; i++)
+  {
+    struct _pfunc *pf=p->pf + ps[i].func;
+
+    if (!pf->n_call || ps[i].func >= p->n_func)
+      continue;
+
+    fprintf(fp, "  %-26s %10" UINT32_FORMAT " %14llu %12s %12s\n",
+            pf->name, pf->n_call, (unsigned long long)ps[i].n_inst,
+            UsToMs(ps[i].us_self, b1), UsToMs(pf->us_total, b2));
+  }
+
+  fprintf(fp, "\n%-28s %10s %14s %12s\n", "Intrinsic", "calls", "", "ms");
+
+  for (i=0; i < p->n_pf; i++)
+  {
+    struct _pfunc *pf=p->pf + ps[i].func;
+
+    if (!pf->n_call || ps[i].func < p->n_func)
+      continue;
+
+    fprintf(fp, "  %-26s %10" UINT32_FORMAT " %14s %12s\n",
+            pf->name, pf->n_call, "", UsToMs(pf->us_total, b1));
+  }
+
+  ProfHotSpots(p, fp);
+
+  hpstat(&hs);
+
+  fprintf(fp, "\nHeap: %" UINT32_FORMAT " allocs (%" UINT32_FORMAT
+          " failed), %lu used, %lu peak of %lu\n",
+          hs.n_alloc, hs.n_fail, (unsigned long)hs.cb_used,
+          (unsigned long)hs.cb_peak, (unsigned long)hs.cb_heap);
+
+  fclose(fp);
+  free(ps);
+
+  snprintf(fname, sizeof fname, "%s.fld", p->path);
+
+  if ((fp=fopen(fname, "w")) != NULL)
+  {
+    ProfFolded(p, fp);
+    fclose(fp);
+  }
+
+  (*pfnLogger)("@MEX:  profile written to %s.prf and %s.fld",
+               p->path, p->path);
+}
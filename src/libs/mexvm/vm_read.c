@@ -26,6 +26,8 @@ static char rcs_id[]="$Id: vm_read.c,v 1.4 2005/10/19 10:57:10 paltas Exp $";
 #define COMPILING_MEX_VM
 
 #include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include "prog.h"
 #include "bfile.h"
 #include "vm.h"
@@ -128,6 +130,7 @@ static int VmReadGlobDataRefs(BFILE b)
   VMADDR ofs;
   struct _ipat gpat;
   struct _imp iref;
+  struct _rtsym *rt;
 
   for (ref=vmh.n_imp; ref--; )
   {
@@ -138,6 +141,9 @@ static int VmReadGlobDataRefs(BFILE b)
 
     ofs=MexEnterSymtab(iref.name, iref.size);
 
+    if ((rt=VmFindSymtab((char *)iref.name)) != NULL)
+      rt->n_ref += iref.n_patch;
+
     /* Initialize constant values */
 
     if (iref.init)
@@ -218,12 +224,74 @@ static int VmReadFuncExports(BFILE b)
 
 
 
+/* Find a function in the hash built by FuncHashBuild() */
+
+static struct _funcdef * near FuncHashFind(struct _funcdef **ppfd,
+                                           VMADDR cSlot, char *name)
+{
+  VMADDR slot;
+
+  for (slot=VmHashName(name) & (cSlot-1); ppfd[slot];
+       slot=(slot+1) & (cSlot-1))
+  {
+    if (eqstr(ppfd[slot]->name, name))
+      return ppfd[slot];
+  }
+
+  return NULL;
+}
+
+
+/* Hash the function list (which includes all of the intrinsics), so     *
+ * that the imports can be resolved without scanning the whole list for  *
+ * each one.  If a name appears more than once, the entry nearest the     *
+ * head of the list wins, just as it does for a linear search.            */
+
+static struct _funcdef ** near FuncHashBuild(VMADDR *pcSlot)
+{
+  struct _funcdef **ppfd, *fd;
+  VMADDR cSlot, slot;
+
+  for (fd=fdlist, cSlot=0; fd; fd=fd->next)
+    cSlot++;
+
+  /* Keep the table less than half full */
+
+  for (slot=cSlot, cSlot=16; cSlot < slot*2; cSlot <<= 1)
+    ;
+
+  if ((ppfd=calloc(cSlot, sizeof(struct _funcdef *)))==NULL)
+    return NULL;
+
+  for (fd=fdlist; fd; fd=fd->next)
+    if (!FuncHashFind(ppfd, cSlot, fd->name))
+    {
+      for (slot=VmHashName(fd->name) & (cSlot-1); ppfd[slot];
+           slot=(slot+1) & (cSlot-1))
+        ;
+
+      ppfd[slot]=fd;
+    }
+
+  *pcSlot=cSlot;
+  return ppfd;
+}
+
+
 /* Read in imported function call references and patch the calls */
 
 static int VmReadFuncImports(BFILE b)
 {
+  struct _funcdef **ppfd;
+  VMADDR cSlot;
   int fcall;
 
+  if ((ppfd=FuncHashBuild(&cSlot))==NULL)
+  {
+    NoMem();
+    return -1;
+  }
+
   for (fcall=vmh.n_fcall; fcall--; )
   {
     struct _dfcall dfc;
@@ -235,6 +303,7 @@ static int VmReadFuncImports(BFILE b)
 
     if (Bread(b, (char *)&dfc, sizeof(dfc)) != sizeof(dfc))
     {
+      free(ppfd);
       return -1;
     }
 
@@ -242,30 +311,32 @@ static int VmReadFuncImports(BFILE b)
 
     if (pvma==NULL || Bread(b, (char *)pvma, (unsigned)size) != size)
     {
+      free(ppfd);
       NoMem();
       return -1;
     }
 
-    /* Now scan the linked list of function declarations, and use this      *
-     * to patch the appropriate offset for the appropriate FUNCJUMP quads. */
+    /* Now look up the function declaration, and use this to patch the    *
+     * appropriate offset for the appropriate FUNCJUMP quads.              */
 
-    for (fdl=fdlist; fdl; fdl=fdl->next)
-      if (eqstr(dfc.name, fdl->name))
-      {
-        while (pvma < pvmaOrig+dfc.n_quads)
-          pinCs[*pvma++].res.jump_label=fdl->quad;
+    dfc.name[MAX_GLOB_LEN-1]='\0';
 
-        break;
-      }
+    if ((fdl=FuncHashFind(ppfd, cSlot, dfc.name)) != NULL)
+      while (pvma < pvmaOrig+dfc.n_quads)
+        pinCs[*pvma++].res.jump_label=fdl->quad;
 
     free(pvmaOrig);
 
     /* If the function wasn't found, generate an error */
 
     if (fdl==NULL)
+    {
+      free(ppfd);
       vm_err("Undefined function '%s'", dfc.name);
+    }
   }
 
+  free(ppfd);
   return 0;
 }
 
@@ -302,9 +373,24 @@ int VmRead(char *name)
   #define VM_BUFSIZE  8192
 
   char temp[PATHLEN];
+  struct stat st;
   int ret;
   BFILE b;
   
+  /* If this program was loaded before and hasn't changed since, just     *
+   * copy the image that was saved last time.                             */
+
+  strcpy(temp,name);
+
+  if (stat(temp, &st) != 0)
+    strcat(temp, ".vm");
+
+  if (stat(temp, &st)==0 &&
+      (ret=VmCacheLoad(temp, st.st_mtime, (long)st.st_size)) != 1)
+  {
+    return ret;
+  }
+
   strcpy(temp,name);
   
   if ((b=Bopen(temp, BO_RDONLY | BO_BINARY, BSH_DENYNO, VM_BUFSIZE))==NULL)
@@ -320,6 +406,8 @@ int VmRead(char *name)
   
   if ((ret=VmReadProc(b))==-1)
       (*pfnLogger)("!MEX:  file format error in '%s'", temp);
+  else if (stat(temp, &st)==0)
+    VmCacheStore(temp, st.st_mtime, (long)st.st_size);
   
   Bclose(b);
   return ret;
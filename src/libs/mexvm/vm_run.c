@@ -215,12 +215,14 @@ static int near VmInit(void)
   /* Initialize all of our <shudder> global variables */
 
   pinCs=NULL;
+  pxiCs=NULL;
   pbDs=NULL;
   pbSp=pbBp=NULL;
   pdshDheap=NULL;
   rtsym=NULL;
   fdlist=NULL;
-  vaIp=high_cs=0;
+  pdwUsrCalls=NULL;
+  vaIp=high_cs=n_usrfn=0;
   n_rtsym=256;
   n_entry=0;
 
@@ -230,6 +232,7 @@ static int near VmInit(void)
   memset(regs_6, '\0', sizeof regs_6);
 
   debheap=0;
+  pvmp=NULL;
 
   return 0;
 }
@@ -249,6 +252,12 @@ static int near vm_cleanup(void)
     pinCs=NULL;
   }
 
+  if (pxiCs)
+  {
+    free(pxiCs);
+    pxiCs=NULL;
+  }
+
   /* Free linked list of functions */
 
   for (fd=fdlist; fd; fdnext=fd->next, free(fd), fd=fdnext)
@@ -257,6 +266,14 @@ static int near vm_cleanup(void)
 
   fdlist=NULL;
 
+  if (pdwUsrCalls)
+  {
+    free(pdwUsrCalls);
+    pdwUsrCalls=NULL;
+  }
+
+  ProfTerm();
+
   /* Free the run-time symbol table */
 
   if (rtsym)
@@ -393,6 +410,7 @@ static int near add_intrinsic_functions(unsigned short uscIntrinsic,
   int rc=TRUE;
 
   usrfn=puf;
+  n_usrfn=0;
 
   for (uf=usrfn, i=(VMADDR)-2L; uf < usrfn+uscIntrinsic && uf->name; uf++, i--)
   {
@@ -418,8 +436,16 @@ static int near add_intrinsic_functions(unsigned short uscIntrinsic,
       rc=FALSE;
       break;
     }
+
+    n_usrfn++;
   }
 
+  /* The quad numbers were handed out in table order, so the intrinsic   *
+   * at quad 'q' is simply usrfn[-2-q].  Keep a call counter for each.   */
+
+  if (rc && (pdwUsrCalls=calloc(n_usrfn ? n_usrfn : 1, sizeof(dword)))==NULL)
+    rc=FALSE;
+
 
   if (!rc)
   {
@@ -434,6 +460,7 @@ static int near add_intrinsic_functions(unsigned short uscIntrinsic,
         free(fdef->name);
 
     fdlist=NULL;
+    n_usrfn=0;
   }
 
   return rc;
@@ -441,6 +468,59 @@ static int near add_intrinsic_functions(unsigned short uscIntrinsic,
 
 
 
+/* Sort intrinsics by descending call count */
+
+static int _stdc UsrCallCmp(const void *p1, const void *p2)
+{
+  dword c1=pdwUsrCalls[*(const VMADDR *)p1];
+  dword c2=pdwUsrCalls[*(const VMADDR *)p2];
+
+  return (c1 < c2) ? 1 : (c1 > c2) ? -1 : 0;
+}
+
+
+/* Write the intrinsic call counts to the log, busiest first */
+
+static void near DumpUsrCalls(void)
+{
+  VMADDR *pva, n, i;
+
+  if ((pva=malloc(sizeof(VMADDR) * (n_usrfn ? n_usrfn : 1)))==NULL)
+    return;
+
+  for (n=i=0; i < n_usrfn; i++)
+    if (pdwUsrCalls[i])
+      pva[n++]=i;
+
+  qsort(pva, n, sizeof(VMADDR), UsrCallCmp);
+
+  for (i=0; i < n; i++)
+    (*pfnLogger)("@MEX:  %-28s %10" UINT32_FORMAT " calls",
+                 usrfn[pva[i]].name, pdwUsrCalls[pva[i]]);
+
+  free(pva);
+}
+
+
+
+/* Write the heap statistics to the log.  Fragmentation is the share of   *
+ * the free space which isn't part of the largest free block.             */
+
+static void near DumpHeapStats(void)
+{
+  struct _hpstat hs;
+
+  hpstat(&hs);
+
+  (*pfnLogger)("@MEX:  heap: %" UINT32_FORMAT " allocs (%" UINT32_FORMAT
+               " failed), %lu used, %lu peak of %lu, %lu%% fragmented",
+               hs.n_alloc, hs.n_fail, (unsigned long)hs.cb_used,
+               (unsigned long)hs.cb_peak, (unsigned long)hs.cb_heap,
+               hs.cb_free ? (unsigned long)(100 - hs.cb_largest * 100 /
+                                                  hs.cb_free) : 0UL);
+}
+
+
 /* Push an ASCIIZ string as a pass-by-ref argument for the function */
 /*
 "asdf" - ObjformValue,    val.str=0xZZZZ, indirect=FALSE
@@ -619,14 +699,299 @@ static int near proc_instruction(INST *inst)
 
 
 
+/* Operand kinds for the pre-decoded instruction stream.  The kind says  *
+ * where an operand lives and how wide it is.  XK_NONE means that the     *
+ * value was known at load time and is already in the template _args.     */
+
+#define XK_NONE       0
+#define XK_ABS_B      1   /* Fixed location: global data or a register */
+#define XK_ABS_W      2
+#define XK_ABS_DW     3
+#define XK_ABS_A      4
+#define XK_BP_B       5   /* Offset from the current activation record */
+#define XK_BP_W       6
+#define XK_BP_DW      7
+#define XK_BP_A       8
+#define XK_FETCH_B    9   /* Anything else, which goes through fetch() */
+#define XK_FETCH_W    10
+#define XK_FETCH_DW   11
+#define XK_FETCH_A    12
+
+/* Operand value known at load time */
+
+struct _xval
+{
+  byte b;
+  word w;
+  dword dw;
+  IADDR a;
+};
+
+
+/* Handler for opcodes that don't exist */
+
+static int op_invalid(INST *inst, struct _args *arg)
+{
+  NW(inst);
+  NW(arg);
+  vm_err(err_invalid_opcode);
+  return 0;
+}
+
+
+
+/* Work out how to find the object at 'pia' at run-time.  'width' is one   *
+ * of 0 (byte), 1 (word), 2 (dword) or 3 (address/string).                 */
+
+static byte near XResolve(IADDR *pia, FORM form, int width,
+                          union _xopnd *po)
+{
+  if (!pia->indirect)
+  {
+    switch (pia->segment)
+    {
+      case SEG_AR:
+        po->ofs=pia->offset;
+        return (byte)(XK_BP_B + width);
+
+      case SEG_GLOBAL:
+      case SEG_TEMP:
+        /* Neither the data segment nor the registers move while the    *
+         * program is running, so the address can be resolved now.      */
+
+        po->p=fetch(form, pia);
+        return (byte)(XK_ABS_B + width);
+    }
+  }
+
+  /* Pointers have to be followed at run-time, and bad segments must     *
+   * still cause an error when (and only if) they are executed.          */
+
+  po->ia=*pia;
+  return (byte)(XK_FETCH_B + width);
+}
+
+
+
+/* Translate one operand.  This mirrors the decoding that                  *
+ * proc_instruction() performs every time that it runs an instruction.    */
+
+static byte near XOperand(union _lit_or_addr *pla, int fAddr, int fLit,
+                          int fRaw, FORM form, union _xopnd *po,
+                          struct _xval *pv)
+{
+  IADDR got;
+
+  if (fAddr)
+  {
+    if (!pla->addr.indirect || fRaw)
+    {
+      pv->a=pla->addr;
+      return XK_NONE;
+    }
+
+    got=pla->addr;
+    got.indirect=FALSE;
+
+    return XResolve(&got, FormAddr, 3, po);
+  }
+
+  switch (form)
+  {
+    case FormByte:
+      if (!fLit)
+        return XResolve(&pla->addr, FormByte, 0, po);
+
+      pv->b=pla->litbyte;
+      break;
+
+    case FormWord:
+      if (!fLit)
+        return XResolve(&pla->addr, FormWord, 1, po);
+
+      pv->w=pla->litword;
+      break;
+
+    case FormDword:
+      if (!fLit)
+        return XResolve(&pla->addr, FormDword, 2, po);
+
+      pv->dw=pla->litdword;
+      break;
+
+    case FormString:
+      if (!fLit)
+        return XResolve(&pla->addr, FormString, 3, po);
+
+      pv->a=pla->litstr;
+      break;
+  }
+
+  return XK_NONE;
+}
+
+
+
+/* Translate the code segment into pxiCs.  If there isn't enough memory   *
+ * for the translation, we just run the quads directly.                   */
+
+static void near XlateCode(void)
+{
+  struct _xval v;
+  INST *inst;
+  XINST *xi;
+  FORM opform;
+  int fRaw;
+
+  if ((pxiCs=malloc(sizeof(XINST) * (high_cs ? high_cs : 1)))==NULL)
+    return;
+
+  memset(pxiCs, '\0', sizeof(XINST) * high_cs);
+
+  for (inst=pinCs, xi=pxiCs; inst < pinCs+high_cs; inst++, xi++)
+  {
+    xi->op_proc=(inst->opcode < QOP_QUAD_LAST)
+                  ? opproc[inst->opcode].op_proc : op_invalid;
+
+    if (inst->opcode==QOP_FUNCRET)
+      continue;
+
+    fRaw=(inst->opcode==QOP_ARG_VAL || inst->opcode==QOP_ARG_REF);
+    opform=inst->opform;
+
+    memset(&v, '\0', sizeof v);
+
+    xi->k1=XOperand(&inst->arg1, inst->flag & FLAG_ARG1_ADDR,
+                    inst->flag & FLAG_ARG1_LIT, fRaw, opform, &xi->o1, &v);
+
+    xi->arg.b1=v.b;
+    xi->arg.w1=v.w;
+    xi->arg.dw1=v.dw;
+    xi->arg.a1=v.a;
+
+    if (inst->opcode==QOP_SLVAL || inst->opcode==QOP_SRVAL)
+      opform=FormWord;
+
+    if (fRaw ||
+        inst->opcode==QOP_BYTE2WORD || inst->opcode==QOP_BYTE2DWORD ||
+        inst->opcode==QOP_WORD2BYTE || inst->opcode==QOP_WORD2DWORD ||
+        inst->opcode==QOP_DWORD2BYTE || inst->opcode==QOP_DWORD2WORD)
+    {
+      continue;
+    }
+
+    memset(&v, '\0', sizeof v);
+
+    xi->k2=XOperand(&inst->arg2, inst->flag & FLAG_ARG2_ADDR,
+                    inst->flag & FLAG_ARG2_LIT, FALSE, opform, &xi->o2, &v);
+
+    xi->arg.b2=v.b;
+    xi->arg.w2=v.w;
+    xi->arg.dw2=v.dw;
+    xi->arg.a2=v.a;
+  }
+}
+
+
+
+/* Load operand 'n' of instruction 'xi' into 'arg'.  XLBL() is the entry  *
+ * point for each operand kind and XEND() moves on to the next step.  With *
+ * GNU C, these are labels and computed gotos, so that control threads     *
+ * straight from one step to the next; otherwise, they are the cases of a  *
+ * switch statement.                                                       */
+
+#define XLOAD(n)                                                            \
+  XLBL(n, XK_NONE):     XEND(n);                                            \
+  XLBL(n, XK_ABS_B):    arg.b##n=*(byte *)xi->o##n.p;             XEND(n);  \
+  XLBL(n, XK_ABS_W):    arg.w##n=*(word *)xi->o##n.p;             XEND(n);  \
+  XLBL(n, XK_ABS_DW):   arg.dw##n=*(dword *)xi->o##n.p;           XEND(n);  \
+  XLBL(n, XK_ABS_A):    arg.a##n=*(IADDR *)xi->o##n.p;            XEND(n);  \
+  XLBL(n, XK_BP_B):     arg.b##n=*(byte *)(pbBp+xi->o##n.ofs);    XEND(n);  \
+  XLBL(n, XK_BP_W):     arg.w##n=*(word *)(pbBp+xi->o##n.ofs);    XEND(n);  \
+  XLBL(n, XK_BP_DW):    arg.dw##n=*(dword *)(pbBp+xi->o##n.ofs);  XEND(n);  \
+  XLBL(n, XK_BP_A):     arg.a##n=*(IADDR *)(pbBp+xi->o##n.ofs);   XEND(n);  \
+  XLBL(n, XK_FETCH_B):                                                      \
+    arg.b##n=*(byte *)fetch(FormByte, &xi->o##n.ia);              XEND(n);  \
+  XLBL(n, XK_FETCH_W):                                                      \
+    arg.w##n=*(word *)fetch(FormWord, &xi->o##n.ia);              XEND(n);  \
+  XLBL(n, XK_FETCH_DW):                                                     \
+    arg.dw##n=*(dword *)fetch(FormDword, &xi->o##n.ia);           XEND(n);  \
+  XLBL(n, XK_FETCH_A):                                                      \
+    arg.a##n=*(IADDR *)fetch(FormAddr, &xi->o##n.ia);             XEND(n);
+
+#ifdef __GNUC__
+  #define XLBL(n, k)  x##n##_##k
+  #define XEND(n)     XEND##n
+  #define XEND1       goto *xtab2[xi->k2]
+  #define XEND2       goto xexec
+  #define XTAB(n)     { &&x##n##_XK_NONE,                                   \
+                        &&x##n##_XK_ABS_B, &&x##n##_XK_ABS_W,               \
+                        &&x##n##_XK_ABS_DW, &&x##n##_XK_ABS_A,              \
+                        &&x##n##_XK_BP_B, &&x##n##_XK_BP_W,                 \
+                        &&x##n##_XK_BP_DW, &&x##n##_XK_BP_A,                \
+                        &&x##n##_XK_FETCH_B, &&x##n##_XK_FETCH_W,           \
+                        &&x##n##_XK_FETCH_DW, &&x##n##_XK_FETCH_A }
+#else
+  #define XLBL(n, k)  case k
+  #define XEND(n)     break
+#endif
+
+
+/* Run the pre-decoded code segment until we fall off the end of it */
+
+static void near XRun(void)
+{
+  struct _args arg;
+  INST *inst;
+  XINST *xi;
+
+#ifdef __GNUC__
+  static void *xtab1[]=XTAB(1);
+  static void *xtab2[]=XTAB(2);
+#endif
+
+  while (vaIp < high_cs)
+  {
+    /* vaIp must point past the instruction before it is executed, just  *
+     * as it does for proc_instruction().                                 */
+
+    inst=pinCs + vaIp;
+    xi=pxiCs + vaIp++;
+    arg=xi->arg;
+
+#ifdef __GNUC__
+    goto *xtab1[xi->k1];
+
+    XLOAD(1)
+    XLOAD(2)
+
+xexec:
+#else
+    switch (xi->k1)
+    {
+      XLOAD(1)
+    }
+
+    switch (xi->k2)
+    {
+      XLOAD(2)
+    }
+#endif
+
+    (*xi->op_proc)(inst, &arg);
+  }
+}
+
+
+
 /* Begin execution of the virtual machine.  */
 
-static int near VmRun(char *pszArgs)
+static int near VmRun(char *pszArgs, dword fFlag)
 {
   struct _funcdef *fd;
   struct _usrfunc *uf;
   unsigned pop_size;
-  VMADDR start_addr;
+  VMADDR start_addr, iuf;
 
   /* Initialize instruction pointer to start of program */
 
@@ -658,7 +1023,17 @@ static int near VmRun(char *pszArgs)
 
   do
   {
-    while (vaIp < high_cs)
+    if (pvmp)
+    {
+      while (vaIp < high_cs)
+      {
+        ProfStep(vaIp);
+        proc_instruction(pinCs + vaIp++);
+      }
+    }
+    else if (pxiCs)
+      XRun();
+    else while (vaIp < high_cs)
     {
       #ifdef DEBUGVM
       if (deb)
@@ -676,34 +1051,58 @@ static int near VmRun(char *pszArgs)
       #endif
     }
     
-    for (uf=usrfn; uf->name; uf++)
-      if (vaIp==uf->quad)
-      {
-        Push(pbBp, byte *);
+    /* Intrinsic n lives at quad -2-n (see add_intrinsic_functions), so   *
+     * the return address of -1 maps to an out-of-range index.            */
 
-        pbBp=pbSp;
+    iuf=(VMADDR)-2L - vaIp;
 
-        if (pfnHookBefore)
-          (*pfnHookBefore)();
+    if (iuf < n_usrfn)
+    {
+      uf=usrfn + iuf;
+      pdwUsrCalls[iuf]++;
 
-        pop_size=(*uf->fn)();
+      Push(pbBp, byte *);
 
-        if (pfnHookAfter)
-          (*pfnHookAfter)();
+      pbBp=pbSp;
 
-        Pop(pbBp, byte *);
-        Pop(vaIp, VMADDR);
+      if (pvmp)
+        ProfEnterIntrinsic(iuf);
 
-        pbSp += pop_size;
+      if (pfnHookBefore)
+        (*pfnHookBefore)();
 
-        break;
-      }
-      
-    if (uf->name==NULL && vaIp != (VMADDR)-1L)
+      pop_size=(*uf->fn)();
+
+      if (pfnHookAfter)
+        (*pfnHookAfter)();
+
+      if (pvmp)
+        ProfLeave();
+
+      Pop(pbBp, byte *);
+      Pop(vaIp, VMADDR);
+
+      pbSp += pop_size;
+    }
+    else if (vaIp != (VMADDR)-1L)
       vm_err("abnormal program termination");
   }
   while (vaIp != (VMADDR)-1L);
 
+  if (fFlag & VMF_PROFILE)
+  {
+    dword dwHits, dwMisses;
+
+    DumpUsrCalls();
+
+    MexCacheStats(&dwHits, &dwMisses);
+    (*pfnLogger)("@MEX:  image cache: %" UINT32_FORMAT " hits, %"
+                 UINT32_FORMAT " misses", dwHits, dwMisses);
+
+    DumpHeapStats();
+    ProfReport();
+  }
+
   #ifdef DEBUGVM
     if (debheap)
       hpdbug();
@@ -764,13 +1163,23 @@ int EXPENTRY MexExecute(char *pszFile, char *pszArgs, dword fFlag,
       }
       else
       {
+        /* Pre-decode the instructions, unless we need to trace them.    *
+         * The profiler counts each quad, so it runs them directly too.  */
+
+        if ((fFlag & VMF_PROFILE) && !ProfInit(pszFile))
+          (*pfnLogger)("!MEX:  not enough memory to profile '%s'", pszFile);
+
+        if (!deb && !pvmp && (fFlag & VMF_NOXLATE)==0)
+          XlateCode();
+
+
         /* If we have a user-defined initialization or set-up function,
          * call it now.
          */
 
         if (!pfnSetup || (ret=(*pfnSetup)())==0)
         {
-          ret=VmRun(pszArgs);
+          ret=VmRun(pszArgs, fFlag);
 
           if (pfnTerm)
             (*pfnTerm)(&ret);
@@ -803,6 +1212,7 @@ void EXPENTRY MexSaveVmState(struct _mex_vm_state *s)
 {
 /* Code segment */
 s->pinCs   = pinCs;
+s->pxiCs   = pxiCs;
 s->high_cs = high_cs;
 
 /* Data segment */
@@ -826,6 +1236,8 @@ s->vaIp = vaIp;
 /* Function list and intrinsic table pointer */
 s->fdlist = fdlist;
 s->usrfn  = usrfn;
+s->n_usrfn = n_usrfn;
+s->pdwUsrCalls = pdwUsrCalls;
 
 /* Registers */
 memcpy(s->regs_1, regs_1, sizeof(regs_1));
@@ -836,6 +1248,7 @@ memcpy(s->regs_6, regs_6, sizeof(regs_6));
 /* Debug flags */
 s->deb     = deb;
 s->debheap = debheap;
+s->pvmp    = pvmp;
 
 /* Logger and hooks (static in this file) */
 s->pfnLogger     = pfnLogger;
@@ -851,6 +1264,7 @@ void EXPENTRY MexRestoreVmState(struct _mex_vm_state *s)
 {
 /* Code segment */
 pinCs   = s->pinCs;
+pxiCs   = s->pxiCs;
 high_cs = s->high_cs;
 
 /* Data segment */
@@ -874,6 +1288,8 @@ vaIp = s->vaIp;
 /* Function list and intrinsic table pointer */
 fdlist = s->fdlist;
 usrfn  = s->usrfn;
+n_usrfn = s->n_usrfn;
+pdwUsrCalls = s->pdwUsrCalls;
 
 /* Registers */
 memcpy(regs_1, s->regs_1, sizeof(regs_1));
@@ -884,6 +1300,7 @@ memcpy(regs_6, s->regs_6, sizeof(regs_6));
 /* Debug flags */
 deb     = s->deb;
 debheap = s->debheap;
+pvmp    = s->pvmp;
 
 /* Logger and hooks */
 pfnLogger     = s->pfnLogger;
@@ -46,6 +46,26 @@ void MexSetLastAssigned(VMADDR val)
 }
 
 
+/* The hash buckets for the symbol table live in the same allocation,     *
+ * just past the last symbol, so that saving 'rtsym' saves both.  There    *
+ * is one bucket for each symbol.                                          */
+
+#define RtsymBucket(h)  (((VMADDR *)(rtsym + n_rtsym))[(h) % n_rtsym])
+
+
+/* Hash a symbol name */
+
+VMADDR VmHashName(char *name)
+{
+  VMADDR h=0;
+
+  while (*name)
+    h=h*31 + (byte)*name++;
+
+  return h;
+}
+
+
 /* Initialize the symbol table */
 
 int init_symtab(int cRtSym)
@@ -53,28 +73,69 @@ int init_symtab(int cRtSym)
   n_rtsym=cRtSym;
   vaLastAssigned=0;
 
-  if ((rtsym=malloc(sizeof(struct _rtsym) * n_rtsym))==NULL)
+  if ((rtsym=malloc((sizeof(struct _rtsym) + sizeof(VMADDR)) * n_rtsym))==NULL)
     return -1;
 
+  memset(rtsym + n_rtsym, 0xff, sizeof(VMADDR) * n_rtsym);
+
   return 0;
 }
 
 
+/* Find a symbol in the run-time symbol table */
+
+static struct _rtsym * near FindSymtab(char *name, VMADDR h)
+{
+  struct _rtsym *rt;
+  VMADDR ent;
+
+  for (ent=RtsymBucket(h); ent != RTSYM_NONE; ent=rt->next)
+  {
+    rt=rtsym + ent;
+
+    if (rt->hash==h && eqstr(rt->name, name))
+      return rt;
+  }
+
+  return NULL;
+}
+
+
+struct _rtsym *VmFindSymtab(char *name)
+{
+  return FindSymtab(name, VmHashName(name));
+}
+
+
+/* Returns TRUE if the loaded program refers to the global 'name'.  This   *
+ * lets the application skip filling in globals that can't be seen.       */
+
+int EXPENTRY MexSymbolUsed(char *name)
+{
+  struct _rtsym *rt=VmFindSymtab(name);
+
+  return (rt && rt->n_ref != 0);
+}
+
+
 /* Enter a symbol in the rum-time symbol table.  If it already exists,      *
  * return its allocated offset.  Otherwise, allocate a                      *
  * new entry in the global table, and return its offset too.                */
 
 VMADDR EXPENTRY MexEnterSymtab(char *name, word size)
 {
-  struct _rtsym *rt, *end;
-  VMADDR thisofs;
+  struct _rtsym *rt;
+  VMADDR thisofs, h=0;
   
-  /* Scan from rtsym[0] .. rtsym[n_entry], and look for this var */
+  /* Look for this var in its hash chain */
   
   if (*name)
-    for (rt=rtsym, end=rtsym+n_entry; rt < end; rt++)
-      if (eqstr(rt->name, name))
-        return rt->offset;
+  {
+    h=VmHashName(name);
+
+    if ((rt=FindSymtab(name, h)) != NULL)
+      return rt->offset;
+  }
   
   /* Not found, so assign a new one */
     
@@ -92,8 +153,15 @@ VMADDR EXPENTRY MexEnterSymtab(char *name, word size)
   if (! *name)
     return thisofs;
   
-  strcpy(rtsym[n_entry].name, name);
-  rtsym[n_entry++].offset=thisofs;
+  rt=rtsym + n_entry;
+
+  strcpy(rt->name, name);
+  rt->offset=thisofs;
+  rt->hash=h;
+  rt->n_ref=0;
+  rt->next=RtsymBucket(h);
+
+  RtsymBucket(h)=n_entry++;
   
   return thisofs;
 }
@@ -0,0 +1,296 @@
+/*
+ * Maximus Version 3.02
+ * Copyright 1989, 2002 by Lanius Corporation.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*# name=Compiled nodelist index (NODELIST.NLX) lookups
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <io.h>
+#include <share.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(UNIX)
+#include <sys/mman.h>
+#endif
+#include "prog.h"
+#include "msgapi.h"
+#include "nlx.h"
+
+/* The index that is currently mapped.  It's kept around between lookups  *
+ * and only remapped when NLCOMP replaces the file underneath us.         */
+
+static NLXMAP nlx;
+static int nlx_open=FALSE;
+
+
+/* Mix the bits of a 32-bit value (MurmurHash3 finalizer) */
+
+static dword near NlxMix(dword h)
+{
+  h ^= h >> 16;
+  h *= 0x85ebca6bL;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35L;
+  h ^= h >> 16;
+
+  return h;
+}
+
+
+/* Hash a node address.  Seed 0 selects the perfect hash bucket; the      *
+ * bucket displacement is then used as the seed to select the slot.       */
+
+dword NlxHash(word zone, word net, word node, word point, dword seed)
+{
+  dword h=NlxMix(seed + 0x9e3779b9L);
+
+  h=NlxMix(h ^ (((dword)zone << 16) | net));
+  h=NlxMix(h ^ (((dword)node << 16) | point));
+
+  return h;
+}
+
+
+/* Make sure that an n-element table of size 'each' lies inside the file */
+
+static int near NlxTableOk(NLXMAP *nm, dword ofs, dword n, dword each)
+{
+  if ((ofs & 3) || ofs > (dword)nm->size)
+    return FALSE;
+
+  return (n <= ((dword)nm->size - ofs) / each);
+}
+
+
+/* Validate a freshly-loaded index and set up the table pointers */
+
+static int near NlxSetup(NLXMAP *nm)
+{
+  struct _nlxhdr *h=(struct _nlxhdr *)nm->base;
+  struct _nlxrec *r;
+  dword i;
+
+  if (nm->size < (long)sizeof(struct _nlxhdr) ||
+      h->id != NLX_ID || h->ver != NLX_VER ||
+      h->rec_size != sizeof(struct _nlxrec))
+    return FALSE;
+
+  if (!NlxTableOk(nm, h->ofs_rec, h->nrec, sizeof(struct _nlxrec)) ||
+      !NlxTableOk(nm, h->ofs_disp, h->nbucket, sizeof(dword)) ||
+      !NlxTableOk(nm, h->ofs_slot, h->nslot, sizeof(dword)) ||
+      !NlxTableOk(nm, h->ofs_name, h->nrec, sizeof(dword)) ||
+      h->cb_str==0 || h->ofs_str > (dword)nm->size ||
+      h->cb_str > (dword)nm->size - h->ofs_str ||
+      (h->nrec && (h->nbucket==0 || h->nslot < h->nrec)))
+    return FALSE;
+
+  nm->hdr=h;
+  nm->rec=(struct _nlxrec *)(nm->base + h->ofs_rec);
+  nm->disp=(dword *)(nm->base + h->ofs_disp);
+  nm->slot=(dword *)(nm->base + h->ofs_slot);
+  nm->name=(dword *)(nm->base + h->ofs_name);
+  nm->str=(char *)nm->base + h->ofs_str;
+
+  /* The string pool must be terminated and every record must point      *
+   * inside it, so that NlxStr() can be used without further checks.    */
+
+  if (nm->str[h->cb_str-1] != '\0')
+    return FALSE;
+
+  for (i=0, r=nm->rec; i < h->nrec; i++, r++)
+    if (r->name >= h->cb_str || r->city >= h->cb_str ||
+        r->sysop >= h->cb_str || r->phone >= h->cb_str ||
+        r->flags >= h->cb_str || nm->name[i] >= h->nrec)
+      return FALSE;
+
+  return TRUE;
+}
+
+
+/* Release the currently-mapped index, if any */
+
+void NlxClose(void)
+{
+  if (!nlx_open)
+    return;
+
+#if defined(UNIX)
+  if (nlx.mapped)
+    munmap(nlx.base, (size_t)nlx.size);
+  else
+#endif
+    free(nlx.base);
+
+  free(nlx.path);
+  memset(&nlx, 0, sizeof nlx);
+  nlx_open=FALSE;
+}
+
+
+/* Load the index from the specified file into nlx */
+
+static int near NlxLoad(char *path, struct stat *st)
+{
+  int fd;
+
+  if (st->st_size < (long)sizeof(struct _nlxhdr))
+    return FALSE;
+
+  if ((fd=shopen(path, O_RDONLY | O_BINARY | O_NOINHERIT))==-1)
+    return FALSE;
+
+  nlx.size=(long)st->st_size;
+  nlx.mtime=st->st_mtime;
+
+#if defined(UNIX)
+  nlx.base=mmap(NULL, (size_t)nlx.size, PROT_READ, MAP_SHARED, fd, 0);
+
+  if (nlx.base != MAP_FAILED)
+    nlx.mapped=TRUE;
+  else
+#endif
+  {
+    /* No shared mapping available, so just read it all in */
+
+    if ((nlx.base=malloc((size_t)nlx.size))==NULL ||
+        read(fd, (char *)nlx.base, (unsigned)nlx.size) != (int)nlx.size)
+    {
+      if (nlx.base)
+        free(nlx.base);
+
+      nlx.base=NULL;
+    }
+  }
+
+  close(fd);
+
+  if (!nlx.base)
+    return FALSE;
+
+  if ((nlx.path=strdup(path))==NULL)
+  {
+    nlx_open=TRUE;
+    NlxClose();
+    return FALSE;
+  }
+
+  nlx_open=TRUE;
+
+  if (!NlxSetup(&nlx))
+  {
+    NlxClose();
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+/* Return the compiled nodelist index in the given nodelist directory,    *
+ * or NULL if there isn't a usable one.  The mapping is cached, so this    *
+ * only costs a stat() unless the index has been recompiled.              */
+
+NLXMAP * NlxOpen(const char *net_info)
+{
+  char path[PATHLEN];
+  struct stat st;
+
+  if (net_info==NULL)
+    return NULL;
+
+  snprintf(path, sizeof path, "%s%s", net_info, NLX_NAME);
+
+  if (stat(path, &st) != 0)
+  {
+    NlxClose();
+    return NULL;
+  }
+
+  if (nlx_open && eqstr(nlx.path, path) && nlx.mtime==st.st_mtime &&
+      nlx.size==(long)st.st_size)
+  {
+    return &nlx;
+  }
+
+  NlxClose();
+
+  return NlxLoad(path, &st) ? &nlx : NULL;
+}
+
+
+/* Find a node by address.  No wildcards are allowed. */
+
+struct _nlxrec * NlxFindAddr(NLXMAP *nm, NETADDR *addr)
+{
+  struct _nlxhdr *h=nm->hdr;
+  struct _nlxrec *r;
+  dword b, rec;
+
+  if (h->nrec==0)
+    return NULL;
+
+  b=NlxHash(addr->zone, addr->net, addr->node, addr->point, 0) % h->nbucket;
+
+  rec=nm->slot[NlxHash(addr->zone, addr->net, addr->node, addr->point,
+                       nm->disp[b]) % h->nslot];
+
+  if (rec >= h->nrec)
+    return NULL;
+
+  r=nm->rec + rec;
+
+  /* The perfect hash only knows about the keys it was built from, so an *
+   * unlisted address lands on some other node's slot.                   */
+
+  if (r->zone != addr->zone || r->net != addr->net ||
+      r->node != addr->node || r->point != addr->point)
+    return NULL;
+
+  return r;
+}
+
+
+/* Find a node by the sysop's name ("First Last", case-insensitive).  If  *
+ * the sysop runs more than one system, the lowest address is returned.   */
+
+struct _nlxrec * NlxFindName(NLXMAP *nm, char *name)
+{
+  dword lo=0, hi=nm->hdr->nrec, mid;
+
+  while (lo < hi)
+  {
+    mid=lo + (hi-lo)/2;
+
+    if (stricmp(NlxStr(nm, nm->rec[nm->name[mid]].sysop), name) < 0)
+      lo=mid+1;
+    else hi=mid;
+  }
+
+  if (lo < nm->hdr->nrec &&
+      eqstri(NlxStr(nm, nm->rec[nm->name[lo]].sysop), name))
+  {
+    return nm->rec + nm->name[lo];
+  }
+
+  return NULL;
+}
+
@@ -0,0 +1,108 @@
+/*
+ * Maximus Version 3.02
+ * Copyright 1989, 2002 by Lanius Corporation.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * Compiled nodelist index (NODELIST.NLX)
+ *
+ * A single flat file built by NLCOMP from raw St. Louis format nodelists
+ * (plus nodediffs).  It is laid out so that it can be mapped into memory
+ * as-is and shared between every process on the system:
+ *
+ *   header | node records | hash displacements | hash slots |
+ *   sysop name index | string pool
+ *
+ * Address lookups go through a minimal "hash and displace" perfect hash,
+ * so they cost two table reads and one record compare.  Sysop lookups
+ * binary search an array of record numbers sorted by name.  All offsets
+ * are relative to the start of the file.  Numbers are stored in the
+ * native byte order of the machine that compiled the index.
+ */
+
+#ifndef __NLX_H_DEFINED
+#define __NLX_H_DEFINED
+
+#ifndef UNIX
+#define NLX_NAME      "NODELIST.NLX"
+#else
+#define NLX_NAME      "nodelist.nlx"
+#endif
+
+#define NLX_ID        0x31584c4eL   /* "NLX1" */
+#define NLX_VER       1
+#define NLX_NOREC     0xffffffffL   /* Empty perfect hash slot */
+
+struct _nlxhdr
+{
+  dword id;           /* NLX_ID                                           */
+  word ver;           /* NLX_VER                                          */
+  word rec_size;      /* sizeof(struct _nlxrec)                           */
+  dword stamp;        /* Time the index was compiled                      */
+  dword nrec;         /* Number of node records                           */
+  dword nbucket;      /* Number of perfect hash buckets                   */
+  dword nslot;        /* Number of perfect hash slots                     */
+  dword ofs_rec;      /* struct _nlxrec[nrec], in nodelist order          */
+  dword ofs_disp;     /* dword[nbucket] bucket displacements              */
+  dword ofs_slot;     /* dword[nslot] record numbers, or NLX_NOREC        */
+  dword ofs_name;     /* dword[nrec] record numbers sorted by sysop name  */
+  dword ofs_str;      /* String pool of nul-terminated strings            */
+  dword cb_str;       /* Size of the string pool                          */
+};
+
+struct _nlxrec
+{
+  word zone, net, node, point;
+  word flag;          /* B_xxx nodelist flags                             */
+  word cost;          /* Cost of sending a message to this node           */
+  word baud;          /* Maximum baud rate from the nodelist              */
+  word rsvd;
+  dword name;         /* String pool offsets of the nodelist fields       */
+  dword city;
+  dword sysop;
+  dword phone;
+  dword flags;
+};
+
+/* A mapped index.  The table pointers all point into the mapping. */
+
+typedef struct _nlxmap
+{
+  char *path;
+  byte *base;
+  long size;
+  time_t mtime;
+  int mapped;
+
+  struct _nlxhdr *hdr;
+  struct _nlxrec *rec;
+  dword *disp;
+  dword *slot;
+  dword *name;
+  char *str;
+} NLXMAP;
+
+#define NlxStr(nm, ofs)   ((nm)->str + (ofs))
+
+dword NlxHash(word zone, word net, word node, word point, dword seed);
+NLXMAP * NlxOpen(const char *net_info);
+void NlxClose(void);
+struct _nlxrec * NlxFindAddr(NLXMAP *nm, NETADDR *addr);
+struct _nlxrec * NlxFindName(NLXMAP *nm, char *name);
+
+#endif /* __NLX_H_DEFINED */
+
@@ -4,6 +4,7 @@
 #include <signal.h>
 #include "dosproc.h"
 #include "compat.h"
+#include "process.h"
 
 unsigned long DosExit(unsigned long ulAction, unsigned long ulResult)
 {
@@ -135,7 +136,7 @@ int spawnlp(int mode, const char *cmdname, const char *arg0, ...)
   }
 
   /* Parent process */
-  if (mode == 0) {  /* P_WAIT */
+  if (mode == P_WAIT) {
     if (waitpid(pid, &status, 0) == -1) {
       return -1;
     }
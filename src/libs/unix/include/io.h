@@ -68,9 +68,10 @@ int sopen(const char *filename, int openMode, int shacc, ...);
 long tell(int fd);
 int fputchar(int c);
 
-/* DOS/OS2 spawn compatibility - P_WAIT means wait for child */
+/* DOS/OS2 spawn compatibility - P_WAIT means wait for child.  It must  *
+ * have the same value as in process.h, since spawnvp() tests for it.    */
 #ifndef P_WAIT
-#define P_WAIT 0
+#define P_WAIT 1
 #endif
 int spawnlp(int mode, const char *cmdname, const char *arg0, ...);
 
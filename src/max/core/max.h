@@ -807,6 +807,14 @@ typedef struct _amenu
 
   word cm_prompt_x;
   word cm_prompt_y;
+
+  /* Option ACS strings, pre-parsed by Read_Menu().  Option i uses terms   *
+   * acs[acs_first[i]] up to acs[acs_first[i+1]].  acs_first lives in the  *
+   * same allocation as acs.  NULL if the menu wasn't compiled.            */
+
+  ACSTERM *acs;
+  word *acs_first;
+  word acs_terms;
 } AMENU, *PAMENU;
 
 
@@ -289,12 +289,35 @@ static void SZKeyMask(char *pszKeys, dword *maskon, dword *maskoff)
   }
 }
 
-static int _PrivOK(char *acstest, unsigned use_real_priv)
+/* Test an "item=value" ACS term.  Modifies acstest. */
+
+static int AcsTextOK(char *acstest)
+{
+  char *equals=strchr(acstest, '=');
+  int len=equals - acstest;
+
+  Strip_Underscore(equals+1);
+
+  if (strnicmp(acstest, "name", len)==0)
+    return eqstri(equals+1, usr.name);
+  else if (strnicmp(acstest, "alias", len)==0)
+    return eqstri(equals+1, usr.alias);
+
+  logit(log_invalid_acs, acstest);
+  return FALSE;
+}
+
+/* Parse one term of an ACS string into *pat.  Returns FALSE (and sets     *
+ * pat->type to ACST_TEXT) if the term is an "item=value" comparison,      *
+ * which has to be tested with AcsTextOK().                                */
+
+static int AcsParseTerm(char *acstest, ACSTERM *pat)
 {
-  int rc;
-  int privop;
   char *equals;
 
+  memset(pat, 0, sizeof *pat);
+  pat->type=ACST_LEVEL;
+
   /* Test for "item=value" comparisons */
 
   equals = strchr(acstest, '=');
@@ -309,77 +332,78 @@ static int _PrivOK(char *acstest, unsigned use_real_priv)
       ;
     else
     {
-      int len = equals - acstest;
-
-      Strip_Underscore(equals+1);
-
-      if (strnicmp(acstest, "name", len)==0)
-      {
-        return eqstri(equals+1, usr.name);
-      }
-      else if (strnicmp(acstest, "alias", len)==0)
-      {
-        return eqstri(equals+1, usr.alias);
-      }
-      else
-      {
-        logit(log_invalid_acs, acstest);
-        return FALSE;
-      }
+      pat->type=ACST_TEXT;
+      return FALSE;
     }
   }
 
-  privop=privGE;    /* Default to >= comparison */
+  pat->privop=privGE;    /* Default to >= comparison */
 
   if (*acstest=='>')
   {
-    privop=privGT;
+    pat->privop=privGT;
     if (*(++acstest)=='=')
     {
-      privop=privGE;
+      pat->privop=privGE;
       ++acstest;
     }
   }
   else if (*acstest=='<')
   {
-    privop=privLT;
+    pat->privop=privLT;
     if (*(++acstest)=='=')
     {
-      privop=privLE;
+      pat->privop=privLE;
       ++acstest;
     }
     else if (*acstest=='>')
     {
-      privop=privNE;
+      pat->privop=privNE;
       ++acstest;
     }
   }
   else if (*acstest=='!')
   {
-    privop=privNE;
+    pat->privop=privNE;
     if (*(++acstest)=='=')  /* Superfluous */
       ++acstest;
   }
   else if (*acstest=='=')
   {
-    privop=privEQ;
+    pat->privop=privEQ;
     if (*(++acstest)=='=')  /* Superfluous */
       ++acstest;
   }
 
   if (*acstest=='@')
   {
-    use_real_priv=TRUE; /* Force use of real priv */
+    pat->real_priv=TRUE; /* Force use of real priv */
     ++acstest;
   }
 
-  rc=TRUE;
   if (*acstest && *acstest != '/')    /* Blank priv, assume ok */
   {
-    word compareto_priv=use_real_priv ? realpriv() : usr.priv;
-    word compare_priv=ClassLevel(acstest);
+    pat->has_level=TRUE;
+    pat->level=ClassLevel(acstest);
+  }
 
-    switch (privop)
+  SZKeyMask(acstest, &pat->maskon, &pat->maskoff);
+  return TRUE;
+}
+
+/* Test a parsed ACST_LEVEL term against the current user */
+
+static int AcsTermOK(ACSTERM *pat, unsigned use_real_priv)
+{
+  int rc=TRUE;
+
+  if (pat->has_level)
+  {
+    word compareto_priv=(use_real_priv || pat->real_priv) ? realpriv()
+                                                          : usr.priv;
+    word compare_priv=pat->level;
+
+    switch (pat->privop)
     {
       default:
       case privGE:  rc=( compareto_priv >= compare_priv ); break;
@@ -394,16 +418,22 @@ static int _PrivOK(char *acstest, unsigned use_real_priv)
     /* Finally, make sure that the keys match okay */
 
   if (rc)
-  {
-    dword maskon, maskoff;
-
-    SZKeyMask(acstest,&maskon,&maskoff);
-    rc=((usr.xkeys & maskon) == maskon) && ((usr.xkeys & maskoff) == 0);
-  }
+    rc=((usr.xkeys & pat->maskon) == pat->maskon) &&
+       ((usr.xkeys & pat->maskoff) == 0);
 
   return rc;
 }
 
+static int _PrivOK(char *acstest, unsigned use_real_priv)
+{
+  ACSTERM at;
+
+  if (!AcsParseTerm(acstest, &at))
+    return AcsTextOK(acstest);
+
+  return AcsTermOK(&at, use_real_priv);
+}
+
 
 /* PrivOK - function used to check an ACS string to see if the current
  * user has enough privileges to be given access to the resource.
@@ -463,6 +493,114 @@ int PrivOK(char *acstest, unsigned use_real_priv)
 }
 
 
+/* Return the number of ACSTERMs that AcsCompile() needs for 'acs' */
+
+int AcsTermCount(char *acs)
+{
+  int n=1;
+
+  while ((acs=strpbrk(acs, ",|&")) != NULL)
+  {
+    n++;
+    acs++;
+  }
+
+  return n;
+}
+
+
+/* Parse an ACS string once, for testing with AcsOK() as often as needed.  *
+ * pat must have room for AcsTermCount(acs) terms.  Class names are        *
+ * resolved here, so this has to be called after the class file is read.   *
+ * Returns the number of terms stored.                                     */
+
+int AcsCompile(char *acs, ACSTERM *pat)
+{
+  char *acsdup;
+  char *next;
+  char *s;
+  int  rel=0;
+  int  n=0;
+
+  if ((acsdup=alloca(strlen(acs)+1))==NULL)
+    return 0;
+
+  strcpy(acsdup,acs);
+
+  /* Split the string exactly as PrivOK() does */
+
+  for (next = acsdup; next; n++)
+  {
+    char *p;
+
+    s = next;
+
+    if ((p=strpbrk(s, ",|&"))==NULL)
+      next = NULL;
+    else
+    {
+      rel=(*p=='|');
+      *p=0;
+      next = p+1;
+    }
+
+    if (!AcsParseTerm(s, pat+n))
+    {
+      pat[n].ofs=(word)(s - acsdup);
+      pat[n].len=(word)strlen(s);
+    }
+
+    pat[n].or_rel=(byte)rel;
+  }
+
+  return n;
+}
+
+
+/* Same as PrivOK(), using the terms which AcsCompile() built from 'acs' */
+
+int AcsOK(char *acs, ACSTERM *pat, int n, unsigned use_real_priv)
+{
+  int rc = TRUE;
+
+  for (; n--; pat++)
+  {
+    int ok;
+
+    if (pat->type==ACST_TEXT)
+    {
+      char *term;
+
+      if ((term=alloca(pat->len+1))==NULL)
+      {
+        logit(log_badnm);
+        return FALSE;
+      }
+
+      memcpy(term, acs + pat->ofs, pat->len);
+      term[pat->len]='\0';
+      ok=AcsTextOK(term);
+    }
+    else ok=AcsTermOK(pat, use_real_priv);
+
+    if (!ok)
+    {
+      rc = FALSE;
+      if (!pat->or_rel)
+        break;
+    }
+    else
+    {
+      rc = TRUE;
+      if (pat->or_rel)
+        break;
+    }
+  }
+
+  return rc;
+}
+
+
 void ClassFlag(int idx, int which, dword fSet, dword fReset)
 {
   if (ValidClassIndex(idx))
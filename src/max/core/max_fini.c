@@ -57,6 +57,7 @@ static char __attribute__((unused)) rcs_id[]="$Id: max_fini.c,v 1.6 2004/06/07 1
 #include "dr.h"
 #include "userapi.h"
 #include "trackm.h"
+#include "mci.h"
 
 #ifndef ORACLE
 
@@ -112,6 +113,21 @@ void FinishUp2(int hangup)
   Restore_Directories3();
   Restore_Directories2();
 
+  {
+    dword dwHits, dwMisses;
+
+    DisplayCacheStats(&dwHits, &dwMisses);
+    logit("@Display file cache: %lu hits, %lu misses",
+          (unsigned long)dwHits, (unsigned long)dwMisses);
+  }
+
+  {
+    unsigned long ulHits, ulMisses;
+
+    MciTemplateStats(&ulHits, &ulMisses);
+    logit("@MCI template cache: %lu hits, %lu misses", ulHits, ulMisses);
+  }
+
   /* Exit the current message and file areas */
 
   while (PopMsgArea())
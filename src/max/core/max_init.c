@@ -67,7 +67,10 @@ static char rcs_id[]="$Id: max_init.c,v 1.7 2004/06/06 21:48:51 paltas Exp $";
 #include "makekey.h"
 #endif
 
-MaxCfg *ng_cfg = NULL;
+MaxCfgToml *ng_cfg = NULL;
+
+/* Compiled copy of everything Read_Cfg() loads; see maxcfg_toml_snapshot_load() */
+#define NGCFG_SNAPSHOT "config/maximus.snap"
 
 static struct
 {
@@ -240,6 +243,258 @@ static bool build_themed_key(const char *key, const char *theme,
     return true;
 }
 
+/*
+ * Config key handles.
+ *
+ * ngcfg_key() interns a dotted TOML path and returns a handle that caches
+ * the value of the key and of its themed variant (see build_themed_key).
+ * The cache is good for as long as ng_cfg's generation number and the
+ * current theme stay the same, so a call site that keeps the handle in a
+ * static reads its value without any string formatting or path parsing.
+ * The ngcfg_get_*() functions use the same table, so every constant key
+ * is only resolved once per configuration change.
+ */
+
+#define NGCFG_KEY_BUCKETS 256     /* Hash buckets for interned keys */
+#define NGCFG_KEY_MAX     2048    /* Keys interned before we stop caching */
+
+struct ngcfg_key
+{
+  struct ngcfg_key *next;         /* Next key in the same bucket */
+  const char *path;               /* Dotted TOML path */
+  unsigned long gen;              /* ng_cfg generation cached, 0 = none */
+  const char *theme;              /* Theme short_name cached for */
+  MaxCfgStatus st_base;           /* Lookup of path */
+  MaxCfgVar base;
+  MaxCfgStatus st_themed;         /* Lookup of the themed key */
+  MaxCfgVar themed;
+};
+
+static struct ngcfg_key *ngcfg_keys[NGCFG_KEY_BUCKETS];
+static int ngcfg_key_count = 0;
+
+/**
+ * @brief Intern a config key path.
+ *
+ * The same path always returns the same handle.  Handles live until the
+ * process exits.
+ *
+ * @param toml_path  Dotted TOML key path
+ * @return Handle, or NULL if toml_path is NULL, memory is short, or the
+ *         table is full.  The ngcfg_key_*() readers accept NULL and
+ *         return their "not found" value.
+ */
+struct ngcfg_key *ngcfg_key(const char *toml_path)
+{
+  struct ngcfg_key *k;
+  unsigned h = 0;
+  size_t len;
+  const char *p;
+
+  if (toml_path == NULL)
+    return NULL;
+
+  for (p = toml_path; *p; p++)
+    h = h * 31u + (unsigned char)*p;
+
+  h %= NGCFG_KEY_BUCKETS;
+
+  for (k = ngcfg_keys[h]; k; k = k->next)
+    if (strcmp(k->path, toml_path) == 0)
+      return k;
+
+  /* Keys built at run time (area names and so on) could grow the table
+   * without bound, so stop somewhere. */
+  if (ngcfg_key_count >= NGCFG_KEY_MAX)
+    return NULL;
+
+  len = strlen(toml_path) + 1;
+
+  if ((k = (struct ngcfg_key *)calloc(1, sizeof(*k) + len)) == NULL)
+    return NULL;
+
+  memcpy(k + 1, toml_path, len);
+  k->path = (const char *)(k + 1);
+  k->next = ngcfg_keys[h];
+  ngcfg_keys[h] = k;
+  ngcfg_key_count++;
+  return k;
+}
+
+/**
+ * @brief Intern a path, or set up an uncached handle in *scratch if the
+ *        key table can't take it.
+ */
+static struct ngcfg_key *ngcfg_key_or_scratch(const char *toml_path,
+                                              struct ngcfg_key *scratch)
+{
+  struct ngcfg_key *k = ngcfg_key(toml_path);
+
+  if (k)
+    return k;
+
+  memset(scratch, 0, sizeof(*scratch));
+  scratch->path = toml_path ? toml_path : "";
+  return scratch;
+}
+
+/**
+ * @brief Bring a handle's cached values up to date with ng_cfg and the
+ *        current theme.
+ */
+static void ngcfg_key_resolve(struct ngcfg_key *k)
+{
+  unsigned long gen = maxcfg_toml_generation(ng_cfg);
+  const char *theme = theme_get_current_shortname();
+  char themed_key[256];
+
+  if (gen != 0 && k->gen == gen && k->theme == theme)
+    return;
+
+  k->gen = gen;
+  k->theme = theme;
+  k->st_base = MAXCFG_ERR_NOT_FOUND;
+  k->st_themed = MAXCFG_ERR_NOT_FOUND;
+
+  if (ng_cfg == NULL)
+    return;
+
+  k->st_base = maxcfg_toml_get(ng_cfg, k->path, &k->base);
+
+  if (theme && *theme &&
+      build_themed_key(k->path, theme, themed_key, sizeof(themed_key)))
+    k->st_themed = maxcfg_toml_get(ng_cfg, themed_key, &k->themed);
+}
+
+/**
+ * @brief Read a key's raw (non-themed) string value.
+ *
+ * @param k  Key handle
+ * @return Pointer to the string value, or "" if not found
+ */
+const char *ngcfg_key_string_raw(struct ngcfg_key *k)
+{
+  if (k == NULL)
+    return "";
+
+  ngcfg_key_resolve(k);
+
+  if (k->st_base == MAXCFG_OK && k->base.type == MAXCFG_VAR_STRING && k->base.v.s)
+    return k->base.v.s;
+
+  return "";
+}
+
+/**
+ * @brief Read a key's string value, preferring the themed variant.
+ *
+ * @param k  Key handle
+ * @return Pointer to the string value, or "" if not found/empty
+ */
+const char *ngcfg_key_string(struct ngcfg_key *k)
+{
+  if (k == NULL)
+    return "";
+
+  ngcfg_key_resolve(k);
+
+  if (k->st_themed == MAXCFG_OK && k->themed.type == MAXCFG_VAR_STRING &&
+      k->themed.v.s && *k->themed.v.s)
+    return k->themed.v.s;
+
+  if (k->st_base == MAXCFG_OK && k->base.type == MAXCFG_VAR_STRING &&
+      k->base.v.s && *k->base.v.s)
+    return k->base.v.s;
+
+  return "";
+}
+
+/**
+ * @brief Read a key's integer value, preferring the themed variant.
+ *
+ * @param k  Key handle
+ * @return Integer value, or 0 if not found
+ */
+int ngcfg_key_int(struct ngcfg_key *k)
+{
+  if (k == NULL)
+    return 0;
+
+  ngcfg_key_resolve(k);
+
+  if (k->st_themed == MAXCFG_OK)
+  {
+    if (k->themed.type == MAXCFG_VAR_INT)
+      return k->themed.v.i;
+    if (k->themed.type == MAXCFG_VAR_UINT)
+      return (int)k->themed.v.u;
+  }
+
+  if (k->st_base == MAXCFG_OK)
+  {
+    if (k->base.type == MAXCFG_VAR_INT)
+      return k->base.v.i;
+    if (k->base.type == MAXCFG_VAR_UINT)
+      return (int)k->base.v.u;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Read a key's boolean value, preferring the themed variant.
+ *
+ * @param k  Key handle
+ * @return 1 if true, 0 if false or not found
+ */
+int ngcfg_key_bool(struct ngcfg_key *k)
+{
+  if (k == NULL)
+    return 0;
+
+  ngcfg_key_resolve(k);
+
+  if (k->st_themed == MAXCFG_OK && k->themed.type == MAXCFG_VAR_BOOL)
+    return k->themed.v.b ? 1 : 0;
+
+  if (k->st_base == MAXCFG_OK && k->base.type == MAXCFG_VAR_BOOL)
+    return k->base.v.b ? 1 : 0;
+
+  return 0;
+}
+
+/**
+ * @brief Read a key's 2-element integer array, preferring the themed variant.
+ *
+ * @param k      Key handle
+ * @param out_a  Output for the first element
+ * @param out_b  Output for the second element
+ * @return 1 on success, 0 if not found or fewer than 2 elements
+ */
+int ngcfg_key_int_array_2(struct ngcfg_key *k, int *out_a, int *out_b)
+{
+  const MaxCfgVar *v = NULL;
+
+  if (k == NULL)
+    return 0;
+
+  ngcfg_key_resolve(k);
+
+  if (k->st_themed == MAXCFG_OK && k->themed.type == MAXCFG_VAR_INT_ARRAY &&
+      k->themed.v.intv.count >= 2)
+    v = &k->themed;
+  else if (k->st_base == MAXCFG_OK && k->base.type == MAXCFG_VAR_INT_ARRAY &&
+           k->base.v.intv.count >= 2)
+    v = &k->base;
+
+  if (v == NULL)
+    return 0;
+
+  if (out_a) *out_a = v->v.intv.items[0];
+  if (out_b) *out_b = v->v.intv.items[1];
+  return 1;
+}
+
 /**
  * @brief Retrieve a raw string value from the TOML configuration.
  *
@@ -248,14 +503,9 @@ static bool build_themed_key(const char *key, const char *theme,
  */
 const char *ngcfg_get_string_raw(const char *toml_path)
 {
-  MaxCfgVar v;
-
-  if (toml_path && ng_cfg &&
-      maxcfg_toml_get(ng_cfg, toml_path, &v) == MAXCFG_OK &&
-      v.type == MAXCFG_VAR_STRING && v.v.s)
-    return v.v.s;
+  struct ngcfg_key scratch;
 
-  return "";
+  return ngcfg_key_string_raw(ngcfg_key_or_scratch(toml_path, &scratch));
 }
 
 /**
@@ -657,42 +907,29 @@ fail:
  */
 const char *ngcfg_get_string(const char *toml_path)
 {
-  const char *theme = theme_get_current_shortname();
-  if (theme && *theme)
-  {
-    char themed_key[256];
-    if (build_themed_key(toml_path, theme, themed_key, sizeof(themed_key)))
-    {
-      const char *result = ngcfg_get_string_raw(themed_key);
-      if (result && *result)
-        return result;
-    }
-  }
+  struct ngcfg_key scratch;
 
-  /* Fall back to base key */
-  const char *s = ngcfg_get_string_raw(toml_path);
-  if (s && *s)
-    return s;
-  return "";
+  return ngcfg_key_string(ngcfg_key_or_scratch(toml_path, &scratch));
 }
 
 /**
- * @brief Retrieve a filesystem path from config, resolving relative paths.
+ * @brief Read a key as a filesystem path, resolving relative paths.
  *
  * Relative paths are joined to maximus.sys_path. Directories get a
  * trailing separator appended automatically.
  *
- * @param toml_path  Dotted TOML key path
+ * @param k  Key handle
  * @return Resolved path string (static buffer — not thread-safe)
  */
-const char *ngcfg_get_path(const char *toml_path)
+const char *ngcfg_key_path(struct ngcfg_key *k)
 {
+  static struct ngcfg_key *sys_path_key = NULL;
   const char *s;
   const char *sys_base;
   static char buf[PATHLEN];
   size_t len;
 
-  s = ngcfg_get_string_raw(toml_path);
+  s = ngcfg_key_string_raw(k);
 
   /* An explicitly empty value means "not configured" — return empty so
    * callers can distinguish it from a missing key.  Only fall back to
@@ -728,7 +965,11 @@ const char *ngcfg_get_path(const char *toml_path)
     return buf;
   }
 
-  sys_base = ngcfg_get_string_raw("maximus.sys_path");
+  if (sys_path_key == NULL)
+    sys_path_key = ngcfg_key("maximus.sys_path");
+
+  sys_base = sys_path_key ? ngcfg_key_string_raw(sys_path_key)
+                          : ngcfg_get_string_raw("maximus.sys_path");
 
   if (*sys_base == '\0')
     return s;
@@ -751,6 +992,19 @@ const char *ngcfg_get_path(const char *toml_path)
   return buf;
 }
 
+/**
+ * @brief Retrieve a filesystem path from config, resolving relative paths.
+ *
+ * @param toml_path  Dotted TOML key path
+ * @return Resolved path string (static buffer — not thread-safe)
+ */
+const char *ngcfg_get_path(const char *toml_path)
+{
+  struct ngcfg_key scratch;
+
+  return ngcfg_key_path(ngcfg_key_or_scratch(toml_path, &scratch));
+}
+
 /**
  * @brief Retrieve an integer value from TOML configuration with theme-aware resolution.
  *
@@ -759,37 +1013,9 @@ const char *ngcfg_get_path(const char *toml_path)
  */
 int ngcfg_get_int(const char *toml_path)
 {
-  MaxCfgVar v;
+  struct ngcfg_key scratch;
 
-  /* Try themed key first */
-  const char *theme = theme_get_current_shortname();
-  if (theme && *theme)
-  {
-    char themed_key[256];
-    if (build_themed_key(toml_path, theme, themed_key, sizeof(themed_key)))
-    {
-      if (themed_key[0] && ng_cfg &&
-          maxcfg_toml_get(ng_cfg, themed_key, &v) == MAXCFG_OK)
-      {
-        if (v.type == MAXCFG_VAR_INT)
-          return v.v.i;
-        if (v.type == MAXCFG_VAR_UINT)
-          return (int)v.v.u;
-      }
-    }
-  }
-
-  /* Fall back to base key */
-  if (toml_path && ng_cfg &&
-      maxcfg_toml_get(ng_cfg, toml_path, &v) == MAXCFG_OK)
-  {
-    if (v.type == MAXCFG_VAR_INT)
-      return v.v.i;
-    if (v.type == MAXCFG_VAR_UINT)
-      return (int)v.v.u;
-  }
-
-  return 0;
+  return ngcfg_key_int(ngcfg_key_or_scratch(toml_path, &scratch));
 }
 
 /**
@@ -800,33 +1026,9 @@ int ngcfg_get_int(const char *toml_path)
  */
 int ngcfg_get_bool(const char *toml_path)
 {
-  MaxCfgVar v;
-
-  /* Try themed key first */
-  const char *theme = theme_get_current_shortname();
-  if (theme && *theme)
-  {
-    char themed_key[256];
-    if (build_themed_key(toml_path, theme, themed_key, sizeof(themed_key)))
-    {
-      if (themed_key[0] && ng_cfg &&
-          maxcfg_toml_get(ng_cfg, themed_key, &v) == MAXCFG_OK &&
-          v.type == MAXCFG_VAR_BOOL)
-      {
-        return v.v.b ? 1 : 0;
-      }
-    }
-  }
-
-  /* Fall back to base key */
-  if (toml_path && ng_cfg &&
-      maxcfg_toml_get(ng_cfg, toml_path, &v) == MAXCFG_OK &&
-      v.type == MAXCFG_VAR_BOOL)
-  {
-    return v.v.b ? 1 : 0;
-  }
+  struct ngcfg_key scratch;
 
-  return 0;
+  return ngcfg_key_bool(ngcfg_key_or_scratch(toml_path, &scratch));
 }
 
 /**
@@ -839,39 +1041,10 @@ int ngcfg_get_bool(const char *toml_path)
  */
 int ngcfg_get_int_array_2(const char *toml_path, int *out_a, int *out_b)
 {
-  MaxCfgVar v;
-
-  /* Try themed key first */
-  const char *theme = theme_get_current_shortname();
-  if (theme && *theme)
-  {
-    char themed_key[256];
-    if (build_themed_key(toml_path, theme, themed_key, sizeof(themed_key)))
-    {
-      if (themed_key[0] && ng_cfg &&
-          maxcfg_toml_get(ng_cfg, themed_key, &v) == MAXCFG_OK &&
-          v.type == MAXCFG_VAR_INT_ARRAY &&
-          v.v.intv.count >= 2)
-      {
-        if (out_a) *out_a = v.v.intv.items[0];
-        if (out_b) *out_b = v.v.intv.items[1];
-        return 1;
-      }
-    }
-  }
+  struct ngcfg_key scratch;
 
-  /* Fall back to base key */
-  if (toml_path && ng_cfg &&
-      maxcfg_toml_get(ng_cfg, toml_path, &v) == MAXCFG_OK &&
-      v.type == MAXCFG_VAR_INT_ARRAY &&
-      v.v.intv.count >= 2)
-  {
-    if (out_a) *out_a = v.v.intv.items[0];
-    if (out_b) *out_b = v.v.intv.items[1];
-    return 1;
-  }
-
-  return 0;
+  return ngcfg_key_int_array_2(ngcfg_key_or_scratch(toml_path, &scratch),
+                               out_a, out_b);
 }
 
 /**
@@ -1752,7 +1925,17 @@ void Read_Cfg(void)
 
   if (ng_cfg == NULL)
   {
-    if (maxcfg_toml_init(&ng_cfg) == MAXCFG_OK)
+    int from_snapshot = FALSE;
+
+    if (maxcfg_toml_init(&ng_cfg) == MAXCFG_OK &&
+        maxcfg_toml_snapshot_load(ng_cfg, NGCFG_SNAPSHOT) == MAXCFG_OK)
+    {
+#ifndef ORACLE
+      startup_logit(": Read_Cfg: using " NGCFG_SNAPSHOT);
+#endif
+      from_snapshot = TRUE;
+    }
+    else if (ng_cfg)
     {
       (void)maxcfg_toml_load_file(ng_cfg, "config/maximus", "maximus");
       (void)maxcfg_toml_load_file(ng_cfg, "config/general/session", "general.session");
@@ -1770,14 +1953,23 @@ void Read_Cfg(void)
       (void)maxcfg_toml_load_file(ng_cfg, "config/areas/file/areas", "areas.file");
       (void)maxcfg_toml_load_file(ng_cfg, "config/matrix", "matrix");
 
+      /* Adding or removing a menu changes the directory's mtime */
+      (void)maxcfg_toml_add_dependency(ng_cfg, "config/menus");
       load_menu_tomls();
     }
 
     /* Initialize theme registry after all config is loaded */
     theme_registry_init();
 
-    /* Load per-theme config namespace overlays */
-    load_themed_config_files();
+    /* Load per-theme config namespace overlays (already in a snapshot),
+     * then save the result so that the next node can map it instead. */
+    if (!from_snapshot)
+    {
+      load_themed_config_files();
+
+      if (ng_cfg)
+        (void)maxcfg_toml_snapshot_write(ng_cfg, NGCFG_SNAPSHOT);
+    }
   }
 
   /* Now figure out which main menu to display */
@@ -1387,6 +1387,15 @@ static int near OverridePrivOkay(struct _amenu *menu, struct _opt *popt,
     }
   }
 
+  if (menu->acs && popt >= menu->opt &&
+      popt < menu->opt + menu->m.num_options)
+  {
+    word *first=menu->acs_first + (popt - menu->opt);
+
+    return AcsOK(menu->menuheap + popt->priv, menu->acs + first[0],
+                 first[1] - first[0], FALSE);
+  }
+
   return PrivOK(menu->menuheap + popt->priv, FALSE);
 }
 
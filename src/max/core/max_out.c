@@ -125,7 +125,7 @@ static const char *MciMaybeExpandString(const char *s)
     cbMciString=need;
   }
 
-  MciExpand(s, szMciString, cbMciString);
+  MciExpandCached(s, szMciString, cbMciString);
   return szMciString;
 }
 
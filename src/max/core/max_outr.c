@@ -679,6 +679,8 @@ void Mdm_putc(int ch)
           if (usr.video)
             display_line=display_col=current_line=current_col=1;
 
+          screen_clears++;
+
           if (usr.video==GRAPH_ANSI)
             CMDM_PPUTs(ansi_cls);
           else CMDM_PPUTcw('\x0c');
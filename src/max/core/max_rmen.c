@@ -46,6 +46,8 @@ static char rcs_id[]="$Id: max_rmen.c,v 1.4 2004/01/28 06:38:10 paltas Exp $";
 #include "max_msg.h"
 
 static int near Read_Menu_Toml(struct _amenu *menu, const char *mname);
+static int near Compile_Menu_Toml(struct _amenu *menu, const char *path, size_t *pheap);
+static void near Compile_Menu_Acs(struct _amenu *menu);
 static int near mnu_cmd_to_opt(const char *cmd, option *out);
 static int near mnu_heap_add(char **pp, char *base, size_t cap, const char *s, zstr *out);
 static void near mnu_apply_modifiers(MaxCfgStrView mods, word *pflag, byte *pareatype);
@@ -55,6 +57,28 @@ static word near mnu_menu_flag_from_types(MaxCfgStrView types, int kind);
 #define MENU_TYPE_FOOTER 1
 #define MENU_TYPE_BODY   2
 
+/* Menus defined in the TOML configuration are compiled into the same      *
+ * structure that a .mnu file is read into: command names are mapped to    *
+ * option codes, modifiers to flags, the strings are packed into the heap  *
+ * and the option ACS strings are pre-parsed.  A caller moves between the  *
+ * same few menus all session, so each compiled menu is kept here and      *
+ * later reads only copy it.  An entry is only good for the generation of  *
+ * ng_cfg that it was built from.                                          */
+
+#define MNU_CACHE_MAX 32      /* Max number of compiled menus to keep */
+
+struct _mnucache
+{
+  char *name;                 /* Key: lower-case menu name */
+  unsigned long gen;          /* ...and ng_cfg generation */
+  dword last_use;             /* For discarding the least recently used */
+  size_t heap_size;           /* Bytes in am.menuheap */
+  AMENU am;                   /* Compiled menu */
+};
+
+static struct _mnucache mnuc[MNU_CACHE_MAX];
+static dword dwMnuUse=0;
+
 /**
  * @brief Count the number of visible menu options and set menu_lines.
  *
@@ -187,12 +211,184 @@ sword Read_Menu(struct _amenu *menu, char *mname)
 
   close(menufile);
 
+  Compile_Menu_Acs(menu);
   CountMenuLines(menu, mname);
 
   return 0;
 }
 
 
+/**
+ * @brief Pre-parse the ACS string of every option in a menu.
+ *
+ * Leaves menu->acs NULL if memory is short; OptionOkay() then parses
+ * the strings as it goes.
+ *
+ * @param menu  Menu with opt and menuheap loaded
+ */
+static void near Compile_Menu_Acs(struct _amenu *menu)
+{
+  word n=menu->m.num_options;
+  word i;
+  int terms=0;
+
+  menu->acs=NULL;
+  menu->acs_first=NULL;
+  menu->acs_terms=0;
+
+  for (i=0; i < n; i++)
+    terms += AcsTermCount(menu->menuheap + menu->opt[i].priv);
+
+  if (terms > 0xffff ||
+      (menu->acs=malloc(sizeof(ACSTERM) * terms +
+                        sizeof(word) * (n+1)))==NULL)
+    return;
+
+  menu->acs_first=(word *)(menu->acs + terms);
+  menu->acs_terms=(word)terms;
+
+  for (i=0, terms=0; i < n; i++)
+  {
+    menu->acs_first[i]=(word)terms;
+    terms += AcsCompile(menu->menuheap + menu->opt[i].priv,
+                        menu->acs + terms);
+  }
+
+  menu->acs_first[n]=(word)terms;
+}
+
+
+/**
+ * @brief Make a private copy of a menu.
+ *
+ * @param to         Output menu structure
+ * @param from       Menu to copy
+ * @param heap_size  Number of bytes in from->menuheap
+ * @return 0 on success, -1 if out of memory
+ */
+static int near Copy_Menu(struct _amenu *to, struct _amenu *from, size_t heap_size)
+{
+  size_t opt_size=sizeof(struct _opt) * from->m.num_options;
+  size_t acs_size=sizeof(ACSTERM) * from->acs_terms +
+                  sizeof(word) * (from->m.num_options+1);
+
+  *to=*from;
+  to->opt=NULL;
+  to->menuheap=NULL;
+  to->acs=NULL;
+  to->acs_first=NULL;
+
+  if ((from->opt && (to->opt=malloc(opt_size ? opt_size : 1))==NULL) ||
+      (to->menuheap=malloc(heap_size))==NULL ||
+      (from->acs && (to->acs=malloc(acs_size))==NULL))
+  {
+    logit(mem_none);
+    Free_Menu(to);
+    return -1;
+  }
+
+  if (from->opt)
+    memcpy(to->opt, from->opt, opt_size);
+
+  memcpy(to->menuheap, from->menuheap, heap_size);
+
+  if (from->acs)
+  {
+    memcpy(to->acs, from->acs, acs_size);
+    to->acs_first=(word *)(to->acs + to->acs_terms);
+  }
+
+  return 0;
+}
+
+
+/**
+ * @brief Release one menu cache entry.
+ */
+static void near MenuCacheFree(struct _mnucache *pmc)
+{
+  if (pmc->name)
+    free(pmc->name);
+
+  Free_Menu(&pmc->am);
+  memset(pmc, 0, sizeof *pmc);
+}
+
+
+/**
+ * @brief Find the compiled copy of a menu.
+ *
+ * @param name  Lower-case menu name
+ * @param gen   Current ng_cfg generation
+ * @return Cache entry, or NULL if the menu isn't cached for this generation
+ */
+static struct _mnucache * near MenuCacheFind(const char *name, unsigned long gen)
+{
+  struct _mnucache *pmc;
+
+  for (pmc=mnuc; pmc < mnuc+MNU_CACHE_MAX; pmc++)
+    if (pmc->name && strcmp(pmc->name, name)==0)
+    {
+      /* Throw it away if the configuration has changed since */
+
+      if (pmc->gen != gen)
+      {
+        MenuCacheFree(pmc);
+        return NULL;
+      }
+
+      pmc->last_use=++dwMnuUse;
+      return pmc;
+    }
+
+  return NULL;
+}
+
+
+/**
+ * @brief Save a copy of a menu that was just compiled.
+ *
+ * @param name       Lower-case menu name
+ * @param gen        ng_cfg generation the menu was compiled from
+ * @param menu       Compiled menu
+ * @param heap_size  Number of bytes in menu->menuheap
+ */
+static void near MenuCacheStore(const char *name, unsigned long gen,
+                                struct _amenu *menu, size_t heap_size)
+{
+  struct _mnucache *pmc, *pmcOld;
+
+  /* Use an empty slot, or else the one which was used longest ago */
+
+  for (pmc=pmcOld=mnuc; pmc < mnuc+MNU_CACHE_MAX; pmc++)
+  {
+    if (pmc->name && strcmp(pmc->name, name)==0)
+      break;
+
+    if (!pmc->name || (pmcOld->name && pmc->last_use < pmcOld->last_use))
+      pmcOld=pmc;
+  }
+
+  if (pmc==mnuc+MNU_CACHE_MAX)
+    pmc=pmcOld;
+
+  MenuCacheFree(pmc);
+
+  if ((pmc->name=strdup(name))==NULL)
+    return;
+
+  if (Copy_Menu(&pmc->am, menu, heap_size) != 0)
+  {
+    MenuCacheFree(pmc);
+    return;
+  }
+
+  pmc->gen=gen;
+  pmc->heap_size=heap_size;
+  pmc->last_use=++dwMnuUse;
+}
+
+
 /**
  * @brief Map a command string token to a menu option enum value.
  *
@@ -533,18 +729,77 @@ static word near mnu_menu_flag_from_types(MaxCfgStrView types, int kind)
 /**
  * @brief Load a menu definition from the TOML configuration tree.
  *
+ * The compiled menu is cached; see MNU_CACHE_MAX.
+ *
  * @param menu   Output menu structure to populate
  * @param mname  Menu name (matched case-insensitively under menus.*)
  * @return 0 on success, -2 if not found, -1 on error
  */
 static int near Read_Menu_Toml(struct _amenu *menu, const char *mname)
 {
-  MaxCfgNgMenu ng;
-  size_t opt_count;
+  struct _mnucache *pmc;
+  unsigned long gen;
+  size_t heap_size;
   size_t i;
   char path[128];
   char lower[96];
   size_t n;
+  int rc;
+
+  if (menu == NULL || mname == NULL || *mname == '\0')
+    return -2;
+  if (ng_cfg == NULL)
+    return -2;
+
+  n = strlen(mname);
+  if (n == 0 || n >= sizeof(lower))
+    return -2;
+
+  for (i = 0; i < n; i++)
+  {
+    unsigned char c = (unsigned char)mname[i];
+    if (c >= 'A' && c <= 'Z')
+      lower[i] = (char)(c - 'A' + 'a');
+    else
+      lower[i] = (char)c;
+  }
+  lower[n] = '\0';
+
+  gen = maxcfg_toml_generation(ng_cfg);
+
+  if ((pmc = MenuCacheFind(lower, gen)) != NULL)
+    return Copy_Menu(menu, &pmc->am, pmc->heap_size);
+
+  if (snprintf(path, sizeof(path), "menus.%s", lower) >= (int)sizeof(path))
+    return -2;
+
+  if ((rc = Compile_Menu_Toml(menu, path, &heap_size)) != 0)
+    return rc;
+
+  Compile_Menu_Acs(menu);
+
+  /* A store without a generation number can't be cached against */
+
+  if (gen != 0)
+    MenuCacheStore(lower, gen, menu, heap_size);
+
+  return 0;
+}
+
+
+/**
+ * @brief Build a menu structure from one menus.* table.
+ *
+ * @param menu   Output menu structure to populate
+ * @param path   Dotted path of the menu table (e.g. "menus.main")
+ * @param pheap  Output: number of bytes in menu->menuheap
+ * @return 0 on success, -2 if not found, -1 on error
+ */
+static int near Compile_Menu_Toml(struct _amenu *menu, const char *path, size_t *pheap)
+{
+  MaxCfgNgMenu ng;
+  size_t opt_count;
+  size_t i;
   const char *title = "";
   const char *header_file = "";
   const char *footer_file = "";
@@ -587,28 +842,6 @@ static int near Read_Menu_Toml(struct _amenu *menu, const char *mname)
   menu->cm_prompt_x = 0;
   menu->cm_prompt_y = 0;
 
-  if (menu == NULL || mname == NULL || *mname == '\0')
-    return -2;
-  if (ng_cfg == NULL)
-    return -2;
-
-  n = strlen(mname);
-  if (n == 0 || n >= sizeof(lower))
-    return -2;
-
-  for (i = 0; i < n; i++)
-  {
-    unsigned char c = (unsigned char)mname[i];
-    if (c >= 'A' && c <= 'Z')
-      lower[i] = (char)(c - 'A' + 'a');
-    else
-      lower[i] = (char)c;
-  }
-  lower[n] = '\0';
-
-  if (snprintf(path, sizeof(path), "menus.%s", lower) >= (int)sizeof(path))
-    return -2;
-
   if (maxcfg_ng_menu_init(&ng) != MAXCFG_OK)
     return -2;
   if (maxcfg_ng_get_menu(ng_cfg, path, &ng) != MAXCFG_OK)
@@ -741,6 +974,7 @@ static int near Read_Menu_Toml(struct _amenu *menu, const char *mname)
   if (menu->menuheap == NULL)
     goto fail;
   memset(menu->menuheap, 0, heap_cap);
+  *pheap = heap_cap;
 
   hp = menu->menuheap;
   *hp++ = '\0';
@@ -839,6 +1073,9 @@ void Free_Menu(struct _amenu *menu)
   if (menu->opt)
     free(menu->opt);
 
+  if (menu->acs)
+    free(menu->acs);
+
   Initialize_Menu(menu);
 }
 
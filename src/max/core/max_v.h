@@ -458,6 +458,7 @@ extrn unsigned char display_line;       /* # of lines since last More[Y,n] */
 extrn unsigned char display_col;        /* Column# since last More[Y,n]    */
 extrn unsigned char current_line;       /* Actual line of screen we're on  */
 extrn unsigned char current_col;        /* Actual col of screen we're on   */
+extrn word screen_clears;               /* # of clear-screens sent         */
 
 extrn struct _maxcol col;               /* Max colour information          */
 extrn int last_protocol;                /* Last protocol download          */
@@ -37,6 +37,7 @@ static char rcs_id[]="$Id: node.c,v 1.4 2004/01/28 06:38:11 paltas Exp $";
 #include "cfg_consts.h"
 #include "mm.h"
 #include "node.h"
+#include "nlx.h"
 #include "fdnode.h"
 
 
@@ -47,6 +48,8 @@ int phcomp(void *s1, void *r2);
 static int near V56FindOpen(NFIND *nf);
 static NFIND * near V7FindOpen(NFIND *nf);
 static NFIND * near FDFindOpen(NFIND *nf);
+static NFIND * near NlxFindOpen(NFIND *nf, NLXMAP *nm);
+static int near NlxFindNext(NFIND *nf);
 static word near FDCostOf(int fdafd, word rec_num);
 static word near FDLookUpCost(struct _johofile *jf, struct _johonode *jn);
 
@@ -58,6 +61,7 @@ static word near FDLookUpCost(struct _johofile *jf, struct _johonode *jn);
 NFIND * NodeFindOpen(NETADDR *find)
 {
   NFIND *nf;
+  NLXMAP *nm;
   int nlver;
   
   if ((nf=malloc(sizeof(NFIND)))==NULL)
@@ -67,6 +71,12 @@ NFIND * NodeFindOpen(NETADDR *find)
 
   nf->find=*find;
 
+  /* A compiled nodelist index (see NLCOMP) takes precedence over the     *
+   * nodelist format given in the configuration.                          */
+
+  if ((nm=NlxOpen(ngcfg_get_path("maximus.net_info_path"))) != NULL)
+    return (NlxFindOpen(nf, nm));
+
   nlver = ngcfg_get_nodelist_version_int();
 
   /* Version 5 or version 6 nodelist */
@@ -170,6 +180,87 @@ static NFIND * near V7FindOpen(NFIND *nf)
 }
 
 
+static void near NlxFound(NFIND *nf, NLXMAP *nm, struct _nlxrec *r)
+{
+  nf->found.zone=r->zone;
+  nf->found.net=r->net;
+  nf->found.node=r->node;
+  nf->found.point=r->point;
+  nf->found.cost=r->cost;
+
+  strnncpy(nf->found.name, NlxStr(nm, r->name), sizeof nf->found.name);
+  strnncpy(nf->found.phone, NlxStr(nm, r->phone), sizeof nf->found.phone);
+  strnncpy(nf->found.city, NlxStr(nm, r->city), sizeof nf->found.city);
+  nf->found.flag=r->flag;
+}
+
+
+static NFIND * near NlxFindOpen(NFIND *nf, NLXMAP *nm)
+{
+  struct _nlxrec *r;
+  NETADDR tofind;
+
+  nf->nlx=nm;
+  nf->nlxcur=0;
+
+  /* Wildcard searches walk the records, which are in nodelist order */
+
+  if (nf->find.zone==ZONE_ALL || nf->find.net==NET_ALL ||
+      nf->find.node==NODE_ALL || nf->find.point==POINT_ALL)
+  {
+    if (NlxFindNext(nf)==0)
+      return nf;
+
+    NodeFindClose(nf);
+    return NULL;
+  }
+
+  /* Otherwise it's a straight hash lookup, falling back to the boss node */
+
+  nf->nlxcur=NLX_NOREC;
+  tofind=nf->find;
+
+  if ((r=NlxFindAddr(nm, &tofind)) != NULL ||
+      (tofind.point && (tofind.point=0, r=NlxFindAddr(nm, &tofind)) != NULL))
+  {
+    NlxFound(nf, nm, r);
+    return nf;
+  }
+
+  NodeFindClose(nf);
+  return NULL;
+}
+
+
+static int near NlxFindNext(NFIND *nf)
+{
+  NLXMAP *nm=nf->nlx;
+  struct _nlxrec *r;
+
+  /* The index may have been dropped since the search began */
+
+  if (nm->hdr==NULL)
+    return -1;
+
+  for (; nf->nlxcur < nm->hdr->nrec; nf->nlxcur++)
+  {
+    r=nm->rec + nf->nlxcur;
+
+    if ((r->zone==nf->find.zone || nf->find.zone==ZONE_ALL) &&
+        (r->net==nf->find.net || nf->find.net==NET_ALL) &&
+        (r->node==nf->find.node || nf->find.node==NODE_ALL) &&
+        (r->point==nf->find.point || nf->find.point==POINT_ALL))
+    {
+      NlxFound(nf, nm, r);
+      nf->nlxcur++;
+      return 0;
+    }
+  }
+
+  return -1;
+}
+
+
 static NFIND * near FDFindOpen(NFIND *nf)
 {
   struct _johonode jn;
@@ -386,6 +477,9 @@ int NodeFindNext(NFIND *nf)
   struct _node node5;
   struct _newnode node6;
 
+  if (nf->nlx)
+    return NlxFindNext(nf);
+
   /* V7 findnext is not supported */
 
   nlver = ngcfg_get_nodelist_version_int();
@@ -526,6 +620,14 @@ void NodeFindClose(NFIND *nf)
 
   if (!nf)
     return;
+
+  /* The compiled index stays mapped for the next search */
+
+  if (nf->nlx)
+  {
+    free(nf);
+    return;
+  }
   
   nlver = ngcfg_get_nodelist_version_int();
 
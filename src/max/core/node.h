@@ -37,6 +37,9 @@ typedef struct
 
     struct _ndi *idxbuf;
   } v56;
+
+  struct _nlxmap *nlx;    /* Compiled index in use, or NULL */
+  dword nlxcur;           /* Next record to check for NodeFindNext */
   
 } NFIND;
 
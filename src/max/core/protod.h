@@ -127,6 +127,8 @@ void Chg_City(void);
 void Chg_Alias(void);
 void Chg_Phone(void);
 int _stdc Display_File(word type, char *o_nonstop, char *fname,...);
+void DisplayCacheStats(dword *pdwHits, dword *pdwMisses);
+void DisplayCacheFlush(void);
 int Parse_Priv(FILE *bbsfile)  /* 1==EOF 2==EOL */;
 char * Ordinal(long number);
 void Get_To_Blank(char *s,FILE *f);
@@ -559,8 +561,8 @@ void beep(void);
 int safe_path_join(const char *base, const char *component, char *out, size_t out_sz);
 
 /* ngcfg configuration access functions */
-typedef struct MaxCfg MaxCfg;  /* Forward declaration */
-extern MaxCfg *ng_cfg;
+typedef struct MaxCfgToml MaxCfgToml;  /* Forward declaration */
+extern MaxCfgToml *ng_cfg;
 const char *ngcfg_get_path(const char *toml_path);
 int ngcfg_get_bool(const char *toml_path);
 int ngcfg_get_int(const char *toml_path);
@@ -570,6 +572,16 @@ int ngcfg_get_nodelist_version_int(void);
 const char *ngcfg_get_string(const char *toml_path);
 const char *ngcfg_get_string_raw(const char *toml_path);
 
+/* Config key handles: intern a path once, read it without re-parsing */
+struct ngcfg_key;
+struct ngcfg_key *ngcfg_key(const char *toml_path);
+const char *ngcfg_key_string(struct ngcfg_key *k);
+const char *ngcfg_key_string_raw(struct ngcfg_key *k);
+const char *ngcfg_key_path(struct ngcfg_key *k);
+int ngcfg_key_int(struct ngcfg_key *k);
+int ngcfg_key_bool(struct ngcfg_key *k);
+int ngcfg_key_int_array_2(struct ngcfg_key *k, int *out_a, int *out_b);
+
 /** @brief Supported message area color wire-formats. */
 #ifndef NGCFG_COLOR_SUPPORT_DEFINED
 #define NGCFG_COLOR_SUPPORT_DEFINED
@@ -143,6 +143,26 @@ enum _privcmp
   privNE  =5    /* != */
 };
 
+  /* One pre-parsed term of an ACS string, as built by AcsCompile().
+   * "item=value" comparisons are kept as text and run through PrivOK's
+   * code when the term is tested.
+   */
+
+#define ACST_LEVEL  0         /* Priv level and/or key comparison */
+#define ACST_TEXT   1         /* name=, alias= (or an invalid item=) */
+
+typedef struct _acsterm
+{
+  byte    type;                             /* ACST_LEVEL or ACST_TEXT */
+  byte    privop;                       /* enum _privcmp, for ACST_LEVEL */
+  byte    real_priv;          /* '@': always compare with the real priv */
+  byte    has_level;          /* FALSE if the level was blank (always ok) */
+  byte    or_rel;                    /* Term is tested as part of an OR */
+  word    level;                              /* Level to compare with */
+  word    ofs, len;        /* ACST_TEXT: position within the ACS string */
+  dword   maskon, maskoff;                    /* Keys required on / off */
+} ACSTERM;
+
 
   /* Class information API */
 
@@ -160,6 +180,9 @@ dword ClassGetInfo(int idx, int itype);             /* class information */
 word ClassLevel(char *pszAbbrev);                   /* Level from access */
 void ClassFlag(int idx, int which, dword fSet, dword fReset);
 char *privstr(word priv, char *buf);
+int AcsTermCount(char *acs);                /* Terms needed to compile */
+int AcsCompile(char *acs, ACSTERM *pat);     /* Pre-parse an ACS string */
+int AcsOK(char *acs, ACSTERM *pat, int n, unsigned use_real_priv);
 
 #define ClassSetMailFlag(i,f)   ClassFlag(i,CIT_MAILFLAGS,f,0)
 #define ClassResetMailFlag(i,f) ClassFlag(i,CIT_MAILFLAGS,0,f)
@@ -0,0 +1,375 @@
+/*
+ * arttest.c — Test for mapped display files
+ *
+ * Copyright 2026 by Kevin Morgan.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*# name=Stand-alone test for disp_art.c
+*/
+
+/* Built on its own with disp_art.c ("make artcheck" in src/max), not     *
+ * linked into max.  Each case opens a scratch file the way               *
+ * DisplayOpenFile() does and reads it with DispGetChar(), through the    *
+ * same refill as _DispGetChar().  Some of them rewrite the file part way *
+ * through, the way a utility regenerating a bulletin would, while the    *
+ * display is holding a window of it.  That has to carry on without a     *
+ * SIGBUS: the window the display already has is shown as it was, and    *
+ * the rest is read() from the file as it is now.                         */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <io.h>
+#include "prog.h"
+#include "mm.h"
+#include "display.h"
+
+static char szName[]="/tmp/arttestXXXXXX";
+static int fFail=FALSE;
+
+
+/* The same refill as _DispGetChar(), without the raw ANSI handling */
+
+word _DispGetChar(DSTK *d, word inc)
+{
+  sword got;
+
+  if ((got=DisplayMapRead(d)) < 0)
+    got=read(d->bbsfile, d->filebufr, FILEBUFSIZ);
+
+  if (got <= 0)
+    return DISP_EOF;
+
+  d->highp=d->filebufr+got;
+  d->bufp=d->filebufr;
+
+  return (word)(inc ? *d->bufp++ : *d->bufp);
+}
+
+
+static void Bus(int sig)
+{
+  static const char msg[]="FAILED: SIGBUS reading a display file\n";
+
+  NW(sig);
+  (void)write(1, msg, sizeof msg-1);
+  _exit(1);
+}
+
+static void near Fail(const char *test, const char *what)
+{
+  printf("FAILED: %s: %s\n", test, what);
+  fFail=TRUE;
+}
+
+
+/* Byte n of a file written with WriteFile(..., seed) */
+
+static byte near Pat(long n, int seed)
+{
+  return (byte)((n*31 + n/509 + seed*7) & 0xff);
+}
+
+/* Rewrite the file in place, as fopen("w") does */
+
+static void near WriteFile(long size, int seed)
+{
+  FILE *fp;
+  long n;
+
+  if ((fp=fopen(szName, "wb"))==NULL)
+    return;
+
+  for (n=0; n < size; n++)
+    putc(Pat(n, seed), fp);
+
+  fclose(fp);
+}
+
+static void near AppendFile(long size, long from, int seed)
+{
+  FILE *fp;
+  long n;
+
+  if ((fp=fopen(szName, "ab"))==NULL)
+    return;
+
+  for (n=from; n < from+size; n++)
+    putc(Pat(n, seed), fp);
+
+  fclose(fp);
+}
+
+static void near Open(DSTK *d, word type)
+{
+  memset(d, 0, sizeof *d);
+  d->type=type;
+  d->bbsfile=open(szName, O_RDONLY);
+  d->filebufr=malloc(DISPBUFSIZ);
+  d->bufp=d->highp=d->filebufr;
+
+  DisplayMapFile(d);
+}
+
+static void near Close(DSTK *d)
+{
+  DisplayUnmapFile(d);
+  close(d->bbsfile);
+  free(d->filebufr);
+}
+
+/* Read n bytes (or to the end) and check them against the pattern */
+
+static long near Read(DSTK *d, long n, long pos, int seed, const char *test)
+{
+  long got;
+  word ch;
+
+  for (got=0; got < n && (ch=DispGetChar()) != DISP_EOF; got++)
+    if (ch != Pat(pos+got, seed))
+    {
+      Fail(test, "wrong data");
+      break;
+    }
+
+  return got;
+}
+
+
+static void near TestWhole(void)
+{
+  DSTK ds, *d=&ds;
+
+  WriteFile(100000L, 1);
+  Open(d, DISPLAY_NONE);
+
+  if (!d->map)
+    Fail("whole file", "not mapped");
+
+  if (Read(d, 200000L, 0L, 1, "whole file") != 100000L)
+    Fail("whole file", "wrong length");
+
+  /* A second display reuses the mapping */
+
+  {
+    DSTK ds2;
+    byte *map=d->map;
+
+    Close(d);
+    Open(&ds2, DISPLAY_NONE);
+
+    if (!ds2.map || ds2.map != map)
+      Fail("whole file", "mapping not reused");
+
+    Close(&ds2);
+  }
+}
+
+static void near TestSeek(void)
+{
+  DSTK ds, *d=&ds;
+
+  WriteFile(100000L, 1);
+  Open(d, DISPLAY_NONE);
+
+  (void)Read(d, 10L, 0L, 1, "seek");
+
+  /* As [goto] in a questionnaire does */
+
+  lseek(d->bbsfile, 70000L, SEEK_SET);
+  d->bufp=d->highp=d->filebufr;
+
+  if (Read(d, 50000L, 70000L, 1, "seek") != 30000L)
+    Fail("seek", "wrong length");
+
+  Close(d);
+}
+
+/* Shrink the file while the display is part way through a window */
+
+static void near TestTruncate(void)
+{
+  DSTK ds, *d=&ds;
+
+  WriteFile(100000L, 1);
+  Open(d, DISPLAY_NONE);
+
+  if (Read(d, 1000L, 0L, 1, "truncate") != 1000L)
+    Fail("truncate", "short read");
+
+  WriteFile(300L, 2);
+
+  /* The rest of the window is what was there when it was taken; after   *
+   * that, the file is read as it is now, and it has no more data there. */
+
+  if (Read(d, 200000L, 1000L, 1, "truncate") != DISPBUFSIZ-1000L)
+    Fail("truncate", "wrong length");
+
+  if (d->map)
+    Fail("truncate", "still mapped");
+
+  Close(d);
+
+  /* The next display maps the new file */
+
+  Open(d, DISPLAY_NONE);
+
+  if (!d->map || Read(d, 1000L, 0L, 2, "truncate") != 300L)
+    Fail("truncate", "new file not shown");
+
+  Close(d);
+}
+
+/* Empty the file between windows */
+
+static void near TestEmpty(void)
+{
+  DSTK ds, *d=&ds;
+
+  WriteFile(100000L, 1);
+  Open(d, DISPLAY_NONE);
+
+  if (Read(d, DISPBUFSIZ, 0L, 1, "empty") != DISPBUFSIZ)
+    Fail("empty", "short read");
+
+  if (truncate(szName, 0L) != 0 || DispGetChar() != DISP_EOF)
+    Fail("empty", "data after truncation");
+
+  Close(d);
+}
+
+/* Append to the file, as a last-callers list grows */
+
+static void near TestGrow(void)
+{
+  DSTK ds, *d=&ds;
+
+  WriteFile(100000L, 1);
+  Open(d, DISPLAY_NONE);
+
+  (void)Read(d, 100L, 0L, 1, "grow");
+  AppendFile(5000L, 100000L, 1);
+
+  if (Read(d, 200000L, 100L, 1, "grow") != 104900L)
+    Fail("grow", "wrong length");
+
+  Close(d);
+}
+
+/* A nested display of a file that changed under an outer one is read */
+
+static void near TestNested(void)
+{
+  DSTK ds, ds2, *d=&ds;
+
+  WriteFile(100000L, 1);
+  Open(d, DISPLAY_NONE);
+  (void)Read(d, 10L, 0L, 1, "nested");
+
+  WriteFile(50000L, 3);
+  Open(&ds2, DISPLAY_NONE);
+
+  if (ds2.map)
+    Fail("nested", "mapped while an outer display uses the old mapping");
+
+  d=&ds2;
+
+  if (Read(d, 100000L, 0L, 3, "nested") != 50000L)
+    Fail("nested", "wrong length");
+
+  Close(&ds2);
+  Close(&ds);
+}
+
+static void near TestFilesBbs(void)
+{
+  DSTK ds;
+
+  WriteFile(1000L, 1);
+  Open(&ds, DISPLAY_FILESBBS);
+
+  if (ds.map)
+    Fail("files.bbs", "mapped");
+
+  Close(&ds);
+}
+
+/* A raw ANSI file with a SAUCE record and comment */
+
+static void near TestSauce(void)
+{
+  DSTK ds;
+  byte rec[128];
+  FILE *fp;
+
+  WriteFile(1000L, 1);
+
+  memset(rec, 0, sizeof rec);
+  memcpy(rec, "SAUCE00", 7);
+  rec[104]=1;
+
+  if ((fp=fopen(szName, "ab")) != NULL)
+  {
+    fputc(0x1a, fp);
+    fwrite("COMNT", 5, 1, fp);
+    fprintf(fp, "%-64s", "A comment");
+    fwrite(rec, sizeof rec, 1, fp);
+    fclose(fp);
+  }
+
+  Open(&ds, DISPLAY_NONE);
+
+  if (DisplayMapSauceEnd(&ds) != 1000L)
+    Fail("sauce", "wrong end of art");
+
+  Close(&ds);
+}
+
+
+int main(void)
+{
+  int fd;
+
+  if ((fd=mkstemp(szName)) < 0)
+  {
+    perror(szName);
+    return 1;
+  }
+
+  close(fd);
+  signal(SIGBUS, Bus);
+
+  TestWhole();
+  TestSeek();
+  TestTruncate();
+  TestEmpty();
+  TestGrow();
+  TestNested();
+  TestFilesBbs();
+  TestSauce();
+
+  unlink(szName);
+
+  if (!fFail)
+    printf("Mapped display files: all tests passed\n");
+
+  return fFail;
+}
+
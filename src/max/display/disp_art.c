@@ -0,0 +1,266 @@
+/*
+ * disp_art.c — Mapped display files (the art cache)
+ *
+ * Copyright 2026 by Kevin Morgan.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*# name=.BBS-file display routines (mapped files)
+*/
+
+/* Display files are mapped read-only instead of being read through       *
+ * FILEBUFSIZ bytes at a time.  Every node maps the same files, so they    *
+ * all share one copy in the system's page cache.  The mappings are kept   *
+ * here, along with where the file's SAUCE record starts, so that showing  *
+ * a file again costs one fstat().  A mapping is only reused while the     *
+ * file's size and mtime are unchanged, and it is never discarded while a  *
+ * (possibly nested) display is still using it.                            *
+ *                                                                         *
+ * Bulletins and the like are often rewritten in place while a caller is  *
+ * looking at them, and touching a mapping past the end of a file that    *
+ * has been cut short raises SIGBUS.  So the display loop never reads the *
+ * mapping itself: DisplayMapRead() checks the file's size and copies the *
+ * next DISPBUFSIZ bytes into d->filebufr, and the display then works on  *
+ * that copy for as long as it likes (a More prompt, say).  If the size   *
+ * has changed, the file goes back to being read with read().             *
+ *                                                                         *
+ * The copy is taken from the position of d->bbsfile, which is then moved *
+ * past it, so the places that lseek() within a display file work         *
+ * unchanged.                                                              */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <io.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef UNIX
+#include <sys/mman.h>
+#endif
+#include "prog.h"
+#include "mm.h"
+#include "display.h"
+
+#ifdef UNIX
+
+#define ACACHE_MAX  32                /* Max number of files to keep mapped */
+#define ACACHE_SIZE (4L*1024L*1024L)  /* Larger files are read as before */
+
+struct _artcache
+{
+  dev_t dev;                  /* Key: the file's device and inode */
+  ino_t ino;
+  time_t mtime;               /* ...and its mtime and size when mapped */
+  off_t size;
+
+  byte *base;                 /* Mapping, or NULL if the slot is free */
+  long sauce_end;             /* Offset where the SAUCE block starts, or -1 */
+  word users;                 /* Displays using the mapping right now */
+  dword last_use;             /* For discarding the least recently used */
+};
+
+static struct _artcache acache[ACACHE_MAX];
+static dword dwAcUse=0;
+
+
+static void near ArtCacheFree(struct _artcache *pac)
+{
+  if (pac->base)
+    munmap(pac->base, (size_t)pac->size);
+
+  memset(pac, 0, sizeof *pac);
+}
+
+
+/* Same as DisplayDetectSauce(), for a file that is in memory.  Returns   *
+ * the offset where the art ends, or -1 if there is no SAUCE record.       */
+
+static long near SauceDataEnd(const byte *p, long size)
+{
+  const byte *rec;
+  long sauce_pos;
+  long cut_pos;
+  long comnt_pos;
+
+  if (size < 128L)
+    return -1L;
+
+  sauce_pos=size-128L;
+  rec=p+sauce_pos;
+
+  if (memcmp(rec, "SAUCE", 5) != 0)
+    return -1L;
+
+  cut_pos=sauce_pos;
+
+  if (rec[104])
+  {
+    comnt_pos=sauce_pos - (5L + ((long)rec[104] * 64L));
+
+    if (comnt_pos >= 0 && memcmp(p+comnt_pos, "COMNT", 5)==0)
+      cut_pos=comnt_pos;
+  }
+
+  if (cut_pos > 0 && p[cut_pos-1]==0x1a)
+    cut_pos--;
+
+  return cut_pos;
+}
+
+#endif
+
+
+/* Map the file which DisplayOpenFile() just opened, if we can */
+
+void DisplayMapFile(DSTK *d)
+{
+#ifdef UNIX
+  struct _artcache *pac, *pacOld=NULL;
+  struct stat st, st2;
+  void *base;
+
+  /* FILES.BBS is rewritten in place, so it is always read */
+
+  if ((d->type & DISPLAY_FILESBBS) || fstat(d->bbsfile, &st) != 0 ||
+      !S_ISREG(st.st_mode) || st.st_size==0 || st.st_size > ACACHE_SIZE)
+    return;
+
+  for (pac=acache; pac < acache+ACACHE_MAX; pac++)
+  {
+    if (pac->base && pac->dev==st.st_dev && pac->ino==st.st_ino)
+      break;
+
+    /* Use an empty slot, or else the idle one used longest ago */
+
+    if (!pac->users &&
+        (!pacOld || (pacOld->base && (!pac->base ||
+                                      pac->last_use < pacOld->last_use))))
+      pacOld=pac;
+  }
+
+  if (pac < acache+ACACHE_MAX)
+  {
+    if (pac->mtime==st.st_mtime && pac->size==st.st_size)
+      goto Use;
+
+    /* The file has changed, but an outer display is still showing the    *
+     * old copy.                                                           */
+
+    if (pac->users)
+      return;
+  }
+  else if ((pac=pacOld)==NULL)
+    return;
+
+  ArtCacheFree(pac);
+
+  base=mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, d->bbsfile, 0);
+
+  if (base==MAP_FAILED)
+    return;
+
+  /* Don't hand out a mapping of a file that changed size meanwhile */
+
+  if (fstat(d->bbsfile, &st2) != 0 || st2.st_size != st.st_size)
+  {
+    munmap(base, (size_t)st.st_size);
+    return;
+  }
+
+  pac->base=(byte *)base;
+  pac->dev=st.st_dev;
+  pac->ino=st.st_ino;
+  pac->mtime=st.st_mtime;
+  pac->size=st.st_size;
+  pac->sauce_end=SauceDataEnd(pac->base, (long)st.st_size);
+
+Use:
+  pac->users++;
+  pac->last_use=++dwAcUse;
+
+  d->art=pac;
+  d->map=pac->base;
+  d->map_end=(long)pac->size;
+#else
+  NW(d);
+#endif
+}
+
+
+/* Let go of the file's mapping, if it has one */
+
+void DisplayUnmapFile(DSTK *d)
+{
+#ifdef UNIX
+  if (d->art && d->art->users)
+    d->art->users--;
+#endif
+
+  d->art=NULL;
+  d->map=NULL;
+}
+
+
+/* Where the art in a mapped file ends, not counting its SAUCE record,    *
+ * or -1 if it has none.                                                   */
+
+long DisplayMapSauceEnd(DSTK *d)
+{
+#ifdef UNIX
+  if (d->art)
+    return d->art->sauce_end;
+#else
+  NW(d);
+#endif
+
+  return -1L;
+}
+
+
+/* Copy the next window of a mapped file into d->filebufr.  Returns the   *
+ * number of bytes copied, 0 at the end of the data, or -1 if the file    *
+ * isn't mapped (or no longer is) and should be read().                   */
+
+sword DisplayMapRead(DSTK *d)
+{
+#ifdef UNIX
+  struct stat st;
+  long pos, n;
+
+  if (!d->map)
+    return -1;
+
+  if (fstat(d->bbsfile, &st) != 0 || st.st_size != d->art->size)
+  {
+    DisplayUnmapFile(d);
+    return -1;
+  }
+
+  if ((pos=tell(d->bbsfile)) < 0 || pos >= d->map_end)
+    return 0;
+
+  n=min(d->map_end-pos, (long)DISPBUFSIZ);
+
+  memcpy(d->filebufr, d->map+pos, (size_t)n);
+  lseek(d->bbsfile, pos+n, SEEK_SET);
+
+  return (sword)n;
+#else
+  NW(d);
+  return -1;
+#endif
+}
+
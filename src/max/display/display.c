@@ -39,6 +39,7 @@ static char rcs_id[]="$Id: display.c,v 1.4 2004/01/27 21:00:26 paltas Exp $";
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <time.h>
 #include <io.h>
 #include <fcntl.h>
 #include <sys/types.h>
@@ -76,6 +77,7 @@ int _stdc Display_File(word type, char *nonstop, char *fname,...)
 {
   DSTK *d, *dtsave;
   va_list var_args;
+  int ret;
 
   /* Save pointer to top of display stack */
 
@@ -98,13 +100,14 @@ int _stdc Display_File(word type, char *nonstop, char *fname,...)
   while (*d->filename && DisplayOneFile(d)==0)
     ;
   
+  ret=d->ret;
   DisplayCleanup(d);
 
   /* Restore pointer to top of display stack */
 
   dtop=dtsave;
 
-  return d->ret;
+  return ret;
 }
 
 
@@ -354,7 +357,8 @@ static const ext_probe_t basic_tty_tier[] = {
  * @return 0 if a file was opened (d->bbsfile set), -1 otherwise
  */
 static int near DisplayTryTier(DSTK *d, const ext_probe_t *tier,
-                                const char *theme_sname)
+                                const char *theme_sname,
+                                const ext_probe_t **phit)
 {
   int fd;
   int i;
@@ -376,6 +380,7 @@ static int near DisplayTryTier(DSTK *d, const ext_probe_t *tier,
           raw_display_state.active  = TRUE;
           raw_display_state.raw_end = -1L;
         }
+        *phit = &tier[i];
         return 0;
       }
     }
@@ -395,6 +400,7 @@ static int near DisplayTryTier(DSTK *d, const ext_probe_t *tier,
         raw_display_state.active  = TRUE;
         raw_display_state.raw_end = -1L;
       }
+      *phit = &tier[i];
       return 0;
     }
   }
@@ -403,6 +409,241 @@ static int near DisplayTryTier(DSTK *d, const ext_probe_t *tier,
 }
 
 
+/**
+ * @brief Run the tiered search for a display file (see DisplayOpenFile).
+ *
+ * @param d           Display stack (uses scratch buffer, sets bbsfile)
+ * @param theme_sname Current theme short_name (NULL/"" = no themed probes)
+ * @param phit        Output: tier entry that matched, or NULL for a bare
+ *                    filename match or no match
+ * @return Name of the file that was opened, or NULL if none was found
+ */
+static char * near DisplayProbeFile(DSTK *d, const char *theme_sname,
+                                    const ext_probe_t **phit)
+{
+  const ext_probe_t *basic_tier;
+
+  *phit = NULL;
+
+  /* ---- Tier 1: RIP ------------------------------------------------- */
+  if (hasRIP())
+    DisplayTryTier(d, rip_tier, theme_sname, phit);
+
+  /* ---- Tier 2: ANSI ------------------------------------------------ */
+  if (d->bbsfile == -1 && usr.video == GRAPH_ANSI)
+    DisplayTryTier(d, ansi_tier, theme_sname, phit);
+
+  /* ---- Tier 3: Basic / fallback ------------------------------------ */
+  if (d->bbsfile == -1)
+  {
+    if (usr.video == GRAPH_ANSI)
+      basic_tier = basic_ansi_tier;
+    else if (usr.video == GRAPH_AVATAR)
+      basic_tier = basic_avatar_tier;
+    else
+      basic_tier = basic_tty_tier;
+
+    DisplayTryTier(d, basic_tier, theme_sname, phit);
+  }
+
+  if (d->bbsfile != -1)
+    return (char *)d->scratch;
+
+  /* ---- Tier 4: Bare filename — themed then unthemed ---------------- */
+  if ((d->bbsfile = DisplayTryThemedOpen(d, theme_sname, "")) != -1)
+    return (char *)d->scratch;
+
+  if ((d->bbsfile = shopen(d->filename, O_RDONLY | O_BINARY | O_NOINHERIT)) != -1)
+    return (char *)d->filename;
+
+  return NULL;
+}
+
+
+/* Menus and MECCA files display the same few files over and over, and     *
+ * finding each one can take twenty or so open() calls.  The outcome of    *
+ * the search is kept here, keyed on the file name, the theme and the      *
+ * terminal capabilities that pick the tiers.  All of the candidates live  *
+ * in the file's directory, so an entry is only trusted while that         *
+ * directory's inode and modification time are unchanged.  A file that     *
+ * was not found at all is cached as well.                                 */
+
+#define DCACHE_MAX 64         /* Max number of resolved names to keep */
+
+struct _dispcache
+{
+  char *name;                 /* Key: file name, as passed to Display_File */
+  char *theme;                /* ...theme short_name ("" = none) */
+  byte caps;                  /* ...and DisplayCaps() */
+
+  dev_t dev;                  /* Directory the name was resolved in */
+  ino_t ino;
+  time_t mtime;
+
+  char *path;                 /* File found, or NULL if there was none */
+  word flags;                 /* Display flags to OR into d->type */
+  byte raw;                   /* Display it raw (no MECCA processing) */
+
+  dword last_use;             /* For discarding the least recently used */
+};
+
+static struct _dispcache dcache[DCACHE_MAX];
+static dword dwDcUse=0;
+static dword dwDcHits=0, dwDcMisses=0;
+
+
+/* The terminal capabilities which DisplayProbeFile looks at */
+
+static byte near DisplayCaps(void)
+{
+  return (byte)((hasRIP() ? 0x80 : 0) | (usr.video & 0x7f));
+}
+
+
+/* Stat the directory that holds 'name'.  Returns TRUE on success. */
+
+static int near DisplayDirStat(const char *name, struct stat *pst)
+{
+  char dir[PATHLEN];
+  const char *p;
+  size_t len;
+
+  if ((p=strrchr(name, PATH_DELIM))==NULL)
+    return stat(".", pst)==0;
+
+  len=(size_t)(p - name);
+
+  if (len==0)
+    len=1;                    /* The root directory */
+
+  if (len >= sizeof(dir))
+    return FALSE;
+
+  memcpy(dir, name, len);
+  dir[len]='\0';
+
+  return stat(dir, pst)==0;
+}
+
+
+static void near DisplayCacheFree(struct _dispcache *pdc)
+{
+  if (pdc->name)
+    free(pdc->name);
+
+  if (pdc->theme)
+    free(pdc->theme);
+
+  if (pdc->path)
+    free(pdc->path);
+
+  memset(pdc, 0, sizeof *pdc);
+}
+
+
+/* Find the resolution of 'name', or return NULL if it isn't cached */
+
+static struct _dispcache * near DisplayCacheFind(const char *name,
+                                                 const char *theme,
+                                                 byte caps,
+                                                 struct stat *pstDir)
+{
+  struct _dispcache *pdc;
+
+  for (pdc=dcache; pdc < dcache+DCACHE_MAX; pdc++)
+    if (pdc->name && pdc->caps==caps && eqstr(pdc->name, name) &&
+        eqstr(pdc->theme, theme))
+    {
+      /* Throw it away if the directory has changed since */
+
+      if (pdc->dev != pstDir->st_dev || pdc->ino != pstDir->st_ino ||
+          pdc->mtime != pstDir->st_mtime)
+      {
+        DisplayCacheFree(pdc);
+        return NULL;
+      }
+
+      pdc->last_use=++dwDcUse;
+      return pdc;
+    }
+
+  return NULL;
+}
+
+
+/* Remember how 'name' was resolved.  path is NULL if it wasn't found. */
+
+static void near DisplayCacheStore(const char *name, const char *theme,
+                                   byte caps, struct stat *pstDir,
+                                   const char *path, const ext_probe_t *hit)
+{
+  struct _dispcache *pdc, *pdcOld;
+
+  /* A directory changed in this very second could change again without   *
+   * its mtime moving, so don't trust it yet.                             */
+
+  if (pstDir->st_mtime >= time(NULL))
+    return;
+
+  /* Use an empty slot, or else the one which was used longest ago */
+
+  for (pdc=pdcOld=dcache; pdc < dcache+DCACHE_MAX; pdc++)
+  {
+    if (pdc->name && pdc->caps==caps && eqstr(pdc->name, name) &&
+        eqstr(pdc->theme, theme))
+      break;
+
+    if (!pdc->name || (pdcOld->name && pdc->last_use < pdcOld->last_use))
+      pdcOld=pdc;
+  }
+
+  if (pdc==dcache+DCACHE_MAX)
+    pdc=pdcOld;
+
+  DisplayCacheFree(pdc);
+
+  if ((pdc->name=strdup(name))==NULL ||
+      (pdc->theme=strdup(theme))==NULL ||
+      (path && (pdc->path=strdup(path))==NULL))
+  {
+    DisplayCacheFree(pdc);
+    return;
+  }
+
+  pdc->caps=caps;
+  pdc->dev=pstDir->st_dev;
+  pdc->ino=pstDir->st_ino;
+  pdc->mtime=pstDir->st_mtime;
+  pdc->flags=hit ? hit->flags : 0;
+  pdc->raw=hit ? hit->raw : 0;
+  pdc->last_use=++dwDcUse;
+}
+
+
+/* Return the number of display file lookups satisfied from (and missed   *
+ * by) the cache.                                                          */
+
+void DisplayCacheStats(dword *pdwHits, dword *pdwMisses)
+{
+  if (pdwHits)
+    *pdwHits=dwDcHits;
+
+  if (pdwMisses)
+    *pdwMisses=dwDcMisses;
+}
+
+
+/* Discard all cached display file names */
+
+void DisplayCacheFlush(void)
+{
+  struct _dispcache *pdc;
+
+  for (pdc=dcache; pdc < dcache+DCACHE_MAX; pdc++)
+    DisplayCacheFree(pdc);
+}
+
+
 /**
  * @brief Open a display file using tiered capability-based resolution.
  *
@@ -416,62 +657,91 @@ static int near DisplayTryTier(DSTK *d, const ext_probe_t *tier,
  *                                     AVATAR→ .avt .bbs .txt
  *                                     TTY   → .bbs .txt
  * Tier 4 — Bare filename             <base>.<theme> then <base>
+ *
+ * The result is cached per directory; see DCACHE_MAX.
  */
 static sword near DisplayOpenFile(DSTK *d)
 {
   const char *theme_sname = theme_get_current_shortname();
-  const ext_probe_t *basic_tier;
+  struct _dispcache *pdc = NULL;
+  struct stat stDir;
+  int have_dir;
+  byte caps = DisplayCaps();
+
+  if (theme_sname == NULL)
+    theme_sname = "";
 
   d->bbsfile = -1;
+  d->art = NULL;
+  d->map = NULL;
 
   /* Reset raw display state — must not leak between successive files */
   raw_display_state.active  = FALSE;
   raw_display_state.raw_end = -1L;
 
-  /* ---- Tier 1: RIP ------------------------------------------------- */
-  if (hasRIP())
-    DisplayTryTier(d, rip_tier, theme_sname);
+  have_dir = DisplayDirStat((char *)d->filename, &stDir);
 
-  /* ---- Tier 2: ANSI ------------------------------------------------ */
-  if (d->bbsfile == -1 && usr.video == GRAPH_ANSI)
-    DisplayTryTier(d, ansi_tier, theme_sname);
-
-  /* ---- Tier 3: Basic / fallback ------------------------------------ */
-  if (d->bbsfile == -1)
+  if (have_dir &&
+      (pdc = DisplayCacheFind((char *)d->filename, theme_sname, caps, &stDir)) != NULL)
   {
-    if (usr.video == GRAPH_ANSI)
-      basic_tier = basic_ansi_tier;
-    else if (usr.video == GRAPH_AVATAR)
-      basic_tier = basic_avatar_tier;
-    else
-      basic_tier = basic_tty_tier;
+    dwDcHits++;
+
+    if (pdc->path == NULL)
+      return (d->ret = DRET_NOTFOUND);
 
-    DisplayTryTier(d, basic_tier, theme_sname);
+    /* If the file went away without the directory changing (which can     *
+     * only happen within the same second), just search again.            */
+
+    if ((d->bbsfile = shopen(pdc->path, O_RDONLY | O_BINARY | O_NOINHERIT)) != -1)
+    {
+      d->type |= pdc->flags;
+
+      if (pdc->raw)
+      {
+        raw_display_state.active  = TRUE;
+        raw_display_state.raw_end = -1L;
+      }
+    }
   }
 
-  /* ---- Tier 4: Bare filename — themed then unthemed ---------------- */
   if (d->bbsfile == -1)
   {
-    d->bbsfile = DisplayTryThemedOpen(d, theme_sname, "");
+    const ext_probe_t *hit;
+    char *path;
+
+    dwDcMisses++;
 
-    if (d->bbsfile == -1)
-      d->bbsfile = shopen(d->filename, O_RDONLY | O_BINARY | O_NOINHERIT);
+    path = DisplayProbeFile(d, theme_sname, &hit);
+
+    if (have_dir)
+      DisplayCacheStore((char *)d->filename, theme_sname, caps, &stDir, path, hit);
   }
 
   if (d->bbsfile == -1)
     return (d->ret = DRET_NOTFOUND);
 
-  /* Detect and suppress SAUCE metadata for raw ANSI files */
-  if (raw_display_state.active && usr.video == GRAPH_ANSI)
-    DisplayDetectSauce(d, &raw_display_state);
-
   /* Allocate memory for this file's buffer */
 
-  if ((d->filebufr = malloc(FILEBUFSIZ)) == NULL)
+  if ((d->filebufr = malloc(DISPBUFSIZ)) == NULL)
     return (d->ret = DRET_NOMEM);
 
   d->bufp = d->highp = d->filebufr;
 
+  DisplayMapFile(d);
+
+  /* Detect and suppress SAUCE metadata for raw ANSI files */
+  if (raw_display_state.active && usr.video == GRAPH_ANSI)
+  {
+    if (d->map)
+    {
+      raw_display_state.raw_end = DisplayMapSauceEnd(d);
+
+      if (raw_display_state.raw_end >= 0L)
+        d->map_end = raw_display_state.raw_end;
+    }
+    else DisplayDetectSauce(d, &raw_display_state);
+  }
+
   /* Seek to the restore offset, if any */
 
   if (rst_offset != -1L)
@@ -516,6 +786,7 @@ static void near DisplayFixFilename(DSTK *d)
 
 static sword near DispCloseFiles(DSTK *d, sword ret)
 {
+  DisplayUnmapFile(d);
   close(d->bbsfile);
 
   if (d->filebufr)
@@ -1167,6 +1438,19 @@ word _DispGetChar(DSTK *d, word inc)
   long remaining;
   sword got;
 
+  /* A mapped file is copied from its mapping (see disp_art.c) */
+
+  if ((got=DisplayMapRead(d)) >= 0)
+  {
+    if (got==0)
+      return DISP_EOF;
+
+    d->highp=d->filebufr+got;
+    d->bufp=d->filebufr;
+
+    return (word)(inc ? *d->bufp++ : *d->bufp);
+  }
+
   if (raw_display_state.active && raw_display_state.raw_end >= 0L)
   {
     pos=tell(d->bbsfile);
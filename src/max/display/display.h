@@ -32,6 +32,10 @@
 
 #define DispGetPos()  (tell(d->bbsfile)-(long)(d->highp-d->bufp))
 
+#define DISPBUFSIZ  16384      /* Size of d->filebufr.  read() fills only    *
+                                * FILEBUFSIZ of it; a mapped file is copied  *
+                                * in this many bytes at a time.              */
+
 #define DISPLAY_NONE      0x00 /* Nothing special for display               */
 #define DISPLAY_FILESBBS  0x01 /* If displaying a FILES.BBS                 */
 #define DISPLAY_NEWFILES  0x02 /* If only displaying new files              */
@@ -52,6 +56,8 @@
 #define DRET_EXIT         4     /* Cancel display of all via [exit] token */
 
 
+struct _artcache;
+
 typedef struct _dstk
 {
   int bbsfile;    /* file we're currently reading from */
@@ -83,6 +89,10 @@ typedef struct _dstk
   byte *filebufr;           /* buffer for reading file */
   byte *bufp;               /* current location in buffer */
   byte *highp;              /* highest location in buffer */
+
+  struct _artcache *art;    /* Art cache entry if the file is mapped */
+  byte *map;                /* ...the file's mapping */
+  long map_end;             /* ...and the offset where its data ends */
   
   word beginline;           /* If we're at beginning of a line */
 
@@ -90,6 +100,10 @@ typedef struct _dstk
 
 
 word _DispGetChar(DSTK *d, word inc);
+void DisplayMapFile(DSTK *d);
+void DisplayUnmapFile(DSTK *d);
+long DisplayMapSauceEnd(DSTK *d);
+sword DisplayMapRead(DSTK *d);
 void Add_Full_Path(char *src,char *dest);
 word DisplayDatacode(DSTK *d);
 word DisplayQuestionnaire(DSTK *d);
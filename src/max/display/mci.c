@@ -972,7 +972,7 @@ literal_dollar:
       /* No closing brace — fall through to literal output */
     }
 
-    if ((g_mci_parse_flags & MCI_PARSE_MCI_CODES) && in[i]=='|' &&
+    if ((g_mci_parse_flags & MCI_PARSE_MCI_CODES) && in[i]=='|' && in[i+1] &&
         (mci_is_upper2(in[i+1], in[i+2]) || (in[i+1]=='U' && in[i+2]=='#')))
     {
       char a=in[i+1];
@@ -1060,6 +1060,838 @@ literal_dollar:
   return out_len;
 }
 
+/*
+ * MCI templates.
+ *
+ * MciExpand() re-tokenizes its input every time, but most of what goes
+ * through it is the same language strings and prompts over and over.
+ * MciCompile() does the tokenizing once and produces a list of ops: runs
+ * of literal output (with their effect on the current column), format
+ * ops, cursor ops and fetches of info codes, parameters and theme colors.
+ * MciRender() plays the ops back and produces exactly what MciExpand()
+ * would have for the same input and parse flags.
+ *
+ * A few constructs can only be tokenized once their value is known: a
+ * format op or cursor op whose width is an info code ($L|TW, |[X|TC).
+ * A template containing one of those is marked dynamic and is always
+ * rendered by MciExpand().
+ */
+
+enum
+{
+  MOP_TEXT = 0,   /* Literal output from the pool */
+  MOP_FMT,        /* Set pending justify op: a=fill, b=MCI_FMT_*, n=width */
+  MOP_TRIM,       /* Set pending trim to n */
+  MOP_PADSPACE,   /* |PD */
+  MOP_REPEAT,     /* $D: n copies of a */
+  MOP_TOCOL,      /* $X: fill with a up to column n */
+  MOP_CUREND,     /* |[> */
+  MOP_CURMID,     /* |[H */
+  MOP_ROW,        /* |[Y: output text, then set the current line to n */
+  MOP_PARAM,      /* |!N / |#N, n=parameter index */
+  MOP_STRING,     /* |{...}: value from the pool */
+  MOP_CODE,       /* |XY info code a,b */
+  MOP_THEME       /* |xx theme color a,b */
+};
+
+typedef struct
+{
+  unsigned char op;     /* MOP_* */
+  unsigned char col_abs;/* MOP_TEXT: set cur_col to n instead of adding n */
+  char a, b;            /* Code letters, fill char or MCI_FMT_* */
+  int n;                /* Width, count, column, line or parameter index */
+  size_t ofs, len;      /* Text in the template's pool */
+} MciOp;
+
+struct mci_template
+{
+  unsigned long flags;  /* Parse flags it was compiled for */
+  int dynamic;          /* Must be rendered by MciExpand() */
+  size_t n_ops, max_ops;
+  MciOp *ops;
+  char *pool;
+  size_t pool_len, pool_max;
+  char *src;            /* Source string */
+};
+
+/**
+ * @brief Append text to a template's pool.
+ *
+ * @return Offset of the text, or (size_t)-1 if out of memory.
+ */
+static size_t mci_tpl_pool(MciTemplate *t, const char *s, size_t len)
+{
+  size_t ofs;
+
+  if (t->pool_len + len + 1 > t->pool_max)
+  {
+    size_t max = t->pool_max ? t->pool_max * 2 : 128;
+    char *p;
+
+    while (max < t->pool_len + len + 1)
+      max *= 2;
+
+    if ((p = realloc(t->pool, max)) == NULL)
+      return (size_t)-1;
+
+    t->pool = p;
+    t->pool_max = max;
+  }
+
+  ofs = t->pool_len;
+  memcpy(t->pool + ofs, s, len);
+  t->pool[ofs + len] = '\0';
+  t->pool_len += len + 1;
+  return ofs;
+}
+
+/**
+ * @brief Add an op to a template.
+ *
+ * @return The new op, or NULL if out of memory.
+ */
+static MciOp *mci_tpl_op(MciTemplate *t, int op)
+{
+  MciOp *o;
+
+  if (t->n_ops == t->max_ops)
+  {
+    size_t max = t->max_ops ? t->max_ops * 2 : 16;
+    MciOp *p = realloc(t->ops, max * sizeof(MciOp));
+
+    if (p == NULL)
+      return NULL;
+
+    t->ops = p;
+    t->max_ops = max;
+  }
+
+  o = &t->ops[t->n_ops++];
+  memset(o, 0, sizeof(*o));
+  o->op = (unsigned char)op;
+  return o;
+}
+
+/**
+ * @brief Add literal output to a template.
+ *
+ * Joins the text to a directly preceding text op when it can.
+ *
+ * @param t       Template.
+ * @param s       Text to output.
+ * @param len     Length of @p s.
+ * @param col_abs Non-zero if the text sets the column to @p col, zero if
+ *                it advances the column by @p col.
+ * @param col     Column or column advance.
+ * @return        0 on success, -1 if out of memory.
+ */
+static int mci_tpl_text(MciTemplate *t, const char *s, size_t len, int col_abs, int col)
+{
+  MciOp *o = t->n_ops ? &t->ops[t->n_ops - 1] : NULL;
+
+  /* Extend the previous run; its text is always last in the pool */
+  if (o && o->op == MOP_TEXT && o->ofs + o->len + 1 == t->pool_len)
+  {
+    if (mci_tpl_pool(t, s, len) == (size_t)-1)
+      return -1;
+
+    /* Pull the new text back over the previous run's terminator */
+    memmove(t->pool + o->ofs + o->len, t->pool + o->ofs + o->len + 1, len + 1);
+    t->pool_len--;
+    o->len += len;
+
+    if (col_abs)
+    {
+      o->col_abs = 1;
+      o->n = col;
+    }
+    else
+      o->n += col;
+
+    return 0;
+  }
+
+  if ((o = mci_tpl_op(t, MOP_TEXT)) == NULL)
+    return -1;
+
+  if ((o->ofs = mci_tpl_pool(t, s, len)) == (size_t)-1)
+    return -1;
+
+  o->len = len;
+  o->col_abs = (unsigned char)(col_abs != 0);
+  o->n = col;
+  return 0;
+}
+
+/**
+ * @brief Check a format-op width the way mci_parse_width() would.
+ *
+ * @return 1 if it is a literal two-digit width (*out_val, *out_len set),
+ *         -1 if it is an info code whose value is only known at render
+ *         time, or 0 if it isn't a width.
+ */
+static int mci_tpl_width(const char *s, int *out_val, int *out_len)
+{
+  if (isdigit((unsigned char)s[0]) && isdigit((unsigned char)s[1]))
+  {
+    *out_val = ((int)(s[0] - '0') * 10) + (int)(s[1] - '0');
+    *out_len = 2;
+    return 1;
+  }
+
+  if (s[0] == '|' && s[1] && s[2] &&
+      (mci_is_upper2(s[1], s[2]) || (s[1] == 'U' && s[2] == '#')))
+    return -1;
+
+  return 0;
+}
+
+/**
+ * @brief Release a template.
+ *
+ * @param t Template from MciCompile(), or NULL.
+ */
+void MciFreeTemplate(MciTemplate *t)
+{
+  if (t == NULL)
+    return;
+
+  free(t->ops);
+  free(t->pool);
+  free(t->src);
+  free(t);
+}
+
+/**
+ * @brief Compile an MCI string into a template.
+ *
+ * Follows MciExpand() step for step.
+ *
+ * @param in    Input string.
+ * @param flags Parse flags to compile for (MCI_PARSE_*).
+ * @return      Template, or NULL if out of memory.
+ */
+MciTemplate *MciCompile(const char *in, unsigned long flags)
+{
+  MciTemplate *t;
+  MciOp *o;
+  int rc = 0;
+
+  if ((t = calloc(1, sizeof(*t))) == NULL)
+    return NULL;
+
+  t->flags = flags;
+
+  if ((t->src = strdup(in)) == NULL)
+  {
+    free(t);
+    return NULL;
+  }
+
+  for (size_t i=0; in[i] != '\0' && rc == 0 && !t->dynamic; )
+  {
+    if (in[i]=='|' && in[i+1]=='|')
+    {
+      rc = mci_tpl_text(t, "||", 2, 0, 1);
+      i += 2;
+      continue;
+    }
+
+    if (in[i]=='$' && in[i+1]=='$')
+    {
+      rc = mci_tpl_text(t, "$", 1, 0, 1);
+      i += 2;
+      continue;
+    }
+
+    if ((flags & MCI_PARSE_FORMAT_OPS) && in[i]=='$')
+    {
+      char op=in[i+1];
+      int n=0;
+      int wlen=0;
+      int w = op ? mci_tpl_width(in + i + 2, &n, &wlen) : 0;
+
+      if (w < 0 && op && strchr("CLRTclrDX", op))
+      {
+        t->dynamic = 1;
+        break;
+      }
+
+      if (w > 0)
+      {
+        char ch=in[i + 2 + wlen];
+
+        if (op=='C' || op=='L' || op=='R' || op=='T')
+        {
+          if ((o = mci_tpl_op(t, op=='T' ? MOP_TRIM : MOP_FMT)) == NULL)
+            goto nomem;
+
+          o->n = n;
+          o->a = ' ';
+          o->b = (char)((op=='C') ? MCI_FMT_CENTER : (op=='L' ? MCI_FMT_LEFTPAD : MCI_FMT_RIGHTPAD));
+          i += 2 + wlen;
+          continue;
+        }
+        else if ((op=='c' || op=='l' || op=='r' || op=='D' || op=='X') && ch != '\0')
+        {
+          if ((o = mci_tpl_op(t, op=='D' ? MOP_REPEAT : op=='X' ? MOP_TOCOL : MOP_FMT)) == NULL)
+            goto nomem;
+
+          o->n = n;
+          o->a = ch;
+          o->b = (char)((op=='c') ? MCI_FMT_CENTER : (op=='l' ? MCI_FMT_LEFTPAD : MCI_FMT_RIGHTPAD));
+          i += 2 + wlen + 1;
+          continue;
+        }
+      }
+
+      rc = mci_tpl_text(t, "$", 1, 0, 1);
+      ++i;
+      continue;
+    }
+
+    if ((flags & MCI_PARSE_FORMAT_OPS) && in[i]=='|' && in[i+1]=='P' && in[i+2]=='D')
+    {
+      if (mci_tpl_op(t, MOP_PADSPACE) == NULL)
+        goto nomem;
+
+      i += 3;
+      continue;
+    }
+
+    if ((flags & MCI_PARSE_MCI_CODES) && in[i]=='|' && in[i+1]=='[')
+    {
+      char cc=in[i+2];
+      int nn=0;
+      int wlen=0;
+      int w;
+
+      if (cc=='0' || cc=='1' || cc=='K' || cc=='<')
+      {
+        const char *seq = (cc=='0') ? "\x1b[?25l" : (cc=='1') ? "\x1b[?25h" :
+                          (cc=='K') ? "\x1b[K" : "\x1b[1G";
+
+        rc = mci_tpl_text(t, seq, strlen(seq), cc=='<', cc=='<' ? 1 : 0);
+        i += 3;
+        continue;
+      }
+
+      if (cc=='>' || cc=='H')
+      {
+        if (mci_tpl_op(t, cc=='>' ? MOP_CUREND : MOP_CURMID) == NULL)
+          goto nomem;
+
+        i += 3;
+        continue;
+      }
+
+      if (cc=='A' || cc=='B' || cc=='C' || cc=='D' ||
+          cc=='L' || cc=='X' || cc=='Y')
+      {
+        if ((w = mci_tpl_width(in + i + 3, &nn, &wlen)) < 0)
+        {
+          t->dynamic = 1;
+          break;
+        }
+
+        if (w > 0)
+        {
+          char csi[32];
+
+          if (cc=='L')
+            snprintf(csi, sizeof(csi), "\x1b[%dG\x1b[K", nn);
+          else
+            snprintf(csi, sizeof(csi), "\x1b[%d%c", nn,
+                     cc=='X' ? 'G' : cc=='Y' ? 'd' : cc);
+
+          if (cc=='Y')
+          {
+            if ((o = mci_tpl_op(t, MOP_ROW)) == NULL ||
+                (o->ofs = mci_tpl_pool(t, csi, strlen(csi))) == (size_t)-1)
+              goto nomem;
+
+            o->len = strlen(csi);
+            o->n = nn;
+          }
+          else
+            rc = mci_tpl_text(t, csi, strlen(csi), cc=='X' || cc=='L',
+                              (cc=='X' || cc=='L') ? nn : 0);
+
+          i += 3 + wlen;
+          continue;
+        }
+      }
+    }
+
+    if ((flags & MCI_PARSE_MCI_CODES) && in[i]=='|' &&
+        (in[i+1]=='!' || in[i+1]=='#') &&
+        ((in[i+2] >= '1' && in[i+2] <= '9') || (in[i+2] >= 'A' && in[i+2] <= 'F')))
+    {
+      if ((o = mci_tpl_op(t, MOP_PARAM)) == NULL)
+        goto nomem;
+
+      o->n = (in[i+2] >= '1' && in[i+2] <= '9') ? in[i+2] - '1' : in[i+2] - 'A' + 9;
+      i += 3;
+      continue;
+    }
+
+    if ((flags & MCI_PARSE_MCI_CODES) &&
+        in[i]=='|' && in[i+1]=='&' && in[i+2]=='&')
+    {
+      rc = mci_tpl_text(t, "\x1b[6n", 4, 0, 0);
+      i += 3;
+      continue;
+    }
+
+    /* Whether the theme has the slot is only known at render time */
+    if ((flags & MCI_PARSE_PIPE_COLORS) &&
+        in[i]=='|' && in[i+1] >= 'a' && in[i+1] <= 'z' &&
+        in[i+2] >= 'a' && in[i+2] <= 'z')
+    {
+      if ((o = mci_tpl_op(t, MOP_THEME)) == NULL)
+        goto nomem;
+
+      o->a = in[i+1];
+      o->b = in[i+2];
+      i += 3;
+      continue;
+    }
+
+    if ((flags & MCI_PARSE_MCI_CODES) && in[i]=='|' &&
+        in[i+1] >= 'A' && in[i+1] <= 'Z' &&
+        in[i+2] >= 'A' && in[i+2] <= 'Z')
+    {
+      char a=in[i+1], b=in[i+2];
+      const char *ctrl = NULL;
+
+      if (a=='C' && b=='L')       ctrl = "\x0c";
+      else if (a=='B' && b=='S')  ctrl = "\x08 \x08";
+      else if (a=='C' && b=='R')  ctrl = "\r\n";
+      else if (a=='C' && b=='D')  ctrl = "\x1b[0m";
+      else if (a=='S' && b=='A')  ctrl = "\x1b""7";
+      else if (a=='R' && b=='A')  ctrl = "\x1b""8";
+      else if (a=='S' && b=='S')  ctrl = "\x1b[?47h";
+      else if (a=='R' && b=='S')  ctrl = "\x1b[?47l";
+      else if (a=='L' && b=='C')  ctrl = "";
+      else if (a=='L' && b=='F')  ctrl = "";
+
+      if (ctrl)
+      {
+        int reset = (a=='C' && (b=='L' || b=='R'));
+
+        rc = mci_tpl_text(t, ctrl, strlen(ctrl), reset, reset ? 1 : 0);
+        i += 3;
+        continue;
+      }
+    }
+
+    if ((flags & MCI_PARSE_MCI_CODES) && in[i]=='|' && in[i+1]=='{')
+    {
+      const char *start = in + i + 2;
+      const char *end   = strchr(start, '}');
+
+      if (end)
+      {
+        size_t slen = (size_t)(end - start);
+
+        /* Same limit as MciExpand()'s buffer, including where it resumes */
+        if (slen >= 512)
+          slen = 511;
+
+        if ((o = mci_tpl_op(t, MOP_STRING)) == NULL ||
+            (o->ofs = mci_tpl_pool(t, start, slen)) == (size_t)-1)
+          goto nomem;
+
+        o->len = slen;
+        i += 2 + slen + 1;
+        continue;
+      }
+    }
+
+    /* An info code with an empty value is output as is, at render time */
+    if ((flags & MCI_PARSE_MCI_CODES) && in[i]=='|' && in[i+1] &&
+        (mci_is_upper2(in[i+1], in[i+2]) || (in[i+1]=='U' && in[i+2]=='#')))
+    {
+      if ((o = mci_tpl_op(t, MOP_CODE)) == NULL)
+        goto nomem;
+
+      o->a = in[i+1];
+      o->b = in[i+2];
+      i += 3;
+      continue;
+    }
+
+    if (in[i]=='\r' || in[i]=='\n')
+      rc = mci_tpl_text(t, in + i, 1, 1, 1);
+    else
+      rc = mci_tpl_text(t, in + i, 1, 0, 1);
+    ++i;
+  }
+
+  if (rc==0)
+    return t;
+
+nomem:
+  MciFreeTemplate(t);
+  return NULL;
+}
+
+/**
+ * @brief Renderer state, the same as MciExpand()'s locals.
+ */
+typedef struct
+{
+  char *out;
+  size_t out_size;
+  size_t out_len;
+  int cur_col;
+  int pending_pad_space;
+  int pending_fmt;
+  int pending_width;
+  char pending_padch;
+  int pending_trim;
+} MciRenderState;
+
+/**
+ * @brief Output text of known length.
+ *
+ * Same as mci_out_append_str(), but copies the whole run at once when it
+ * fits.
+ */
+static void mci_render_text(MciRenderState *r, const char *s, size_t len)
+{
+  if (r->out_len + len < r->out_size)
+  {
+    memcpy(r->out + r->out_len, s, len);
+    r->out_len += len;
+    r->out[r->out_len]='\0';
+  }
+  else
+    mci_out_append_str(r->out, r->out_size, &r->out_len, s);
+}
+
+/**
+ * @brief Output a value (info code, parameter or |{string}) with the
+ *        pending pad, trim and justify ops applied.
+ *
+ * @param r   Renderer state.
+ * @param tmp Value, in a buffer of 512 bytes which may be modified.
+ */
+static void mci_render_value(MciRenderState *r, char *tmp)
+{
+  if (r->pending_pad_space)
+  {
+    char with_pad[512];
+    snprintf(with_pad, sizeof(with_pad), " %s", tmp);
+    snprintf(tmp, 512, "%s", with_pad);
+  }
+  r->pending_pad_space=0;
+
+  if (r->pending_trim >= 0)
+  {
+    mci_apply_trim(tmp, r->pending_trim);
+    r->pending_trim=-1;
+  }
+
+  if (r->pending_fmt != MCI_FMT_NONE && r->pending_width >= 0)
+  {
+    int vlen=mci_visible_len(tmp);
+    int pad=(r->pending_width > vlen) ? (r->pending_width - vlen) : 0;
+    int left=0, right=0;
+
+    if (r->pending_fmt==MCI_FMT_LEFTPAD)       left=pad;
+    else if (r->pending_fmt==MCI_FMT_RIGHTPAD)  right=pad;
+    else { left=pad/2; right=pad-left; }
+
+    if (left)
+    {
+      r->out_len=mci_emit_repeated(r->out, r->out_size, r->out_len, left, r->pending_padch);
+      r->cur_col += left;
+    }
+
+    mci_render_text(r, tmp, strlen(tmp));
+    r->cur_col += mci_visible_len(tmp);
+
+    if (right)
+    {
+      r->out_len=mci_emit_repeated(r->out, r->out_size, r->out_len, right, r->pending_padch);
+      r->cur_col += right;
+    }
+
+    r->pending_fmt=MCI_FMT_NONE;
+    r->pending_width=-1;
+    r->pending_padch=' ';
+  }
+  else
+  {
+    mci_render_text(r, tmp, strlen(tmp));
+    r->cur_col += mci_visible_len(tmp);
+  }
+}
+
+/**
+ * @brief Output a three-character code as literal text.
+ */
+static void mci_render_literal3(MciRenderState *r, char a, char b)
+{
+  mci_out_append_ch(r->out, r->out_size, &r->out_len, '|');
+  mci_out_append_ch(r->out, r->out_size, &r->out_len, a);
+  mci_out_append_ch(r->out, r->out_size, &r->out_len, b);
+  r->cur_col += 3;
+}
+
+/**
+ * @brief Render a compiled template.
+ *
+ * @param t        Template from MciCompile().
+ * @param out      Output buffer.
+ * @param out_size Size of output buffer in bytes.
+ * @return         Number of bytes written (excluding NUL terminator).
+ */
+size_t MciRender(const MciTemplate *t, char *out, size_t out_size)
+{
+  MciRenderState r;
+  const MciOp *o, *end;
+
+  if (out_size==0)
+    return 0;
+
+  if (t->dynamic)
+  {
+    unsigned long save = g_mci_parse_flags;
+    size_t len;
+
+    g_mci_parse_flags = t->flags;
+    len = MciExpand(t->src, out, out_size);
+    g_mci_parse_flags = save;
+    return len;
+  }
+
+  out[0]='\0';
+
+  r.out=out;
+  r.out_size=out_size;
+  r.out_len=0;
+  r.cur_col=(int)current_col;
+  r.pending_pad_space=0;
+  r.pending_fmt=MCI_FMT_NONE;
+  r.pending_width=-1;
+  r.pending_padch=' ';
+  r.pending_trim=-1;
+
+  for (o=t->ops, end=t->ops + t->n_ops; o < end; o++)
+  {
+    switch (o->op)
+    {
+      case MOP_TEXT:
+        mci_render_text(&r, t->pool + o->ofs, o->len);
+        if (o->col_abs)
+          r.cur_col=o->n;
+        else
+          r.cur_col += o->n;
+        break;
+
+      case MOP_FMT:
+        r.pending_width=o->n;
+        r.pending_padch=o->a;
+        r.pending_fmt=o->b;
+        break;
+
+      case MOP_TRIM:
+        r.pending_trim=o->n;
+        break;
+
+      case MOP_PADSPACE:
+        r.pending_pad_space=1;
+        break;
+
+      case MOP_REPEAT:
+        r.out_len=mci_emit_repeated(out, out_size, r.out_len, o->n, o->a);
+        r.cur_col += o->n;
+        break;
+
+      case MOP_TOCOL:
+        if (o->n > r.cur_col)
+        {
+          int count=o->n - r.cur_col;
+          r.out_len=mci_emit_repeated(out, out_size, r.out_len, count, o->a);
+          r.cur_col += count;
+        }
+        break;
+
+      case MOP_CUREND:
+      case MOP_CURMID:
+      {
+        int w = usr.width ? usr.width : 80;
+        int col = (o->op==MOP_CUREND) ? w : (w + 1) / 2;
+        char csi[32];
+
+        snprintf(csi, sizeof(csi), "\x1b[%dG", col);
+        mci_out_append_str(out, out_size, &r.out_len, csi);
+        r.cur_col=col;
+        break;
+      }
+
+      case MOP_ROW:
+        mci_render_text(&r, t->pool + o->ofs, o->len);
+        current_line=(byte)o->n;
+        display_line=(byte)o->n;
+        break;
+
+      case MOP_PARAM:
+        if (g_lang_params && o->n < g_lang_params->count &&
+            g_lang_params->values[o->n])
+        {
+          char tmp[512];
+          snprintf(tmp, sizeof(tmp), "%s", g_lang_params->values[o->n]);
+          mci_render_value(&r, tmp);
+        }
+        else
+        {
+          r.pending_trim=-1;
+          r.pending_fmt=MCI_FMT_NONE;
+          r.pending_width=-1;
+          r.pending_pad_space=0;
+        }
+        break;
+
+      case MOP_STRING:
+      {
+        char tmp[512];
+        memcpy(tmp, t->pool + o->ofs, o->len + 1);
+        mci_render_value(&r, tmp);
+        break;
+      }
+
+      case MOP_CODE:
+      {
+        char val[256];
+
+        mci_expand_code(o->a, o->b, val, sizeof(val));
+
+        if (val[0] != '\0')
+        {
+          char tmp[512];
+          memcpy(tmp, val, strlen(val) + 1);
+          mci_render_value(&r, tmp);
+        }
+        else
+          mci_render_literal3(&r, o->a, o->b);
+        break;
+      }
+
+      case MOP_THEME:
+      {
+        const char *expansion = g_mci_theme ?
+          maxcfg_theme_lookup((const MaxCfgThemeColors *)g_mci_theme, o->a, o->b) : NULL;
+
+        if (expansion)
+          mci_out_append_str(out, out_size, &r.out_len, expansion);
+        else
+          mci_render_literal3(&r, o->a, o->b);
+        break;
+      }
+    }
+  }
+
+  return r.out_len;
+}
+
+/*
+ * Template cache for MciExpandCached().  A string is only compiled the
+ * second time it is seen, so one-off strings (a Printf() with a user's
+ * name in it, say) go straight to MciExpand() without paying for a
+ * compile.  The cache is direct-mapped on a hash of the string and the
+ * parse flags.
+ */
+
+#define MCI_TCACHE_SLOTS 512
+
+typedef struct
+{
+  unsigned long hash;   /* Hash of the last string seen in this slot */
+  size_t len;           /* ...its length */
+  MciTemplate *t;       /* Compiled template, or NULL if only seen once */
+} MciCacheSlot;
+
+static MciCacheSlot g_mci_tcache[MCI_TCACHE_SLOTS];
+static unsigned long g_mci_thits = 0;
+static unsigned long g_mci_tmisses = 0;
+
+/**
+ * @brief Expand a string through the template cache.
+ *
+ * Same result as MciExpand().
+ *
+ * @param in       Input string.
+ * @param out      Output buffer.
+ * @param out_size Size of output buffer in bytes.
+ * @return         Number of bytes written (excluding NUL terminator).
+ */
+size_t MciExpandCached(const char *in, char *out, size_t out_size)
+{
+  unsigned long h = 2166136261UL ^ g_mci_parse_flags;
+  const unsigned char *p;
+  MciCacheSlot *slot;
+  size_t len;
+
+  for (p = (const unsigned char *)in; *p; p++)
+    h = ((h ^ *p) * 16777619UL) & 0xffffffffUL;
+
+  len = (size_t)(p - (const unsigned char *)in);
+  slot = &g_mci_tcache[h % MCI_TCACHE_SLOTS];
+
+  if (slot->hash == h && slot->len == len)
+  {
+    if (slot->t && slot->t->flags == g_mci_parse_flags &&
+        memcmp(slot->t->src, in, len) == 0)
+    {
+      g_mci_thits++;
+      return MciRender(slot->t, out, out_size);
+    }
+
+    /* Second sighting: worth compiling */
+    if (slot->t == NULL && (slot->t = MciCompile(in, g_mci_parse_flags)) != NULL)
+    {
+      g_mci_tmisses++;
+      return MciRender(slot->t, out, out_size);
+    }
+  }
+
+  MciFreeTemplate(slot->t);
+  slot->t = NULL;
+  slot->hash = h;
+  slot->len = len;
+
+  g_mci_tmisses++;
+  return MciExpand(in, out, out_size);
+}
+
+/**
+ * @brief Return the number of MciExpandCached() calls served from (and
+ *        missed by) the template cache.
+ */
+void MciTemplateStats(unsigned long *hits, unsigned long *misses)
+{
+  if (hits)
+    *hits = g_mci_thits;
+
+  if (misses)
+    *misses = g_mci_tmisses;
+}
+
+/**
+ * @brief Discard all cached templates.
+ */
+void MciFlushTemplates(void)
+{
+  for (int i=0; i < MCI_TCACHE_SLOTS; i++)
+  {
+    MciFreeTemplate(g_mci_tcache[i].t);
+    memset(&g_mci_tcache[i], 0, sizeof(g_mci_tcache[i]));
+  }
+}
+
 /**
  * @brief Strip MCI-related sequences from a string.
  *
@@ -1131,7 +1963,7 @@ size_t MciStrip(const char *in, char *out, size_t out_size, unsigned long strip_
       }
     }
 
-    if (in[i]=='|' && (mci_is_upper2(in[i+1], in[i+2]) || (in[i+1]=='U' && in[i+2]=='#')))
+    if (in[i]=='|' && in[i+1] && (mci_is_upper2(in[i+1], in[i+2]) || (in[i+1]=='U' && in[i+2]=='#')))
     {
       if (strip_flags & MCI_STRIP_INFO)
       {
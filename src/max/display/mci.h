@@ -113,6 +113,56 @@ void MciPopParseFlags(void);
  */
 size_t MciExpand(const char *in, char *out, size_t out_size);
 
+/** @brief A string compiled by MciCompile(). */
+typedef struct mci_template MciTemplate;
+
+/**
+ * @brief Compile a string into a template which MciRender() can expand
+ *        without re-parsing it.
+ *
+ * @param in Input string.
+ * @param flags Parse flags (@c MCI_PARSE_*) to compile for.
+ * @return Template, or NULL if out of memory.  Free with MciFreeTemplate().
+ */
+MciTemplate *MciCompile(const char *in, unsigned long flags);
+
+/**
+ * @brief Expand a compiled template.
+ *
+ * Produces the same output as MciExpand() on the template's source string,
+ * using the current info codes, parameters, theme and cursor column.
+ *
+ * @param t Template from MciCompile().
+ * @param out Output buffer.
+ * @param out_size Size of @p out in bytes.
+ * @return Number of bytes written to @p out (excluding terminating NUL).
+ */
+size_t MciRender(const MciTemplate *t, char *out, size_t out_size);
+
+/**
+ * @brief Release a template from MciCompile().
+ */
+void MciFreeTemplate(MciTemplate *t);
+
+/**
+ * @brief MciExpand(), through a cache of compiled templates.
+ *
+ * Strings are compiled the second time they are seen with the same parse
+ * flags; one-off strings are expanded directly.
+ */
+size_t MciExpandCached(const char *in, char *out, size_t out_size);
+
+/**
+ * @brief Return the number of MciExpandCached() calls served from (and
+ *        missed by) the template cache.
+ */
+void MciTemplateStats(unsigned long *hits, unsigned long *misses);
+
+/**
+ * @brief Discard all cached templates.
+ */
+void MciFlushTemplates(void);
+
 /**
  * @brief Strip MCI-related sequences from a string.
  *
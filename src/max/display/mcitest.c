@@ -0,0 +1,258 @@
+/*
+ * mcitest.c — MCI template compiler differential test and benchmark
+ *
+ * Copyright 2026 by Kevin Morgan.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*# name=Stand-alone test for MciCompile()/MciRender()
+*/
+
+/* Built on its own with mci.c ("make mcicheck" in src/max), not linked   *
+ * into max.  The rest of Maximus is replaced by the few globals and      *
+ * functions that mci.c needs.                                            *
+ *                                                                        *
+ *   mcitest [cases]   Expand random strings built from MCI fragments     *
+ *                     with MciExpand(), MciRender(MciCompile()) and      *
+ *                     MciExpandCached(), and fail if any of them differ  *
+ *                     in output, length or cursor line.                  *
+ *   mcitest -b [n]    Time MciExpand() against MciExpandCached() on a    *
+ *                     few typical prompts.                               */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "libmaxcfg.h"
+#include "prog.h"
+#include "mm.h"
+#include "max_area.h"
+#include "mci.h"
+#include "theme.h"
+
+
+/* What mci.c uses from the rest of Maximus */
+
+struct _usr usr;
+char usrname[sizeof(usr.name)]="Bob Smith";
+long g_user_record_id=7;
+MAH mah;
+FAH fah;
+unsigned char current_col, current_line, display_line;
+
+signed int timeleft(void)
+{
+  return 42;
+}
+
+const char *ngcfg_get_string_raw(const char *toml_path)
+{
+  NW(toml_path);
+  return "TestBBS";
+}
+
+const char *theme_get_current_shortname(void)
+{
+  return "def";
+}
+
+const char *maxcfg_theme_lookup(const MaxCfgThemeColors *theme, char a, char b)
+{
+  NW(theme);
+
+  if (a=='p' && b=='r')
+    return "|07";
+
+  if (a=='h' && b=='i')
+    return "|15|17";
+
+  return NULL;
+}
+
+
+/* Fragments that random test strings are built from: every kind of      *
+ * code, plus truncated and malformed ones.                               */
+
+static const char *frag[]=
+{
+  "a", "Z", " ", "|", "||", "$", "$$",
+  "$L10", "$R05", "$C20", "$T03", "$l10.", "$r08*", "$c12-", "$D05=",
+  "$X30.", "$X02", "$L|TL", "$D|TL#", "$Q10", "$L1",
+  "|PD", "|[0", "|[1", "|[K", "|[<", "|[>", "|[H", "|[A02", "|[X10",
+  "|[Y05", "|[L20", "|[X|TL", "|[Z", "|[A1",
+  "|!1", "|!2", "|#3", "|!9", "|#F", "|&&",
+  "|pr", "|hi", "|zz",
+  "|CL", "|CR", "|BS", "|CD", "|LC", "|QQ", "|UN", "|BN", "|TL", "|U#",
+  "|{hello}", "|{ab", "}", "\r", "\n", "|07", "|15|17", "|XX",
+  "$L", "|[", "|!", "|{}"
+};
+
+#define N_FRAG (sizeof(frag)/sizeof(frag[0]))
+
+
+static int near DiffTest(long cases)
+{
+  static char a[8192], b[8192], c[8192], s[2048];
+  static const char *params[3]={"Alpha", "|15Bright", "  x  "};
+  MciLangParams lp;
+  MciTemplate *t;
+  unsigned long hits, misses;
+  long i;
+  int bad=0;
+
+  memset(&lp, 0, sizeof lp);
+  srand(1);
+
+  for (i=0; i < cases; i++)
+  {
+    size_t la, lb, lc, osz;
+    int n, k, r, l1, d1;
+    unsigned char col;
+
+    for (n=rand() % 12, s[0]='\0', k=0; k < n; k++)
+      strcat(s, frag[rand() % N_FRAG]);
+
+    lp.values[0]=params[0];
+    lp.values[1]=params[1];
+    lp.values[2]=params[2];
+    lp.count=rand() % 4;
+
+    g_lang_params=(rand() % 3) ? &lp : NULL;
+    g_mci_theme=(rand() % 2) ? (void *)&lp : NULL;
+    g_mci_parse_flags=(unsigned long)(rand() % 8);
+    usr.width=(rand() % 2) ? 0 : 132;
+
+    col=(unsigned char)(rand() % 40);
+    osz=(rand() % 4) ? sizeof a : (size_t)(rand() % 20 + 1);
+
+    current_col=col;
+    current_line=display_line=1;
+    la=MciExpand(s, a, osz);
+    l1=current_line;
+    d1=display_line;
+
+    t=MciCompile(s, g_mci_parse_flags);
+
+    current_col=col;
+    current_line=display_line=1;
+    lb=t ? MciRender(t, b, osz) : (size_t)-1;
+
+    MciFreeTemplate(t);
+
+    if (la != lb || memcmp(a, b, la+1) != 0 ||
+        l1 != current_line || d1 != display_line)
+    {
+      if (++bad <= 20)
+        printf("MciRender() differs: flags=%lu col=%d size=%lu [%s]\n"
+               "  expand=[%s]\n  render=[%s]\n",
+               g_mci_parse_flags, col, (unsigned long)osz, s, a, b);
+      continue;
+    }
+
+    /* The first calls miss the cache and later ones hit it */
+
+    for (r=0; r < 3; r++)
+    {
+      current_col=col;
+      current_line=display_line=1;
+      lc=MciExpandCached(s, c, osz);
+
+      if (lc != la || memcmp(a, c, la+1) != 0)
+      {
+        if (++bad <= 20)
+          printf("MciExpandCached() differs on call %d: [%s]\n", r+1, s);
+        break;
+      }
+    }
+  }
+
+  MciTemplateStats(&hits, &misses);
+  MciFlushTemplates();
+
+  printf("%ld cases, %d differ; template cache %lu hits, %lu misses\n",
+         cases, bad, hits, misses);
+
+  return bad != 0;
+}
+
+
+static double near NowNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec*1e9 + (double)ts.tv_nsec;
+}
+
+static int near Bench(long n)
+{
+  static const char *prompt[]=
+  {
+    "|pr$L20|UN |hiTime left: |TL mins|CR",
+    "|15Select: |07[|14A|07]rea  [|14M|07]sg  [|14F|07]ile  [|14G|07]oodbye|CR",
+    "$R30|{Message area} |pr$C10|!1|CD",
+    "Please enter your name: "
+  };
+  static char out[4096];
+  MciLangParams lp;
+  double t0, t1, t2;
+  size_t k;
+  long i;
+
+  memset(&lp, 0, sizeof lp);
+  lp.values[0]="General";
+  lp.count=1;
+
+  g_lang_params=&lp;
+  g_mci_theme=&lp;
+  g_mci_parse_flags=MCI_PARSE_ALL;
+
+  for (k=0; k < sizeof(prompt)/sizeof(prompt[0]); k++)
+  {
+    t0=NowNs();
+
+    for (i=0; i < n; i++)
+    {
+      current_col=1;
+      MciExpand(prompt[k], out, sizeof out);
+    }
+
+    t1=NowNs();
+
+    for (i=0; i < n; i++)
+    {
+      current_col=1;
+      MciExpandCached(prompt[k], out, sizeof out);
+    }
+
+    t2=NowNs();
+
+    printf("%-50.50s  expand %6.1f ns  cached %6.1f ns\n",
+           prompt[k], (t1-t0)/n, (t2-t1)/n);
+  }
+
+  MciFlushTemplates();
+  return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+  if (argc > 1 && strcmp(argv[1], "-b")==0)
+    return Bench(argc > 2 ? atol(argv[2]) : 1000000L);
+
+  return DiffTest(argc > 1 ? atol(argv[1]) : 200000L);
+}
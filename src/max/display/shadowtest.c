@@ -0,0 +1,457 @@
+/*
+ * shadowtest.c — Byte-count regression test for shadow buffer painting
+ *
+ * Copyright 2026 by Kevin Morgan.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*# name=Stand-alone byte-count test for ui_shadowbuf.c and ui_scroll.c
+*/
+
+/* Built on its own with ui_shadowbuf.c and ui_scroll.c ("make            *
+ * shadowcheck" in src/max), not linked into max.  The output layer is    *
+ * replaced by a small terminal that keeps an 80x25 screen and counts     *
+ * the bytes Maximus would send for each Putc(), Goto(), attribute change *
+ * and AVATAR run-length repeat.                                          *
+ *                                                                        *
+ * A few scripted sessions drive the text viewer and scrolling region.    *
+ * For each step the test compares the bytes sent and a hash of the       *
+ * emulated screen with the table below, for both ANSI and AVATAR         *
+ * callers.  It fails if the screen differs or if a step costs more       *
+ * bytes than it used to.  If a change sends fewer bytes, or is meant to  *
+ * change what is drawn, run "shadowtest -v" and update the table.        */
+
+#define MAX_INCL_COMMS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "prog.h"
+#include "keys.h"
+#include "mm.h"
+#include "ui_field.h"
+#include "ui_scroll.h"
+
+
+/* What the UI code uses from the rest of Maximus */
+
+struct _usr usr;
+char mdm_attr=-1;
+unsigned char current_line=1, current_col=1;
+word screen_clears;
+char rle_str[]="\x19%c%c";
+
+#define SCR_ROWS 25
+#define SCR_COLS 80
+
+static struct { char ch; byte attr; } scr[SCR_ROWS+1][SCR_COLS+1];
+static long bytes;
+
+static void near PutCell(char ch)
+{
+  if (current_line >= 1 && current_line <= SCR_ROWS &&
+      current_col >= 1 && current_col <= SCR_COLS)
+  {
+    scr[current_line][current_col].ch=ch;
+    scr[current_line][current_col].attr=(byte)mdm_attr;
+  }
+
+  if (++current_col > SCR_COLS)
+  {
+    current_col=1;
+
+    if (current_line < SCR_ROWS)
+      current_line++;
+  }
+}
+
+int TermWidth(void)
+{
+  return SCR_COLS;
+}
+
+byte Mci2Attr(const char *mci, byte base)
+{
+  NW(mci);
+  return base;
+}
+
+int ui_read_key(void)
+{
+  return 0;
+}
+
+void _fast vbuf_flush(void)
+{
+}
+
+void Putc(int ch)
+{
+  bytes++;
+  PutCell((char)ch);
+}
+
+/* The UI code only uses Printf() for rle_str */
+
+int _stdc Printf(char *fmt, ...)
+{
+  va_list va;
+
+  va_start(va, fmt);
+
+  if ((byte)fmt[0]==0x19)
+  {
+    int ch=va_arg(va, int);
+    int n=va_arg(va, int) & 0xff;
+
+    /* ANSI callers get the characters themselves */
+    bytes += (usr.video==GRAPH_AVATAR) ? 3 : n;
+
+    while (n--)
+      PutCell((char)ch);
+  }
+
+  va_end(va);
+  return 0;
+}
+
+void ui_goto(int row, int col)
+{
+  char buf[32];
+
+  if (usr.video==GRAPH_AVATAR)
+    bytes += 4;   /* goto_str */
+  else bytes += sprintf(buf, col==1 ? "\x1b[%dH" : "\x1b[%d;%dH", row, col);
+
+  current_line=(unsigned char)row;
+  current_col=(unsigned char)col;
+}
+
+void ui_set_attr(byte attr)
+{
+  char buf[64];
+
+  if (usr.video==GRAPH_AVATAR)
+    bytes += (attr & 0x80) ? 5 : 3;
+  else bytes += (mdm_attr==-1 ? 4 : 0) +
+                (long)strlen((char *)avt2ansi(attr, mdm_attr, buf));
+
+  mdm_attr=(char)attr;
+}
+
+
+
+/* The sessions */
+
+static void near ScreenClear(void)
+{
+  memset(scr, 0, sizeof scr);
+  current_line=current_col=1;
+  mdm_attr=7;
+  screen_clears++;
+  bytes=0;
+}
+
+static unsigned long near ScreenHash(void)
+{
+  unsigned long h=5381;
+  int r, c;
+
+  for (r=1; r <= SCR_ROWS; r++)
+    for (c=1; c <= SCR_COLS; c++)
+      h=(h*33 + (byte)scr[r][c].ch*7 + scr[r][c].attr) & 0xffffffffUL;
+
+  return h;
+}
+
+/* Build line i of some coloured text, with the odd blank and rule */
+
+static void near MakeLine(char *buf, int i)
+{
+  static const char *words[]={"the", "quick", "|brown", "fox", "jumps",
+                              "over", "lazy", "dog", "Maximus", "BBS",
+                              "FidoNet", "echomail", "netmail", "sysop"};
+  static const char colour[]={7, 15, 11, 14, 10, 12, 3};
+  int n=(i*7) % 11, p=0, k;
+
+  if (i % 9==0)
+    *buf='\0';
+  else if (i % 13==0)
+  {
+    memset(buf, '-', 60);
+    buf[60]='\0';
+  }
+  else for (k=0; k < n+3; k++)
+    p += sprintf(buf+p, "\x16\x01%c%s ", colour[(i+k) % 7], words[(i*3+k) % 14]);
+}
+
+
+struct _step
+{
+  const char *name;
+  long bytes[2];              /* Most bytes allowed: ANSI, AVATAR */
+  unsigned long hash;         /* Screen afterwards (same for both) */
+};
+
+/* Update with "shadowtest -v" when the output is meant to change */
+
+static const struct _step expect[]=
+{
+  {"viewer: first paint",   {  2466,    923}, 0x6c761002UL},
+  {"viewer: 30 x down",     { 38283,  25090}, 0xf10d9087UL},
+  {"viewer: 5 x pgdn",      {  6340,   4160}, 0x1d42cb96UL},
+  {"viewer: 10 x up",       { 12441,   8005}, 0xf4f449e4UL},
+  {"viewer: end",           {  1295,    812}, 0xd246416cUL},
+  {"viewer: home",          {  1230,    841}, 0x6c761002UL},
+  {"viewer: after cls",     {  2466,    923}, 0x6c761002UL},
+  {"chat: 40 appends",      { 28287,  17801}, 0x9794ae9cUL},
+  {"highlight: 40 moves",   { 18002,  11459}, 0x24430f25UL},
+};
+
+#define N_STEP (sizeof(expect)/sizeof(expect[0]))
+
+static long got_bytes[N_STEP];
+static unsigned long got_hash[N_STEP];
+static int n_step;
+static int fStepBad=FALSE;
+
+/* Record the bytes sent since the last step, and the screen */
+
+static void near Step(const char *name)
+{
+  if (n_step < (int)N_STEP && strcmp(name, expect[n_step].name)==0)
+  {
+    got_bytes[n_step]=bytes;
+    got_hash[n_step]=ScreenHash();
+    n_step++;
+  }
+  else
+  {
+    printf("FAILED: step \"%s\" is not in the table\n", name);
+    fStepBad=TRUE;
+  }
+
+  bytes=0;
+}
+
+
+/* A full-screen text viewer, paged around */
+
+static void near ViewerSession(void)
+{
+  ui_text_viewer_t v;
+  ui_text_viewer_style_t st;
+  char line[1024];
+  char *text;
+  long sum;
+  int i, p;
+
+  if ((text=malloc(300*1024))==NULL)
+    return;
+
+  for (i=0, p=0; i < 300; i++)
+  {
+    MakeLine(line, i);
+    p += sprintf(text+p, "%s\n", line);
+  }
+
+  ScreenClear();
+  ui_text_viewer_style_default(&st);
+  ui_text_viewer_init(&v, 1, 2, 79, 23, &st);
+  ui_text_viewer_set_text(&v, text);
+
+  ui_text_viewer_render(&v);
+  Step("viewer: first paint");
+
+  for (i=0, sum=0; i < 30; i++, sum += bytes, bytes=0)
+    if (ui_text_viewer_handle_key(&v, K_DOWN))
+      ui_text_viewer_render(&v);
+
+  bytes=sum;
+  Step("viewer: 30 x down");
+
+  for (i=0, sum=0; i < 5; i++, sum += bytes, bytes=0)
+    if (ui_text_viewer_handle_key(&v, K_PGDN))
+      ui_text_viewer_render(&v);
+
+  bytes=sum;
+  Step("viewer: 5 x pgdn");
+
+  for (i=0, sum=0; i < 10; i++, sum += bytes, bytes=0)
+    if (ui_text_viewer_handle_key(&v, K_UP))
+      ui_text_viewer_render(&v);
+
+  bytes=sum;
+  Step("viewer: 10 x up");
+
+  ui_text_viewer_handle_key(&v, K_END);
+  ui_text_viewer_render(&v);
+  Step("viewer: end");
+
+  ui_text_viewer_handle_key(&v, K_HOME);
+  ui_text_viewer_render(&v);
+  Step("viewer: home");
+
+  ScreenClear();
+  ui_text_viewer_render(&v);
+  Step("viewer: after cls");
+
+  ui_text_viewer_free(&v);
+  free(text);
+}
+
+
+/* A chat-style scrolling region, one line appended at a time */
+
+static void near ChatSession(void)
+{
+  ui_scrolling_region_t r;
+  ui_scrolling_region_style_t st;
+  char line[1024];
+  long sum=0;
+  int i;
+
+  ScreenClear();
+  ui_scrolling_region_style_default(&st);
+  st.flags |= UI_SCROLL_REGION_SHOW_SCROLLBAR | UI_SCROLL_REGION_AUTO_FOLLOW;
+  ui_scrolling_region_init(&r, 1, 5, 78, 15, 500, &st);
+
+  for (i=0; i < 40; i++, sum += bytes, bytes=0)
+  {
+    MakeLine(line, i+5);
+    ui_scrolling_region_append(&r, line, UI_SCROLL_APPEND_DEFAULT);
+    ui_scrolling_region_render(&r);
+  }
+
+  bytes=sum;
+  Step("chat: 40 appends");
+
+  ui_scrolling_region_free(&r);
+}
+
+
+/* A highlight bar moved down and back up a scrolling region, the way    *
+ * the quote popup does it: the region is rendered, one row's attributes *
+ * are changed in the shadow buffer and that row is painted again.  This *
+ * does not use ui_lightbar.c.                                           */
+
+static void near HighlightSession(void)
+{
+  ui_scrolling_region_t r;
+  ui_scrolling_region_style_t st;
+  char line[1024];
+  long sum=0;
+  int i, k, hl, c;
+
+  ScreenClear();
+  ui_scrolling_region_style_default(&st);
+  st.flags |= UI_SCROLL_REGION_SHOW_SCROLLBAR;
+  ui_scrolling_region_init(&r, 3, 15, 70, 8, 500, &st);
+
+  for (i=0; i < 60; i++)
+  {
+    MakeLine(line, i);
+    ui_scrolling_region_append(&r, line, UI_SCROLL_APPEND_NOFOLLOW);
+  }
+
+  r.view_top=0;
+
+  for (k=0; k < 40; k++, sum += bytes, bytes=0)
+  {
+    hl=(k < 25) ? k : 50-k;
+
+    if (hl < r.view_top)
+      r.view_top=hl;
+    else if (hl >= r.view_top+8)
+      r.view_top=hl-7;
+
+    ui_scrolling_region_render(&r);
+
+    for (c=0; c < r.sb.width; c++)
+      r.sb.cells[(hl-r.view_top)*r.sb.width + c].attr=0x1f;
+
+    ui_shadowbuf_paint_region(&r.sb, r.x, r.y, 1, hl-r.view_top+1,
+                              r.sb.width, hl-r.view_top+1);
+  }
+
+  bytes=sum;
+  Step("highlight: 40 moves");
+
+  ui_scrolling_region_free(&r);
+}
+
+
+int main(int argc, char *argv[])
+{
+  static const char *mode[2]={"ansi", "avatar"};
+  static const byte video[2]={GRAPH_ANSI, GRAPH_AVATAR};
+  long got[2][N_STEP];
+  unsigned long hash[2][N_STEP];
+  int verbose=(argc > 1 && strcmp(argv[1], "-v")==0);
+  int failed=0;
+  int m, i;
+
+  for (m=0; m < 2; m++)
+  {
+    memset(&usr, 0, sizeof usr);
+    usr.video=video[m];
+    n_step=0;
+
+    ViewerSession();
+    ChatSession();
+    HighlightSession();
+
+    if (fStepBad || n_step != (int)N_STEP)
+    {
+      printf("FAILED: %d steps, expected %d\n", n_step, (int)N_STEP);
+      return 1;
+    }
+
+    memcpy(got[m], got_bytes, sizeof got_bytes);
+    memcpy(hash[m], got_hash, sizeof got_hash);
+  }
+
+  printf("%-24s %8s %8s  %s\n", "step", mode[0], mode[1], "screen");
+
+  for (i=0; i < (int)N_STEP; i++)
+  {
+    const char *why=NULL;
+
+    if (hash[0][i] != hash[1][i])
+      why="screen differs between ANSI and AVATAR";
+    else if (hash[0][i] != expect[i].hash)
+      why="screen differs";
+    else if (got[0][i] > expect[i].bytes[0] || got[1][i] > expect[i].bytes[1])
+      why="more bytes than before";
+
+    if (verbose)
+    {
+      char name[40];
+
+      sprintf(name, "\"%s\",", expect[i].name);
+      printf("  {%-24s {%6ld, %6ld}, 0x%08lxUL},\n",
+             name, got[0][i], got[1][i], hash[0][i]);
+    }
+    else
+      printf("%-24s %8ld %8ld  %08lx%s%s\n", expect[i].name, got[0][i],
+             got[1][i], hash[0][i], why ? "  FAILED: " : "", why ? why : "");
+
+    if (why)
+      failed=1;
+  }
+
+  return failed;
+}
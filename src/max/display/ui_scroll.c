@@ -526,7 +526,7 @@ void ui_scrolling_region_render(ui_scrolling_region_t *r)
     r->last_thumb_len = thumb_len;
   }
 
-  ui_shadowbuf_paint_region(&r->sb, r->x, r->y, 1, 1, r->sb.width, r->sb.height);
+  ui_shadowbuf_present(&r->sb, r->x, r->y);
 }
 
 /**
@@ -977,7 +977,7 @@ void ui_text_viewer_render(ui_text_viewer_t *v)
   if (v->style.flags & UI_TBV_SHOW_STATUS)
     ui_text_viewer_render_status(v);
 
-  ui_shadowbuf_paint_region(&v->sb, v->x, v->y, 1, 1, v->sb.width, v->sb.height);
+  ui_shadowbuf_present(&v->sb, v->x, v->y);
 }
 
 /**
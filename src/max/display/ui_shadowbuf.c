@@ -204,6 +204,9 @@ void ui_shadowbuf_free(ui_shadowbuf_t *b)
   if (b->cells)
     free(b->cells);
 
+  if (b->front)
+    free(b->front);
+
   memset(b, 0, sizeof(*b));
 }
 
@@ -810,8 +813,235 @@ void ui_shadowbuf_paint_region(const ui_shadowbuf_t *b, int screen_x, int screen
       }
 
       Putc((int)b->cells[idx].ch);
+
+      /* Keep ui_shadowbuf_present()'s idea of the screen up to date */
+      if (b->front && b->front_valid && b->front_x == screen_x && b->front_y == screen_y)
+        b->front[idx] = b->cells[idx];
     }
   }
 
   vbuf_flush();
 }
+
+/**
+ * @brief Number of decimal digits in a screen coordinate.
+ */
+static int near ui_shadowbuf_digits(int n)
+{
+  return (n >= 100) ? 3 : (n >= 10) ? 2 : 1;
+}
+
+/**
+ * @brief Bytes the output layer sends for Goto(row, col).
+ */
+static int near ui_shadowbuf_goto_cost(int row, int col)
+{
+  /* goto_str: ^V ^H row col */
+  if (usr.video != GRAPH_ANSI)
+    return 4;
+
+  /* ansi_goto1 / ansi_goto */
+  return ui_shadowbuf_digits(row) + ((col == 1) ? 3 : 4 + ui_shadowbuf_digits(col));
+}
+
+/**
+ * @brief Bytes the output layer sends to change from attribute old to nw.
+ *
+ * @param old Current attribute, or -1 if unknown.
+ */
+static int near ui_shadowbuf_attr_cost(int nw, int old)
+{
+  char ansi[32];
+
+  if (nw == old)
+    return 0;
+
+  if (usr.video != GRAPH_ANSI)
+    return (nw & 0x80) ? 5 : 3;
+
+  return ((old == -1) ? 4 : 0) + (int)strlen((char *)avt2ansi(nw, old, ansi));
+}
+
+/**
+ * @brief Decide whether re-sending the unchanged cells in front of a
+ *        changed cell is cheaper than a Goto() to it.
+ *
+ * @param b     Shadow buffer.
+ * @param idx   Index of the first unchanged cell.
+ * @param gap   Number of unchanged cells before the changed one.
+ * @param attr  Current attribute, or -1 if unknown.
+ * @param row   Screen row of the changed cell.
+ * @param col   Screen column of the changed cell.
+ * @return      Non-zero to re-send the gap.
+ */
+static int near ui_shadowbuf_gap_cheaper(const ui_shadowbuf_t *b, int idx, int gap, int attr, int row, int col)
+{
+  int want = (int)b->cells[idx + gap].attr & 0xFF;
+  int limit = ui_shadowbuf_goto_cost(row, col) + ui_shadowbuf_attr_cost(want, attr);
+  int cost = 0;
+  int i;
+
+  for (i = 0; i < gap && cost <= limit; i++)
+  {
+    int a = (int)b->cells[idx + i].attr & 0xFF;
+
+    cost += ui_shadowbuf_attr_cost(a, attr) + 1;
+    attr = a;
+  }
+
+  return (cost + ui_shadowbuf_attr_cost(want, attr)) <= limit;
+}
+
+/**
+ * @brief Send one run of cells, tracking the remote cursor and attribute.
+ *
+ * @param b         Shadow buffer.
+ * @param idx       Index of the first cell.
+ * @param count     Number of cells.
+ * @param sx        Screen column of the first cell.
+ * @param cur_col   Remote cursor column (-1 once unknown).
+ * @param cur_attr  Remote attribute (-1 if unknown).
+ */
+static void near ui_shadowbuf_send(const ui_shadowbuf_t *b, int idx, int count, int sx, int *cur_col, int *cur_attr)
+{
+  int tw = TermWidth();
+
+  while (count > 0)
+  {
+    char ch = b->cells[idx].ch;
+    int a = (int)b->cells[idx].attr & 0xFF;
+    int k;
+
+    for (k = 1; k < count && k < 255 &&
+                b->cells[idx + k].ch == ch && b->cells[idx + k].attr == b->cells[idx].attr; k++)
+      ;
+
+    if (*cur_attr != a)
+    {
+      ui_set_attr((byte)a);
+      *cur_attr = a;
+    }
+
+    if (k >= 4 && (byte)ch >= ' ')
+      Printf(rle_str, ch, k);
+    else
+    {
+      int i;
+
+      for (i = 0; i < k; i++)
+        Putc((int)ch);
+    }
+
+    /* The output layer wraps after the last column; don't guess where */
+    sx += k;
+    *cur_col = (sx > tw) ? -1 : sx;
+
+    idx += k;
+    count -= k;
+  }
+}
+
+/**
+ * @brief Paint the cells which differ from what the terminal shows.
+ *
+ * @param b        Shadow buffer.
+ * @param screen_x Screen column (1-indexed) where buffer column 1 should paint.
+ * @param screen_y Screen row (1-indexed) where buffer row 1 should paint.
+ */
+void ui_shadowbuf_present(ui_shadowbuf_t *b, int screen_x, int screen_y)
+{
+  int n;
+  int full;
+  int rr;
+  int cc;
+  int cur_row;
+  int cur_col;
+  int cur_attr;
+
+  if (!b || !b->cells)
+    return;
+
+  n = b->width * b->height;
+
+  /* Without cursor positioning there is nothing to be gained */
+  if (!usr.video ||
+      (!b->front && (b->front = (ui_shadow_cell_t *)malloc((size_t)n * sizeof(ui_shadow_cell_t))) == NULL))
+  {
+    ui_shadowbuf_paint_region(b, screen_x, screen_y, 1, 1, b->width, b->height);
+    return;
+  }
+
+  full = (!b->front_valid || b->front_x != screen_x || b->front_y != screen_y ||
+          b->front_gen != screen_clears);
+
+  cur_row = current_line;
+  cur_col = current_col;
+  cur_attr = (mdm_attr == -1) ? -1 : (int)(byte)mdm_attr;
+
+  for (rr = 1; rr <= b->height; rr++)
+  {
+    int sy = screen_y + (rr - 1);
+
+    for (cc = 1; cc <= b->width; )
+    {
+      int idx = ui_shadowbuf_idx(b, rr, cc);
+      int sx = screen_x + (cc - 1);
+      int end;
+
+      if (!full && b->cells[idx].ch == b->front[idx].ch && b->cells[idx].attr == b->front[idx].attr)
+      {
+        cc++;
+        continue;
+      }
+
+      /* Find the end of this run of changed cells */
+      for (end = cc + 1; end <= b->width; end++)
+      {
+        int j = idx + (end - cc);
+
+        if (!full && b->cells[j].ch == b->front[j].ch && b->cells[j].attr == b->front[j].attr)
+          break;
+      }
+
+      if (cur_row != sy || cur_col != sx)
+      {
+        int gap = sx - cur_col;
+
+        /* Re-send the unchanged cells between here and the cursor, or Goto() */
+        if (cur_row == sy && cur_col >= screen_x && gap > 0 &&
+            ui_shadowbuf_gap_cheaper(b, idx - gap, gap, cur_attr, sy, sx))
+          ui_shadowbuf_send(b, idx - gap, gap, cur_col, &cur_col, &cur_attr);
+        else
+        {
+          ui_goto(sy, sx);
+          cur_row = sy;
+          cur_col = sx;
+        }
+      }
+
+      ui_shadowbuf_send(b, idx, end - cc, sx, &cur_col, &cur_attr);
+      cc = end;
+    }
+  }
+
+  memcpy(b->front, b->cells, (size_t)n * sizeof(ui_shadow_cell_t));
+  b->front_valid = 1;
+  b->front_x = screen_x;
+  b->front_y = screen_y;
+  b->front_gen = screen_clears;
+
+  vbuf_flush();
+}
+
+/**
+ * @brief Force the next ui_shadowbuf_present() to repaint everything.
+ *
+ * @param b Shadow buffer.
+ */
+void ui_shadowbuf_invalidate(ui_shadowbuf_t *b)
+{
+  if (!b)
+    return;
+
+  b->front_valid = 0;
+}
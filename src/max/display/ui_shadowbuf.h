@@ -80,6 +80,13 @@ typedef struct ui_shadowbuf
   byte current_attr;
 
   ui_shadow_cell_t *cells;
+
+  /* Front buffer: what ui_shadowbuf_present() last sent to the terminal */
+  ui_shadow_cell_t *front;
+  int front_valid;
+  int front_x;     /* Screen position it was sent to */
+  int front_y;
+  word front_gen;  /* screen_clears at the time */
 } ui_shadowbuf_t;
 
 /**
@@ -203,4 +210,29 @@ void ui_shadowbuf_overlay_pop(ui_shadowbuf_t *b, ui_shadow_overlay_t *ov);
  */
 void ui_shadowbuf_paint_region(const ui_shadowbuf_t *b, int screen_x, int screen_y, int left, int top, int right, int bottom);
 
+/**
+ * @brief Paint only what has changed since the last call.
+ *
+ * Keeps a front buffer of what the terminal is showing and sends only the
+ * cells which differ from it.  The cursor is moved with Goto() or by
+ * re-sending the unchanged cells in between, whichever is fewer bytes;
+ * attributes are only sent when they change, and runs of one character
+ * are sent with AVATAR RLE.
+ *
+ * The whole buffer is painted on the first call, if the buffer is painted
+ * somewhere else on screen, or if the screen has been cleared since.
+ * Callers which draw over the area by other means must call
+ * ui_shadowbuf_invalidate() to get a full repaint.
+ *
+ * @param screen_x Screen column (1-indexed) where buffer column 1 should paint.
+ * @param screen_y Screen row (1-indexed) where buffer row 1 should paint.
+ */
+void ui_shadowbuf_present(ui_shadowbuf_t *b, int screen_x, int screen_y);
+
+/**
+ * @brief Forget what the terminal is showing, so that the next
+ *        ui_shadowbuf_present() repaints the whole buffer.
+ */
+void ui_shadowbuf_invalidate(ui_shadowbuf_t *b);
+
 #endif /* __UI_SHADOWBUF_H_DEFINED */
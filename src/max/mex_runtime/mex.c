@@ -118,6 +118,7 @@ static struct _usrfunc _intrinfunc[]=
   {"json_array_push_str",     intrin_json_array_push_str,      0},
   {"json_bool",               intrin_json_bool,                0},
   {"json_close",              intrin_json_close,               0},
+  {"json_compile",            intrin_json_compile,             0},
   {"json_count",              intrin_json_count,               0},
   {"json_create",             intrin_json_create,              0},
   {"json_create_array",       intrin_json_create_array,        0},
@@ -133,12 +134,27 @@ static struct _usrfunc _intrinfunc[]=
   {"json_next",               intrin_json_next,                0},
   {"json_num",                intrin_json_num,                 0},
   {"json_open",               intrin_json_open,                0},
+  {"json_path_bool",          intrin_json_path_bool,           0},
+  {"json_path_count",         intrin_json_path_count,          0},
+  {"json_path_free",          intrin_json_path_free,           0},
+  {"json_path_num",           intrin_json_path_num,            0},
+  {"json_path_str",           intrin_json_path_str,            0},
+  {"json_path_type",          intrin_json_path_type,           0},
   {"json_rewind",             intrin_json_rewind,              0},
   {"json_serialize",          intrin_json_serialize,           0},
   {"json_set_bool",           intrin_json_set_bool,            0},
   {"json_set_num",            intrin_json_set_num,             0},
   {"json_set_str",            intrin_json_set_str,             0},
   {"json_str",                intrin_json_str,                 0},
+  {"json_stream_bool",        intrin_json_stream_bool,         0},
+  {"json_stream_close",       intrin_json_stream_close,        0},
+  {"json_stream_depth",       intrin_json_stream_depth,        0},
+  {"json_stream_key",         intrin_json_stream_key,          0},
+  {"json_stream_next",        intrin_json_stream_next,         0},
+  {"json_stream_num",         intrin_json_stream_num,          0},
+  {"json_stream_open",        intrin_json_stream_open,         0},
+  {"json_stream_skip",        intrin_json_stream_skip,         0},
+  {"json_stream_str",         intrin_json_stream_str,          0},
   {"json_type",               intrin_json_type,                0},
   {"kbhit",                   intrin_kbhit,                   0},
   {"keyboard",                intrin_keyboard,                0},
@@ -187,10 +203,12 @@ static struct _usrfunc _intrinfunc[]=
   {"snoop",                   intrin_snoop,                   0},
   {"sock_avail",              intrin_sock_avail,              0},
   {"sock_close",              intrin_sock_close,              0},
+  {"sock_nonblock",           intrin_sock_nonblock,           0},
   {"sock_open",               intrin_sock_open,               0},
   {"sock_recv",               intrin_sock_recv,               0},
   {"sock_send",               intrin_sock_send,               0},
   {"sock_status",             intrin_sock_status,             0},
+  {"sock_wait",               intrin_sock_wait,               0},
   {"stamp_string",            intrin_stamp_string,            0},
   {"stamp_to_long",           intrin_stamp_to_long,           0},
   {"strfind",                 intrin_strfind,                 0},
@@ -366,11 +384,15 @@ int EXPENTRY intrin_setup(void)
   pmis->vmaMsg   = EnterSymtabBlank("msg",   sizeof(struct mex_msg));
   pmis->vmaSys   = EnterSymtabBlank("sys",   sizeof(struct mex_sys));
 
-  /* Fill out the USER structure */
+  /* Fill out the USER structure.  This is only worth doing if the
+   * program refers to 'usr'; otherwise, it can't see or change it.
+   */
 
   pmis->pmu=MexDSEG(pmis->vmaUser);
   memset(pmis->pmu, '\0', sizeof(struct mex_usr));
-  MexExportUser(pmis->pmu, &usr);
+
+  if (MexSymbolUsed("usr"))
+    MexBindUser(pmis);
 
   /* Fill out the mex_instancedata structure */
 
@@ -402,11 +424,13 @@ int EXPENTRY intrin_setup(void)
 
   /* Fill out the "marea" structure */
 
-  MexStoreMarea(MexDSEG(pmis->vmaMarea), &mah);
+  if (MexSymbolUsed("marea"))
+    MexStoreMarea(MexDSEG(pmis->vmaMarea), &mah);
 
   /* Fill out the "farea" structure */
 
-  MexStoreFarea(MexDSEG(pmis->vmaFarea), &fah);
+  if (MexSymbolUsed("farea"))
+    MexStoreFarea(MexDSEG(pmis->vmaFarea), &fah);
 
   /* Fill out the "msg" structure */
 
@@ -454,10 +478,14 @@ int EXPENTRY intrin_setup(void)
 
 void MexImportData(struct _mex_instance_stack *pmis)
 {
-  MexImportUser(pmis->pmu, &usr);
-  SetUserName(&usr, usrname);
-  Set_Lang_Alternate(hasRIP());
-  Find_Class_Number();
+  if (MexUserDirty(pmis))
+  {
+    MexImportUser(pmis->pmu, &usr);
+    SetUserName(&usr, usrname);
+    Set_Lang_Alternate(hasRIP());
+    Find_Class_Number();
+  }
+
   MexImportString(linebuf, pmis->vmaLinebuf, BUFLEN);
   mex_newuser_answered_mask=pmis->pmid->newuser_answered_mask;
 }
@@ -477,10 +505,106 @@ void MexImportData(struct _mex_instance_stack *pmis)
 void MexExportData(struct _mex_instance_stack *pmis)
 {
   MexExportString(pmis->vmaLinebuf, linebuf);
-  MexExportUser(pmis->pmu, &usr);
+
+  if (pmis->fUserBound)
+    MexBindUser(pmis);
+
   pmis->pmid->newuser_answered_mask=mex_newuser_answered_mask;
 }
 
+/* Offsets of the string fields in struct mex_usr */
+
+static size_t mex_usr_str[]=
+{
+  offsetof(struct mex_usr, name),
+  offsetof(struct mex_usr, city),
+  offsetof(struct mex_usr, alias),
+  offsetof(struct mex_usr, phone),
+  offsetof(struct mex_usr, pwd),
+  offsetof(struct mex_usr, dataphone),
+  offsetof(struct mex_usr, xkeys),
+  offsetof(struct mex_usr, msg),
+  offsetof(struct mex_usr, files),
+  offsetof(struct mex_usr, dob)
+};
+
+#define N_MEX_USR_STR (sizeof(mex_usr_str)/sizeof(mex_usr_str[0]))
+
+
+/* Take a copy of the user record in the MEX data space, followed by the
+ * contents of its strings (since a program can change those in place).
+ */
+
+static char * near MexUserImage(struct mex_usr *pmu, unsigned *pcb)
+{
+  char *pcImg, *pc, *s;
+  unsigned cb=sizeof *pmu;
+  int i;
+
+  for (i=0; i < N_MEX_USR_STR; i++)
+  {
+    s=MexFetch(FormString, (IADDR *)((char *)pmu + mex_usr_str[i]));
+    cb += sizeof(word) + *(word *)s;
+  }
+
+  if ((pcImg=malloc(cb))==NULL)
+    return NULL;
+
+  memcpy(pcImg, pmu, sizeof *pmu);
+  pc=pcImg + sizeof *pmu;
+
+  for (i=0; i < N_MEX_USR_STR; i++)
+  {
+    s=MexFetch(FormString, (IADDR *)((char *)pmu + mex_usr_str[i]));
+    memcpy(pc, s, sizeof(word) + *(word *)s);
+    pc += sizeof(word) + *(word *)s;
+  }
+
+  *pcb=cb;
+  return pcImg;
+}
+
+
+/* Export the current user into this instance's 'usr' and remember what
+ * it looked like, so that we can tell later if the program changed it.
+ */
+
+void MexBindUser(struct _mex_instance_stack *pmis)
+{
+  unsigned cb=0;
+
+  MexExportUser(pmis->pmu, &usr);
+
+  if (pmis->pcUserImage)
+    free(pmis->pcUserImage);
+
+  pmis->pcUserImage=MexUserImage(pmis->pmu, &cb);
+  pmis->cbUserImage=cb;
+  pmis->fUserBound=TRUE;
+}
+
+
+/* Returns TRUE if 'usr' needs to be imported back into Maximus */
+
+int MexUserDirty(struct _mex_instance_stack *pmis)
+{
+  char *pcImg;
+  unsigned cb;
+  int rc;
+
+  if (!pmis->fUserBound)
+    return FALSE;
+
+  if (!pmis->pcUserImage || (pcImg=MexUserImage(pmis->pmu, &cb))==NULL)
+    return TRUE;
+
+  rc=(cb != pmis->cbUserImage || memcmp(pcImg, pmis->pcUserImage, cb) != 0);
+
+  free(pcImg);
+  return rc;
+}
+
+
 void MexSetNewUserAnsweredMask(dword mask)
 {
   mex_newuser_answered_mask=mask;
@@ -814,9 +938,13 @@ void EXPENTRY intrin_term(short *psRet)
   strcpy(szOldFile, usr.files);
 
 
-  /* Import the current user structure */
+  /* Import the current user structure, if the program changed it */
 
-  MexImportUser(pmis->pmu, &usr);
+  if (MexUserDirty(pmis))
+    MexImportUser(pmis->pmu, &usr);
+
+  if (pmis->pcUserImage)
+    free(pmis->pcUserImage);
 
   /* Handle changes to the lastread pointer and reading direction */
 
@@ -947,6 +1075,11 @@ int MexStartupIntrin(char *pszFile, char *pszArgs, dword fFlag)
 
     cMexInvoked++;
 
+    /* Let the sysop find the hot spots in their MEX programs */
+
+    if (ngcfg_get_bool("maximus.mex_profile"))
+      fFlag |= VMF_PROFILE;
+
     rc=MexExecute(pszFile, pszArgs, fFlag, N_INTRINFUNC, _intrinfunc,
                   intrin_setup, intrin_term, MexLog,
                   intrin_hook_before, intrin_hook_after);
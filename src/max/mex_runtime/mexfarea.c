@@ -151,8 +151,11 @@
     {
       fileareaexport(MexDSEG(pmisThis->vmaFarea), &fah);
       SetAreaName(usr.files, FAS(fah, name));
-      MexKillStructString(mex_usr, pmisThis->pmu, files);
-      StoreString(MexPtrToVM(pmisThis->pmu), struct mex_usr, files, FAS(fah,name));
+      if (pmisThis->fUserBound)
+      {
+        MexKillStructString(mex_usr, pmisThis->pmu, files);
+        StoreString(MexPtrToVM(pmisThis->pmu), struct mex_usr, files, FAS(fah,name));
+      }
     }
     return 0;
   }
@@ -208,8 +211,11 @@
           fileareaexport(MexDSEG(pmisThis->vmaFarea), &myfah);
           strcpy(usr.files, FAS(myfah,name));
           regs_2[0]=TRUE;
-          MexKillStructString(mex_usr, pmisThis->pmu, files);
-          StoreString(MexPtrToVM(pmisThis->pmu), struct mex_usr, files, FAS(myfah,name));
+          if (pmisThis->fUserBound)
+          {
+            MexKillStructString(mex_usr, pmisThis->pmu, files);
+            StoreString(MexPtrToVM(pmisThis->pmu), struct mex_usr, files, FAS(myfah,name));
+          }
         }
         AreaFileFindClose(pmisThis->hafFile);
         pmisThis->hafFile=0;
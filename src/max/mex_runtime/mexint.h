@@ -262,6 +262,26 @@
   word EXPENTRY intrin_json_array_push_num(void);
   word EXPENTRY intrin_json_serialize(void);
 
+  /* JSON compiled paths */
+  word EXPENTRY intrin_json_compile(void);
+  word EXPENTRY intrin_json_path_free(void);
+  word EXPENTRY intrin_json_path_str(void);
+  word EXPENTRY intrin_json_path_num(void);
+  word EXPENTRY intrin_json_path_bool(void);
+  word EXPENTRY intrin_json_path_type(void);
+  word EXPENTRY intrin_json_path_count(void);
+
+  /* JSON streaming parser */
+  word EXPENTRY intrin_json_stream_open(void);
+  word EXPENTRY intrin_json_stream_next(void);
+  word EXPENTRY intrin_json_stream_skip(void);
+  word EXPENTRY intrin_json_stream_key(void);
+  word EXPENTRY intrin_json_stream_str(void);
+  word EXPENTRY intrin_json_stream_num(void);
+  word EXPENTRY intrin_json_stream_bool(void);
+  word EXPENTRY intrin_json_stream_depth(void);
+  word EXPENTRY intrin_json_stream_close(void);
+
   /* JSON cleanup — called from intrin_term() */
   void MexJsonCleanup(void);
 
@@ -272,6 +292,8 @@
   word EXPENTRY intrin_sock_recv(void);
   word EXPENTRY intrin_sock_status(void);
   word EXPENTRY intrin_sock_avail(void);
+  word EXPENTRY intrin_sock_nonblock(void);
+  word EXPENTRY intrin_sock_wait(void);
   word EXPENTRY intrin_http_request(void);
 
   /* Socket cleanup/init — called from intrin_term() and startup */
@@ -34,6 +34,11 @@
 
 #define MAX_MEXJSON    16   /**< Maximum concurrent JSON handles          */
 #define MAX_JSON_DEPTH 16   /**< Maximum cursor nesting depth             */
+#define MAX_JSON_INDEX  8   /**< Indexed containers kept per handle       */
+#define JSON_INDEX_MIN 16   /**< Index containers with this many children */
+#define MAX_MEXJSONPATH 16  /**< Maximum compiled path handles            */
+#define MAX_MEXJSONSTREAM 4 /**< Maximum concurrent stream parsers        */
+#define MAX_JSON_STREAM_DEPTH 64 /**< Maximum nesting in a streamed doc   */
 
 /* JSON type constants — must match json.mh */
 #define MEX_JSON_NULL     0
@@ -45,19 +50,89 @@
 #define MEX_JSON_END     -1
 #define MEX_JSON_INVALID -2
 
+/* Stream events beyond the type constants — must match json.mh */
+#define MEX_JSON_ARRAY_END   6
+#define MEX_JSON_OBJECT_END  7
+
+/* Index of a [] step in a compiled path: supplied at lookup time */
+#define JSON_STEP_VAR    -1
+
 /*------------------------------------------------------------------------*
  * Handle table                                                           *
  *------------------------------------------------------------------------*/
 
+/**
+ * Lookup table for one large array or object.
+ *
+ * cJSON keeps children in a linked list, so "items[500]" walks 500 nodes
+ * and a member lookup compares every key. Containers with at least
+ * JSON_INDEX_MIN children get a table of child pointers (and, for objects,
+ * a hash of the keys) the first time they are searched.
+ */
+typedef struct _mex_json_index {
+    cJSON    *node;                       /**< Container, NULL = unused    */
+    int       count;                      /**< Number of children          */
+    cJSON   **item;                       /**< Children in document order  */
+    int      *hash;                       /**< Objects: item numbers by key
+                                               hash, -1 = empty bucket     */
+    int       n_hash;                     /**< Buckets (power of two)      */
+    unsigned  last_use;
+} MEX_JSON_INDEX;
+
 /** Per-handle state: parsed tree + cursor + parent stack. */
 typedef struct _mex_json {
     cJSON  *root;                         /**< Parsed tree root            */
     cJSON  *cursor;                       /**< Current cursor position     */
     cJSON  *stack[MAX_JSON_DEPTH];        /**< Parent stack for enter/exit */
     int     depth;                        /**< Current nesting depth       */
+    unsigned gen;                         /**< Changes with the tree shape */
+    MEX_JSON_INDEX index[MAX_JSON_INDEX]; /**< Large-container indexes     */
+    unsigned index_use;
 } MEX_JSON;
 
 static MEX_JSON g_mex_json[MAX_MEXJSON];
+static unsigned g_json_gen = 0;
+
+/** One step of a compiled path. */
+typedef struct _mex_json_step {
+    char *key;                            /**< Member name, NULL = index   */
+    int   index;                          /**< Array index or JSON_STEP_VAR */
+} MEX_JSON_STEP;
+
+/**
+ * A compiled path. The node that the path (or, with a [] step, the part
+ * before it) resolves to is remembered along with the document handle
+ * and generation, so repeated lookups skip straight to it.
+ */
+typedef struct _mex_json_path {
+    MEX_JSON_STEP *step;                  /**< Steps, NULL = unused slot   */
+    int            n_step;
+    int            var;                   /**< Step number of [], or -1    */
+    int            c_jh;                  /**< Cached: document handle     */
+    unsigned       c_gen;                 /**< ...its generation           */
+    cJSON         *c_node;                /**< ...and the node reached     */
+} MEX_JSON_PATH;
+
+static MEX_JSON_PATH g_mex_json_path[MAX_MEXJSONPATH];
+
+/** Pull parser state for json_stream_*. */
+typedef struct _mex_json_stream {
+    char   *text;                         /**< Document, NULL = unused slot.
+                                               Strings are decoded in place */
+    char   *p;                            /**< Parse position              */
+    char    ctx[MAX_JSON_STREAM_DEPTH];   /**< '{' or '[' per open level   */
+    int     depth;                        /**< Open containers             */
+    int     need_comma;                   /**< Current level has a value   */
+    int     done;                         /**< Top-level value finished    */
+    int     event;                        /**< Last event returned         */
+    char   *key;                          /**< Member name of last value   */
+    char   *str;                          /**< Decoded string value        */
+    char    num_text[64];                 /**< Number as written           */
+    double  num;
+    int     bval;
+} MEX_JSON_STREAM;
+
+static MEX_JSON_STREAM g_mex_json_stream[MAX_MEXJSONSTREAM];
 
 /*------------------------------------------------------------------------*
  * Internal helpers                                                       *
@@ -110,6 +185,7 @@ static void mex_json_init_slot(int slot, cJSON *root)
     g_mex_json[slot].root   = root;
     g_mex_json[slot].cursor = root;
     g_mex_json[slot].depth  = 0;
+    g_mex_json[slot].gen    = ++g_json_gen;
     memset(g_mex_json[slot].stack, 0, sizeof(g_mex_json[slot].stack));
 }
 
@@ -123,18 +199,200 @@ static cJSON *mex_json_parent(MEX_JSON *j)
     return (j->depth > 0) ? j->stack[j->depth - 1] : j->root;
 }
 
+/*------------------------------------------------------------------------*
+ * Large-container indexes                                                *
+ *------------------------------------------------------------------------*/
+
+/**
+ * @brief Free every container index kept for a handle.
+ */
+static void mex_json_index_free(MEX_JSON *j)
+{
+    for (int i = 0; i < MAX_JSON_INDEX; i++)
+    {
+        free(j->index[i].item);
+        free(j->index[i].hash);
+        memset(&j->index[i], 0, sizeof(j->index[i]));
+    }
+}
+
 /**
- * @brief Resolve a dotted/bracketed path against a cJSON tree.
+ * @brief Note that the tree has been added to or deleted from.
+ *
+ * Drops the container indexes and moves the handle to a new generation,
+ * which invalidates the nodes cached in compiled paths.
+ */
+static void mex_json_touch(MEX_JSON *j)
+{
+    mex_json_index_free(j);
+    j->gen = ++g_json_gen;
+}
+
+/**
+ * @brief Release a handle's tree and everything cached for it.
+ */
+static void mex_json_free_slot(MEX_JSON *j)
+{
+    mex_json_index_free(j);
+    cJSON_Delete(j->root);
+    memset(j, 0, sizeof(*j));
+}
+
+/** FNV-1a hash of an object key. */
+static unsigned mex_json_hash(const char *s)
+{
+    unsigned h = 2166136261u;
+
+    while (*s)
+        h = (h ^ (unsigned char)*s++) * 16777619u;
+
+    return h;
+}
+
+/**
+ * @brief Return the index for a container, building it on first use.
+ *
+ * @return NULL if the container is too small to be worth indexing or
+ *         memory is short; callers then fall back to walking the list.
+ */
+static MEX_JSON_INDEX *mex_json_index_get(MEX_JSON *j, cJSON *node)
+{
+    MEX_JSON_INDEX *pi, *old = &j->index[0];
+    cJSON *c;
+    int n = 0, i;
+
+    for (pi = j->index; pi < j->index + MAX_JSON_INDEX; pi++)
+    {
+        if (pi->node == node)
+        {
+            pi->last_use = ++j->index_use;
+            return pi;
+        }
+
+        if (!pi->node || (old->node && pi->last_use < old->last_use))
+            old = pi;
+    }
+
+    for (c = node->child; c; c = c->next)
+        n++;
+
+    if (n < JSON_INDEX_MIN)
+        return NULL;
+
+    pi = old;
+    free(pi->item);
+    free(pi->hash);
+    memset(pi, 0, sizeof(*pi));
+
+    if ((pi->item = malloc(n * sizeof(cJSON *))) == NULL)
+        return NULL;
+
+    for (c = node->child, i = 0; c; c = c->next)
+        pi->item[i++] = c;
+
+    if (cJSON_IsObject(node))
+    {
+        for (pi->n_hash = 2; pi->n_hash < n * 2; pi->n_hash <<= 1)
+            ;
+
+        if ((pi->hash = malloc(pi->n_hash * sizeof(int))) == NULL)
+        {
+            free(pi->item);
+            pi->item = NULL;
+            return NULL;
+        }
+
+        memset(pi->hash, 0xff, pi->n_hash * sizeof(int));
+
+        /* Linear probing. Duplicate keys keep the first, as cJSON does. */
+        for (i = 0; i < n; i++)
+        {
+            const char *key = pi->item[i]->string;
+            unsigned b;
+
+            if (!key)
+                continue;
+
+            for (b = mex_json_hash(key) & (pi->n_hash - 1);
+                 pi->hash[b] != -1;
+                 b = (b + 1) & (pi->n_hash - 1))
+            {
+                if (strcmp(pi->item[pi->hash[b]]->string, key) == 0)
+                    break;
+            }
+
+            if (pi->hash[b] == -1)
+                pi->hash[b] = i;
+        }
+    }
+
+    pi->node     = node;
+    pi->count    = n;
+    pi->last_use = ++j->index_use;
+    return pi;
+}
+
+/**
+ * @brief Get child number idx of an array or object.
+ */
+static cJSON *mex_json_item(MEX_JSON *j, cJSON *node, int idx)
+{
+    MEX_JSON_INDEX *pi;
+
+    if (!node || idx < 0 || (!cJSON_IsArray(node) && !cJSON_IsObject(node)))
+        return NULL;
+
+    if ((pi = mex_json_index_get(j, node)) != NULL)
+        return (idx < pi->count) ? pi->item[idx] : NULL;
+
+    return cJSON_GetArrayItem(node, idx);
+}
+
+/**
+ * @brief Look up an object member by its exact (case-sensitive) key.
+ */
+static cJSON *mex_json_member(MEX_JSON *j, cJSON *node, const char *key)
+{
+    MEX_JSON_INDEX *pi;
+    unsigned b;
+
+    if (!node || !cJSON_IsObject(node))
+        return NULL;
+
+    if ((pi = mex_json_index_get(j, node)) == NULL || !pi->hash)
+        return cJSON_GetObjectItemCaseSensitive(node, key);
+
+    for (b = mex_json_hash(key) & (pi->n_hash - 1);
+         pi->hash[b] != -1;
+         b = (b + 1) & (pi->n_hash - 1))
+    {
+        cJSON *c = pi->item[pi->hash[b]];
+
+        if (strcmp(c->string, key) == 0)
+            return c;
+    }
+
+    return NULL;
+}
+
+/*------------------------------------------------------------------------*
+ * Paths                                                                  *
+ *------------------------------------------------------------------------*/
+
+/**
+ * @brief Resolve a dotted/bracketed path against a handle's tree.
  *
  * Supports: "key", "key.sub", "arr[0]", "obj.arr[2].name"
  * Empty string returns root.
  *
- * @param root  The cJSON root node.
+ * @param j     The JSON handle.
  * @param path  Dot/bracket path string.
  * @return Pointer to the resolved cJSON node, or NULL if not found.
  */
-static cJSON *json_resolve_path(cJSON *root, const char *path)
+static cJSON *json_resolve_path(MEX_JSON *j, const char *path)
 {
+    cJSON *root = j->root;
+
     if (!root || !path || !*path)
         return root;
 
@@ -157,7 +415,7 @@ static cJSON *json_resolve_path(cJSON *root, const char *path)
         if (*p == '[')
         {
             int idx = atoi(p + 1);
-            cur = cJSON_GetArrayItem(cur, idx);
+            cur = mex_json_item(j, cur, idx);
             p = strchr(p, ']');
             if (p) p++;
             else break;
@@ -173,7 +431,7 @@ static cJSON *json_resolve_path(cJSON *root, const char *path)
             *end = '\0';
         }
 
-        cur = cJSON_GetObjectItemCaseSensitive(cur, p);
+        cur = mex_json_member(j, cur, p);
 
         if (end)
         {
@@ -187,6 +445,135 @@ static cJSON *json_resolve_path(cJSON *root, const char *path)
     return cur;
 }
 
+/**
+ * @brief Free the steps of a compiled path and mark its slot unused.
+ */
+static void mex_json_path_free(MEX_JSON_PATH *pp)
+{
+    for (int i = 0; i < pp->n_step; i++)
+        free(pp->step[i].key);
+
+    free(pp->step);
+    memset(pp, 0, sizeof(*pp));
+}
+
+/**
+ * @brief Split a path into steps, using the same syntax as
+ *        json_resolve_path() plus "[]" for an index given at lookup time.
+ *
+ * @return 0 on success, -1 on a malformed path or no memory.
+ */
+static int mex_json_path_compile(MEX_JSON_PATH *pp, const char *path)
+{
+    const char *p = path;
+    int max = 1;
+
+    for (const char *s = path; *s; s++)
+        if (*s == '.' || *s == '[')
+            max++;
+
+    if ((pp->step = calloc(max, sizeof(MEX_JSON_STEP))) == NULL)
+        return -1;
+
+    pp->var = -1;
+
+    while (*p)
+    {
+        MEX_JSON_STEP *ps = &pp->step[pp->n_step];
+
+        if (*p == '.')
+        {
+            p++;
+            continue;
+        }
+
+        if (*p == '[')
+        {
+            const char *end = strchr(p, ']');
+
+            if (!end)
+                return -1;
+
+            if (end == p + 1)
+            {
+                /* Only one placeholder: the cache holds one base node */
+                if (pp->var != -1)
+                    return -1;
+
+                pp->var   = pp->n_step;
+                ps->index = JSON_STEP_VAR;
+            }
+            else
+                ps->index = atoi(p + 1);
+
+            pp->n_step++;
+            p = end + 1;
+            continue;
+        }
+
+        size_t len = strcspn(p, ".[");
+
+        if ((ps->key = malloc(len + 1)) == NULL)
+            return -1;
+
+        memcpy(ps->key, p, len);
+        ps->key[len] = '\0';
+        pp->n_step++;
+        p += len;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Follow steps [from, to) of a compiled path, starting at node.
+ */
+static cJSON *mex_json_path_walk(MEX_JSON *j, MEX_JSON_PATH *pp, cJSON *node,
+                                 int from, int to, int idx)
+{
+    for (int i = from; i < to && node; i++)
+    {
+        MEX_JSON_STEP *ps = &pp->step[i];
+
+        if (ps->key)
+            node = mex_json_member(j, node, ps->key);
+        else
+            node = mex_json_item(j, node,
+                                 ps->index == JSON_STEP_VAR ? idx : ps->index);
+    }
+
+    return node;
+}
+
+/**
+ * @brief Resolve a compiled path against handle jh.
+ *
+ * The node reached by the steps before the [] placeholder (or by the
+ * whole path, if there isn't one) is cached until the document changes,
+ * so "items[]" only costs the index lookup itself.
+ */
+static cJSON *mex_json_path_resolve(int jh, int ph, int idx)
+{
+    MEX_JSON *j = mex_json_slot(jh);
+    MEX_JSON_PATH *pp;
+    int base;
+
+    if (!j || ph < 0 || ph >= MAX_MEXJSONPATH || !g_mex_json_path[ph].step)
+        return NULL;
+
+    pp   = &g_mex_json_path[ph];
+    base = (pp->var == -1) ? pp->n_step : pp->var;
+
+    if (pp->c_jh != jh || pp->c_gen != j->gen)
+    {
+        pp->c_node = mex_json_path_walk(j, pp, j->root, 0, base, 0);
+        pp->c_jh   = jh;
+        pp->c_gen  = j->gen;
+    }
+
+    return mex_json_path_walk(j, pp, pp->c_node, base, pp->n_step, idx);
+}
+
 /**
  * @brief Convert a cJSON node's value to a string representation.
  *
@@ -228,10 +615,19 @@ void MexJsonCleanup(void)
     for (int i = 0; i < MAX_MEXJSON; i++)
     {
         if (g_mex_json[i].root)
-        {
-            cJSON_Delete(g_mex_json[i].root);
-            memset(&g_mex_json[i], 0, sizeof(g_mex_json[i]));
-        }
+            mex_json_free_slot(&g_mex_json[i]);
+    }
+
+    for (int i = 0; i < MAX_MEXJSONPATH; i++)
+    {
+        if (g_mex_json_path[i].step)
+            mex_json_path_free(&g_mex_json_path[i]);
+    }
+
+    for (int i = 0; i < MAX_MEXJSONSTREAM; i++)
+    {
+        free(g_mex_json_stream[i].text);
+        memset(&g_mex_json_stream[i], 0, sizeof(g_mex_json_stream[i]));
     }
 }
 
@@ -330,10 +726,7 @@ word EXPENTRY intrin_json_close(void)
 
     MEX_JSON *j = mex_json_slot(jh);
     if (j)
-    {
-        cJSON_Delete(j->root);
-        memset(j, 0, sizeof(*j));
-    }
+        mex_json_free_slot(j);
 
     return MexArgEnd(&ma);
 }
@@ -461,7 +854,7 @@ word EXPENTRY intrin_json_find(void)
         return MexArgEnd(&ma);
     }
 
-    cJSON *found = cJSON_GetObjectItemCaseSensitive(parent, key);
+    cJSON *found = mex_json_member(j, parent, key);
     free(key);
 
     if (!found)
@@ -607,7 +1000,7 @@ word EXPENTRY intrin_json_get_str(void)
         return MexArgEnd(&ma);
     }
 
-    cJSON *node = json_resolve_path(j->root, path);
+    cJSON *node = json_resolve_path(j, path);
     free(path);
 
     char buf[64];
@@ -630,7 +1023,7 @@ word EXPENTRY intrin_json_get_num(void)
     MEX_JSON *j = mex_json_slot(jh);
     if (j && path)
     {
-        cJSON *node = json_resolve_path(j->root, path);
+        cJSON *node = json_resolve_path(j, path);
         if (node && cJSON_IsNumber(node))
             regs_4[0] = (dword)(long)node->valuedouble;
     }
@@ -652,7 +1045,7 @@ word EXPENTRY intrin_json_get_bool(void)
     MEX_JSON *j = mex_json_slot(jh);
     if (j && path)
     {
-        cJSON *node = json_resolve_path(j->root, path);
+        cJSON *node = json_resolve_path(j, path);
         if (node && cJSON_IsBool(node))
             regs_2[0] = (word)cJSON_IsTrue(node);
     }
@@ -674,7 +1067,7 @@ word EXPENTRY intrin_json_get_type(void)
     MEX_JSON *j = mex_json_slot(jh);
     if (j && path)
     {
-        cJSON *node = json_resolve_path(j->root, path);
+        cJSON *node = json_resolve_path(j, path);
         regs_2[0] = (word)mex_cjson_type(node);
     }
 
@@ -695,7 +1088,7 @@ word EXPENTRY intrin_json_get_count(void)
     MEX_JSON *j = mex_json_slot(jh);
     if (j && path)
     {
-        cJSON *node = json_resolve_path(j->root, path);
+        cJSON *node = json_resolve_path(j, path);
         if (node && (cJSON_IsArray(node) || cJSON_IsObject(node)))
             regs_2[0] = (word)cJSON_GetArraySize(node);
     }
@@ -736,11 +1129,14 @@ word EXPENTRY intrin_json_set_str(void)
     }
 
     /* Replace if exists, otherwise add */
-    cJSON *existing = cJSON_GetObjectItemCaseSensitive(parent, key);
+    cJSON *existing = mex_json_member(j, parent, key);
     if (existing)
         cJSON_SetValuestring(existing, val);
     else
+    {
         cJSON_AddItemToObject(parent, key, cJSON_CreateString(val));
+        mex_json_touch(j);
+    }
 
     free(key);
     free(val);
@@ -773,11 +1169,14 @@ word EXPENTRY intrin_json_set_num(void)
         return MexArgEnd(&ma);
     }
 
-    cJSON *existing = cJSON_GetObjectItemCaseSensitive(parent, key);
+    cJSON *existing = mex_json_member(j, parent, key);
     if (existing)
         cJSON_SetNumberValue(existing, (double)(long)val);
     else
+    {
         cJSON_AddItemToObject(parent, key, cJSON_CreateNumber((double)(long)val));
+        mex_json_touch(j);
+    }
 
     free(key);
     regs_2[0] = 0;
@@ -809,13 +1208,14 @@ word EXPENTRY intrin_json_set_bool(void)
         return MexArgEnd(&ma);
     }
 
-    cJSON *existing = cJSON_GetObjectItemCaseSensitive(parent, key);
+    cJSON *existing = mex_json_member(j, parent, key);
     if (existing)
     {
         /* cJSON doesn't have SetBoolValue; delete and re-add */
         cJSON_DeleteItemFromObjectCaseSensitive(parent, key);
     }
     cJSON_AddItemToObject(parent, key, cJSON_CreateBool(val ? 1 : 0));
+    mex_json_touch(j);
 
     free(key);
     regs_2[0] = 0;
@@ -847,6 +1247,7 @@ word EXPENTRY intrin_json_add_object(void)
     }
 
     cJSON_AddItemToObject(parent, key, cJSON_CreateObject());
+    mex_json_touch(j);
     free(key);
     regs_2[0] = 0;
     return MexArgEnd(&ma);
@@ -877,6 +1278,7 @@ word EXPENTRY intrin_json_add_array(void)
     }
 
     cJSON_AddItemToObject(parent, key, cJSON_CreateArray());
+    mex_json_touch(j);
     free(key);
     regs_2[0] = 0;
     return MexArgEnd(&ma);
@@ -907,6 +1309,7 @@ word EXPENTRY intrin_json_array_push_str(void)
     }
 
     cJSON_AddItemToArray(parent, cJSON_CreateString(val));
+    mex_json_touch(j);
     free(val);
     regs_2[0] = 0;
     return MexArgEnd(&ma);
@@ -931,6 +1334,7 @@ word EXPENTRY intrin_json_array_push_num(void)
         return MexArgEnd(&ma);
 
     cJSON_AddItemToArray(parent, cJSON_CreateNumber((double)(long)val));
+    mex_json_touch(j);
     regs_2[0] = 0;
     return MexArgEnd(&ma);
 }
@@ -961,4 +1365,619 @@ word EXPENTRY intrin_json_serialize(void)
     return MexArgEnd(&ma);
 }
 
+/*========================================================================*
+ * COMPILED PATH INTRINSICS                                               *
+ *========================================================================*/
+
+/**
+ * Compile a path for repeated use. "[]" marks an array index supplied
+ * to each json_path_*() call. Returns a path handle or -1.
+ */
+word EXPENTRY intrin_json_compile(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    char *path = MexArgGetString(&ma, FALSE);
+
+    regs_2[0] = (word)-1;
+
+    if (!path)
+        return MexArgEnd(&ma);
+
+    for (int i = 0; i < MAX_MEXJSONPATH; i++)
+    {
+        if (g_mex_json_path[i].step)
+            continue;
+
+        if (mex_json_path_compile(&g_mex_json_path[i], path) == 0)
+            regs_2[0] = (word)i;
+        else
+        {
+            logit("!MEX json_compile: bad path \"%s\"", path);
+            mex_json_path_free(&g_mex_json_path[i]);
+        }
+
+        free(path);
+        return MexArgEnd(&ma);
+    }
+
+    logit("!MEX json_compile: no free slots");
+    free(path);
+    return MexArgEnd(&ma);
+}
+
+/** Release a compiled path handle. */
+word EXPENTRY intrin_json_path_free(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int ph = (int)MexArgGetWord(&ma);
+
+    if (ph >= 0 && ph < MAX_MEXJSONPATH && g_mex_json_path[ph].step)
+        mex_json_path_free(&g_mex_json_path[ph]);
+
+    return MexArgEnd(&ma);
+}
+
+/** Get string by compiled path. Returns "" if not found. */
+word EXPENTRY intrin_json_path_str(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int jh  = (int)MexArgGetWord(&ma);
+    int ph  = (int)MexArgGetWord(&ma);
+    int idx = (int)(sword)MexArgGetWord(&ma);
+
+    char numbuf[64];
+    MexReturnString((char *)mex_json_value_as_str(
+                        mex_json_path_resolve(jh, ph, idx),
+                        numbuf, sizeof(numbuf)));
+    return MexArgEnd(&ma);
+}
+
+/** Get number by compiled path. Returns 0 if not found. */
+word EXPENTRY intrin_json_path_num(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int jh  = (int)MexArgGetWord(&ma);
+    int ph  = (int)MexArgGetWord(&ma);
+    int idx = (int)(sword)MexArgGetWord(&ma);
+
+    cJSON *node = mex_json_path_resolve(jh, ph, idx);
+    regs_4[0] = (node && cJSON_IsNumber(node)) ? (dword)(long)node->valuedouble
+                                               : 0;
+    return MexArgEnd(&ma);
+}
+
+/** Get boolean by compiled path. Returns 0 if not found. */
+word EXPENTRY intrin_json_path_bool(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int jh  = (int)MexArgGetWord(&ma);
+    int ph  = (int)MexArgGetWord(&ma);
+    int idx = (int)(sword)MexArgGetWord(&ma);
+
+    cJSON *node = mex_json_path_resolve(jh, ph, idx);
+    regs_2[0] = (node && cJSON_IsTrue(node)) ? 1 : 0;
+    return MexArgEnd(&ma);
+}
+
+/** Get type by compiled path. */
+word EXPENTRY intrin_json_path_type(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int jh  = (int)MexArgGetWord(&ma);
+    int ph  = (int)MexArgGetWord(&ma);
+    int idx = (int)(sword)MexArgGetWord(&ma);
+
+    regs_2[0] = (word)mex_cjson_type(mex_json_path_resolve(jh, ph, idx));
+    return MexArgEnd(&ma);
+}
+
+/** Count children at compiled path. */
+word EXPENTRY intrin_json_path_count(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int jh  = (int)MexArgGetWord(&ma);
+    int ph  = (int)MexArgGetWord(&ma);
+    int idx = (int)(sword)MexArgGetWord(&ma);
+
+    cJSON *node = mex_json_path_resolve(jh, ph, idx);
+    regs_2[0] = (node && (cJSON_IsArray(node) || cJSON_IsObject(node)))
+                    ? (word)cJSON_GetArraySize(node) : 0;
+    return MexArgEnd(&ma);
+}
+
+/*========================================================================*
+ * STREAMING PARSER                                                       *
+ *========================================================================*/
+
+/*
+ * json_stream_* walk a document one value at a time without building a
+ * cJSON tree. The text is copied once; strings are unescaped in place
+ * (the result is never longer than the source), so the only memory used
+ * beyond the copy is the fixed state in MEX_JSON_STREAM.
+ */
+
+static MEX_JSON_STREAM *mex_json_stream_slot(int sh)
+{
+    if (sh < 0 || sh >= MAX_MEXJSONSTREAM || !g_mex_json_stream[sh].text)
+        return NULL;
+    return &g_mex_json_stream[sh];
+}
+
+static void mex_json_stream_ws(MEX_JSON_STREAM *s)
+{
+    while (*s->p == ' ' || *s->p == '\t' || *s->p == '\r' || *s->p == '\n')
+        s->p++;
+}
+
+/** Parse four hex digits. Returns the value or -1. */
+static long mex_json_hex4(const char *p)
+{
+    long v = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        int c = p[i];
+
+        v <<= 4;
+
+        if (c >= '0' && c <= '9')      v |= c - '0';
+        else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+        else return -1;
+    }
+
+    return v;
+}
+
+/** Append code point cp to dst as UTF-8. */
+static char *mex_json_utf8(char *dst, unsigned long cp)
+{
+    if (cp < 0x80)
+        *dst++ = (char)cp;
+    else if (cp < 0x800)
+    {
+        *dst++ = (char)(0xc0 | (cp >> 6));
+        *dst++ = (char)(0x80 | (cp & 0x3f));
+    }
+    else if (cp < 0x10000)
+    {
+        *dst++ = (char)(0xe0 | (cp >> 12));
+        *dst++ = (char)(0x80 | ((cp >> 6) & 0x3f));
+        *dst++ = (char)(0x80 | (cp & 0x3f));
+    }
+    else
+    {
+        *dst++ = (char)(0xf0 | (cp >> 18));
+        *dst++ = (char)(0x80 | ((cp >> 12) & 0x3f));
+        *dst++ = (char)(0x80 | ((cp >> 6) & 0x3f));
+        *dst++ = (char)(0x80 | (cp & 0x3f));
+    }
+
+    return dst;
+}
+
+/**
+ * @brief Unescape the string starting at s->p (on the opening quote)
+ *        in place and step past it.
+ * @return The decoded string, or NULL if it is malformed.
+ */
+static char *mex_json_stream_string(MEX_JSON_STREAM *s)
+{
+    char *src = s->p + 1, *dst = src, *start = src;
+
+    for (;;)
+    {
+        unsigned char c = (unsigned char)*src;
+
+        if (c == '"')
+            break;
+
+        if (c < 0x20)               /* Control character or end of text */
+            return NULL;
+
+        if (c != '\\')
+        {
+            *dst++ = *src++;
+            continue;
+        }
+
+        switch (src[1])
+        {
+            case '"':  *dst++ = '"';  break;
+            case '\\': *dst++ = '\\'; break;
+            case '/':  *dst++ = '/';  break;
+            case 'b':  *dst++ = '\b'; break;
+            case 'f':  *dst++ = '\f'; break;
+            case 'n':  *dst++ = '\n'; break;
+            case 'r':  *dst++ = '\r'; break;
+            case 't':  *dst++ = '\t'; break;
+
+            case 'u':
+            {
+                long cp = mex_json_hex4(src + 2);
+
+                if (cp < 0)
+                    return NULL;
+
+                src += 6;
+
+                /* Surrogate pair: \uD83D\uDE00 and the like */
+                if (cp >= 0xd800 && cp <= 0xdbff && src[0] == '\\' &&
+                    src[1] == 'u')
+                {
+                    long lo = mex_json_hex4(src + 2);
+
+                    if (lo >= 0xdc00 && lo <= 0xdfff)
+                    {
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                        src += 6;
+                    }
+                }
+
+                if (cp >= 0xd800 && cp <= 0xdfff)
+                    *dst++ = '?';   /* Unpaired surrogate */
+                else
+                    dst = mex_json_utf8(dst, (unsigned long)cp);
+
+                continue;
+            }
+
+            default:
+                return NULL;
+        }
+
+        src += 2;
+    }
+
+    /* dst never passes src, so the terminator can't clobber the quote
+     * before we have stepped over it. */
+    s->p = src + 1;
+    *dst = '\0';
+    return start;
+}
+
+/**
+ * @brief Parse a scalar value or open a container at s->p.
+ * @return The event, or MEX_JSON_INVALID.
+ */
+static int mex_json_stream_value(MEX_JSON_STREAM *s)
+{
+    char c = *s->p;
+
+    if (c == '{' || c == '[')
+    {
+        if (s->depth >= MAX_JSON_STREAM_DEPTH)
+            return MEX_JSON_INVALID;
+
+        s->ctx[s->depth++] = c;
+        s->need_comma = 0;
+        s->p++;
+        return (c == '{') ? MEX_JSON_OBJECT : MEX_JSON_ARRAY;
+    }
+
+    s->need_comma = 1;
+
+    if (c == '"')
+        return (s->str = mex_json_stream_string(s)) ? MEX_JSON_STRING
+                                                    : MEX_JSON_INVALID;
+
+    if (strncmp(s->p, "true", 4) == 0 || strncmp(s->p, "false", 5) == 0)
+    {
+        s->bval = (c == 't');
+        s->p   += s->bval ? 4 : 5;
+        return MEX_JSON_BOOL;
+    }
+
+    if (strncmp(s->p, "null", 4) == 0)
+    {
+        s->p += 4;
+        return MEX_JSON_NULL;
+    }
+
+    if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        char *end;
+        size_t len;
+
+        s->num = strtod(s->p, &end);
+        len = (size_t)(end - s->p);
+
+        if (len == 0 || len >= sizeof(s->num_text))
+            return MEX_JSON_INVALID;
+
+        memcpy(s->num_text, s->p, len);
+        s->num_text[len] = '\0';
+        s->p = end;
+        return MEX_JSON_NUMBER;
+    }
+
+    return MEX_JSON_INVALID;
+}
+
+/** Produce the next event for a stream. */
+static int mex_json_stream_next(MEX_JSON_STREAM *s)
+{
+    s->key = NULL;
+    s->str = NULL;
+
+    mex_json_stream_ws(s);
+
+    if (s->done)
+        return *s->p ? MEX_JSON_INVALID : MEX_JSON_END;
+
+    if (s->depth > 0)
+    {
+        char open = s->ctx[s->depth - 1];
+
+        if (*s->p == (open == '{' ? '}' : ']'))
+        {
+            s->p++;
+            s->need_comma = 1;
+
+            if (--s->depth == 0)
+                s->done = 1;
+
+            return (open == '{') ? MEX_JSON_OBJECT_END : MEX_JSON_ARRAY_END;
+        }
+
+        if (s->need_comma)
+        {
+            if (*s->p != ',')
+                return MEX_JSON_INVALID;
+
+            s->p++;
+            mex_json_stream_ws(s);
+        }
+
+        if (open == '{')
+        {
+            if (*s->p != '"' || (s->key = mex_json_stream_string(s)) == NULL)
+                return MEX_JSON_INVALID;
+
+            mex_json_stream_ws(s);
+
+            if (*s->p != ':')
+                return MEX_JSON_INVALID;
+
+            s->p++;
+            mex_json_stream_ws(s);
+        }
+    }
+
+    int ev = mex_json_stream_value(s);
+
+    if (s->depth == 0 && ev != MEX_JSON_INVALID)
+        s->done = 1;
+
+    return ev;
+}
+
+/** Parse a JSON string as a stream. Returns a stream handle or -1. */
+word EXPENTRY intrin_json_stream_open(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    char *text = MexArgGetString(&ma, FALSE);
+
+    regs_2[0] = (word)-1;
+
+    if (!text)
+        return MexArgEnd(&ma);
+
+    for (int i = 0; i < MAX_MEXJSONSTREAM; i++)
+    {
+        MEX_JSON_STREAM *s = &g_mex_json_stream[i];
+
+        if (s->text)
+            continue;
+
+        memset(s, 0, sizeof(*s));
+        s->text  = text;
+        s->p     = text;
+        s->event = MEX_JSON_END;
+        regs_2[0] = (word)i;
+        return MexArgEnd(&ma);
+    }
+
+    logit("!MEX json_stream_open: no free slots");
+    free(text);
+    return MexArgEnd(&ma);
+}
+
+/**
+ * Advance to the next value or container end. Returns its type,
+ * JSON_ARRAY_END / JSON_OBJECT_END, JSON_END after the last value, or
+ * JSON_INVALID on a syntax error (which is sticky).
+ */
+word EXPENTRY intrin_json_stream_next(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int sh = (int)MexArgGetWord(&ma);
+
+    MEX_JSON_STREAM *s = mex_json_stream_slot(sh);
+
+    if (!s)
+        regs_2[0] = (word)MEX_JSON_INVALID;
+    else
+    {
+        /* Once an error is reported, keep reporting it */
+        if (s->event != MEX_JSON_INVALID)
+            s->event = mex_json_stream_next(s);
+
+        regs_2[0] = (word)s->event;
+    }
+
+    return MexArgEnd(&ma);
+}
+
+/**
+ * Skip the rest of the container just opened by json_stream_next().
+ * The next event is whatever follows it. Returns 0 or -1.
+ */
+word EXPENTRY intrin_json_stream_skip(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int sh = (int)MexArgGetWord(&ma);
+
+    regs_2[0] = (word)-1;
+
+    MEX_JSON_STREAM *s = mex_json_stream_slot(sh);
+    if (!s || (s->event != MEX_JSON_OBJECT && s->event != MEX_JSON_ARRAY))
+        return MexArgEnd(&ma);
+
+    int level = 1;
+    char *p = s->p;
+
+    while (*p && level)
+    {
+        if (*p == '"')
+        {
+            for (p++; *p && *p != '"'; p++)
+                if (*p == '\\' && p[1])
+                    p++;
+
+            if (!*p)
+                break;
+        }
+        else if (*p == '{' || *p == '[')
+            level++;
+        else if (*p == '}' || *p == ']')
+            level--;
+
+        p++;
+    }
+
+    if (level)
+    {
+        s->event = MEX_JSON_INVALID;
+        return MexArgEnd(&ma);
+    }
+
+    s->p = p;
+    s->need_comma = 1;
+    s->event = (s->ctx[s->depth - 1] == '{') ? MEX_JSON_OBJECT_END
+                                             : MEX_JSON_ARRAY_END;
+
+    if (--s->depth == 0)
+        s->done = 1;
+
+    regs_2[0] = 0;
+    return MexArgEnd(&ma);
+}
+
+/** Member name of the current value, or "" outside an object. */
+word EXPENTRY intrin_json_stream_key(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int sh = (int)MexArgGetWord(&ma);
+
+    MEX_JSON_STREAM *s = mex_json_stream_slot(sh);
+    MexReturnString((s && s->key) ? s->key : "");
+    return MexArgEnd(&ma);
+}
+
+/**
+ * Current value as a string. Numbers come back exactly as written;
+ * booleans and null as "true"/"false"/"null"; containers as "".
+ */
+word EXPENTRY intrin_json_stream_str(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int sh = (int)MexArgGetWord(&ma);
+
+    MEX_JSON_STREAM *s = mex_json_stream_slot(sh);
+    const char *out = "";
+
+    if (s)
+    {
+        switch (s->event)
+        {
+            case MEX_JSON_STRING: out = s->str;                        break;
+            case MEX_JSON_NUMBER: out = s->num_text;                   break;
+            case MEX_JSON_BOOL:   out = s->bval ? "true" : "false";    break;
+            case MEX_JSON_NULL:   out = "null";                        break;
+        }
+    }
+
+    MexReturnString((char *)out);
+    return MexArgEnd(&ma);
+}
+
+/** Current value as a long. Returns 0 if it is not a number. */
+word EXPENTRY intrin_json_stream_num(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int sh = (int)MexArgGetWord(&ma);
+
+    MEX_JSON_STREAM *s = mex_json_stream_slot(sh);
+    regs_4[0] = (s && s->event == MEX_JSON_NUMBER) ? (dword)(long)s->num : 0;
+    return MexArgEnd(&ma);
+}
+
+/** Current value as a boolean (0 or 1). */
+word EXPENTRY intrin_json_stream_bool(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int sh = (int)MexArgGetWord(&ma);
+
+    MEX_JSON_STREAM *s = mex_json_stream_slot(sh);
+    regs_2[0] = (s && s->event == MEX_JSON_BOOL && s->bval) ? 1 : 0;
+    return MexArgEnd(&ma);
+}
+
+/**
+ * Nesting depth: 0 for the top-level value, 1 for its members, and so
+ * on. A container's start and end events report the same depth.
+ */
+word EXPENTRY intrin_json_stream_depth(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int sh = (int)MexArgGetWord(&ma);
+
+    MEX_JSON_STREAM *s = mex_json_stream_slot(sh);
+    int d = 0;
+
+    if (s)
+    {
+        d = s->depth;
+
+        if (s->event == MEX_JSON_OBJECT || s->event == MEX_JSON_ARRAY)
+            d--;
+    }
+
+    regs_2[0] = (word)d;
+    return MexArgEnd(&ma);
+}
+
+/** Close a stream and free its copy of the text. */
+word EXPENTRY intrin_json_stream_close(void)
+{
+    MA ma;
+    MexArgBegin(&ma);
+    int sh = (int)MexArgGetWord(&ma);
+
+    MEX_JSON_STREAM *s = mex_json_stream_slot(sh);
+    if (s)
+    {
+        free(s->text);
+        memset(s, 0, sizeof(*s));
+    }
+
+    return MexArgEnd(&ma);
+}
+
 #endif /* MEX */
@@ -150,8 +150,11 @@
     {
       msgareaexport(MexDSEG(pmisThis->vmaMarea), &mah);
       SetAreaName(usr.msg, MAS(mah,name));
-      MexKillStructString(mex_usr, pmisThis->pmu, msg);
-      StoreString(MexPtrToVM(pmisThis->pmu), struct mex_usr, msg, MAS(mah,name));
+      if (pmisThis->fUserBound)
+      {
+        MexKillStructString(mex_usr, pmisThis->pmu, msg);
+        StoreString(MexPtrToVM(pmisThis->pmu), struct mex_usr, msg, MAS(mah,name));
+      }
       if (!sq)
         memset(pmisThis->pmm,0,sizeof *pmisThis->pmm);
       else
@@ -214,8 +217,11 @@
           SetAreaName(usr.msg, MAS(mymah, name));
           msgareaexport(MexDSEG(pmisThis->vmaMarea), &mymah);
           regs_2[0]=TRUE;
-          MexKillStructString(mex_usr, pmisThis->pmu, msg);
-          StoreString(MexPtrToVM(pmisThis->pmu), struct mex_usr, msg, MAS(mymah,name));
+          if (pmisThis->fUserBound)
+          {
+            MexKillStructString(mex_usr, pmisThis->pmu, msg);
+            StoreString(MexPtrToVM(pmisThis->pmu), struct mex_usr, msg, MAS(mymah,name));
+          }
           if (!sq)
             memset(pmisThis->pmm,0,sizeof *pmisThis->pmm);
           else
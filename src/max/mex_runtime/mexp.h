@@ -54,6 +54,9 @@ struct _mex_instance_stack    // Instance info for this invocation of MEX
 #endif
   sdword cbPriorMsg;
   sdword cbPriorFile;
+  int fUserBound;               // usr has been exported into the MEX space
+  char *pcUserImage;            // ...and what it looked like at the time
+  unsigned cbUserImage;
 } __attribute__((packed));
 
 
@@ -76,6 +79,8 @@ void MexExportUser(struct mex_usr *pusr, struct _usr *user);
 void MexImportUser(struct mex_usr *pusr, struct _usr *user);
 void MexImportData(struct _mex_instance_stack *pmis);
 void MexExportData(struct _mex_instance_stack *pmis);
+void MexBindUser(struct _mex_instance_stack *pmis);
+int MexUserDirty(struct _mex_instance_stack *pmis);
 
 int MexAddFHandle(struct _mex_instance_stack *pmis, int fd);
 int MexDelFHandle(struct _mex_instance_stack *pmis, int fd);
@@ -18,6 +18,7 @@
  * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
  */
 
+#define _GNU_SOURCE       /* strcasestr() */
 #define MAX_LANG_m_area
 #include "mexall.h"
 
@@ -25,6 +26,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <signal.h>
+#include <time.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -52,12 +55,24 @@
 #define HTTP_MAX_HEADER    4096  /**< Max HTTP header block size           */
 #define MAX_REDIRECTS      5     /**< Max HTTP redirects to follow         */
 #define TLS_HANDSHAKE_TMO  500   /**< Default TLS handshake timeout (ms)   */
+#define HTTP_RD_BUF        8192  /**< HTTP response read buffer size       */
+#define HTTP_POOL_SIZE     4     /**< Max idle keep-alive HTTP connections */
+#define HTTP_IDLE_TMO      15000 /**< Default keep-alive idle timeout (ms) */
+#define HTTP_CACHE_SIZE    16    /**< Max cached HTTP responses            */
+#define HTTP_CACHE_MAX_KB  512   /**< Default HTTP cache size limit (KB)   */
 
 /* Status constants — must match socket.mh */
 #define MEX_SOCK_CLOSED     0
 #define MEX_SOCK_CONNECTED  1
 #define MEX_SOCK_ERROR     -1
 
+/* sock_wait() flags and results — must match socket.mh */
+#define MEX_SOCK_WAIT_INPUT    1    /**< Also wake up on a keystroke        */
+#define MEX_SOCK_WAIT_TIMEOUT -1
+#define MEX_SOCK_WAIT_KEY     -2
+
+#define SOCK_WAIT_SLICE    50    /**< Max ms per select() while waiting    */
+
 /*------------------------------------------------------------------------*
  * Handle table                                                           *
  *------------------------------------------------------------------------*/
@@ -68,6 +83,7 @@ typedef struct _mex_sock {
     int   connected;    /**< 1 = connected, 0 = closed, -1 = error       */
     char  host[256];    /**< Remote host (for logging)                   */
     int   port;         /**< Remote port                                 */
+    int   nonblock;     /**< 1 = sock_send/sock_recv never wait          */
 } MEX_SOCK;
 
 static MEX_SOCK g_mex_socks[MAX_MEXSOCK];
@@ -84,6 +100,7 @@ static void mex_sock_ensure_init(void)
         g_mex_socks[i].connected = MEX_SOCK_CLOSED;
         g_mex_socks[i].host[0] = '\0';
         g_mex_socks[i].port = 0;
+        g_mex_socks[i].nonblock = 0;
     }
     g_mex_socks_initialized = 1;
 }
@@ -147,6 +164,15 @@ static void mex_http_conn_close(MEX_HTTP_CONN *c)
  * Internal helpers                                                       *
  *------------------------------------------------------------------------*/
 
+/** @brief Milliseconds on the monotonic clock. */
+static long long mex_sock_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
 /**
  * @brief Clamp a timeout value to sane bounds.
  * @param timeout_ms Requested timeout from script (0 = use default).
@@ -191,6 +217,7 @@ static void mex_sock_free_slot(int slot)
     g_mex_socks[slot].connected = MEX_SOCK_CLOSED;
     g_mex_socks[slot].host[0] = '\0';
     g_mex_socks[slot].port = 0;
+    g_mex_socks[slot].nonblock = 0;
 }
 
 /**
@@ -409,6 +436,96 @@ static int mex_sock_send_timeout(int fd, const char *data, int len, int timeout_
     return rc;
 }
 
+/**
+ * @brief Wait for socket activity, caller input, or a timeout.
+ *
+ * Sleeps in select() on the script's sockets, at most SOCK_WAIT_SLICE ms
+ * at a time. Between slices it does what Mdm_kpeek_tic() does while
+ * waiting for a key — checks carrier and the time limit, picks up
+ * inter-node messages and gives away the time slice — so a script
+ * waiting on a slow peer doesn't freeze the node.
+ *
+ * A socket counts as ready when sock_recv() would not wait: data has
+ * arrived, or the peer closed or reset the connection.
+ *
+ * @param mask       Bit n set to wait on handle n; 0 = every open handle.
+ * @param flags      MEX_SOCK_WAIT_INPUT to also return on a keystroke.
+ * @param timeout_ms 0 to poll once, < 0 to wait indefinitely.
+ * @return Ready handle, MEX_SOCK_WAIT_KEY, or MEX_SOCK_WAIT_TIMEOUT.
+ *         An indefinite wait with no open socket in @p mask and no
+ *         MEX_SOCK_WAIT_INPUT returns MEX_SOCK_WAIT_TIMEOUT at once.
+ */
+static int mex_sock_wait(unsigned mask, int flags, int timeout_ms)
+{
+    static int last = MAX_MEXSOCK - 1;  /* Rotate so one busy socket can't
+                                         * starve the others */
+    long long deadline = mex_sock_now_ms() + timeout_ms;
+
+    vbuf_flush();
+
+    for (;;)
+    {
+        fd_set rfds;
+        struct timeval tv;
+        int maxfd = -1;
+        int slice = SOCK_WAIT_SLICE;
+        int rc;
+
+        if ((flags & MEX_SOCK_WAIT_INPUT) && Mdm_kpeek() != -1)
+            return MEX_SOCK_WAIT_KEY;
+
+        FD_ZERO(&rfds);
+        for (int i = 0; i < MAX_MEXSOCK; i++)
+        {
+            if (g_mex_socks[i].fd >= 0 && (!mask || (mask & (1u << i))))
+            {
+                FD_SET(g_mex_socks[i].fd, &rfds);
+                if (g_mex_socks[i].fd > maxfd)
+                    maxfd = g_mex_socks[i].fd;
+            }
+        }
+
+        /* Nothing could ever wake an endless wait */
+        if (maxfd < 0 && timeout_ms < 0 && !(flags & MEX_SOCK_WAIT_INPUT))
+            return MEX_SOCK_WAIT_TIMEOUT;
+
+        if (timeout_ms >= 0)
+        {
+            long long left = deadline - mex_sock_now_ms();
+
+            if (left < slice)
+                slice = (left > 0) ? (int)left : 0;
+        }
+
+        tv.tv_sec = slice / 1000;
+        tv.tv_usec = (slice % 1000) * 1000;
+
+        rc = select(maxfd + 1, &rfds, NULL, NULL, &tv);
+        if (rc > 0)
+        {
+            for (int n = 1; n <= MAX_MEXSOCK; n++)
+            {
+                int i = (last + n) % MAX_MEXSOCK;
+
+                if (g_mex_socks[i].fd >= 0 && FD_ISSET(g_mex_socks[i].fd, &rfds))
+                {
+                    last = i;
+                    return i;
+                }
+            }
+        }
+        else if (rc < 0 && errno != EINTR)
+            return MEX_SOCK_WAIT_TIMEOUT;
+
+        if (timeout_ms >= 0 && mex_sock_now_ms() >= deadline)
+            return MEX_SOCK_WAIT_TIMEOUT;
+
+        Check_Time_Limit(NULL, NULL);
+        Check_For_Message(NULL, NULL);
+        Giveaway_Slice();
+    }
+}
+
 /*------------------------------------------------------------------------*
  * URL parser (for http_request)                                          *
  *------------------------------------------------------------------------*/
@@ -486,311 +603,1020 @@ static int mex_parse_url(const char *url, PARSED_URL *out)
 }
 
 /*------------------------------------------------------------------------*
- * HTTP helper                                                            *
+ * HTTP keep-alive pool                                                   *
  *------------------------------------------------------------------------*/
 
 /**
- * @brief Perform a complete HTTP/1.1 request and return the response body.
+ * @brief An idle HTTP connection waiting to be reused.
  *
- * Supports both http:// and https:// URLs. Follows 301/302/307/308
- * redirects up to MAX_REDIRECTS times. Uses MEX_HTTP_CONN for TLS-aware
- * I/O via OpenSSL when available.
+ * The pool belongs to the node process rather than to one MEX session, so
+ * a script run from a menu over and over skips the TCP and TLS handshakes
+ * after its first request to a given server.
+ */
+typedef struct _mex_http_idle {
+    MEX_HTTP_CONN conn;       /**< conn.fd == -1 marks an unused slot      */
+    char          host[256];  /**< Server the connection is open to       */
+    int           port;
+    int           use_tls;
+    long long     since_ms;   /**< When the connection went idle          */
+} MEX_HTTP_IDLE;
+
+static MEX_HTTP_IDLE g_http_pool[HTTP_POOL_SIZE];
+static int g_http_pool_initialized = 0;
+
+/** @brief Ensure the pool is initialized (fd = -1 for all slots). */
+static void mex_http_pool_ensure_init(void)
+{
+    if (g_http_pool_initialized)
+        return;
+    for (int i = 0; i < HTTP_POOL_SIZE; i++)
+    {
+        g_http_pool[i].conn.fd = -1;
+        g_http_pool[i].conn.tls = NULL;
+        g_http_pool[i].host[0] = '\0';
+    }
+    g_http_pool_initialized = 1;
+}
+
+/** @brief Close a pooled connection and free its slot. */
+static void mex_http_pool_drop(MEX_HTTP_IDLE *pi)
+{
+    mex_http_conn_close(&pi->conn);
+    pi->host[0] = '\0';
+}
+
+/** @brief Close pooled connections that have been idle too long. */
+static void mex_http_pool_reap(void)
+{
+    long long now = mex_sock_now_ms();
+    int tmo = ngcfg_get_int("mex.sockets.http_idle_timeout_ms");
+
+    if (!g_http_pool_initialized)
+        return;
+
+    if (tmo <= 0)
+        tmo = HTTP_IDLE_TMO;
+
+    for (int i = 0; i < HTTP_POOL_SIZE; i++)
+    {
+        if (g_http_pool[i].conn.fd >= 0 &&
+            now - g_http_pool[i].since_ms > tmo)
+            mex_http_pool_drop(&g_http_pool[i]);
+    }
+}
+
+/**
+ * @brief Check that an idle connection has not been closed by the server.
  *
- * @param url        Full URL (http:// or https://).
- * @param method     HTTP method ("GET", "POST", etc.).
- * @param headers    Extra headers (\r\n separated) or empty string.
- * @param body       Request body (for POST/PUT) or empty string.
- * @param response   Output buffer for response body (caller frees).
- * @param resp_len   Output: length of response body.
- * @param timeout_ms Timeout per I/O operation.
- * @return HTTP status code (200, 404, etc.) or -1 on error.
+ * An idle connection should have nothing to read. EOF means the server
+ * timed it out; stray bytes on a plain connection mean the stream is out
+ * of step. On TLS they are usually a late session ticket, which OpenSSL
+ * consumes on the next read.
+ *
+ * @return 1 if the connection looks usable, 0 if it should be dropped.
  */
-static int mex_http_request(const char *url, const char *method,
-                            const char *headers, const char *body,
-                            char **response, int *resp_len, int timeout_ms)
+static int mex_http_conn_alive(MEX_HTTP_CONN *c)
 {
-    char current_url[2048];
-    int redir;
+    fd_set rfds;
+    struct timeval tv;
+    char peek;
 
-    *response = NULL;
-    *resp_len = 0;
+    FD_ZERO(&rfds);
+    FD_SET(c->fd, &rfds);
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
 
-    strncpy(current_url, url, sizeof(current_url) - 1);
-    current_url[sizeof(current_url) - 1] = '\0';
+    if (select(c->fd + 1, &rfds, NULL, NULL, &tv) == 0)
+        return 1;
 
-    for (redir = 0; redir <= MAX_REDIRECTS; redir++)
+    if (recv(c->fd, &peek, 1, MSG_PEEK) <= 0)
+        return 0;
+
+    return c->tls != NULL;
+}
+
+/**
+ * @brief Take an idle connection to the URL's server out of the pool.
+ * @param pu  Parsed URL (host, port and scheme must all match).
+ * @param c   Output connection.
+ * @return 1 if a connection was found, 0 if the caller must connect.
+ */
+static int mex_http_pool_get(const PARSED_URL *pu, MEX_HTTP_CONN *c)
+{
+    mex_http_pool_ensure_init();
+    mex_http_pool_reap();
+
+    for (int i = 0; i < HTTP_POOL_SIZE; i++)
     {
-        PARSED_URL pu;
-        int status_code = -1;
-        int content_length = -1;
+        MEX_HTTP_IDLE *pi = &g_http_pool[i];
 
-        if (mex_parse_url(current_url, &pu) < 0)
-            return -1;
+        if (pi->conn.fd < 0 || pi->port != pu->port ||
+            pi->use_tls != pu->use_tls || strcasecmp(pi->host, pu->host) != 0)
+            continue;
 
-        /* TCP connect */
-        int fd = mex_sock_connect(pu.host, pu.port, timeout_ms);
-        if (fd < 0)
+        if (!mex_http_conn_alive(&pi->conn))
         {
-            logit("!MEX http_request: connect to %s:%d failed", pu.host, pu.port);
-            return -1;
+            mex_http_pool_drop(pi);
+            continue;
         }
 
-        /* Set up connection wrapper */
-        MEX_HTTP_CONN conn;
-        conn.fd = fd;
-        conn.tls = NULL;
+        *c = pi->conn;
+        pi->conn.fd = -1;
+        pi->conn.tls = NULL;
+        pi->host[0] = '\0';
+        return 1;
+    }
 
-        /* TLS handshake for HTTPS via OpenSSL (isolated in mex_tls.c) */
-        if (pu.use_tls)
-        {
-            int hs_tmo = ngcfg_get_int("mex.sockets.tls_handshake_timeout_ms");
-            if (hs_tmo <= 0)
-                hs_tmo = TLS_HANDSHAKE_TMO;
+    return 0;
+}
 
-            conn.tls = mex_tls_connect(fd, pu.host, hs_tmo);
-            if (!conn.tls)
-            {
-                logit("!MEX http_request: TLS failed for %s:%d (cap %dms): %s",
-                      pu.host, pu.port, hs_tmo, mex_tls_last_error());
-                close(fd);
-                return -1;
-            }
+/**
+ * @brief Return a connection to the pool after a complete response.
+ *
+ * Evicts the connection that has been idle longest if the pool is full.
+ * Ownership of the connection passes to the pool.
+ */
+static void mex_http_pool_put(const PARSED_URL *pu, MEX_HTTP_CONN *c)
+{
+    MEX_HTTP_IDLE *victim = NULL;
+
+    mex_http_pool_ensure_init();
+
+    for (int i = 0; i < HTTP_POOL_SIZE; i++)
+    {
+        MEX_HTTP_IDLE *pi = &g_http_pool[i];
+
+        if (pi->conn.fd < 0)
+        {
+            victim = pi;
+            break;
         }
+        if (!victim || pi->since_ms < victim->since_ms)
+            victim = pi;
+    }
+
+    if (victim->conn.fd >= 0)
+        mex_http_pool_drop(victim);
+
+    /* Don't hand pooled sockets to doors and other child processes */
+    fcntl(c->fd, F_SETFD, FD_CLOEXEC);
+
+    victim->conn = *c;
+    strncpy(victim->host, pu->host, sizeof(victim->host) - 1);
+    victim->host[sizeof(victim->host) - 1] = '\0';
+    victim->port = pu->port;
+    victim->use_tls = pu->use_tls;
+    victim->since_ms = mex_sock_now_ms();
+
+    c->fd = -1;
+    c->tls = NULL;
+}
+
+/*------------------------------------------------------------------------*
+ * HTTP response reader                                                   *
+ *------------------------------------------------------------------------*/
+
+/** A parsed HTTP response. */
+typedef struct _http_resp {
+    int   status;                       /**< HTTP status code             */
+    int   keep_alive;                   /**< Connection may be reused     */
+    char  hdrs[HTTP_MAX_HEADER + 1];    /**< Status line and headers,
+                                             each ending in CRLF          */
+    char *body;                         /**< Body (malloc'd) or NULL      */
+    int   body_len;
+    int   body_cap;
+} HTTP_RESP;
+
+/** Buffered reader over an HTTP connection. */
+typedef struct _http_rd {
+    MEX_HTTP_CONN *c;
+    int   timeout_ms;
+    int   pos, len;           /**< Unread data is buf[pos..len)           */
+    int   got_any;            /**< Anything at all has been received      */
+    char  buf[HTTP_RD_BUF + 1];
+} HTTP_RD;
+
+/**
+ * @brief Read more data into the reader's buffer.
+ * @return Bytes received, or -1 on EOF, timeout or error.
+ */
+static int mex_http_rd_fill(HTTP_RD *rd)
+{
+    if (rd->pos > 0)
+    {
+        memmove(rd->buf, rd->buf + rd->pos, rd->len - rd->pos);
+        rd->len -= rd->pos;
+        rd->pos = 0;
+    }
 
-        /* Build request */
-        char req[2048];
-        int body_len = body ? (int)strlen(body) : 0;
-        int req_len;
+    if (rd->len >= HTTP_RD_BUF)
+        return -1;
+
+    int got = mex_http_recv(rd->c, rd->buf + rd->len, HTTP_RD_BUF - rd->len,
+                            rd->timeout_ms);
+    if (got <= 0)
+        return -1;
 
-        if (body_len > 0)
+    rd->len += got;
+    rd->got_any = 1;
+    return got;
+}
+
+/**
+ * @brief Read one line, stripping the CRLF. Long lines are truncated.
+ * @return Line length, or -1 on EOF/error.
+ */
+static int mex_http_rd_line(HTTP_RD *rd, char *line, int max)
+{
+    for (;;)
+    {
+        char *nl = memchr(rd->buf + rd->pos, '\n', rd->len - rd->pos);
+        if (nl)
         {
-            req_len = snprintf(req, sizeof(req),
-                "%s %s HTTP/1.1\r\n"
-                "Host: %s\r\n"
-                "Connection: close\r\n"
-                "Content-Length: %d\r\n"
-                "%s"
-                "\r\n",
-                method, pu.path, pu.host, body_len,
-                headers ? headers : "");
+            int n = (int)(nl - (rd->buf + rd->pos));
+            int copy = n;
+
+            if (copy > 0 && rd->buf[rd->pos + copy - 1] == '\r')
+                copy--;
+            if (copy >= max)
+                copy = max - 1;
+
+            memcpy(line, rd->buf + rd->pos, copy);
+            line[copy] = '\0';
+            rd->pos += n + 1;
+            return copy;
         }
-        else
+
+        if (mex_http_rd_fill(rd) < 0)
+            return -1;
+    }
+}
+
+/**
+ * @brief Make room for more body data, capped at HTTP_MAX_RESPONSE.
+ * @param want Bytes the caller would like to add.
+ * @return Bytes that fit (may be less than want), or -1 if out of memory.
+ */
+static int mex_http_body_grow(HTTP_RESP *r, int want)
+{
+    if (want > HTTP_MAX_RESPONSE - r->body_len)
+        want = HTTP_MAX_RESPONSE - r->body_len;
+
+    if (r->body_len + want + 1 > r->body_cap)
+    {
+        int cap = r->body_cap ? r->body_cap : 4096;
+
+        while (cap < r->body_len + want + 1)
+            cap *= 2;
+        if (cap > HTTP_MAX_RESPONSE + 1)
+            cap = HTTP_MAX_RESPONSE + 1;
+
+        char *nb = realloc(r->body, cap);
+        if (!nb)
+            return -1;
+
+        r->body = nb;
+        r->body_cap = cap;
+    }
+
+    return want;
+}
+
+/**
+ * @brief Read exactly n bytes of body.
+ * @return 0 on success, 1 if the body was truncated at HTTP_MAX_RESPONSE
+ *         (the rest is left unread), or -1 on error.
+ */
+static int mex_http_read_body(HTTP_RD *rd, HTTP_RESP *r, long n)
+{
+    int fit = mex_http_body_grow(r, n > HTTP_MAX_RESPONSE ? HTTP_MAX_RESPONSE : (int)n);
+    int left = fit;
+
+    if (fit < 0)
+        return -1;
+
+    while (left > 0)
+    {
+        if (rd->pos == rd->len && mex_http_rd_fill(rd) < 0)
+            return -1;
+
+        int take = rd->len - rd->pos;
+        if (take > left)
+            take = left;
+
+        memcpy(r->body + r->body_len, rd->buf + rd->pos, take);
+        r->body_len += take;
+        rd->pos += take;
+        left -= take;
+    }
+
+    return (fit < n) ? 1 : 0;
+}
+
+/**
+ * @brief Read a body that is delimited only by the server closing.
+ * @return 0 at EOF, 1 if truncated, or -1 if out of memory.
+ */
+static int mex_http_read_to_eof(HTTP_RD *rd, HTTP_RESP *r)
+{
+    for (;;)
+    {
+        if (rd->pos == rd->len && mex_http_rd_fill(rd) < 0)
+            return 0;
+
+        int avail = rd->len - rd->pos;
+        int fit = mex_http_body_grow(r, avail);
+        if (fit < 0)
+            return -1;
+
+        memcpy(r->body + r->body_len, rd->buf + rd->pos, fit);
+        r->body_len += fit;
+        rd->pos += fit;
+
+        if (fit < avail)
+            return 1;
+    }
+}
+
+/**
+ * @brief Find a header in a response's header block.
+ * @param hdrs  Header block from HTTP_RESP.
+ * @param name  Header name (case-insensitive, without the colon).
+ * @param out   Output buffer for the value, with whitespace trimmed.
+ * @param max   Size of out.
+ * @return 1 if the header was found, 0 if not.
+ */
+static int mex_http_header(const char *hdrs, const char *name,
+                           char *out, int max)
+{
+    size_t nlen = strlen(name);
+    const char *p = strstr(hdrs, "\r\n");
+
+    while (p && p[2])
+    {
+        p += 2;
+
+        if (strncasecmp(p, name, nlen) == 0 && p[nlen] == ':')
         {
-            req_len = snprintf(req, sizeof(req),
-                "%s %s HTTP/1.1\r\n"
-                "Host: %s\r\n"
-                "Connection: close\r\n"
-                "%s"
-                "\r\n",
-                method, pu.path, pu.host,
-                headers ? headers : "");
+            const char *v = p + nlen + 1;
+            const char *e = strstr(v, "\r\n");
+            int len;
+
+            while (*v == ' ' || *v == '\t')
+                v++;
+
+            len = e ? (int)(e - v) : (int)strlen(v);
+            while (len > 0 && (v[len - 1] == ' ' || v[len - 1] == '\t'))
+                len--;
+            if (len >= max)
+                len = max - 1;
+
+            memcpy(out, v, len);
+            out[len] = '\0';
+            return 1;
         }
 
-        /* Send request */
-        if (mex_http_send(&conn, req, req_len, timeout_ms) < 0)
+        p = strstr(p, "\r\n");
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Read one complete response, using its framing to find the end.
+ *
+ * The body is delimited by Content-Length, chunked transfer-encoding or,
+ * failing both, by the server closing the connection. Interim 1xx
+ * responses are skipped. A connection is only marked reusable when the
+ * body was fully consumed and the server didn't ask to close.
+ *
+ * @param c          Connection to read from.
+ * @param head_only  Nonzero for a HEAD request (no body follows).
+ * @param timeout_ms Timeout per I/O operation.
+ * @param r          Output response (caller frees r->body).
+ * @param got_any    Output: nonzero if any bytes arrived at all.
+ * @return HTTP status code, or -1 if no usable status line arrived.
+ */
+static int mex_http_read_response(MEX_HTTP_CONN *c, int head_only,
+                                  int timeout_ms, HTTP_RESP *r, int *got_any)
+{
+    HTTP_RD rd;
+    char line[HTTP_MAX_HEADER];
+    char val[128];
+    int http10, rc;
+
+    rd.c = c;
+    rd.timeout_ms = timeout_ms;
+    rd.pos = rd.len = 0;
+    rd.got_any = 0;
+
+    r->status = -1;
+    r->keep_alive = 0;
+    r->hdrs[0] = '\0';
+    r->body = NULL;
+    r->body_len = r->body_cap = 0;
+
+    do
+    {
+        int hlen;
+
+        /* Status line: "HTTP/1.x NNN reason" */
+        if (mex_http_rd_line(&rd, line, sizeof(line)) < 0 ||
+            strncmp(line, "HTTP/", 5) != 0)
         {
-            logit("!MEX http_request: send failed");
-            mex_http_conn_close(&conn);
+            *got_any = rd.got_any;
             return -1;
         }
 
-        /* Send body if present */
-        if (body_len > 0)
+        char *sp = strchr(line, ' ');
+        r->status = sp ? atoi(sp + 1) : -1;
+        http10 = (strncmp(line, "HTTP/1.0", 8) == 0);
+
+        hlen = snprintf(r->hdrs, sizeof(r->hdrs) - 2, "%s\r\n", line);
+        if (hlen >= (int)sizeof(r->hdrs) - 2)
+            hlen = (int)sizeof(r->hdrs) - 3;
+
+        /* Headers, up to the blank line; excess is dropped */
+        for (;;)
         {
-            if (mex_http_send(&conn, body, body_len, timeout_ms) < 0)
+            int n = mex_http_rd_line(&rd, line, sizeof(line));
+            if (n < 0)
             {
-                logit("!MEX http_request: send body failed");
-                mex_http_conn_close(&conn);
+                *got_any = rd.got_any;
                 return -1;
             }
+            if (n == 0)
+                break;
+
+            if (hlen + n + 2 < (int)sizeof(r->hdrs))
+            {
+                memcpy(r->hdrs + hlen, line, n);
+                memcpy(r->hdrs + hlen + n, "\r\n", 3);
+                hlen += n + 2;
+            }
         }
+    } while (r->status >= 100 && r->status < 200);
 
-        /* Read response — accumulate until EOF */
-        char *raw = malloc(HTTP_MAX_RESPONSE + 1);
-        if (!raw)
+    *got_any = 1;
+
+    /* HTTP/1.1 persists unless told otherwise; 1.0 only if it says so */
+    if (mex_http_header(r->hdrs, "Connection", val, sizeof(val)))
+        r->keep_alive = http10 ? (strcasestr(val, "keep-alive") != NULL)
+                               : (strcasestr(val, "close") == NULL);
+    else
+        r->keep_alive = !http10;
+
+    if (head_only || r->status == 204 || r->status == 304)
+        rc = 0;
+    else if (mex_http_header(r->hdrs, "Transfer-Encoding", val, sizeof(val)) &&
+             strcasestr(val, "chunked"))
+    {
+        /* <hex-size>[;ext]\r\n<data>\r\n ... 0\r\n<trailers>\r\n */
+        for (;;)
         {
-            mex_http_conn_close(&conn);
-            return -1;
+            char *end;
+            long sz;
+
+            if (mex_http_rd_line(&rd, line, sizeof(line)) < 0)
+            {
+                rc = -1;
+                break;
+            }
+
+            sz = strtol(line, &end, 16);
+            if (end == line || sz < 0)
+            {
+                rc = -1;
+                break;
+            }
+
+            if (sz == 0)
+            {
+                int n;
+
+                while ((n = mex_http_rd_line(&rd, line, sizeof(line))) > 0)
+                    ;
+                rc = (n < 0) ? -1 : 0;
+                break;
+            }
+
+            if ((rc = mex_http_read_body(&rd, r, sz)) != 0)
+                break;
+
+            if (mex_http_rd_line(&rd, line, sizeof(line)) != 0)
+            {
+                rc = -1;
+                break;
+            }
+        }
+    }
+    else if (mex_http_header(r->hdrs, "Content-Length", val, sizeof(val)) &&
+             atol(val) >= 0)
+        rc = mex_http_read_body(&rd, r, atol(val));
+    else
+    {
+        /* Unframed: the body runs until the server closes */
+        mex_http_read_to_eof(&rd, r);
+        rc = 1;
+    }
+
+    /* A short, truncated or over-long response leaves the stream unusable */
+    if (rc != 0 || rd.pos != rd.len)
+        r->keep_alive = 0;
+
+    if (r->body)
+        r->body[r->body_len] = '\0';
+
+    return r->status;
+}
+
+/*------------------------------------------------------------------------*
+ * HTTP response cache                                                    *
+ *------------------------------------------------------------------------*/
+
+/**
+ * @brief A cached GET response.
+ *
+ * Only 200 responses that allow storing are kept. An entry is served
+ * without contacting the server until its Cache-Control max-age runs out;
+ * after that it is revalidated with If-None-Match when it has an ETag.
+ */
+typedef struct _mex_http_cached {
+    char      *key;           /**< URL + request headers; NULL = unused   */
+    char      *body;
+    int        body_len;
+    char       etag[128];     /**< Validator, or empty                    */
+    long long  expires_ms;    /**< Fresh until this time                  */
+    long long  last_use_ms;   /**< For discarding the least recently used */
+} MEX_HTTP_CACHED;
+
+static MEX_HTTP_CACHED g_http_cache[HTTP_CACHE_SIZE];
+static long g_http_cache_bytes = 0;
+
+/** @brief Release one cache entry. */
+static void mex_http_cache_free(MEX_HTTP_CACHED *pc)
+{
+    if (pc->key)
+    {
+        g_http_cache_bytes -= pc->body_len;
+        free(pc->key);
+    }
+    if (pc->body)
+        free(pc->body);
+    memset(pc, 0, sizeof(*pc));
+}
+
+/**
+ * @brief Build the cache key for a request.
+ *
+ * Request headers are part of the key, so responses fetched with
+ * different credentials never answer for one another.
+ *
+ * @return malloc'd key, or NULL if out of memory.
+ */
+static char *mex_http_cache_key(const char *url, const char *headers)
+{
+    size_t len = strlen(url) + strlen(headers) + 2;
+    char *key = malloc(len);
+
+    if (key)
+        snprintf(key, len, "%s\n%s", url, headers);
+    return key;
+}
+
+/** @brief Find the cache entry for a key, or NULL. */
+static MEX_HTTP_CACHED *mex_http_cache_find(const char *key)
+{
+    for (int i = 0; i < HTTP_CACHE_SIZE; i++)
+    {
+        if (g_http_cache[i].key && strcmp(g_http_cache[i].key, key) == 0)
+            return &g_http_cache[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Work out how long a response may be served from the cache.
+ * @param hdrs    Response header block.
+ * @param max_age Output: seconds the response stays fresh (0 = revalidate).
+ * @param etag    Output: ETag value (empty if none), 128 bytes.
+ * @return 1 if the response may be stored, 0 if not.
+ */
+static int mex_http_cache_policy(const char *hdrs, long *max_age, char *etag)
+{
+    char cc[256], vary[64];
+    const char *ma;
+
+    *max_age = 0;
+    etag[0] = '\0';
+    mex_http_header(hdrs, "ETag", etag, 128);
+
+    if (mex_http_header(hdrs, "Vary", vary, sizeof(vary)) && strchr(vary, '*'))
+        return 0;
+
+    if (mex_http_header(hdrs, "Cache-Control", cc, sizeof(cc)))
+    {
+        /* Responses the server marked as per-user are never kept */
+        if (strcasestr(cc, "no-store") || strcasestr(cc, "private"))
+            return 0;
+
+        if (!strcasestr(cc, "no-cache") && (ma = strcasestr(cc, "max-age=")) != NULL)
+        {
+            *max_age = atol(ma + 8);
+            if (*max_age < 0)
+                *max_age = 0;
         }
+    }
+
+    /* Nothing to gain from an entry that is never fresh and can't be revalidated */
+    return (*max_age > 0 || etag[0]);
+}
+
+/**
+ * @brief Store a 200 response, evicting the least recently used entries
+ *        to stay within mex.sockets.http_cache_max_kb.
+ */
+static void mex_http_cache_store(const char *key, const HTTP_RESP *r)
+{
+    MEX_HTTP_CACHED *pc;
+    char etag[128];
+    long max_age;
+    long limit = ngcfg_get_int("mex.sockets.http_cache_max_kb") * 1024L;
+    long long now = mex_sock_now_ms();
+
+    if (limit <= 0)
+        limit = HTTP_CACHE_MAX_KB * 1024L;
 
-        int raw_len = 0;
-        int done = 0;
+    /* Drop any older copy first; a response that can't be stored replaces it */
+    if ((pc = mex_http_cache_find(key)) != NULL)
+        mex_http_cache_free(pc);
+
+    if (!mex_http_cache_policy(r->hdrs, &max_age, etag) || r->body_len > limit)
+        return;
+
+    for (;;)
+    {
+        MEX_HTTP_CACHED *lru = NULL;
 
-        while (!done && raw_len < HTTP_MAX_RESPONSE)
+        pc = NULL;
+        for (int i = 0; i < HTTP_CACHE_SIZE; i++)
         {
-            int got = mex_http_recv(&conn, raw + raw_len,
-                                    HTTP_MAX_RESPONSE - raw_len,
-                                    timeout_ms);
-            if (got <= 0)
-                done = 1;
-            else
-                raw_len += got;
+            if (!g_http_cache[i].key)
+                pc = &g_http_cache[i];
+            else if (!lru || g_http_cache[i].last_use_ms < lru->last_use_ms)
+                lru = &g_http_cache[i];
         }
 
-        mex_http_conn_close(&conn);
+        if (pc && g_http_cache_bytes + r->body_len <= limit)
+            break;
+
+        mex_http_cache_free(lru);
+    }
+
+    if ((pc->key = strdup(key)) == NULL ||
+        (pc->body = malloc(r->body_len + 1)) == NULL)
+    {
+        if (pc->key)
+            free(pc->key);
+        memset(pc, 0, sizeof(*pc));
+        return;
+    }
 
-        if (raw_len <= 0)
+    if (r->body_len)
+        memcpy(pc->body, r->body, r->body_len);
+    pc->body[r->body_len] = '\0';
+    pc->body_len = r->body_len;
+    strcpy(pc->etag, etag);
+    pc->expires_ms = now + max_age * 1000LL;
+    pc->last_use_ms = now;
+    g_http_cache_bytes += r->body_len;
+}
+
+/**
+ * @brief Answer a request from a cache entry.
+ * @return 200, or -1 if out of memory.
+ */
+static int mex_http_cache_serve(MEX_HTTP_CACHED *pc, char **response,
+                                int *resp_len)
+{
+    char *out = malloc(pc->body_len + 1);
+
+    if (!out)
+        return -1;
+
+    memcpy(out, pc->body, pc->body_len + 1);
+    pc->last_use_ms = mex_sock_now_ms();
+
+    *response = out;
+    *resp_len = pc->body_len;
+    return 200;
+}
+
+/*------------------------------------------------------------------------*
+ * HTTP helper                                                            *
+ *------------------------------------------------------------------------*/
+
+/**
+ * @brief Open a new connection to the URL's server, with TLS if needed.
+ * @return 0 on success, -1 on error.
+ */
+static int mex_http_open(const PARSED_URL *pu, int timeout_ms, MEX_HTTP_CONN *c)
+{
+    c->fd = mex_sock_connect(pu->host, pu->port, timeout_ms);
+    c->tls = NULL;
+
+    if (c->fd < 0)
+    {
+        logit("!MEX http_request: connect to %s:%d failed", pu->host, pu->port);
+        return -1;
+    }
+
+    /* TLS handshake for HTTPS via OpenSSL (isolated in mex_tls.c) */
+    if (pu->use_tls)
+    {
+        int hs_tmo = ngcfg_get_int("mex.sockets.tls_handshake_timeout_ms");
+        if (hs_tmo <= 0)
+            hs_tmo = TLS_HANDSHAKE_TMO;
+
+        c->tls = mex_tls_connect(c->fd, pu->host, hs_tmo);
+        if (!c->tls)
         {
-            free(raw);
+            logit("!MEX http_request: TLS failed for %s:%d (cap %dms): %s",
+                  pu->host, pu->port, hs_tmo, mex_tls_last_error());
+            close(c->fd);
+            c->fd = -1;
             return -1;
         }
+    }
+
+    return 0;
+}
 
-        raw[raw_len] = '\0';
+/**
+ * @brief Send one request and read its response.
+ *
+ * Uses an idle pooled connection when one is open to the same server.
+ * If the server turns out to have closed it, the request is retried once
+ * on a fresh connection.  That is always safe when the send fails; when
+ * the connection closes before any part of a response arrives, only GET
+ * and HEAD are retried, and a read timeout is never retried.
+ *
+ * @param pu         Parsed URL.
+ * @param method     HTTP method.
+ * @param headers    Extra request headers (CRLF separated).
+ * @param body       Request body or empty string.
+ * @param keepalive  Nonzero to ask for and pool a persistent connection.
+ * @param timeout_ms Timeout per I/O operation.
+ * @param r          Output response (caller frees r->body).
+ * @return HTTP status code or -1 on error.
+ */
+static int mex_http_exchange(const PARSED_URL *pu, const char *method,
+                             const char *headers, const char *body,
+                             int keepalive, int timeout_ms, HTTP_RESP *r)
+{
+    char req[2048];
+    char clen[32] = "";
+    int body_len = (int)strlen(body);
+    int head_only = (strcasecmp(method, "HEAD") == 0);
+    int idempotent = head_only || strcasecmp(method, "GET") == 0;
+    int req_len;
+
+    if (body_len > 0)
+        snprintf(clen, sizeof(clen), "Content-Length: %d\r\n", body_len);
+
+    req_len = snprintf(req, sizeof(req),
+        "%s %s HTTP/1.1\r\n"
+        "Host: %s\r\n"
+        "Connection: %s\r\n"
+        "%s"
+        "%s"
+        "\r\n",
+        method, pu->path, pu->host,
+        keepalive ? "keep-alive" : "close",
+        clen, headers);
+
+    if (req_len < 0 || req_len >= (int)sizeof(req))
+    {
+        logit("!MEX http_request: request headers too long");
+        return -1;
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        MEX_HTTP_CONN conn;
+        int reused = keepalive && mex_http_pool_get(pu, &conn);
+        int got_any = 0;
+        long long sent_at;
+        int status;
 
-        /* Parse status line: "HTTP/1.x NNN reason\r\n" */
-        char *status_start = strstr(raw, "HTTP/");
-        if (status_start)
+        if (!reused && mex_http_open(pu, timeout_ms, &conn) < 0)
+            return -1;
+
+        if (mex_http_send(&conn, req, req_len, timeout_ms) < 0 ||
+            (body_len > 0 &&
+             mex_http_send(&conn, body, body_len, timeout_ms) < 0))
         {
-            char *sp = strchr(status_start, ' ');
-            if (sp)
-                status_code = atoi(sp + 1);
+            mex_http_conn_close(&conn);
+            if (reused)
+                continue;   /* Server dropped the idle connection */
+
+            logit("!MEX http_request: send failed");
+            return -1;
         }
 
-        /* Find header/body separator */
-        char *hdr_end = strstr(raw, "\r\n\r\n");
+        sent_at = mex_sock_now_ms();
+        status = mex_http_read_response(&conn, head_only, timeout_ms, r, &got_any);
 
-        /* Handle redirects (301, 302, 307, 308) */
-        if (status_code >= 301 && status_code <= 308 &&
-            status_code != 304 && status_code != 305 && hdr_end)
+        if (status < 0)
         {
-            char *loc = strcasestr(raw, "\r\nLocation:");
-            if (loc && loc < hdr_end)
+            mex_http_conn_close(&conn);
+            if (r->body)
             {
-                loc += 11;  /* skip "\r\nLocation:" */
-                while (*loc == ' ' || *loc == '\t') loc++;
-
-                char *loc_end = strpbrk(loc, "\r\n");
-                if (loc_end)
-                {
-                    size_t loc_len = loc_end - loc;
-                    if (loc_len > 0 && loc_len < sizeof(current_url))
-                    {
-                        /* Handle relative URLs */
-                        if (loc[0] == '/')
-                        {
-                            char abs_url[2048];
-                            const char *scheme = pu.use_tls ? "https" : "http";
-                            int default_port = pu.use_tls ? 443 : 80;
-
-                            if (pu.port != default_port)
-                                snprintf(abs_url, sizeof(abs_url), "%s://%s:%d%.*s",
-                                         scheme, pu.host, pu.port,
-                                         (int)loc_len, loc);
-                            else
-                                snprintf(abs_url, sizeof(abs_url), "%s://%s%.*s",
-                                         scheme, pu.host,
-                                         (int)loc_len, loc);
-
-                            strncpy(current_url, abs_url, sizeof(current_url) - 1);
-                            current_url[sizeof(current_url) - 1] = '\0';
-                        }
-                        else
-                        {
-                            /* Absolute URL from Location header */
-                            memcpy(current_url, loc, loc_len);
-                            current_url[loc_len] = '\0';
-                        }
-
-                        logit("MEX http_request: %d redirect -> %s",
-                              status_code, current_url);
-                        free(raw);
-                        continue;  /* Follow the redirect */
-                    }
-                }
+                free(r->body);
+                r->body = NULL;
             }
+
+            /* A pooled connection the server already closed fails at once
+             * with nothing read.  The server may still have acted on the
+             * request, so only repeat it if it is safe to do so. */
+            if (reused && !got_any && idempotent &&
+                mex_sock_now_ms() - sent_at < timeout_ms)
+                continue;
+
+            return -1;
         }
 
-        /* Not a redirect — extract body */
-        if (hdr_end)
-        {
-            char *body_start = hdr_end + 4;
-            int body_available = raw_len - (int)(body_start - raw);
+        if (keepalive && r->keep_alive)
+            mex_http_pool_put(pu, &conn);
+        else
+            mex_http_conn_close(&conn);
 
-            /* Check for chunked transfer-encoding */
-            int is_chunked = 0;
+        return status;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Perform a complete HTTP/1.1 request and return the response body.
+ *
+ * Supports both http:// and https:// URLs. Follows 301/302/307/308
+ * redirects up to MAX_REDIRECTS times. Uses MEX_HTTP_CONN for TLS-aware
+ * I/O via OpenSSL when available.
+ *
+ * With mex.sockets.http_keepalive set, connections are kept open in the
+ * pool for later requests to the same server. With mex.sockets.http_cache
+ * set, plain GET requests may be answered from the response cache; a 304
+ * from revalidation is returned to the script as the cached 200.
+ *
+ * @param url        Full URL (http:// or https://).
+ * @param method     HTTP method ("GET", "POST", etc.).
+ * @param headers    Extra headers (\r\n separated) or empty string.
+ * @param body       Request body (for POST/PUT) or empty string.
+ * @param response   Output buffer for response body (caller frees).
+ * @param resp_len   Output: length of response body.
+ * @param timeout_ms Timeout per I/O operation.
+ * @return HTTP status code (200, 404, etc.) or -1 on error.
+ */
+static int mex_http_request(const char *url, const char *method,
+                            const char *headers, const char *body,
+                            char **response, int *resp_len, int timeout_ms)
+{
+    char current_url[2048];
+    int keepalive = ngcfg_get_bool("mex.sockets.http_keepalive");
+    int use_cache;
+    int redir;
+
+    *response = NULL;
+    *resp_len = 0;
+
+    /* Conditional requests from the script itself bypass the cache, so
+     * the script sees the server's own 304. */
+    use_cache = ngcfg_get_bool("mex.sockets.http_cache") &&
+                strcasecmp(method, "GET") == 0 && !*body &&
+                !strcasestr(headers, "If-None-Match") &&
+                !strcasestr(headers, "If-Modified-Since");
+
+    strncpy(current_url, url, sizeof(current_url) - 1);
+    current_url[sizeof(current_url) - 1] = '\0';
+
+    for (redir = 0; redir <= MAX_REDIRECTS; redir++)
+    {
+        PARSED_URL pu;
+        HTTP_RESP r;
+        MEX_HTTP_CACHED *pc = NULL;
+        char *key = NULL;
+        char *req_headers = (char *)headers;
+        int revalidate = 0;
+        int status_code;
+
+        if (mex_parse_url(current_url, &pu) < 0)
+            return -1;
+
+        if (use_cache && (key = mex_http_cache_key(current_url, headers)) != NULL &&
+            (pc = mex_http_cache_find(key)) != NULL)
+        {
+            if (mex_sock_now_ms() < pc->expires_ms)
             {
-                char *te = strcasestr(raw, "\r\nTransfer-Encoding:");
-                if (te && te < hdr_end && strcasestr(te, "chunked"))
-                    is_chunked = 1;
+                logit("MEX http_request: cache hit for %s", current_url);
+                free(key);
+                return mex_http_cache_serve(pc, response, resp_len);
             }
 
-            if (is_chunked)
+            /* Stale: ask the server whether our copy is still good */
+            if (pc->etag[0])
             {
-                /* Decode chunked body in-place:
-                 *   <hex-size>\r\n<data>\r\n ... 0\r\n\r\n */
-                char *out = malloc(body_available + 1);
-                if (out)
+                size_t len = strlen(headers) + strlen(pc->etag) + 20;
+
+                if ((req_headers = malloc(len)) != NULL)
                 {
-                    int out_len = 0;
-                    char *p = body_start;
-                    char *end = body_start + body_available;
-
-                    while (p < end)
-                    {
-                        /* Parse hex chunk size */
-                        long chunk_sz = strtol(p, NULL, 16);
-                        if (chunk_sz <= 0)
-                            break;  /* Final 0-length chunk or parse error */
-
-                        /* Skip past the size line (\r\n) */
-                        char *data = strstr(p, "\r\n");
-                        if (!data)
-                            break;
-                        data += 2;
-
-                        /* Copy chunk data */
-                        int avail = (int)(end - data);
-                        int to_copy = (chunk_sz < avail) ? (int)chunk_sz : avail;
-                        if (out_len + to_copy > HTTP_MAX_RESPONSE)
-                            to_copy = HTTP_MAX_RESPONSE - out_len;
-
-                        memcpy(out + out_len, data, to_copy);
-                        out_len += to_copy;
-
-                        /* Advance past chunk data + trailing \r\n */
-                        p = data + chunk_sz;
-                        if (p + 2 <= end && p[0] == '\r' && p[1] == '\n')
-                            p += 2;
-                    }
-
-                    out[out_len] = '\0';
-                    *response = out;
-                    *resp_len = out_len;
+                    snprintf(req_headers, len, "If-None-Match: %s\r\n%s",
+                             pc->etag, headers);
+                    revalidate = 1;
                 }
+                else
+                    req_headers = (char *)headers;
             }
-            else
-            {
-                /* Non-chunked: use Content-Length or raw body size */
-                char *cl = strcasestr(raw, "Content-Length:");
-                if (cl && cl < hdr_end)
-                {
-                    content_length = atoi(cl + 15);
-                    if (content_length < 0)
-                        content_length = -1;
-                }
+        }
 
-                if (content_length >= 0 && content_length < body_available)
-                    body_available = content_length;
+        status_code = mex_http_exchange(&pu, method, req_headers, body,
+                                        keepalive, timeout_ms, &r);
+
+        if (revalidate)
+            free(req_headers);
+
+        if (status_code < 0)
+        {
+            if (key)
+                free(key);
+            return -1;
+        }
+
+        /* Our copy is still current — refresh it and answer from it */
+        if (status_code == 304 && revalidate)
+        {
+            char etag[128];
+            long max_age;
+
+            if (mex_http_cache_policy(r.hdrs, &max_age, etag))
+                pc->expires_ms = mex_sock_now_ms() + max_age * 1000LL;
+
+            if (r.body)
+                free(r.body);
+            free(key);
+
+            logit("MEX http_request: %s not modified, using cached copy",
+                  current_url);
+            return mex_http_cache_serve(pc, response, resp_len);
+        }
 
-                if (body_available > HTTP_MAX_RESPONSE)
-                    body_available = HTTP_MAX_RESPONSE;
+        /* Handle redirects (301, 302, 307, 308) */
+        if (status_code >= 301 && status_code <= 308 &&
+            status_code != 304 && status_code != 305)
+        {
+            char loc[2048];
 
-                char *resp_buf = malloc(body_available + 1);
-                if (resp_buf)
+            if (mex_http_header(r.hdrs, "Location", loc, sizeof(loc)) && loc[0])
+            {
+                if (loc[0] == '/')
                 {
-                    memcpy(resp_buf, body_start, body_available);
-                    resp_buf[body_available] = '\0';
-                    *response = resp_buf;
-                    *resp_len = body_available;
+                    /* Handle relative URLs */
+                    const char *scheme = pu.use_tls ? "https" : "http";
+                    int default_port = pu.use_tls ? 443 : 80;
+
+                    if (pu.port != default_port)
+                        snprintf(current_url, sizeof(current_url), "%s://%s:%d%.*s",
+                                 scheme, pu.host, pu.port, (int)strlen(loc), loc);
+                    else
+                        snprintf(current_url, sizeof(current_url), "%s://%s%.*s",
+                                 scheme, pu.host, (int)strlen(loc), loc);
                 }
+                else
+                {
+                    /* Absolute URL from Location header */
+                    strcpy(current_url, loc);
+                }
+
+                logit("MEX http_request: %d redirect -> %s",
+                      status_code, current_url);
+
+                if (r.body)
+                    free(r.body);
+                if (key)
+                    free(key);
+                continue;  /* Follow the redirect */
             }
         }
 
-        free(raw);
-
-        if (status_code <= 0)
-            status_code = -1;
+        if (key)
+        {
+            if (status_code == 200)
+                mex_http_cache_store(key, &r);
+            free(key);
+        }
 
+        *response = r.body;
+        *resp_len = r.body_len;
         return status_code;
     }
 
@@ -890,7 +1716,8 @@ word EXPENTRY intrin_sock_close(void)
  * @brief MEX: sock_send(sh, data, len) -> bytes sent or -1
  *
  * Send raw bytes over an open socket. The len parameter specifies how many
- * bytes of data to send (0 = send entire string length).
+ * bytes of data to send (0 = send entire string length). On a non-blocking
+ * socket only what fits in the send buffer is sent, possibly 0 bytes.
  */
 word EXPENTRY intrin_sock_send(void)
 {
@@ -916,7 +1743,18 @@ word EXPENTRY intrin_sock_send(void)
     if (len <= 0 || len > data_len)
         len = data_len;
 
-    int sent = mex_sock_send_timeout(s->fd, data, len, SOCK_DEFAULT_TMO);
+    int sent;
+
+    if (s->nonblock)
+    {
+        /* Send what fits in the socket buffer; 0 means try again later */
+        sent = send(s->fd, data, len, 0);
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            sent = 0;
+    }
+    else
+        sent = mex_sock_send_timeout(s->fd, data, len, SOCK_DEFAULT_TMO);
+
     free(data);
 
     if (sent < 0)
@@ -931,6 +1769,8 @@ word EXPENTRY intrin_sock_send(void)
  *
  * Receive up to max_len bytes with timeout. Returns bytes received,
  * 0 on timeout, -1 on error/disconnect. The buffer is passed by reference.
+ * While waiting, carrier and the time limit are still checked. On a
+ * non-blocking socket the timeout is ignored and 0 means no data yet.
  */
 word EXPENTRY intrin_sock_recv(void)
 {
@@ -963,7 +1803,21 @@ word EXPENTRY intrin_sock_recv(void)
     if (!buf)
         return MexArgEnd(&ma);
 
-    int got = mex_sock_recv_timeout(s->fd, buf, max_len, timeout_ms);
+    int got;
+
+    if (s->nonblock)
+    {
+        /* Never wait: 0 = nothing yet, -1 = closed or failed */
+        got = recv(s->fd, buf, max_len, 0);
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            got = 0;
+        else if (got <= 0)
+            got = -1;
+    }
+    else if (mex_sock_wait(1u << sh, 0, timeout_ms) == sh)
+        got = mex_sock_recv_timeout(s->fd, buf, max_len, 0);
+    else
+        got = 0;   /* timeout */
 
     /* Store result into the ref string */
     MexKillString(&where);
@@ -1062,6 +1916,67 @@ word EXPENTRY intrin_sock_avail(void)
     return MexArgEnd(&ma);
 }
 
+/**
+ * @brief MEX: sock_nonblock(sh, on) -> 0 or -1
+ *
+ * Switch a socket between blocking and non-blocking mode. In non-blocking
+ * mode sock_recv and sock_send return at once; use sock_wait to sleep
+ * until there is something to do.
+ */
+word EXPENTRY intrin_sock_nonblock(void)
+{
+    MA ma;
+    int sh, on;
+
+    MexArgBegin(&ma);
+    sh = (int)MexArgGetWord(&ma);
+    on = (int)MexArgGetWord(&ma);
+
+    regs_2[0] = (word)-1;
+
+    MEX_SOCK *s = mex_sock_validate(sh);
+    if (!s)
+        return MexArgEnd(&ma);
+
+    if ((on ? mex_sock_set_nonblock(s->fd) : mex_sock_set_blocking(s->fd)) == 0)
+    {
+        s->nonblock = (on != 0);
+        regs_2[0] = 0;
+    }
+
+    return MexArgEnd(&ma);
+}
+
+/**
+ * @brief MEX: sock_wait(mask, flags, timeout_ms) -> handle, SOCK_WAIT_KEY
+ *        or SOCK_WAIT_TIMEOUT
+ *
+ * Sleep until one of the sockets in mask has data (or was closed by the
+ * peer), the caller presses a key (with SOCK_WAIT_INPUT), or the timeout
+ * runs out. Bit n of mask selects handle n; 0 selects every open socket.
+ * A timeout of 0 polls, SOCK_WAIT_FOREVER waits with no limit. The key
+ * is left unread for getch() or input_ch().
+ */
+word EXPENTRY intrin_sock_wait(void)
+{
+    MA ma;
+    unsigned mask;
+    int flags, timeout_ms;
+
+    MexArgBegin(&ma);
+    mask       = (unsigned)MexArgGetWord(&ma);
+    flags      = (int)MexArgGetWord(&ma);
+    timeout_ms = (int)(sword)MexArgGetWord(&ma);
+
+    mex_sock_ensure_init();
+
+    if (timeout_ms > SOCK_MAX_TMO)
+        timeout_ms = SOCK_MAX_TMO;
+
+    regs_2[0] = (word)mex_sock_wait(mask, flags, timeout_ms);
+    return MexArgEnd(&ma);
+}
+
 /**
  * @brief MEX: http_request(url, method, headers, body, ref response, timeout_ms)
  *        -> HTTP status code or -1
@@ -1107,11 +2022,18 @@ word EXPENTRY intrin_http_request(void)
 
     char *response = NULL;
     int resp_len = 0;
+
+    /* A pooled connection may have been closed by the server; writing to
+     * it must fail with EPIPE rather than kill the node. */
+    void (*old_pipe)(int) = signal(SIGPIPE, SIG_IGN);
+
     int status = mex_http_request(url, method,
                                   headers ? headers : "",
                                   body ? body : "",
                                   &response, &resp_len, timeout_ms);
 
+    signal(SIGPIPE, old_pipe);
+
     /* Store response body into the ref string */
     MexKillString(&resp_where);
     if (response && resp_len > 0)
@@ -1159,6 +2081,10 @@ void MexSockCleanup(void)
     }
     g_mex_socks_initialized = 0;  /* Re-init on next session */
 
+    /* Idle HTTP connections and cached responses are kept for the next
+     * session on this node; just let go of connections that have expired. */
+    mex_http_pool_reap();
+
     mex_tls_global_cleanup();
 }
 
@@ -1177,6 +2103,7 @@ void MexSockInit(void)
         g_mex_socks[i].connected = MEX_SOCK_CLOSED;
         g_mex_socks[i].host[0] = '\0';
         g_mex_socks[i].port = 0;
+        g_mex_socks[i].nonblock = 0;
     }
 }
 
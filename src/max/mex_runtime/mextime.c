@@ -182,10 +182,17 @@
     /* Fix adjusted data in the user record */
 
     added=usr.time_added-was_added;
-    pmisThis->pmu->time_added+=added;
     ci_timeadd(added);
-    if (usr.xp_flag & XFLAG_EXPMINS)
-      pmisThis->pmu->xp_mins+=(usr.xp_mins-was_xp_mins);
+
+    /* Keep the program's copy of the user record in step */
+
+    if (pmisThis->fUserBound)
+    {
+      pmisThis->pmu->time_added+=added;
+
+      if (usr.xp_flag & XFLAG_EXPMINS)
+        pmisThis->pmu->xp_mins+=(usr.xp_mins-was_xp_mins);
+    }
 
 /*    Printf("Tried to add %ld seconds to time; ended up adding %ld\n",
            lDelta, regs_4[0]);*/
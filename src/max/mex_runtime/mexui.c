@@ -1405,6 +1405,8 @@ word EXPENTRY intrin_ui_scroll_region_render(void)
   obj = mex_find_scroll_region(key);
   if (obj)
   {
+    /* The script may have drawn over the widget since; repaint all of it */
+    ui_shadowbuf_invalidate(&obj->r.sb);
     ui_scrolling_region_render(&obj->r);
     if (pmisThis->pmid->instant_video)
       vbuf_flush();
@@ -1635,6 +1637,8 @@ word EXPENTRY intrin_ui_text_viewer_render(void)
   obj = mex_find_text_viewer(key);
   if (obj)
   {
+    /* The script may have drawn over the widget since; repaint all of it */
+    ui_shadowbuf_invalidate(&obj->v.sb);
     ui_text_viewer_render(&obj->v);
     if (pmisThis->pmid->instant_video)
       vbuf_flush();
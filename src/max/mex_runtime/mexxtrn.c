@@ -119,14 +119,16 @@
       memmove(cap, s, wLen);
       cap[wLen]=0;
 
-      MexImportUser(pmisThis->pmu, &usr);
+      if (MexUserDirty(pmisThis))
+        MexImportUser(pmisThis->pmu, &usr);
 
       /* Call the external program */
 
       regs_2[0]=Outside(NULL, NULL, out_method, cap, FALSE, CTL_NONE,
                         RESTART_MENU, NULL);
 
-      MexExportUser(pmisThis->pmu, &usr);
+      if (pmisThis->fUserBound)
+        MexBindUser(pmisThis);
 
       free(cap);
     }
@@ -45,6 +45,7 @@ static char rcs_id[]="$Id: m_header.c,v 1.5 2004/01/28 06:38:10 paltas Exp $";
 #include "max_msg.h"
 #include "m_full.h"
 #include "node.h"
+#include "nlx.h"
 #include "userapi.h"
 
 static int near SendWarnings(PMAH pmah);
@@ -316,6 +317,24 @@ int Get_FidoList_Name(XMSG *msg, char *netnode, char *fidouser)
   {
     const char *net_info_base = ngcfg_get_path("maximus.net_info_path");
     int nlver = ngcfg_get_nodelist_version_int();
+    NLXMAP *nm;
+    struct _nlxrec *r;
+
+    /* Try the compiled nodelist index first, whatever the format */
+
+    if ((nm=NlxOpen(net_info_base)) != NULL &&
+        (r=NlxFindName(nm, (char *)msg->to)) != NULL)
+    {
+      NETADDR dest;
+
+      dest.zone=r->zone;
+      dest.net=r->net;
+      dest.node=r->node;
+      dest.point=r->point;
+
+      strcpy(netnode, Address(&dest));
+      return TRUE;
+    }
 
     if (nlver==NLVER_7)
     {
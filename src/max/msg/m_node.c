@@ -41,6 +41,7 @@ static char rcs_id[]="$Id: m_node.c,v 1.4 2004/01/28 06:38:10 paltas Exp $";
 #include "cfg_consts.h"
 #include "max_msg.h"
 #include "node.h"
+#include "nlx.h"
 
 /* Returns TRUE if caller should display a 'press enter' prompt after */
 
@@ -54,7 +55,10 @@ static int near Show_Nodelist(NETADDR *n)
   display_line=display_col=1;
   nlver = ngcfg_get_nodelist_version_int();
   
-  if (nlver==NLVER_7 || nlver==NLVER_FD)
+  /* Browsing needs either a V5/V6 nodelist or the compiled index */
+
+  if ((nlver==NLVER_7 || nlver==NLVER_FD) &&
+      NlxOpen(ngcfg_get_path("maximus.net_info_path"))==NULL)
   {
     Puts(not_impl);
     return 1;
@@ -582,7 +582,7 @@ static void near Quote_RenderFrame(const quote_popup_t *qp)
  *        the highlight bar as an attribute override.
  *
  * 1. ui_scrolling_region_render() rebuilds the shadow buffer from line
- *    data and paints the full viewport (fixing partial-scroll bug).
+ *    data and paints whatever changed in the viewport.
  * 2. The highlighted row's cell attributes are overwritten to hilite_attr.
  * 3. Only the highlight row is re-painted (single-row delta).
  */
@@ -590,7 +590,7 @@ static void near Quote_RenderContent(quote_popup_t *qp)
 {
   int highlight_vis;
 
-  /* Full render + paint of content area */
+  /* Render + paint of content area */
   ui_scrolling_region_render(&qp->scroll);
 
   /* Apply highlight bar attribute override (theme-resolved) */
@@ -738,8 +738,8 @@ static void near Quote_LiveUpdate(quote_popup_t *qp)
   /* Redraw the static popup frame (borders + title + help bar) */
   Quote_RenderFrame(qp);
 
-  /* Invalidate shadow buffer so content area fully repaints */
-  qp->scroll.sb_valid = 0;
+  /* The editor repaint may have drawn over the content area */
+  ui_shadowbuf_invalidate(&qp->scroll.sb);
 
   /* Repaint popup content with highlight overlay */
   Quote_RenderContent(qp);
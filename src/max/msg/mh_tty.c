@@ -119,48 +119,78 @@ int near TTYGetPrivate(PMAH pmah, XMSG *msg)
 
 static word near ngcfg_get_msg_ask_priv(int idx)
 {
+  static struct ngcfg_key *keys[MSGKEY_URQ+1];
+  const char *path;
+
   switch (idx)
   {
     case MSGKEY_PRIVATE:
-      return ngcfg_get_int("matrix.message_edit.ask.private");
+      path="matrix.message_edit.ask.private";
+      break;
     case MSGKEY_CRASH:
-      return ngcfg_get_int("matrix.message_edit.ask.crash");
+      path="matrix.message_edit.ask.crash";
+      break;
     case MSGKEY_FILE:
-      return ngcfg_get_int("matrix.message_edit.ask.fileattach");
+      path="matrix.message_edit.ask.fileattach";
+      break;
     case MSGKEY_KILL:
-      return ngcfg_get_int("matrix.message_edit.ask.killsent");
+      path="matrix.message_edit.ask.killsent";
+      break;
     case MSGKEY_HOLD:
-      return ngcfg_get_int("matrix.message_edit.ask.hold");
+      path="matrix.message_edit.ask.hold";
+      break;
     case MSGKEY_FRQ:
-      return ngcfg_get_int("matrix.message_edit.ask.filerequest");
+      path="matrix.message_edit.ask.filerequest";
+      break;
     case MSGKEY_URQ:
-      return ngcfg_get_int("matrix.message_edit.ask.updaterequest");
+      path="matrix.message_edit.ask.updaterequest";
+      break;
     default:
       return 0;
   }
+
+  if (keys[idx]==NULL)
+    keys[idx]=ngcfg_key(path);
+
+  return (word)ngcfg_key_int(keys[idx]);
 }
 
 static word near ngcfg_get_msg_assume_priv(int idx)
 {
+  static struct ngcfg_key *keys[MSGKEY_URQ+1];
+  const char *path;
+
   switch (idx)
   {
     case MSGKEY_PRIVATE:
-      return ngcfg_get_int("matrix.message_edit.assume.private");
+      path="matrix.message_edit.assume.private";
+      break;
     case MSGKEY_CRASH:
-      return ngcfg_get_int("matrix.message_edit.assume.crash");
+      path="matrix.message_edit.assume.crash";
+      break;
     case MSGKEY_FILE:
-      return ngcfg_get_int("matrix.message_edit.assume.fileattach");
+      path="matrix.message_edit.assume.fileattach";
+      break;
     case MSGKEY_KILL:
-      return ngcfg_get_int("matrix.message_edit.assume.killsent");
+      path="matrix.message_edit.assume.killsent";
+      break;
     case MSGKEY_HOLD:
-      return ngcfg_get_int("matrix.message_edit.assume.hold");
+      path="matrix.message_edit.assume.hold";
+      break;
     case MSGKEY_FRQ:
-      return ngcfg_get_int("matrix.message_edit.assume.filerequest");
+      path="matrix.message_edit.assume.filerequest";
+      break;
     case MSGKEY_URQ:
-      return ngcfg_get_int("matrix.message_edit.assume.updaterequest");
+      path="matrix.message_edit.assume.updaterequest";
+      break;
     default:
       return 0;
   }
+
+  if (keys[idx]==NULL)
+    keys[idx]=ngcfg_key(path);
+
+  return (word)ngcfg_key_int(keys[idx]);
 }
 
 
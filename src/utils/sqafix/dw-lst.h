@@ -51,6 +51,28 @@
 #define LST_ERROR      ((USHORT)-1u)
 #define LST_END        ((USHORT)-1u)
 
+  // List hash index entry structure
+
+  typedef struct _LHE {         /* lhe */
+    struct _LHE FAR * plheNext; // Pointer to the next entry in bucket
+    PLE ple;                    // Pointer to the indexed list element
+    ULONG hash;                 // Element key hash value
+  } LHE, FAR * PLHE;
+
+  // List hash index structure
+
+  typedef struct _LH {          /* lh */
+    PLHE FAR * aplhe;           // Bucket array
+    USHORT cBucket;             // Number of buckets, always power of two
+    ULONG cEntry;               // Number of indexed elements
+  } LH, FAR * PLH;
+  typedef PLH FAR * PPLH;
+
+  // List hash index constants
+
+#define LST_HASHMIN    64       // Initial bucket count
+#define LST_HASHMAX    8192     // Bucket count growth limit
+
 /***************************************************************************
 * List manager function prototypes
 */
@@ -63,6 +85,16 @@
   USHORT APIENTRY LstIndexFromElement(PLE ple1st, PLE ple);
   USHORT APIENTRY LstQueryElementCount(PLE ple1st);
 
+  PLH    APIENTRY LstHashCreate(USHORT cBucket);
+  VOID   APIENTRY LstHashDestroy(PLH plh);
+  BOOL   APIENTRY LstHashAdd(PLH plh, PLE ple, ULONG hash);
+  BOOL   APIENTRY LstHashDelete(PLH plh, PLE ple, ULONG hash);
+  PLE    APIENTRY LstHashFind(PLH plh, ULONG hash, PLE pleAfter);
+  USHORT APIENTRY LstLinkHashElement(PPLE pple1st, PLE ple, USHORT ile,
+                                     PPLH pplh, ULONG hash);
+  PLE    APIENTRY LstUnlinkHashElement(PPLE pple1st, USHORT ile,
+                                       PPLH pplh, ULONG hash);
+
 #endif /* DW_LST_DEFS */
 
 /***************************************************************************
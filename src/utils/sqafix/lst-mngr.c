@@ -61,7 +61,59 @@
 // M o d u l e   l o c a l   s u b r o u t i n e s                         //
 /////////////////////////////////////////////////////////////////////////////
 
-  // None so far ...
+/***************************************************************************
+* This subroutine returns the bucket number for the given hash value.
+* Key hashes tend to differ in the low bits only a little (e.g. node
+* numbers) so fold the upper half down before masking
+*/
+
+  static USHORT SUBENTRY LstHashSlot(PLH plh, ULONG hash)
+  {
+    hash^= hash >> 16;
+    hash*= 0x45D9F3Blu;
+    hash^= hash >> 16;
+
+    return (USHORT) (hash & (plh->cBucket - 1));
+  }
+
+/***************************************************************************
+* This subroutine doubles the hash index bucket array if it's overloaded.
+* Failure to grow is not fatal, the chains just get longer
+*/
+
+  static VOID SUBENTRY LstHashGrow(PLH plh)
+  {
+    PLHE FAR * aplheOld = plh->aplhe;
+    USHORT cBucketOld = plh->cBucket;
+    PLHE plhe, plheNext;
+    USHORT iBucket, iSlot;
+
+    // Check if there is a need and room to grow
+
+    if (plh->cEntry <= 2 * (ULONG) cBucketOld || cBucketOld >= LST_HASHMAX)
+      return;
+
+    // Allocate the new bucket array
+
+    if ((plh->aplhe = MemAlloc(sizeof(PLHE) * cBucketOld * 2, MA_CLEAR)) == NULL) {
+      plh->aplhe = aplheOld;
+      return;
+    }
+
+    plh->cBucket = cBucketOld * 2;
+
+    // Move all the entries over to the new buckets
+
+    for (iBucket = 0; iBucket < cBucketOld; iBucket++)
+      for (plhe = aplheOld[iBucket]; plhe != NULL; plhe = plheNext) {
+        plheNext = plhe->plheNext;
+        iSlot = LstHashSlot(plh, plhe->hash);
+        plhe->plheNext = plh->aplhe[iSlot];
+        plh->aplhe[iSlot] = plhe;
+      }
+
+    MemFree(aplheOld);
+  }
 
 /////////////////////////////////////////////////////////////////////////////
 // P u b l i c   r o u t i n e s                                           //
@@ -587,6 +639,179 @@ ASM     mov     ile, cx
     return ile;
   }
 
+/***************************************************************************
+* This routine creates the new list hash index with the given number of
+* buckets, which is rounded up to the power of two
+*/
+
+  PLH APIENTRY LstHashCreate(USHORT cBucket)
+  {
+    USHORT cb = LST_HASHMIN;
+    PLH plh;
+
+    while (cb < cBucket && cb < LST_HASHMAX) cb*= 2;
+
+    if ((plh = MemAlloc(sizeof(LH), MA_CLEAR)) == NULL)
+      return NULL;
+
+    if ((plh->aplhe = MemAlloc(sizeof(PLHE) * cb, MA_CLEAR)) == NULL) {
+      MemFree(plh);
+      return NULL;
+    }
+
+    plh->cBucket = cb;
+
+    return plh;
+  }
+
+/***************************************************************************
+* This routine destroys the given list hash index. Note that the indexed
+* list elements are not affected
+*/
+
+  VOID APIENTRY LstHashDestroy(PLH plh)
+  {
+    PLHE plhe, plheNext;
+    USHORT iBucket;
+
+    if (plh == NULL) return;
+
+    for (iBucket = 0; iBucket < plh->cBucket; iBucket++)
+      for (plhe = plh->aplhe[iBucket]; plhe != NULL; plhe = plheNext) {
+        plheNext = plhe->plheNext;
+        MemFree(plhe);
+      }
+
+    MemFree(plh->aplhe);
+    MemFree(plh);
+  }
+
+/***************************************************************************
+* This routine adds the given list element to the hash index
+*/
+
+  BOOL APIENTRY LstHashAdd(PLH plh, PLE ple, ULONG hash)
+  {
+    USHORT iSlot;
+    PLHE plhe;
+
+    if ((plhe = MemAlloc(sizeof(LHE), 0)) == NULL)
+      return FALSE;
+
+    // Append to the bucket chain so that equal keys are found
+    // in the order they were added
+
+    plhe->plheNext = NULL;
+    plhe->ple = ple;
+    plhe->hash = hash;
+
+    iSlot = LstHashSlot(plh, hash);
+    if (plh->aplhe[iSlot] == NULL)
+      plh->aplhe[iSlot] = plhe;
+    else {
+      PLHE plheLast = plh->aplhe[iSlot];
+      while (plheLast->plheNext != NULL) plheLast = plheLast->plheNext;
+      plheLast->plheNext = plhe;
+    }
+
+    plh->cEntry++;
+    LstHashGrow(plh);
+
+    return TRUE;
+  }
+
+/***************************************************************************
+* This routine removes the given list element from the hash index
+*/
+
+  BOOL APIENTRY LstHashDelete(PLH plh, PLE ple, ULONG hash)
+  {
+    PLHE FAR * pplhe;
+    PLHE plhe;
+
+    for (pplhe = &plh->aplhe[LstHashSlot(plh, hash)]; (plhe = *pplhe) != NULL;
+         pplhe = &plhe->plheNext)
+      if (plhe->ple == ple) {
+        *pplhe = plhe->plheNext;
+        MemFree(plhe);
+        plh->cEntry--;
+        return TRUE;
+      }
+
+    return FALSE;
+  }
+
+/***************************************************************************
+* This routine returns the next list element with the given hash value
+* following the pleAfter element, or the first one if pleAfter is null.
+* The caller has to verify the actual key since hash values may collide
+*/
+
+  PLE APIENTRY LstHashFind(PLH plh, ULONG hash, PLE pleAfter)
+  {
+    PLHE plhe = plh->aplhe[LstHashSlot(plh, hash)];
+
+    // Skip up to and including the previously returned element
+
+    if (pleAfter != NULL) {
+      while (plhe != NULL && plhe->ple != pleAfter) plhe = plhe->plheNext;
+      if (plhe == NULL) return NULL;
+      plhe = plhe->plheNext;
+    }
+
+    // Look for the next element with the same hash value
+
+    for (; plhe != NULL; plhe = plhe->plheNext)
+      if (plhe->hash == hash)
+        return plhe->ple;
+
+    return NULL;
+  }
+
+/***************************************************************************
+* This routine links element at the given position keeping the list hash
+* index in sync. The index is created along with the very first element,
+* and it's dropped if it can't be updated so that it is either complete
+* or missing altogether and the caller has to fall back to a list scan
+*/
+
+  USHORT APIENTRY LstLinkHashElement(PPLE pple1st, PLE ple, USHORT ile,
+                                     PPLH pplh, ULONG hash)
+  {
+    USHORT ileReturn;
+
+    // Create the index if this is the first element in list
+
+    if (*pplh == NULL && *pple1st == NULL)
+      *pplh = LstHashCreate(0);
+
+    // Link the element in and index it
+
+    if ((ileReturn = LstLinkElement(pple1st, ple, ile)) != LST_ERROR &&
+        *pplh != NULL && !LstHashAdd(*pplh, ple, hash)) {
+      LstHashDestroy(*pplh);
+      *pplh = NULL;
+    }
+
+    return ileReturn;
+  }
+
+/***************************************************************************
+* This routine unlinks the given element from list keeping the list hash
+* index in sync
+*/
+
+  PLE APIENTRY LstUnlinkHashElement(PPLE pple1st, USHORT ile,
+                                    PPLH pplh, ULONG hash)
+  {
+    PLE ple;
+
+    if ((ple = LstUnlinkElement(pple1st, ile)) != NULL && *pplh != NULL)
+      LstHashDelete(*pplh, ple, hash);
+
+    return ple;
+  }
+
 /***************************************************************************
 * End of LST-MNGR.C                                                        *
 ****************************************************************************/
@@ -1792,11 +1792,10 @@
 
    // Check if we have seen the node with the same address
 
-   for (pnode = cfg.pnodeFirst; pnode != NULL; pnode = pnode->pnodeNext)
-     if (!xmemcmp(&pnode->netAddr, &netAddr, sizeof(NETADDR))) {
-       DoLineError("Node %s is already defined\n", FormatNetAddr(&netAddr));
-       exit(EXIT_FAILURE);
-     }
+   if (GetNodeFromAddr(&netAddr) != NULL) {
+     DoLineError("Node %s is already defined\n", FormatNetAddr(&netAddr));
+     exit(EXIT_FAILURE);
+   }
 
    // Check if there is a password and scan it in
 
@@ -1826,18 +1825,19 @@
      }
    }
 
-   // Create the new node list element and link it in
+   // Create the new node list element
 
    if ((pnode = (PNODE) LstCreateElement(sizeof(NODE) + cchPassword)) == NULL) {
      DoLineError("Insufficient memory (node list)\n");
      exit(EXIT_FAILURE);
-   } else
-     LstLinkElement((PPLE) &cfg.pnodeFirst, (PLE) pnode, LST_END);
+   }
 
-   // Set the node address and password
+   // Set the node address and password and link it in
 
    xmemcpy(&pnode->netAddr, &netAddr, sizeof(NETADDR));
    xmemcpy(pnode->achPassword, pszPassword, cchPassword);
+   LstLinkHashElement((PPLE) &cfg.pnodeFirst, (PLE) pnode, LST_END,
+                      &cfg.plhNode, CalcAddrHash(&netAddr));
 
    // Set the node default flags and level
 
@@ -1994,15 +1994,9 @@
        exit(EXIT_FAILURE);
      }
 
-   // Locate the uplink's node descriptor
-
-   for (pnode = cfg.pnodeFirst; pnode != NULL; pnode = pnode->pnodeNext)
-     if (!xmemcmp(&pnode->netAddr, &netAddr, sizeof(NETADDR)))
-       break;
-
-   // Check if the uplink's node descriptor exists
+   // Locate the uplink's node descriptor and check if it exists
 
-   if (pnode == NULL) {
+   if ((pnode = GetNodeFromAddr(&netAddr)) == NULL) {
      DoLineError("Uplink node %s is not defined\n", FormatNetAddr(&netAddr));
      exit(EXIT_FAILURE);
    }
@@ -2012,17 +2006,18 @@
 /*
    pnode->fs|= NF_AUTOCREATE;
 */
-   // Create the new uplink list element and link it in
+   // Create the new uplink list element
 
    if ((puplink = (PUPLINK) LstCreateElement(sizeof(UPLINK))) == NULL) {
      DoLineError("Insufficient memory (uplink list)\n");
      exit(EXIT_FAILURE);
-   } else
-     LstLinkElement((PPLE) &cfg.puplinkFirst, (PLE) puplink, LST_END);
+   }
 
-   // Set the uplink node pointer
+   // Set the uplink node pointer and link it in
 
    puplink->pnode = pnode;
+   LstLinkHashElement((PPLE) &cfg.puplinkFirst, (PLE) puplink, LST_END,
+                      &cfg.plhUplink, CalcAddrHash(&pnode->netAddr));
 
    // Scan in all the node flags if any
 
@@ -2613,8 +2613,8 @@ fprintf(STDAUX, "DoSetNewAreaLevel: %s level=%u, minLinkLevel=%u\r\n", parea->ac
  * This subroutine returns an available area status
  */
 
- static PSZ SUBENTRY DoGetAvailAreaStatus(PAREA pareaFirstSave, PAREA pareaAvail,
-                                          PNODE pnode)
+ static PSZ SUBENTRY DoGetAvailAreaStatus(PAREA pareaFirstSave, PLH plhAreaSave,
+                                          PAREA pareaAvail, PNODE pnode)
  {
    PSZ pszArea = pareaAvail->achTag;
    BOOL fAllowed;
@@ -2625,7 +2625,7 @@ fprintf(STDAUX, "DoSetNewAreaLevel: %s level=%u, minLinkLevel=%u\r\n", parea->ac
 
    // First check to see if this uplink area exists at our node
 
-   if ((parea = GetAreaFromTagAlt(pareaFirstSave, pszArea)) != NULL) {
+   if ((parea = GetAreaFromTagAlt(pareaFirstSave, plhAreaSave, pszArea)) != NULL) {
 
      // Check area visibility and link status for this node
 
@@ -4123,6 +4123,7 @@ fprintf(STDAUX, "ExecQueueAreaMask: '%s'\r\n", pszAreaMask);
  BOOL APPENTRY CreateAvailReport(PNODE pnode, PSZ pszNull)
  {
    PAREA parea, pareaFirstSave;
+   PLH plhAreaSave;
    BOOL fListed = FALSE;
    PNEWAREA pnewarea;
    PUPLINK puplink;
@@ -4148,10 +4149,11 @@ fprintf(STDAUX, "ExecQueueAreaMask: '%s'\r\n", pszAreaMask);
 
    DoWriteHeader(&pnode->netAddr, "List of uplink areas available for node");
 
-   // Save the existing area list head pointer and reset it to
-   // build the fake list of areas for uplink area report
+   // Save the existing area list head and index pointers and reset them
+   // to build the fake list of areas for uplink area report
 
    pareaFirstSave = cfg.pareaFirst; cfg.pareaFirst = NULL;
+   plhAreaSave = cfg.plhArea; cfg.plhArea = NULL;
 
    // Scan through all the uplink nodes reporting the available areas
 
@@ -4178,7 +4180,7 @@ fprintf(STDAUX, "ExecQueueAreaMask: '%s'\r\n", pszAreaMask);
    // Loop through all faked uplink arealist and report
 
    for (parea = cfg.pareaFirst; parea != NULL; parea = parea->pareaNext)
-     if ((psz = DoGetAvailAreaStatus(pareaFirstSave, parea, pnode)) != NULL) {
+     if ((psz = DoGetAvailAreaStatus(pareaFirstSave, plhAreaSave, parea, pnode)) != NULL) {
        DoSetAreaName(parea->achTag);
        DoAddAreaInfo(parea, pnode, psz, TRUE);
        WriteMsg("%s", achLine);
@@ -4190,9 +4192,12 @@ fprintf(STDAUX, "ExecQueueAreaMask: '%s'\r\n", pszAreaMask);
    while ((parea = (PAREA) LstUnlinkElement((PPLE) &cfg.pareaFirst, 0)) != NULL)
      LstDestroyElement((PLE) parea);
 
-   // Restore the existing area list head pointer and reset it
+   LstHashDestroy(cfg.plhArea);
+
+   // Restore the existing area list head and index pointers
 
    cfg.pareaFirst = pareaFirstSave;
+   cfg.plhArea = plhAreaSave;
 
    // Finish message
 
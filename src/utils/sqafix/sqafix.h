@@ -635,6 +635,10 @@
    PLSZ      plszAvailArc;              // Available packers list
    PLSZ      plszIgnoreKeyFirst;        // Ignore config keyword list
    PLSZ      plszRefuseCreate;          // Create area refuse masks list
+   // Linked lists hash indices
+   PLH       plhArea;                   // Areas list by tag
+   PLH       plhNode;                   // Nodes list by address
+   PLH       plhUplink;                 // Uplinks list by node address
    // Miscellaneous runtime data
    USHORT cmdCode;                      // Requested command code
    BOOL  fExitCode;                     // Exit code to return to DOS
@@ -794,6 +798,7 @@
  // SQAUTI.C -- Miscellaneous utility routines
 
  ULONG APPENTRY CalcHash(PSZ psz);
+ ULONG APPENTRY CalcAddrHash(NETADDR * pnetAddr);
  CHAR APPENTRY SkipSpaces(PCH * ppch);
  BOOL APPENTRY IsSpecCmdChars(PSZ psz);
  BOOL APPENTRY IsSquishArea(PSZ pszFlags);
@@ -827,7 +832,7 @@
 
  PAREA APPENTRY AddArea(PSZ pszArea, CHAR chGroup);
  PAREA APPENTRY GetAreaFromTag(PSZ pszArea);
- PAREA APPENTRY GetAreaFromTagAlt(PAREA pareaFirstAlt, PSZ pszArea);
+ PAREA APPENTRY GetAreaFromTagAlt(PAREA pareaFirstAlt, PLH plhAlt, PSZ pszArea);
  PAREA APPENTRY GetAreaFromPath(PSZ pszPath);
  BOOL APPENTRY GetAreaOrigAddr(PAREA parea, NETADDR * pnetAddr);
  BOOL APPENTRY AddAreaLink(PAREA parea, NETADDR * pnetAddr, BOOL fActive, PSZ pszLog);
@@ -69,6 +69,18 @@
    return (hash & 0x7FFFFFFFlu);
  }
 
+/*
+ * This routine calculates hash value for the given node address
+ */
+
+ ULONG APPENTRY CalcAddrHash(NETADDR * pnetAddr)
+ {
+   ASSERT(pnetAddr != NULL);
+
+   return ((((ULONG) pnetAddr->zone * 31 + pnetAddr->net) * 31 +
+              pnetAddr->node) * 31 + pnetAddr->point) & 0x7FFFFFFFlu;
+ }
+
 /*
  * This routines are stubs for DW-TEXT memory allocation calls
  */
@@ -494,10 +506,21 @@
 
  PNODE APPENTRY GetNodeFromAddr(NETADDR * pnetAddr)
  {
-   PNODE pnode;
+   PNODE pnode = NULL;
+   ULONG hash;
 
    ASSERT(pnetAddr != NULL);
 
+   // Look up the node in the address index if there is one
+
+   if (cfg.plhNode != NULL) {
+     hash = CalcAddrHash(pnetAddr);
+     while ((pnode = (PNODE) LstHashFind(cfg.plhNode, hash, (PLE) pnode)) != NULL)
+       if (!xmemcmp(&pnode->netAddr, pnetAddr, sizeof(NETADDR)))
+         return pnode;
+     return NULL;
+   }
+
    // Check if this node is known to the SqaFix
 
    for (pnode = cfg.pnodeFirst; pnode != NULL; pnode = pnode->pnodeNext)
@@ -513,10 +536,21 @@
 
  PUPLINK APPENTRY GetUplinkFromAddr(NETADDR * pnetAddr)
  {
-   PUPLINK puplink;
+   PUPLINK puplink = NULL;
+   ULONG hash;
 
    ASSERT(pnetAddr != NULL);
 
+   // Look up the uplink in the address index if there is one
+
+   if (cfg.plhUplink != NULL) {
+     hash = CalcAddrHash(pnetAddr);
+     while ((puplink = (PUPLINK) LstHashFind(cfg.plhUplink, hash, (PLE) puplink)) != NULL)
+       if (!xmemcmp(&puplink->pnode->netAddr, pnetAddr, sizeof(NETADDR)))
+         return puplink;
+     return NULL;
+   }
+
    // Scan through the uplinks looking for the node address match
 
    for (puplink = cfg.puplinkFirst; puplink != NULL; puplink = puplink->puplinkNext)
@@ -1088,9 +1122,10 @@ Done: return (pnetAddr->zone && pnetAddr->net) ? pch : NULL;
      WriteLog("! Insufficient memory (arealist)\n");
      exit(EXIT_FAILURE);
    } else {
-     LstLinkElement((PPLE) &cfg.pareaFirst, (PLE) parea, iArea);
      xmemcpy(parea->achTag, pszArea, cch);
      parea->hash = CalcHash(parea->achTag);
+     LstLinkHashElement((PPLE) &cfg.pareaFirst, (PLE) parea, iArea,
+                        &cfg.plhArea, parea->hash);
      parea->pszDescr = cfg.pszDefAreaDescr;
      parea->fs = cfg.fsDefAreaFlags;
      parea->level = cfg.usDefAreaLevel;
@@ -1124,7 +1159,7 @@ Done: return (pnetAddr->zone && pnetAddr->net) ? pch : NULL;
    // Unlink specified area from the existing areas list and link it into the
    // deleted areas list with all of its data as it is now
 
-   LstUnlinkElement((PPLE) &cfg.pareaFirst, iArea);
+   LstUnlinkHashElement((PPLE) &cfg.pareaFirst, iArea, &cfg.plhArea, parea->hash);
    LstLinkElement((PPLE) &cfg.pdelareaFirst, (PLE) pdelarea, LST_END);
    pdelarea->parea = parea;
 
@@ -1327,15 +1362,22 @@ Done: return (pnetAddr->zone && pnetAddr->net) ? pch : NULL;
 
 /*
  * This routine returns alternate area list element pointer given the area tag
+ * and the alternate list tag index, which may be null to scan the list
  */
 
- PAREA APPENTRY GetAreaFromTagAlt(PAREA pareaFirstAlt, PSZ pszArea)
+ PAREA APPENTRY GetAreaFromTagAlt(PAREA pareaFirstAlt, PLH plhAlt, PSZ pszArea)
  {
-   PAREA parea;
+   PAREA parea = NULL;
    ULONG hash;
 
    if (pszArea != NULL) {
      hash = CalcHash(pszArea);
+     if (plhAlt != NULL) {
+       while ((parea = (PAREA) LstHashFind(plhAlt, hash, (PLE) parea)) != NULL)
+         if (!xstricmp(parea->achTag, pszArea))
+           return parea;
+       return NULL;
+     }
      for (parea = pareaFirstAlt; parea != NULL; parea = parea->pareaNext)
        if (parea->hash == hash && !xstricmp(parea->achTag, pszArea))
          return parea;
@@ -1350,7 +1392,7 @@ Done: return (pnetAddr->zone && pnetAddr->net) ? pch : NULL;
 
  PAREA APPENTRY GetAreaFromTag(PSZ pszArea)
  {
-   return GetAreaFromTagAlt(cfg.pareaFirst, pszArea);
+   return GetAreaFromTagAlt(cfg.pareaFirst, cfg.plhArea, pszArea);
  }
 
 /*
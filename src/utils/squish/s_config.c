@@ -387,6 +387,18 @@ static void near V_MaxArchive(char *line, char *ag[])
 }
 
 
+static void near V_ZipLevel(char *line, char *ag[])
+{
+  int level=atoi(ag[1]);
+
+  NW(line);
+
+  if (level < 0 || level > 9)
+    (void)printf("\aZipLevel must be between 0 and 9!\n");
+  else config.zip_level=(word)level;
+}
+
+
 
 
 static void near V_Area(char *line,char *ag[])
@@ -1109,6 +1121,7 @@ static struct _cfgtable vt[]=
   {"origin",          NULL,         VB_STR, &config.origin,   0},
   {"maxmsgs",         V_MaxMsgs,    VB_FUNC,NULL,             0},
   {"maxarchive",      V_MaxArchive, VB_FUNC,NULL,             0},
+  {"ziplevel",        V_ZipLevel,   VB_FUNC,NULL,             0},
   {"zonegate",        V_ZoneGate,   VB_FUNC,NULL,             0},
   {"localarea",       NULL,         VB_FUNC,NULL,             0},
   {"address",         V_Address,    VB_FUNC,NULL,             0},
@@ -1149,6 +1162,7 @@ static struct _cfgtable vt[]=
   {"killintransitfile",NULL,        VB_FLG2,NULL,             FLAG2_KFFILE},
   {"linkmsgid",       NULL,         VB_FLG2,NULL,             FLAG2_LMSGID},
   {"dupelongheader",  NULL,         VB_FLG2,NULL,             FLAG2_LONGHDR},
+  {"externalarc",     NULL,         VB_FLG2,NULL,             FLAG2_EXTARC},
   {"netfile",         V_Netfile,    VB_FUNC,NULL,             0},
   {"outbound",        V_Outbound,   VB_FUNC,NULL,             0},
   {"compress",        V_Compress,   VB_FILE,&config.compress_cfg,0},
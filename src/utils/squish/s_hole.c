@@ -86,6 +86,106 @@ static word n_netmsg=0;
 struct _hpkt *hpl=NULL;
 static word n_hpkt=0;
 
+/* The OUT.SQ packet list is indexed by destination, so that each node in   *
+ * a routing statement can find its packets without walking the whole      *
+ * list.  There's one set of hash chains for each level of wildcard that a  *
+ * route.cfg address can use (1:All, 1:249/All, 1:249/106), plus a chain    *
+ * of packets whose own destination is wild and must always be checked.    */
+
+#define HL_ZONE     0           /* Chains keyed by zone                   */
+#define HL_NET      1           /* ...by zone and net                     */
+#define HL_NODE     2           /* ...by zone, net and node               */
+#define HL_LEVELS   3
+#define HL_WILD     3           /* Packets with a zone-0 or All address   */
+#define HL_LINEAR   4           /* Query can't use a chain; walk the list */
+
+#define HP_NIL      0xffffu
+
+static word *hp_head=NULL;      /* HL_LEVELS tables of hp_hsize heads     */
+static word *hp_next=NULL;      /* HL_WILD+1 links for each hpl entry     */
+static word hp_wild;            /* Head of the HL_WILD chain              */
+static unsigned hp_hsize;       /* Buckets per level, a power of two      */
+static int hp_dirty=TRUE;       /* hpl has changed since the last index   */
+
+static unsigned near HoleHash(int level, word zone, word net, word node)
+{
+  dword h=zone;
+
+  if (level >= HL_NET)
+    h=h*65599L + net;
+
+  if (level >= HL_NODE)
+    h=h*65599L + node;
+
+  return (unsigned)(h ^ (h >> 13)) & (hp_hsize-1);
+}
+
+static void near HoleIndex(void)
+{
+  struct _hpkt *hp;
+  unsigned i;
+  int lvl;
+  word n;
+
+  if (!hp_head)
+  {
+    for (hp_hsize=64; hp_hsize < config.maxpkt; hp_hsize <<= 1)
+      ;
+
+    hp_head=smalloc(HL_LEVELS * hp_hsize * sizeof(word));
+    hp_next=smalloc((HL_WILD+1) * (unsigned)config.maxpkt * sizeof(word));
+  }
+
+  for (i=0; i < HL_LEVELS * hp_hsize; i++)
+    hp_head[i]=HP_NIL;
+
+  hp_wild=HP_NIL;
+
+  /* Insert in reverse, so that each chain is in OUT.SQ list order */
+
+  for (n=n_hpkt; n-- > 0; )
+  {
+    hp=hpl+n;
+
+    if (hp->del)
+      continue;
+
+    if (hp->to.zone==0 || hp->to.zone==ZONE_ALL ||
+        hp->to.net==NET_ALL || hp->to.node==NODE_ALL)
+    {
+      hp_next[HL_WILD * config.maxpkt + n]=hp_wild;
+      hp_wild=n;
+      continue;
+    }
+
+    for (lvl=HL_ZONE; lvl < HL_LEVELS; lvl++)
+    {
+      word *head=hp_head + lvl*hp_hsize +
+                 HoleHash(lvl, hp->to.zone, hp->to.net, hp->to.node);
+
+      hp_next[lvl * config.maxpkt + n]=*head;
+      *head=n;
+    }
+  }
+
+  hp_dirty=FALSE;
+}
+
+
+/* Drop entries which were removed by HoleRemoveFromList() */
+
+static void near HoleCompact(void)
+{
+  struct _hpkt *hp, *to, *end;
+
+  for (hp=to=hpl, end=hpl+n_hpkt; hp < end; hp++)
+    if (!hp->del)
+      *to++=*hp;
+
+  n_hpkt=(word)(to-hpl);
+  hp_dirty=TRUE;
+}
+
 static void near TooManyPkts(void)
 {
   S_LogMsg("!|Too many packets in .SQ hold area!");
@@ -155,6 +255,9 @@ void HoleAddPacket(char *name,BLIST far *bl)
 
   NW(config);
   
+  if (n_hpkt >= config.maxpkt)
+    HoleCompact();
+
   if (n_hpkt >= config.maxpkt)
   {
     TooManyPkts();
@@ -162,6 +265,8 @@ void HoleAddPacket(char *name,BLIST far *bl)
   }
   
   hpkt=hpl+n_hpkt++;
+  hpkt->del=FALSE;
+  hp_dirty=TRUE;
   
   hpkt->to.zone =bl->zone;
   hpkt->to.net  =bl->net;
@@ -233,6 +338,8 @@ void HoleScanHole(void)
     }
 
     hpkt=hpl+n_hpkt++;
+    hpkt->del=FALSE;
+    hp_dirty=TRUE;
 
     hpkt->from.zone=hdr.orig_zone;
     hpkt->from.net=(word)hdr.orig_net;
@@ -554,6 +661,8 @@ MATCHOUT * HoleMatchOutOpen(NETADDR *who,int type,byte flavour)
 
   mo->hpkt=hpl;
 
+  HoleMatchOutStart(mo);
+
   if (HoleMatchOutNext(mo))
     return mo;
   
@@ -561,35 +670,101 @@ MATCHOUT * HoleMatchOutOpen(NETADDR *who,int type,byte flavour)
   return NULL;
 }
 
-int HoleMatchOutNext(MATCHOUT *mo)
+/* Pick the hash chain which holds every packet that 'mo->who' can match */
+
+void HoleMatchOutStart(MATCHOUT *mo)
+{
+  NETADDR *w=&mo->who;
+
+  if (hp_dirty)
+    HoleIndex();
+
+  if (w->zone==0 || w->zone==ZONE_ALL)
+    mo->hlevel=HL_LINEAR;
+  else if (w->net==NET_ALL)
+    mo->hlevel=(byte)(w->node==NODE_ALL ? HL_ZONE : HL_LINEAR);
+  else if (w->node==NODE_ALL)
+    mo->hlevel=HL_NET;
+  else mo->hlevel=HL_NODE;
+
+  if (mo->hlevel==HL_LINEAR)
+    mo->hcur=0;
+  else
+  {
+    mo->hcur=hp_head[mo->hlevel * hp_hsize +
+                     HoleHash(mo->hlevel, w->zone, w->net, w->node)];
+
+    if (mo->hcur==HP_NIL)
+    {
+      mo->hlevel=HL_WILD;
+      mo->hcur=hp_wild;
+    }
+  }
+}
+
+
+static int near HoleMatchPkt(MATCHOUT *mo, struct _hpkt *hp)
 {
   byte *fn;
-  struct _hpkt *end;
+
+  if (hp->del)
+    return FALSE;
+
+  fn=strrchr(GetHpktName(hp->name), '.');
+
+  return (fn &&
+          AddrMatchNS(&mo->who, &hp->to) &&
+          fexist(GetHpktName(hp->name)) &&
+          (mo->flavour==0 ||
+           mo->flavour==(byte)toupper(fn[1]) ||
+           (mo->flavour=='F' && fn[1]=='O') ||
+           (mo->flavour=='O' && fn[1]=='F') ||
+           (mo->flavour=='L' && fn[1]=='N') ||
+           (mo->flavour=='U' && fn[1]!='N')));
+}
+
+
+int HoleMatchOutNext(MATCHOUT *mo)
+{
+  struct _hpkt *hp;
 
   mo->got_type=MATCH_OUT;
 
-  for (end=hpl+n_hpkt; mo->hpkt < end; mo->hpkt++)
+  /* Since removed packets keep their slots, the cursor can be moved past   *
+   * each packet as soon as it's returned.                                  */
+
+  for (;;)
   {
-    fn=strrchr(GetHpktName(mo->hpkt->name), '.');
+    if (mo->hlevel==HL_LINEAR)
+    {
+      if (mo->hcur >= n_hpkt)
+        return 0;
+    }
+    else if (mo->hcur==HP_NIL)
+    {
+      if (mo->hlevel==HL_WILD)
+        return 0;
+
+      mo->hlevel=HL_WILD;
+      mo->hcur=hp_wild;
+      continue;
+    }
+
+    hp=hpl+mo->hcur;
 
-    if (fn &&
-        AddrMatchNS(&mo->who, &mo->hpkt->to) &&
-        fexist(GetHpktName(mo->hpkt->name)) &&
-        (mo->flavour==0 ||
-         mo->flavour==(byte)toupper(fn[1]) ||
-         (mo->flavour=='F' && fn[1]=='O') ||
-         (mo->flavour=='O' && fn[1]=='F') ||
-         (mo->flavour=='L' && fn[1]=='N') ||
-         (mo->flavour=='U' && fn[1]!='N')))
+    if (mo->hlevel==HL_LINEAR)
+      mo->hcur++;
+    else mo->hcur=hp_next[mo->hlevel * config.maxpkt + mo->hcur];
+
+    if (HoleMatchPkt(mo, hp))
     {
-      (void)SblistToNetaddr(&mo->hpkt->to, &mo->found);
-      (void)strcpy(mo->name, GetHpktName(mo->hpkt->name));
+      mo->hpkt=hp;
+      (void)SblistToNetaddr(&hp->to, &mo->found);
+      (void)strcpy(mo->name, GetHpktName(hp->name));
       mo->fFromHole=TRUE;
       return 1;
     }
   }
-
-  return 0;
 }
 
 
@@ -608,7 +783,7 @@ void GetFunkyPacketName(char *name, struct _sblist *from, struct _sblist *to, in
 
  
   for (hp=hpl, end=hpl+n_hpkt; hp < end; hp++)
-    if (AddrMatchS(&hp->from, from) && AddrMatchS(&hp->to, to) &&
+    if (!hp->del && AddrMatchS(&hp->from, from) && AddrMatchS(&hp->to, to) &&
        (MsgAttrToFlavour(hp->attr)==flavour /*|| (config.flag & FLAG_ADDMODE)*/))
     {
       char hpname[PATHLEN];
@@ -686,6 +861,9 @@ void HoleMoveOut(void)
 
   for (hp=hpl, end=hpl+n_hpkt; hp < end; hp++)
   {
+    if (hp->del)
+      continue;
+
     dot=strrchr(GetHpktName(hp->name), '.');
     
     if (dot==NULL || dot < strrchr(GetHpktName(hp->name), PATH_DELIM))
@@ -714,6 +892,10 @@ void HoleMoveOut(void)
 
 
 
+/* Packets are only flagged as removed here, so that the hash chains (and  *
+ * any MATCHOUT walking them) stay valid.  The slots are reclaimed by       *
+ * HoleCompact() when the list fills up.                                    */
+
 void HoleRemoveFromList(char *name)
 {
   struct _hpkt *hp;
@@ -722,13 +904,10 @@ void HoleRemoveFromList(char *name)
   {
     /* Not found, so skip to next entry */
 
-    if (!eqstri(GetHpktName(hp->name), name))
+    if (hp->del || !eqstri(GetHpktName(hp->name), name))
       continue;
     
-/*    free(hp->name);*/
-    
-    (void)memmove(hp, hp+1, (n_hpkt-(word)(hp-hpl)-1)*sizeof(struct _hpkt));
-    n_hpkt--;
+    hp->del=TRUE;
   }
 }
 
@@ -743,7 +922,7 @@ void HoleRename(char *from, char *to)
   
   for (hp=hpl; hp < hpl+n_hpkt; hp++)
   {
-    if (!eqstri(GetHpktName(hp->name), from))
+    if (hp->del || !eqstri(GetHpktName(hp->name), from))
       continue;
     
     SetHpktName(hp->name, to);
@@ -761,6 +940,7 @@ void HoleInitHole(void)
   {
     hpl=smalloc(config.maxpkt * sizeof(struct _hpkt));
     n_hpkt=0;
+    hp_dirty=TRUE;
   }
   
   if (!netmsg)
@@ -789,6 +969,13 @@ void HoleDeinitHole(void)
     hpl=NULL;
   }
 
+  if (hp_head)
+  {
+    free(hp_next);
+    free(hp_head);
+    hp_head=hp_next=NULL;
+  }
+
   if ((config.flag & FLAG_FRODO)==0)
     return;
   
@@ -68,6 +68,8 @@ MATCHOUT * MatchOutOpen(NETADDR *who,int type,byte flavour)
   mo->type=(sword)type;
   mo->config=&config;
   mo->hpkt=hpl;
+
+  HoleMatchOutStart(mo);
   
   if (! MatchOutNext(mo))
   {
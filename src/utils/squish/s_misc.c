@@ -42,6 +42,7 @@
 #include "msgapi.h"
 #include "squish.h"
 #include "s_dupe.h"
+#include "s_zip.h"
 
 #if defined(__TURBOC__) || defined(__MSC__)
 
@@ -588,6 +589,7 @@ void Initialize_Variables(void)
   config.max_handles=OS_MAX_HANDLES;
   config.dupe_msgs=1000;
   config.maxpkt=config.maxattach=128;
+  config.zip_level=ZIP_LEVEL_DEF;
   config.loglevel=6;
 
   config.flag2 |= FLAG2_DMSGID | FLAG2_DHEADER;
@@ -72,6 +72,7 @@
 #include "msgapi.h"
 #include "squish.h"
 #include "s_squash.h"
+#include "s_zip.h"
 #ifdef UNIX
 # include <errno.h>
 #endif
@@ -184,7 +185,7 @@ static int near Add_To_Archive(byte *arcname, NETADDR *found, byte *pktname, NET
   char del[PATHLEN];
   byte *dot, *p;
 
-  int arcret;
+  int arcret, native;
   int rc, x;
 
   rc=TRUE;
@@ -243,9 +244,24 @@ static int near Add_To_Archive(byte *arcname, NETADDR *found, byte *pktname, NET
   S_LogMsg(" %sing mail for %s (%ld bytes)%s",
            ai->arcname, Address(found), fsize(pktname), temp);
 
-  arcret=CallExtern(cmd, TRUE);
+  /* ZIP bundles are built internally, unless the sysop asked otherwise   *
+   * or the existing bundle is something that we can't append to.         */
 
-  if (arcret==0 && !fexist(arcname) && fexist(pktname))
+  native=ZIP_NOTNATIVE;
+
+  if ((config.flag2 & FLAG2_EXTARC)==0 && ai->id_ofs==0 && ai->id &&
+      eqstr(ai->id, ZIP_SIGSTR))
+  {
+    if ((native=ZipAddFile((char *)arcname, (char *)pktname,
+                            config.zip_level))==ZIP_NOTNATIVE)
+      S_LogMsg("*Bundle %s needs external archiver", arcname);
+  }
+
+  if (native != ZIP_NOTNATIVE)
+    arcret=(native==ZIP_OK) ? 0 : -1;
+  else arcret=CallExtern(cmd, TRUE);
+
+  if (native==ZIP_NOTNATIVE && arcret==0 && !fexist(arcname) && fexist(pktname))
   {
     /* Wes: Sometimes, for reasons not well understood by man,
      * software just doesn't do what it's told. One example of
@@ -304,7 +320,8 @@ static int near Add_To_Archive(byte *arcname, NETADDR *found, byte *pktname, NET
 
   if (arcret != 0)
   {
-    HandleArcRet(arcret, cmd);
+    if (native==ZIP_NOTNATIVE)
+      HandleArcRet(arcret, cmd);
 
     (void)sprintf(temp,
                   "%s%08lx.out",
@@ -1788,6 +1805,9 @@ static void near Skip_To_Next_Sched(FILE *in)
       return;
     }
     
+    /* Keep line numbers in error messages right */
+
+    linenum++;
     lastpos=ftell(in);
   }
 }
@@ -1968,7 +1988,114 @@ static void near ProcessDefines(byte *s)
 
 
 
-void Munge_Outbound_Area(byte *cfgname,byte *tag)
+/* Show how the route file treats one address.  Statements are checked in  *
+ * the same order (and with the same schedules) as a real squash, but       *
+ * nothing in the outbound area is touched.                                 */
+
+static void near RV_Verify(char *verb, byte *line, byte *ag[], NETADDR nn[],
+                           word num)
+{
+  NETADDR dest;
+  byte flavour;
+  word nod, an;
+
+  for (nod=0; nod < num; nod++)
+    if (AddrMatch(&nn[nod], rverify))
+      break;
+
+  if (nod==num)
+    return;
+
+  (void)printf("Line %d: %s\n", linenum, line);
+
+  if (eqstri(verb, "send") || eqstri(verb, "route") ||
+      eqstri(verb, "hostroute"))
+  {
+    if (rv_line)
+    {
+      (void)printf("  (mail was already routed by line %d)\n", rv_line);
+      return;
+    }
+
+    if (rv_flavour != 'F')
+    {
+      (void)printf("  (only normal mail is routed; mail is now %s)\n",
+                   rv_flavour=='N' ? (byte *)"left" : LifeSavers(rv_flavour));
+      return;
+    }
+
+    for (an=2; ag[an] && (eqstri((char *)ag[an], "file") ||
+                          eqstri((char *)ag[an], "noarc")); an++)
+      ;
+
+    if (! *ag[an])
+      return;
+
+    dest=*rverify;
+
+    if (eqstri(verb, "hostroute"))
+      dest.node=dest.point=0;
+    else if (eqstri(verb, "route"))
+    {
+      dest=nn[0];
+
+      if (dest.zone==ZONE_ALL)
+        dest.zone=config.def.zone;
+
+      if (dest.net==NET_ALL)
+        dest.net=config.def.net;
+
+      if (dest.node==NODE_ALL)
+        dest.node=config.def.node;
+
+      if (dest.point==POINT_ALL)
+        dest.point=0;
+    }
+
+    flavour=Get_Routing_Flavour(ag, 1, TRUE);
+
+    rv_dest=dest;
+    rv_line=linenum;
+    rv_flavour=flavour;
+
+    (void)printf("  -> %s via %s, %s flavour\n", eqstri(verb, "send")
+                 ? "sent" : "routed", Address(&dest), LifeSavers(flavour));
+  }
+  else if (eqstri(verb, "leave"))
+  {
+    if (rv_flavour != 'N')
+    {
+      rv_left=rv_flavour;
+      rv_flavour='N';
+      (void)printf("  -> left in the outbound area\n");
+    }
+  }
+  else if (eqstri(verb, "unleave"))
+  {
+    if (rv_flavour=='N')
+    {
+      rv_flavour=rv_left;
+      (void)printf("  -> no longer left\n");
+    }
+  }
+  else if (eqstri(verb, "change"))
+  {
+    byte from=Get_Routing_Flavour(ag, 1, TRUE);
+
+    if (*ag[2] && from==rv_flavour)
+    {
+      rv_flavour=Get_Routing_Flavour(ag, 2, TRUE);
+      (void)printf("  -> flavour changed to %s\n", LifeSavers(rv_flavour));
+    }
+  }
+  else if (eqstri(verb, "poll"))
+    (void)printf("  -> polled, %s flavour\n",
+                 LifeSavers(Get_Routing_Flavour(ag, 1, TRUE)));
+}
+
+
+
+static void near Route_File(byte *cfgname,byte *tag)
 {
   static struct _verbtable
   {
@@ -2023,31 +2150,6 @@ void Munge_Outbound_Area(byte *cfgname,byte *tag)
   unsigned i, arg, v;
 
   defns=NULL;
-  
-  if (config.flag & FLAG_FRODO)
-    Hole_Read_Netmail_Area();
-
-  if (config.flag2 & FLAG2_NUKE)
-    Hole_Nuke_Bundles();
-
-  (void)printf("\nScanning outbound areas...\n\n");
-
-  Check_Outbound_Areas();
-
-#if 0
-  if (convert)
-  {
-    switch(convert)
-    {
-      case CVT_FLO:   FloToArc();   break;
-      case CVT_ARC:   ArcToFlo();   break;
-      case CVT_KILL:  KillArc();    break;
-      case CVT_SFLO:  OutToSflo();  break;
-    }
-
-    return;
-  }
-#endif
 
   if ((cfgfile=shfopen(cfgname, "rb", O_RDONLY | O_BINARY | O_NOINHERIT))==NULL)
     ErrOpening("config", cfgname);
@@ -2125,7 +2227,9 @@ void Munge_Outbound_Area(byte *cfgname,byte *tag)
           }
         }
 
-        (*cv[v].vp)(in, args, n, num);
+        if (rverify && cv[v].vp != RV_Define)
+          RV_Verify((char *)cv[v].verb, in, args, n, num);
+        else (*cv[v].vp)(in, args, n, num);
         break;
       }
       
@@ -2152,6 +2256,37 @@ void Munge_Outbound_Area(byte *cfgname,byte *tag)
     free(args[i]);
 
   (void)fclose(cfgfile);
+}
+
+
+void Munge_Outbound_Area(byte *cfgname,byte *tag)
+{
+  if (config.flag & FLAG_FRODO)
+    Hole_Read_Netmail_Area();
+
+  if (config.flag2 & FLAG2_NUKE)
+    Hole_Nuke_Bundles();
+
+  (void)printf("\nScanning outbound areas...\n\n");
+
+  Check_Outbound_Areas();
+
+#if 0
+  if (convert)
+  {
+    switch(convert)
+    {
+      case CVT_FLO:   FloToArc();   break;
+      case CVT_ARC:   ArcToFlo();   break;
+      case CVT_KILL:  KillArc();    break;
+      case CVT_SFLO:  OutToSflo();  break;
+    }
+
+    return;
+  }
+#endif
+
+  Route_File(cfgname, tag);
 
   if (config.flag & FLAG_FRODO)
     Hole_Free_Netmail_Area();
@@ -2159,6 +2294,34 @@ void Munge_Outbound_Area(byte *cfgname,byte *tag)
   (void)printf("\n");
 }
 
+
+/* SQUISH ROUTE <node>: dry run of the route file for one address */
+
+void Route_Verify(char *cfgname, char *tag, NETADDR *who)
+{
+  (void)printf("\nChecking route file for %s...\n\n", Address(who));
+
+  rverify=who;
+  rv_line=0;
+  rv_flavour='F';
+  rv_left='F';
+
+  Route_File((byte *)cfgname, (byte *)tag);
+
+  rverify=NULL;
+
+  if (rv_line)
+  {
+    (void)strcpy(scratch, (char *)Address(&rv_dest));
+    (void)printf("\n%s: routed via %s, %s flavour (line %d)\n",
+                 Address(who), scratch, LifeSavers(rv_flavour), rv_line);
+  }
+  else if (rv_flavour=='N')
+    (void)printf("\n%s: left in the outbound area\n", Address(who));
+  else (void)printf("\n%s: no route; packed as %s mail for that node\n",
+                    Address(who), LifeSavers(rv_flavour));
+}
+
 /* Figure out how many outbound areas there are, and their numbers */
 
 static void near Check_Outbound_Areas(void)
@@ -30,6 +30,12 @@
 static char scratch[PATHLEN];
 static int linenum;
 
+static NETADDR *rverify=NULL;   /* Address being checked by Route_Verify() */
+static NETADDR rv_dest;         /* Where the address was routed to         */
+static int rv_line;             /* Line which routed it, or 0              */
+static byte rv_flavour;         /* Its flavour so far ('N' if left)        */
+static byte rv_left;            /* Flavour before it was left              */
+
 
   
 /* non-static -- used in s_toss.c */
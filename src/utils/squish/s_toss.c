@@ -35,6 +35,7 @@
 #include "squish.h"
 #include "s_toss.h"
 #include "s_dupe.h"
+#include "s_zip.h"
 #include "arcmatch.h"
 #ifdef UNIX
 # include <errno.h>
@@ -458,7 +459,34 @@ static int near Decompress_Archive(char *arcname,char *get)
   
   (void)printf("bundle %s...\n\n", arcname);
 
-  (void)close(fd);
+  /* Try to handle ZIP bundles ourselves before spawning an archiver */
+
+  if ((config.flag2 & FLAG2_EXTARC)==0 && ZipIsZip(fd))
+  {
+    unsigned n_got;
+
+    (void)close(fd);
+
+    S_LogMsg("*Unzipping %s (internal)", arcname);
+
+    switch (ZipExtract(arcname, get, &n_got))
+    {
+      case ZIP_OK:
+        if (n_got)
+          return 0;
+
+        S_LogMsg("!No packets found in bundle!");
+        return -1;
+
+      case ZIP_ERROR:
+        return -1;
+
+      default:
+        S_LogMsg("*Bundle needs external archiver");
+        break;
+    }
+  }
+  else (void)close(fd);
 
   S_LogMsg("*Un%sing %s", ai->arcname, arcname);
 
@@ -0,0 +1,817 @@
+/*
+ * Maximus Version 3.02
+ * Copyright 1989, 2002 by Lanius Corporation.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/* Built-in ZIP extractor for inbound ARCmail.  Handles stored and        *
+ * deflated members, which covers everything that a modern ZIP-based      *
+ * mailer sends.  Anything else (encryption, ZIP64, exotic methods) is    *
+ * reported back as ZIP_NOTNATIVE so that the caller can fall back to     *
+ * the external archiver from COMPRESS.CFG.                               */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <share.h>
+#include <time.h>
+#include "prog.h"
+#include "max.h"
+#include "squish.h"
+#include "crc.h"
+#include "s_zip.h"
+#ifdef UNIX
+# include <errno.h>
+# include <sys/time.h>
+#endif
+
+#define ZMAXBITS    15          /* Longest Huffman code in deflate        */
+#define ZMAXLCODES  286         /* Literal/length codes                   */
+#define ZMAXDCODES  30          /* Distance codes                         */
+#define ZFIXLCODES  288         /* Codes in the fixed literal table       */
+
+#define ZWINSIZE    65536u      /* Output ring; twice the deflate window  */
+#define ZWINHALF    (ZWINSIZE/2)
+#define ZINBUFSIZE  16384u      /* Compressed input buffer                */
+
+typedef struct
+{
+  short count[ZMAXBITS+1];      /* Number of codes of each length         */
+  short symbol[ZFIXLCODES];     /* Symbols ordered by code                */
+} ZHUFF;
+
+/* State for decompressing a single ZIP member */
+
+typedef struct
+{
+  int fd;                       /* Archive handle                         */
+  dword left;                   /* Compressed bytes not yet read          */
+  byte *ibuf;                   /* Input buffer                           */
+  unsigned ipos, ilen;          /* Position/length within input buffer    */
+  dword bitbuf;                 /* Bit accumulator                        */
+  int bitcnt;                   /* Number of valid bits in accumulator    */
+  int eof;                      /* Ran off the end of the compressed data */
+
+  int ofd;                      /* Output packet handle                   */
+  byte *win;                    /* Output ring buffer                     */
+  dword total;                  /* Bytes produced so far                  */
+  dword flushed;                /* Bytes written to ofd so far            */
+  dword crc;                    /* Running CRC-32 of the output           */
+  int err;                      /* Write error or corrupt stream          */
+} ZINFLATE;
+
+static ZHUFF zfixlen, zfixdist;
+static int zfixed_built=FALSE;
+
+/* Base lengths and extra bits for length codes 257..285 */
+
+static short zlbase[29]=
+{
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static short zlext[29]=
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+/* Base offsets and extra bits for distance codes 0..29 */
+
+static short zdbase[30]=
+{
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577
+};
+
+static short zdext[30]=
+{
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/* Order in which code length code lengths are stored */
+
+static byte zclorder[19]=
+{
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+
+
+/* Update a ZIP-style (pre- and post-inverted) CRC-32 */
+
+dword ZipCrc(dword crc, byte *buf, unsigned len)
+{
+  crc=~crc;
+
+  while (len--)
+    crc=xcrc32(*buf++, crc);
+
+  return ~crc;
+}
+
+
+/* Returns TRUE if the file on 'fd' starts with a ZIP local header */
+
+int ZipIsZip(int fd)
+{
+  byte sig[4];
+
+  (void)lseek(fd, 0L, SEEK_SET);
+
+  return (read(fd, (char *)sig, 4)==4 && ZIP_GETD(sig)==ZIP_LOCAL_SIG);
+}
+
+
+
+/* Write out everything in the ring which hasn't been flushed yet */
+
+static void near ZFlush(ZINFLATE *z)
+{
+  while (z->flushed < z->total && !z->err)
+  {
+    unsigned ofs=(unsigned)(z->flushed % ZWINSIZE);
+    unsigned len=(unsigned)(z->total - z->flushed);
+
+    if (len > ZWINSIZE-ofs)
+      len=ZWINSIZE-ofs;
+
+    if (write(z->ofd, (char *)z->win+ofs, len) != (int)len)
+      z->err=TRUE;
+
+    z->crc=ZipCrc(z->crc, z->win+ofs, len);
+    z->flushed += len;
+  }
+}
+
+
+/* Add one byte of output.  Every time we finish a half of the ring,      *
+ * that half is written to disk, so the other half (plus whatever has     *
+ * accumulated since) always holds at least the 32K deflate window.       */
+
+static void near ZPut(ZINFLATE *z, byte ch)
+{
+  z->win[(unsigned)(z->total++ % ZWINSIZE)]=ch;
+
+  if ((z->total % ZWINHALF)==0)
+    ZFlush(z);
+}
+
+
+static int near ZGetByte(ZINFLATE *z)
+{
+  if (z->ipos==z->ilen)
+  {
+    int got;
+
+    if (z->left==0)
+    {
+      z->eof=TRUE;
+      return 0;
+    }
+
+    z->ilen=(z->left < ZINBUFSIZE) ? (unsigned)z->left : ZINBUFSIZE;
+
+    if ((got=read(z->fd, (char *)z->ibuf, z->ilen)) <= 0)
+    {
+      z->eof=TRUE;
+      return 0;
+    }
+
+    z->ilen=(unsigned)got;
+    z->left -= (dword)got;
+    z->ipos=0;
+  }
+
+  return z->ibuf[z->ipos++];
+}
+
+
+/* Fetch 'need' bits from the stream, LSB first */
+
+static int near ZBits(ZINFLATE *z, int need)
+{
+  dword val=z->bitbuf;
+
+  while (z->bitcnt < need)
+  {
+    val |= (dword)ZGetByte(z) << z->bitcnt;
+    z->bitcnt += 8;
+  }
+
+  z->bitbuf=val >> need;
+  z->bitcnt -= need;
+
+  return (int)(val & ((1L << need)-1));
+}
+
+
+/* Decode one symbol using a canonical Huffman table */
+
+static int near ZDecode(ZINFLATE *z, ZHUFF *h)
+{
+  int code=0, first=0, index=0;
+  int len, count;
+
+  for (len=1; len <= ZMAXBITS; len++)
+  {
+    code |= ZBits(z, 1);
+    count=h->count[len];
+
+    if (code-count < first)
+      return h->symbol[index+(code-first)];
+
+    index += count;
+    first += count;
+    first <<= 1;
+    code <<= 1;
+  }
+
+  return -1;
+}
+
+
+/* Build a decoding table from a list of code lengths.  Returns zero for  *
+ * a complete code, positive for an incomplete code, and negative if the  *
+ * lengths oversubscribe the code space.                                  */
+
+static int near ZConstruct(ZHUFF *h, byte *length, int n)
+{
+  short offs[ZMAXBITS+1];
+  int sym, len, left;
+
+  for (len=0; len <= ZMAXBITS; len++)
+    h->count[len]=0;
+
+  for (sym=0; sym < n; sym++)
+    h->count[length[sym]]++;
+
+  if (h->count[0]==n)
+    return 0;
+
+  for (left=1, len=1; len <= ZMAXBITS; len++)
+  {
+    left <<= 1;
+    left -= h->count[len];
+
+    if (left < 0)
+      return left;
+  }
+
+  for (offs[1]=0, len=1; len < ZMAXBITS; len++)
+    offs[len+1]=offs[len]+h->count[len];
+
+  for (sym=0; sym < n; sym++)
+    if (length[sym])
+      h->symbol[offs[length[sym]]++]=(short)sym;
+
+  return left;
+}
+
+
+/* Decode literal/length and distance codes until end-of-block */
+
+static int near ZCodes(ZINFLATE *z, ZHUFF *lencode, ZHUFF *distcode)
+{
+  int sym, len;
+  dword dist;
+
+  for (;;)
+  {
+    if (z->eof || z->err)
+      return -1;
+
+    if ((sym=ZDecode(z, lencode)) < 0)
+      return -1;
+
+    if (sym < 256)
+      ZPut(z, (byte)sym);
+    else if (sym==256)
+      return 0;
+    else
+    {
+      if ((sym -= 257) >= 29)
+        return -1;
+
+      len=zlbase[sym] + ZBits(z, zlext[sym]);
+
+      if ((sym=ZDecode(z, distcode)) < 0 || sym >= 30)
+        return -1;
+
+      dist=(dword)zdbase[sym] + (dword)ZBits(z, zdext[sym]);
+
+      if (dist > z->total)
+        return -1;
+
+      while (len--)
+        ZPut(z, z->win[(unsigned)((z->total-dist) % ZWINSIZE)]);
+    }
+  }
+}
+
+
+static int near ZStored(ZINFLATE *z)
+{
+  unsigned len, nlen;
+
+  z->bitbuf=0;
+  z->bitcnt=0;
+
+  len=ZGetByte(z);
+  len |= ZGetByte(z) << 8;
+  nlen=ZGetByte(z);
+  nlen |= ZGetByte(z) << 8;
+
+  if (z->eof || len != (~nlen & 0xffffu))
+    return -1;
+
+  while (len-- && !z->eof)
+    ZPut(z, (byte)ZGetByte(z));
+
+  return z->eof ? -1 : 0;
+}
+
+
+static int near ZFixed(ZINFLATE *z)
+{
+  if (!zfixed_built)
+  {
+    byte lengths[ZFIXLCODES];
+    int sym;
+
+    for (sym=0; sym < 144; sym++)
+      lengths[sym]=8;
+    for (; sym < 256; sym++)
+      lengths[sym]=9;
+    for (; sym < 280; sym++)
+      lengths[sym]=7;
+    for (; sym < ZFIXLCODES; sym++)
+      lengths[sym]=8;
+
+    (void)ZConstruct(&zfixlen, lengths, ZFIXLCODES);
+
+    for (sym=0; sym < ZMAXDCODES; sym++)
+      lengths[sym]=5;
+
+    (void)ZConstruct(&zfixdist, lengths, ZMAXDCODES);
+    zfixed_built=TRUE;
+  }
+
+  return ZCodes(z, &zfixlen, &zfixdist);
+}
+
+
+static int near ZDynamic(ZINFLATE *z)
+{
+  byte lengths[ZMAXLCODES+ZMAXDCODES];
+  ZHUFF lencode, distcode;
+  int nlen, ndist, ncode;
+  int index, err;
+
+  nlen=ZBits(z, 5)+257;
+  ndist=ZBits(z, 5)+1;
+  ncode=ZBits(z, 4)+4;
+
+  if (nlen > ZMAXLCODES || ndist > ZMAXDCODES)
+    return -1;
+
+  for (index=0; index < ncode; index++)
+    lengths[zclorder[index]]=(byte)ZBits(z, 3);
+
+  for (; index < 19; index++)
+    lengths[zclorder[index]]=0;
+
+  if (ZConstruct(&lencode, lengths, 19) != 0)
+    return -1;
+
+  for (index=0; index < nlen+ndist; )
+  {
+    int sym, len, rep;
+
+    if (z->eof || (sym=ZDecode(z, &lencode)) < 0)
+      return -1;
+
+    if (sym < 16)
+    {
+      lengths[index++]=(byte)sym;
+      continue;
+    }
+
+    len=0;
+
+    if (sym==16)
+    {
+      if (index==0)
+        return -1;
+
+      len=lengths[index-1];
+      rep=3+ZBits(z, 2);
+    }
+    else if (sym==17)
+      rep=3+ZBits(z, 3);
+    else rep=11+ZBits(z, 7);
+
+    if (index+rep > nlen+ndist)
+      return -1;
+
+    while (rep--)
+      lengths[index++]=(byte)len;
+  }
+
+  /* A block without an end-of-block code can't be decoded */
+
+  if (lengths[256]==0)
+    return -1;
+
+  err=ZConstruct(&lencode, lengths, nlen);
+
+  if (err < 0 || (err > 0 && nlen-lencode.count[0] != 1))
+    return -1;
+
+  err=ZConstruct(&distcode, lengths+nlen, ndist);
+
+  if (err < 0 || (err > 0 && ndist-distcode.count[0] != 1))
+    return -1;
+
+  return ZCodes(z, &lencode, &distcode);
+}
+
+
+/* Decompress (or copy) one member from the archive into ofd */
+
+static int near ZExpand(ZINFLATE *z, word method)
+{
+  int last, type, rc;
+
+  if (method==ZIP_METHOD_STORE)
+  {
+    while (z->left && !z->err)
+    {
+      unsigned want=(z->left < ZINBUFSIZE) ? (unsigned)z->left : ZINBUFSIZE;
+      int got;
+
+      if ((got=read(z->fd, (char *)z->ibuf, want)) <= 0)
+        return -1;
+
+      z->left -= (dword)got;
+      z->total += (dword)got;
+      z->crc=ZipCrc(z->crc, z->ibuf, (unsigned)got);
+
+      if (write(z->ofd, (char *)z->ibuf, (unsigned)got) != got)
+        z->err=TRUE;
+    }
+
+    return z->err ? -1 : 0;
+  }
+
+  do
+  {
+    last=ZBits(z, 1);
+    type=ZBits(z, 2);
+
+    switch (type)
+    {
+      case 0:   rc=ZStored(z);  break;
+      case 1:   rc=ZFixed(z);   break;
+      case 2:   rc=ZDynamic(z); break;
+      default:  rc=-1;          break;
+    }
+
+    if (z->eof || z->err)
+      rc=-1;
+  }
+  while (!last && rc==0);
+
+  ZFlush(z);
+
+  return (rc==0 && !z->err) ? 0 : -1;
+}
+
+
+
+/* Returns TRUE if a member name matches the requested wildcard.  We     *
+ * only need to handle the "*.ext" and literal forms used by the tosser. */
+
+static int near ZNameMatch(char *name, char *get)
+{
+  size_t nlen, glen;
+
+  if (*get=='*')
+  {
+    get++;
+    nlen=strlen(name);
+    glen=strlen(get);
+
+    return (nlen >= glen && eqstri(name+nlen-glen, get));
+  }
+
+  return eqstri(name, get);
+}
+
+
+/* Copy the member name out of a header, without any directory part */
+
+void ZipBaseName(byte *p, word len, char *out, size_t outlen)
+{
+  byte *s, *end=p+len;
+
+  for (s=p; s < end; s++)
+    if (*s=='/' || *s=='\\' || *s==':')
+      p=s+1;
+
+  len=(word)(end-p);
+
+  if (len >= outlen)
+    len=(word)(outlen-1);
+
+  (void)memmove(out, p, len);
+  out[len]='\0';
+}
+
+
+/* Find the end-of-central-directory record and return the offset and    *
+ * size of the central directory itself.                                 */
+
+int ZipFindCentral(int fd, long *pofs, dword *psize, word *pn)
+{
+  long size, start;
+  unsigned got;
+  byte *buf, *p;
+  int found=FALSE;
+
+  if ((size=lseek(fd, 0L, SEEK_END)) < ZIP_END_LEN)
+    return FALSE;
+
+  /* The record is followed by a comment of up to 64K */
+
+  start=size-(ZIP_END_LEN+0xffffL);
+
+  if (start < 0)
+    start=0;
+
+  got=(unsigned)(size-start);
+  buf=smalloc(got);
+
+  if (lseek(fd, start, SEEK_SET)==start &&
+      read(fd, (char *)buf, got)==(int)got)
+  {
+    for (p=buf+got-ZIP_END_LEN; p >= buf; p--)
+      if (ZIP_GETD(p)==ZIP_END_SIG)
+      {
+        *pn=ZIP_GETW(p+10);
+        *psize=ZIP_GETD(p+12);
+        *pofs=(long)ZIP_GETD(p+16);
+        found=TRUE;
+        break;
+      }
+  }
+
+  free(buf);
+
+  return found && *pofs >= 0 && (dword)*pofs + *psize <= (dword)size;
+}
+
+
+/* Extract one member to the current directory.  The data is written to  *
+ * a temporary file first, so that a half-written packet never looks    *
+ * like something that can be tossed.                                    */
+
+static int near ZExtractOne(int fd, byte *cent, char *name, byte *ibuf, byte *win)
+{
+  byte lh[ZIP_LOCAL_LEN];
+  char temp[PATHLEN];
+  char final[PATHLEN];
+  ZINFLATE z;
+  word method;
+  long ofs;
+  int rc;
+
+  method=ZIP_GETW(cent+10);
+  ofs=(long)ZIP_GETD(cent+42);
+
+  if (lseek(fd, ofs, SEEK_SET) != ofs ||
+      read(fd, (char *)lh, ZIP_LOCAL_LEN) != ZIP_LOCAL_LEN ||
+      ZIP_GETD(lh) != ZIP_LOCAL_SIG)
+  {
+    S_LogMsg("!Bad local header for %s", name);
+    return -1;
+  }
+
+  /* Skip the local copy of the name and extra field.  The sizes and CRC  *
+   * come from the central directory, since the local ones may be zero   *
+   * when the creator used a trailing data descriptor.                   */
+
+  ofs += ZIP_LOCAL_LEN + ZIP_GETW(lh+26) + ZIP_GETW(lh+28);
+
+  if (lseek(fd, ofs, SEEK_SET) != ofs)
+    return -1;
+
+  (void)sprintf(temp, "%08lx.zxt", get_unique_number());
+
+  (void)memset(&z, '\0', sizeof z);
+  z.fd=fd;
+  z.left=ZIP_GETD(cent+20);
+  z.ibuf=ibuf;
+  z.win=win;
+
+  if ((z.ofd=sopen(temp, O_CREAT | O_TRUNC | O_WRONLY | O_BINARY,
+                   SH_DENYNONE, S_IREAD | S_IWRITE))==-1)
+  {
+    S_LogMsg(cantopen, temp);
+    return -1;
+  }
+
+  rc=ZExpand(&z, method);
+
+  (void)close(z.ofd);
+
+  if (rc==0 && (z.total != ZIP_GETD(cent+24) || z.crc != ZIP_GETD(cent+16)))
+  {
+    S_LogMsg("!CRC or size mismatch for %s", name);
+    rc=-1;
+  }
+  else if (rc != 0)
+    S_LogMsg("!Error decompressing %s", name);
+
+  if (rc != 0)
+  {
+    (void)unlink(temp);
+    return -1;
+  }
+
+#ifdef UNIX
+  /* Preserve the packet date, since packets are tossed in date order */
+  {
+    union stamp_combo sc;
+    struct timeval tv[2];
+    struct tm tm;
+
+    (void)memset(&tm, '\0', sizeof tm);
+    sc.dos_st.time=ZIP_GETW(cent+12);
+    sc.dos_st.date=ZIP_GETW(cent+14);
+
+    if (sc.ldate != 0)
+    {
+      (void)DosDate_to_TmDate(&sc, &tm);
+
+      tv[0].tv_sec=tv[1].tv_sec=mktime(&tm);
+      tv[0].tv_usec=tv[1].tv_usec=0;
+
+      if (tv[0].tv_sec != (time_t)-1)
+        (void)utimes(temp, tv);
+    }
+  }
+#endif
+
+  /* Don't overwrite a packet of the same name from another bundle */
+
+  (void)strcpy(final, name);
+
+  if (fexist(final))
+    (void)sprintf(final, "%08lx.pkt", get_unique_number());
+
+  if (rename(temp, final) != 0)
+  {
+    S_LogMsg("!Can't rename %s to %s", temp, final);
+    (void)unlink(temp);
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/* Extract all members matching 'get' from a ZIP archive into the        *
+ * current directory.  Returns ZIP_NOTNATIVE (without touching anything)  *
+ * if the archive isn't a ZIP file or uses features we don't handle.     */
+
+int ZipExtract(char *arcname, char *get, unsigned *pn_got)
+{
+  byte *cdir, *p, *end, *ibuf, *win;
+  char name[PATHLEN];
+  long cofs;
+  dword csize;
+  word n_ent, i;
+  int fd, rc;
+
+  *pn_got=0;
+
+  if ((fd=sopen(arcname, O_RDONLY | O_BINARY, SH_DENYNO,
+                S_IREAD | S_IWRITE))==-1)
+    return ZIP_ERROR;
+
+  if (!ZipIsZip(fd))
+  {
+    (void)close(fd);
+    return ZIP_NOTNATIVE;
+  }
+
+  if (!ZipFindCentral(fd, &cofs, &csize, &n_ent) || csize > ZMAXCDIR)
+  {
+    (void)close(fd);
+    return ZIP_ERROR;
+  }
+
+  cdir=smalloc((unsigned)csize+1);
+
+  if (lseek(fd, cofs, SEEK_SET) != cofs ||
+      read(fd, (char *)cdir, (unsigned)csize) != (int)csize)
+  {
+    free(cdir);
+    (void)close(fd);
+    return ZIP_ERROR;
+  }
+
+  end=cdir+csize;
+
+  /* First pass:  make sure that we can handle every member that we've   *
+   * been asked for before extracting anything.                          */
+
+  rc=ZIP_OK;
+
+  for (p=cdir, i=0; i < n_ent && rc==ZIP_OK; i++)
+  {
+    word method, bits;
+
+    if (p+ZIP_CENTRAL_LEN > end || ZIP_GETD(p) != ZIP_CENTRAL_SIG ||
+        p+ZIP_CENTRAL_LEN+ZIP_GETW(p+28) > end)
+    {
+      rc=ZIP_ERROR;
+      break;
+    }
+
+    ZipBaseName(p+ZIP_CENTRAL_LEN, ZIP_GETW(p+28), name, sizeof name);
+
+    bits=ZIP_GETW(p+8);
+    method=ZIP_GETW(p+10);
+
+    if (*name && ZNameMatch(name, get) &&
+        ((bits & 0x0001) ||                           /* Encrypted */
+         (method != ZIP_METHOD_STORE && method != ZIP_METHOD_DEFLATE) ||
+         ZIP_GETD(p+20)==0xffffffffLu || ZIP_GETD(p+24)==0xffffffffLu ||
+         ZIP_GETD(p+42)==0xffffffffLu))                  /* ZIP64 */
+    {
+      rc=ZIP_NOTNATIVE;
+    }
+
+    p += ZIP_CENTRAL_LEN + ZIP_GETW(p+28) + ZIP_GETW(p+30) + ZIP_GETW(p+32);
+  }
+
+  if (rc != ZIP_OK)
+  {
+    free(cdir);
+    (void)close(fd);
+    return rc;
+  }
+
+  /* Second pass:  extract them */
+
+  ibuf=smalloc(ZINBUFSIZE);
+  win=smalloc(ZWINSIZE);
+
+  for (p=cdir, i=0; i < n_ent; i++)
+  {
+    ZipBaseName(p+ZIP_CENTRAL_LEN, ZIP_GETW(p+28), name, sizeof name);
+
+    if (*name && ZNameMatch(name, get))
+    {
+      if (ZExtractOne(fd, p, name, ibuf, win) != 0)
+      {
+        rc=ZIP_ERROR;
+        break;
+      }
+
+      (*pn_got)++;
+    }
+
+    p += ZIP_CENTRAL_LEN + ZIP_GETW(p+28) + ZIP_GETW(p+30) + ZIP_GETW(p+32);
+  }
+
+  free(win);
+  free(ibuf);
+  free(cdir);
+  (void)close(fd);
+
+  return rc;
+}
+
@@ -0,0 +1,1132 @@
+/*
+ * Maximus Version 3.02
+ * Copyright 1989, 2002 by Lanius Corporation.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/* Built-in ZIP archiver for outbound ARCmail.  Packets are deflated      *
+ * straight from the .pkt file into the bundle, and new members are       *
+ * appended to an existing bundle by rewriting its central directory, so  *
+ * squash never has to spawn an external archiver for ZIP links.          */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <share.h>
+#include <time.h>
+#include "prog.h"
+#include "max.h"
+#include "squish.h"
+#include "s_zip.h"
+
+#ifdef UNIX
+# include <unistd.h>
+#endif
+
+#define DWSIZE      32768u      /* Deflate window size                    */
+#define DWMASK      (DWSIZE-1)
+#define DHBITS      15          /* Hash table for 3-byte strings          */
+#define DHSIZE      (1u << DHBITS)
+#define DHMASK      (DHSIZE-1)
+#define DMINMATCH   3
+#define DMAXMATCH   258
+#define DMINLOOK    (DMAXMATCH+DMINMATCH+1)
+#define DMAXDIST    (DWSIZE-DMINLOOK)
+#define DTOOFAR     4096        /* Don't bother with 3-byte far matches   */
+#define DSYMBUF     16384u      /* Symbols buffered per deflate block     */
+#define DOUTBUF     16384u      /* Compressed output buffer               */
+
+#define DLCODES     286         /* Literal/length codes                   */
+#define DDCODES     30          /* Distance codes                         */
+#define DBLCODES    19          /* Bit length codes                       */
+#define DMAXBITS    15
+#define DMAXBLBITS  7
+#define DEOB        256
+
+/* Compression tuning per level, as in the classic deflate tables */
+
+static struct _dconfig
+{
+  word good;                    /* Reduce the search above this length    */
+  word lazy;                    /* Don't look for a lazy match above this */
+  word nice;                    /* Stop searching at this length          */
+  word chain;                   /* Max hash chain entries to follow       */
+} dconfig[10]=
+{
+  {  0,   0,   0,    0},        /* 0: stored, never used for searching    */
+  {  4,   4,   8,    4},
+  {  4,   5,  16,    8},
+  {  4,   6,  32,   32},
+  {  4,   4,  16,   16},
+  {  8,  16,  32,   32},
+  {  8,  16, 128,  128},
+  {  8,  32, 128,  256},
+  { 32, 128, 258, 1024},
+  { 32, 258, 258, 4096}
+};
+
+typedef struct
+{
+  int ifd, ofd;                 /* Packet being read, bundle being written*/
+  int eof;                      /* Hit the end of the packet              */
+  int err;                      /* I/O error                              */
+
+  byte *win;                    /* Sliding window, 2*DWSIZE               */
+  word *head;                   /* Most recent position of each hash      */
+  word *prev;                   /* Previous position with the same hash   */
+  unsigned strstart;            /* Current position in window             */
+  unsigned lookahead;           /* Bytes of input after strstart          */
+  unsigned match_start;         /* Start of the current match             */
+  long block_start;             /* Window position of current block       */
+
+  dword crc;                    /* CRC-32 of the uncompressed data        */
+  dword isize;                  /* Bytes of uncompressed data             */
+  dword csize;                  /* Bytes of compressed data               */
+
+  byte *lbuf;                   /* Literal, or match length-3             */
+  word *dbuf;                   /* Match distance, or 0 for a literal     */
+  unsigned nsym;                /* Symbols in lbuf/dbuf                   */
+  word lfreq[DLCODES];          /* Literal/length frequencies             */
+  word dfreq[DDCODES];          /* Distance frequencies                   */
+
+  byte *obuf;                   /* Output buffer                          */
+  unsigned opos;                /* Bytes in output buffer                 */
+  dword bitbuf;                 /* Bits not yet written to obuf           */
+  int bitcnt;                   /* Number of bits in bitbuf               */
+
+  struct _dconfig *cfg;
+} ZDEFLATE;
+
+/* Base values and extra bits for deflate length and distance codes */
+
+static word dlbase[29]=
+{
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static byte dlext[29]=
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static word ddbase[30]=
+{
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577
+};
+
+static byte ddext[30]=
+{
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static byte dblorder[DBLCODES]=
+{
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+static byte dlencode[256];      /* Match length-3 to length code-257      */
+static byte ddistcode[512];     /* Distance-1 to distance code            */
+static int dtables_built=FALSE;
+
+
+
+static void near DBuildTables(void)
+{
+  unsigned code, n;
+
+  for (code=0; code < 29; code++)
+    for (n=0; n < (1u << dlext[code]); n++)
+      if (dlbase[code]-3+n < 256)
+        dlencode[dlbase[code]-3+n]=(byte)code;
+
+  /* Length 258 has its own code, rather than being 227+31 */
+
+  dlencode[255]=28;
+
+  for (code=0; code < 30; code++)
+    for (n=0; n < (1u << ddext[code]); n++)
+    {
+      unsigned d=ddbase[code]-1+n;
+
+      if (d < 256)
+        ddistcode[d]=(byte)code;
+      else ddistcode[256+(d >> 7)]=(byte)code;
+    }
+
+  dtables_built=TRUE;
+}
+
+#define DDISTCODE(d) ((d) <= 256 ? ddistcode[(d)-1] : ddistcode[256+(((d)-1) >> 7)])
+
+
+
+/*************************** Bit output ***********************************/
+
+static void near DFlushOut(ZDEFLATE *d)
+{
+  if (d->opos && !d->err)
+  {
+    if (write(d->ofd, (char *)d->obuf, d->opos) != (int)d->opos)
+      d->err=TRUE;
+
+    d->csize += d->opos;
+  }
+
+  d->opos=0;
+}
+
+static void near DPutByte(ZDEFLATE *d, byte b)
+{
+  d->obuf[d->opos++]=b;
+
+  if (d->opos==DOUTBUF)
+    DFlushOut(d);
+}
+
+static void near DPutBits(ZDEFLATE *d, unsigned val, int n)
+{
+  d->bitbuf |= (dword)val << d->bitcnt;
+  d->bitcnt += n;
+
+  while (d->bitcnt >= 8)
+  {
+    DPutByte(d, (byte)d->bitbuf);
+    d->bitbuf >>= 8;
+    d->bitcnt -= 8;
+  }
+}
+
+static void near DAlignByte(ZDEFLATE *d)
+{
+  if (d->bitcnt)
+    DPutByte(d, (byte)d->bitbuf);
+
+  d->bitbuf=0;
+  d->bitcnt=0;
+}
+
+
+
+/*************************** Huffman trees ********************************/
+
+/* Compute code lengths for 'n' symbols, limited to 'maxbits'.  If the    *
+ * optimal tree is too deep, the frequencies are flattened and the tree   *
+ * rebuilt, which is cheap and costs very little in compression.          */
+
+static void near DBuildLengths(word *freqin, int n, int maxbits, byte *len)
+{
+  dword freq[2*DLCODES];
+  int parent[2*DLCODES];
+  int live[DLCODES];
+  int nlive, nnodes, sym, deepest;
+  int shift=0;
+
+  for (;;)
+  {
+    nlive=0;
+
+    for (sym=0; sym < n; sym++)
+    {
+      len[sym]=0;
+
+      if (freqin[sym])
+      {
+        freq[sym]=((dword)freqin[sym] >> shift) | 1;
+        live[nlive++]=sym;
+      }
+    }
+
+    /* Deflate decoders want at least two codes in each tree */
+
+    for (sym=0; nlive < 2 && sym < n; sym++)
+      if (!freqin[sym])
+      {
+        freq[sym]=1;
+        live[nlive++]=sym;
+      }
+
+    for (sym=0; sym < 2*n; sym++)
+      parent[sym]=-1;
+
+    /* Repeatedly merge the two lightest nodes */
+
+    for (nnodes=n; nlive > 1; nnodes++)
+    {
+      int i, a=0, b=1;
+
+      if (freq[live[b]] < freq[live[a]])
+        a=1, b=0;
+
+      for (i=2; i < nlive; i++)
+        if (freq[live[i]] < freq[live[a]])
+          b=a, a=i;
+        else if (freq[live[i]] < freq[live[b]])
+          b=i;
+
+      freq[nnodes]=freq[live[a]]+freq[live[b]];
+      parent[live[a]]=parent[live[b]]=nnodes;
+
+      live[a]=nnodes;
+      live[b]=live[--nlive];
+    }
+
+    /* The depth of each leaf is its code length */
+
+    for (deepest=0, sym=0; sym < n; sym++)
+      if (parent[sym] != -1)
+      {
+        int depth=0, node;
+
+        for (node=sym; parent[node] != -1; node=parent[node])
+          depth++;
+
+        len[sym]=(byte)depth;
+
+        if (depth > deepest)
+          deepest=depth;
+      }
+
+    if (deepest <= maxbits)
+      break;
+
+    shift++;
+  }
+}
+
+
+/* Assign canonical codes, bit-reversed for LSB-first output */
+
+static void near DBuildCodes(byte *len, int n, word *code)
+{
+  word next[DMAXBITS+2];
+  word count[DMAXBITS+1];
+  word c;
+  int sym, bits;
+
+  (void)memset(count, '\0', sizeof count);
+
+  for (sym=0; sym < n; sym++)
+    count[len[sym]]++;
+
+  count[0]=0;
+
+  for (c=0, bits=1; bits <= DMAXBITS; bits++)
+  {
+    c=(word)((c+count[bits-1]) << 1);
+    next[bits]=c;
+  }
+
+  for (sym=0; sym < n; sym++)
+    if (len[sym])
+    {
+      word v=next[len[sym]]++, r=0;
+
+      for (bits=len[sym]; bits--; v >>= 1)
+        r=(word)((r << 1) | (v & 1));
+
+      code[sym]=r;
+    }
+}
+
+
+/* Run-length encode the code lengths for a dynamic block header.  Each   *
+ * entry in 'out' is a bit length symbol, with any repeat count in the    *
+ * upper byte.                                                            */
+
+static int near DEncodeLengths(byte *lens, int n, word *out, word *blfreq)
+{
+  int i=0, nout=0;
+
+  while (i < n)
+  {
+    byte cur=lens[i];
+    int run=1;
+
+    while (i+run < n && lens[i+run]==cur)
+      run++;
+
+    i += run;
+
+    if (cur==0)
+    {
+      while (run >= 11)
+      {
+        int r=run > 138 ? 138 : run;
+
+        out[nout++]=(word)(18 | ((r-11) << 8));
+        blfreq[18]++;
+        run -= r;
+      }
+
+      if (run >= 3)
+      {
+        out[nout++]=(word)(17 | ((run-3) << 8));
+        blfreq[17]++;
+        run=0;
+      }
+    }
+    else
+    {
+      out[nout++]=cur;
+      blfreq[cur]++;
+      run--;
+
+      while (run >= 3)
+      {
+        int r=run > 6 ? 6 : run;
+
+        out[nout++]=(word)(16 | ((r-3) << 8));
+        blfreq[16]++;
+        run -= r;
+      }
+    }
+
+    while (run--)
+    {
+      out[nout++]=cur;
+      blfreq[cur]++;
+    }
+  }
+
+  return nout;
+}
+
+
+
+/*************************** Block output *********************************/
+
+static void near DSendSymbols(ZDEFLATE *d, word *lcode, byte *llen,
+                              word *dcode, byte *dlen)
+{
+  unsigned i;
+
+  for (i=0; i < d->nsym; i++)
+  {
+    unsigned dist=d->dbuf[i];
+
+    if (dist==0)
+      DPutBits(d, lcode[d->lbuf[i]], llen[d->lbuf[i]]);
+    else
+    {
+      unsigned lc=dlencode[d->lbuf[i]];
+      unsigned dc=DDISTCODE(dist);
+
+      DPutBits(d, lcode[257+lc], llen[257+lc]);
+      DPutBits(d, d->lbuf[i]+3-dlbase[lc], dlext[lc]);
+      DPutBits(d, dcode[dc], dlen[dc]);
+      DPutBits(d, dist-ddbase[dc], ddext[dc]);
+    }
+  }
+
+  DPutBits(d, lcode[DEOB], llen[DEOB]);
+}
+
+
+/* Emit the current block as stored, fixed or dynamic, whichever is       *
+ * smallest.                                                              */
+
+static void near DFlushBlock(ZDEFLATE *d, int last)
+{
+  byte llen[DLCODES], dlen[DDCODES], bllen[DBLCODES];
+  word lcode[DLCODES], dcode[DDCODES], blcode[DBLCODES];
+  byte fllen[DLCODES+2], fdlen[DDCODES];
+  word flcode[DLCODES+2], fdcode[DDCODES];
+  byte lens[DLCODES+DDCODES];
+  word rle[DLCODES+DDCODES];
+  word blfreq[DBLCODES];
+  dword dyn_bits, fix_bits, stored_len, xbits;
+  int hlit, hdist, hclen, nrle, i;
+
+  d->lfreq[DEOB]++;
+
+  DBuildLengths(d->lfreq, DLCODES, DMAXBITS, llen);
+  DBuildLengths(d->dfreq, DDCODES, DMAXBITS, dlen);
+
+  for (hlit=DLCODES; hlit > 257 && llen[hlit-1]==0; hlit--)
+    ;
+
+  for (hdist=DDCODES; hdist > 1 && dlen[hdist-1]==0; hdist--)
+    ;
+
+  (void)memcpy(lens, llen, hlit);
+  (void)memcpy(lens+hlit, dlen, hdist);
+
+  (void)memset(blfreq, '\0', sizeof blfreq);
+  nrle=DEncodeLengths(lens, hlit+hdist, rle, blfreq);
+  DBuildLengths(blfreq, DBLCODES, DMAXBLBITS, bllen);
+
+  for (hclen=DBLCODES; hclen > 4 && bllen[dblorder[hclen-1]]==0; hclen--)
+    ;
+
+  /* Fixed code lengths */
+
+  for (i=0; i < 144; i++)
+    fllen[i]=8;
+  for (; i < 256; i++)
+    fllen[i]=9;
+  for (; i < 280; i++)
+    fllen[i]=7;
+  for (; i < DLCODES+2; i++)
+    fllen[i]=8;
+  for (i=0; i < DDCODES; i++)
+    fdlen[i]=5;
+
+  /* Extra bits are the same for both fixed and dynamic blocks */
+
+  for (xbits=0, i=0; i < 29; i++)
+    xbits += (dword)d->lfreq[257+i] * dlext[i];
+  for (i=0; i < DDCODES; i++)
+    xbits += (dword)d->dfreq[i] * ddext[i];
+
+  dyn_bits=3+5+5+4+3L*hclen+xbits;
+  fix_bits=3+xbits;
+
+  for (i=0; i < nrle; i++)
+  {
+    int sym=rle[i] & 0xff;
+
+    dyn_bits += bllen[sym] + (sym==16 ? 2 : sym==17 ? 3 : sym==18 ? 7 : 0);
+  }
+
+  for (i=0; i < DLCODES; i++)
+  {
+    dyn_bits += (dword)d->lfreq[i]*llen[i];
+    fix_bits += (dword)d->lfreq[i]*fllen[i];
+  }
+
+  for (i=0; i < DDCODES; i++)
+  {
+    dyn_bits += (dword)d->dfreq[i]*dlen[i];
+    fix_bits += (dword)d->dfreq[i]*fdlen[i];
+  }
+
+  stored_len=(dword)((long)d->strstart-d->block_start);
+
+  if (d->block_start >= 0 && stored_len <= 0xffffu &&
+      (stored_len+4)*8+10 <= dyn_bits && (stored_len+4)*8+10 <= fix_bits)
+  {
+    DPutBits(d, last, 1);
+    DPutBits(d, 0, 2);
+    DAlignByte(d);
+    DPutByte(d, (byte)stored_len);
+    DPutByte(d, (byte)(stored_len >> 8));
+    DPutByte(d, (byte)~stored_len);
+    DPutByte(d, (byte)(~stored_len >> 8));
+
+    for (i=0; i < (int)stored_len; i++)
+      DPutByte(d, d->win[d->block_start+i]);
+  }
+  else if (fix_bits <= dyn_bits)
+  {
+    DBuildCodes(fllen, DLCODES+2, flcode);
+    DBuildCodes(fdlen, DDCODES, fdcode);
+
+    DPutBits(d, last, 1);
+    DPutBits(d, 1, 2);
+    DSendSymbols(d, flcode, fllen, fdcode, fdlen);
+  }
+  else
+  {
+    DBuildCodes(llen, DLCODES, lcode);
+    DBuildCodes(dlen, DDCODES, dcode);
+    DBuildCodes(bllen, DBLCODES, blcode);
+
+    DPutBits(d, last, 1);
+    DPutBits(d, 2, 2);
+    DPutBits(d, hlit-257, 5);
+    DPutBits(d, hdist-1, 5);
+    DPutBits(d, hclen-4, 4);
+
+    for (i=0; i < hclen; i++)
+      DPutBits(d, bllen[dblorder[i]], 3);
+
+    for (i=0; i < nrle; i++)
+    {
+      int sym=rle[i] & 0xff;
+      int rep=rle[i] >> 8;
+
+      DPutBits(d, blcode[sym], bllen[sym]);
+
+      if (sym==16)
+        DPutBits(d, rep, 2);
+      else if (sym==17)
+        DPutBits(d, rep, 3);
+      else if (sym==18)
+        DPutBits(d, rep, 7);
+    }
+
+    DSendSymbols(d, lcode, llen, dcode, dlen);
+  }
+
+  if (last)
+    DAlignByte(d);
+
+  d->block_start=(long)d->strstart;
+  d->nsym=0;
+  (void)memset(d->lfreq, '\0', sizeof d->lfreq);
+  (void)memset(d->dfreq, '\0', sizeof d->dfreq);
+}
+
+
+/* Record a literal (dist==0) or a match.  Returns TRUE if the block      *
+ * buffer is full.                                                        */
+
+static int near DTally(ZDEFLATE *d, unsigned dist, unsigned lc)
+{
+  d->lbuf[d->nsym]=(byte)lc;
+  d->dbuf[d->nsym]=(word)dist;
+  d->nsym++;
+
+  if (dist==0)
+    d->lfreq[lc]++;
+  else
+  {
+    d->lfreq[257+dlencode[lc]]++;
+    d->dfreq[DDISTCODE(dist)]++;
+  }
+
+  return d->nsym==DSYMBUF;
+}
+
+
+
+/*************************** Matching *************************************/
+
+/* Read more of the packet into the window, sliding it down if needed */
+
+static void near DFill(ZDEFLATE *d)
+{
+  while (d->lookahead < DMINLOOK && !d->eof)
+  {
+    unsigned more=2*DWSIZE-d->lookahead-d->strstart;
+    int got;
+
+    if (d->strstart >= DWSIZE+DMAXDIST)
+    {
+      unsigned n;
+
+      (void)memcpy(d->win, d->win+DWSIZE, DWSIZE-more);
+      d->strstart -= DWSIZE;
+      d->match_start=d->match_start >= DWSIZE ? d->match_start-DWSIZE : 0;
+      d->block_start -= DWSIZE;
+
+      for (n=0; n < DHSIZE; n++)
+        d->head[n]=(word)(d->head[n] >= DWSIZE ? d->head[n]-DWSIZE : 0);
+
+      for (n=0; n < DWSIZE; n++)
+        d->prev[n]=(word)(d->prev[n] >= DWSIZE ? d->prev[n]-DWSIZE : 0);
+
+      more += DWSIZE;
+    }
+
+    if ((got=read(d->ifd, (char *)d->win+d->strstart+d->lookahead, more)) <= 0)
+    {
+      if (got < 0)
+        d->err=TRUE;
+
+      d->eof=TRUE;
+      break;
+    }
+
+    d->crc=ZipCrc(d->crc, d->win+d->strstart+d->lookahead, (unsigned)got);
+    d->isize += (dword)got;
+    d->lookahead += (unsigned)got;
+  }
+}
+
+
+/* Insert the string at 'pos' into the hash chains, returning the         *
+ * previous head of its chain.                                            */
+
+static unsigned near DInsert(ZDEFLATE *d, unsigned pos)
+{
+  byte *p=d->win+pos;
+  unsigned h=((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & DHMASK;
+  unsigned match=d->head[h];
+
+  d->prev[pos & DWMASK]=(word)match;
+  d->head[h]=(word)pos;
+
+  return match;
+}
+
+
+static unsigned near DLongest(ZDEFLATE *d, unsigned cur, unsigned best,
+                              unsigned *pstart)
+{
+  byte *scan=d->win+d->strstart;
+  unsigned chain=d->cfg->chain;
+  unsigned maxlen=d->lookahead < DMAXMATCH ? d->lookahead : DMAXMATCH;
+  unsigned limit=d->strstart > DMAXDIST ? d->strstart-DMAXDIST : 0;
+
+  if (best >= maxlen)
+    return maxlen;
+
+  if (best >= d->cfg->good)
+    chain >>= 2;
+
+  do
+  {
+    byte *m=d->win+cur;
+    unsigned len;
+
+    if (m[best] != scan[best] || m[0] != scan[0] || m[1] != scan[1])
+      continue;
+
+    for (len=2; len < maxlen && m[len]==scan[len]; len++)
+      ;
+
+    if (len > best)
+    {
+      best=len;
+      *pstart=cur;
+
+      if (len >= d->cfg->nice || len >= maxlen)
+        break;
+    }
+  }
+  while ((cur=d->prev[cur & DWMASK]) > limit && --chain);
+
+  return best > maxlen ? maxlen : best;
+}
+
+
+/* The main deflate loop, using lazy match evaluation */
+
+static int near DDeflate(ZDEFLATE *d)
+{
+  unsigned match_len=DMINMATCH-1;
+  unsigned prev_len, prev_match;
+  int match_avail=FALSE;
+
+  for (;;)
+  {
+    unsigned hash_head=0;
+
+    if (d->lookahead < DMINLOOK)
+      DFill(d);
+
+    if (d->lookahead==0 || d->err)
+      break;
+
+    if (d->lookahead >= DMINMATCH)
+      hash_head=DInsert(d, d->strstart);
+
+    prev_len=match_len;
+    prev_match=d->match_start;
+    match_len=DMINMATCH-1;
+
+    if (hash_head && prev_len < d->cfg->lazy &&
+        d->strstart-hash_head <= DMAXDIST)
+    {
+      match_len=DLongest(d, hash_head, prev_len, &d->match_start);
+
+      if (match_len==DMINMATCH && d->strstart-d->match_start > DTOOFAR)
+        match_len=DMINMATCH-1;
+    }
+
+    if (prev_len >= DMINMATCH && match_len <= prev_len)
+    {
+      /* The previous match was better, so emit it */
+
+      unsigned max_insert=d->strstart+d->lookahead-DMINMATCH;
+      int full;
+
+      full=DTally(d, d->strstart-1-prev_match, prev_len-DMINMATCH);
+
+      d->lookahead -= prev_len-1;
+      prev_len -= 2;
+
+      do
+      {
+        if (++d->strstart <= max_insert)
+          (void)DInsert(d, d->strstart);
+      }
+      while (--prev_len != 0);
+
+      match_avail=FALSE;
+      match_len=DMINMATCH-1;
+      d->strstart++;
+
+      if (full)
+        DFlushBlock(d, FALSE);
+    }
+    else if (match_avail)
+    {
+      if (DTally(d, 0, d->win[d->strstart-1]))
+        DFlushBlock(d, FALSE);
+
+      d->strstart++;
+      d->lookahead--;
+    }
+    else
+    {
+      match_avail=TRUE;
+      d->strstart++;
+      d->lookahead--;
+    }
+  }
+
+  if (match_avail)
+    (void)DTally(d, 0, d->win[d->strstart-1]);
+
+  DFlushBlock(d, TRUE);
+  DFlushOut(d);
+
+  return d->err ? -1 : 0;
+}
+
+
+/* Copy the packet into the bundle without compression */
+
+static int near DStore(ZDEFLATE *d)
+{
+  int got;
+
+  while ((got=read(d->ifd, (char *)d->win, 2*DWSIZE)) > 0)
+  {
+    d->crc=ZipCrc(d->crc, d->win, (unsigned)got);
+    d->isize += (dword)got;
+
+    if (write(d->ofd, (char *)d->win, (unsigned)got) != got)
+      return -1;
+
+    d->csize += (dword)got;
+  }
+
+  return got < 0 ? -1 : 0;
+}
+
+
+/* Compress the file on ifd and write it to ofd */
+
+static int near ZCompress(int ifd, int ofd, word level, dword *pcrc,
+                          dword *pcsize, dword *pisize)
+{
+  ZDEFLATE d;
+  int rc;
+
+  if (!dtables_built)
+    DBuildTables();
+
+  (void)memset(&d, '\0', sizeof d);
+
+  d.ifd=ifd;
+  d.ofd=ofd;
+  d.cfg=&dconfig[level > 9 ? 9 : level];
+  d.win=smalloc(2*DWSIZE);
+
+  if (level==0)
+    rc=DStore(&d);
+  else
+  {
+    d.head=smalloc(DHSIZE*sizeof(word));
+    d.prev=smalloc(DWSIZE*sizeof(word));
+    d.lbuf=smalloc(DSYMBUF);
+    d.dbuf=smalloc(DSYMBUF*sizeof(word));
+    d.obuf=smalloc(DOUTBUF);
+
+    (void)memset(d.head, '\0', DHSIZE*sizeof(word));
+    (void)memset(d.prev, '\0', DWSIZE*sizeof(word));
+
+    rc=DDeflate(&d);
+
+    free(d.obuf);
+    free(d.dbuf);
+    free(d.lbuf);
+    free(d.prev);
+    free(d.head);
+  }
+
+  free(d.win);
+
+  *pcrc=d.crc;
+  *pcsize=d.csize;
+  *pisize=d.isize;
+
+  return rc;
+}
+
+
+
+/*************************** ZIP container ********************************/
+
+/* Get the DOS-style timestamp to store for a file */
+
+static void near ZipFileStamp(int fd, word *ptime, word *pdate)
+{
+  union stamp_combo sc;
+  struct stat st;
+  time_t t;
+
+  t=(fstat(fd, &st)==0) ? st.st_mtime : time(NULL);
+
+  (void)TmDate_to_DosDate(localtime(&t), &sc);
+
+  *ptime=sc.dos_st.time;
+  *pdate=sc.dos_st.date;
+}
+
+
+/* Returns TRUE if the central directory already holds 'name' */
+
+static int near ZipHasMember(byte *cdir, dword csize, word n_ent, char *name)
+{
+  char mname[PATHLEN];
+  byte *p=cdir, *end=cdir+csize;
+  word i;
+
+  for (i=0; i < n_ent && p+ZIP_CENTRAL_LEN <= end; i++)
+  {
+    ZipBaseName(p+ZIP_CENTRAL_LEN, ZIP_GETW(p+28), mname, sizeof mname);
+
+    if (eqstri(mname, name))
+      return TRUE;
+
+    p += ZIP_CENTRAL_LEN + ZIP_GETW(p+28) + ZIP_GETW(p+30) + ZIP_GETW(p+32);
+  }
+
+  return FALSE;
+}
+
+
+/* Cut a bundle back to 'size' bytes.  setfsize() only ever extends a    *
+ * file under UNIX, so use ftruncate() there.                             */
+
+static int near ZipTruncate(int fd, long size)
+{
+#ifdef UNIX
+  return ftruncate(fd, (off_t)size);
+#else
+  return setfsize(fd, size);
+#endif
+}
+
+
+/* Write an end-of-central-directory record, followed by the archive's   *
+ * comment (if any).                                                      */
+
+static int near ZipWriteEnd(int fd, word n_ent, dword csize, long cofs,
+                            byte *cmt, word clen)
+{
+  byte er[ZIP_END_LEN];
+
+  (void)memset(er, '\0', sizeof er);
+  ZIP_PUTD(er, ZIP_END_SIG);
+  ZIP_PUTW(er+8, n_ent);
+  ZIP_PUTW(er+10, n_ent);
+  ZIP_PUTD(er+12, csize);
+  ZIP_PUTD(er+16, cofs);
+  ZIP_PUTW(er+20, clen);
+
+  return (write(fd, (char *)er, ZIP_END_LEN)==ZIP_END_LEN &&
+          (clen==0 || write(fd, (char *)cmt, clen)==(int)clen));
+}
+
+
+/* Add 'filename' to the ZIP bundle 'arcname', creating it if necessary.  *
+ * If anything goes wrong while appending, the bundle is restored to its  *
+ * original state.  Returns ZIP_NOTNATIVE if the existing bundle isn't    *
+ * something that we know how to append to.                               */
+
+int ZipAddFile(char *arcname, char *filename, word level)
+{
+  byte lh[ZIP_LOCAL_LEN];
+  byte ce[ZIP_CENTRAL_LEN];
+  byte er[ZIP_END_LEN];
+  byte *cdir=NULL, *cmt=NULL;
+  char name[PATHLEN];
+  dword csize=0, crc, cmpsize, isize;
+  long cofs=0, orig_size, pos;
+  word n_ent=0, clen=0, method, ftime, fdate, nlen;
+  int afd, ifd, rc=ZIP_ERROR;
+
+  if ((ifd=sopen(filename, O_RDONLY | O_BINARY, SH_DENYWR,
+                 S_IREAD | S_IWRITE))==-1)
+  {
+    S_LogMsg(cantopen, filename);
+    return ZIP_ERROR;
+  }
+
+  if ((afd=sopen(arcname, O_CREAT | O_RDWR | O_BINARY, SH_DENYWR,
+                 S_IREAD | S_IWRITE))==-1)
+  {
+    S_LogMsg(cantopen, arcname);
+    (void)close(ifd);
+    return ZIP_ERROR;
+  }
+
+  orig_size=lseek(afd, 0L, SEEK_END);
+
+  /* If we're appending, read the existing central directory and end    *
+   * record so that they can be rewritten after the new member.  Anything *
+   * too big for a plain end record is left to the external archiver.    */
+
+  if (orig_size > 0)
+  {
+    if (!ZipIsZip(afd) || !ZipFindCentral(afd, &cofs, &csize, &n_ent) ||
+        n_ent >= 0xfffeu || csize > ZMAXCDIR)
+    {
+      (void)close(afd);
+      (void)close(ifd);
+      return ZIP_NOTNATIVE;
+    }
+
+    cdir=smalloc((unsigned)csize+1);
+
+    if (lseek(afd, cofs, SEEK_SET) != cofs ||
+        read(afd, (char *)cdir, (unsigned)csize) != (int)csize ||
+        read(afd, (char *)er, ZIP_END_LEN) != ZIP_END_LEN)
+      goto Done;
+
+    /* The end record must follow the directory directly (no ZIP64     *
+     * locator), and its comment is carried over to the new one.       */
+
+    if (ZIP_GETD(er) != ZIP_END_SIG ||
+        cofs+(long)csize+ZIP_END_LEN+(long)ZIP_GETW(er+20) > orig_size)
+    {
+      rc=ZIP_NOTNATIVE;
+      goto Done;
+    }
+
+    if ((clen=ZIP_GETW(er+20)) != 0)
+    {
+      cmt=smalloc(clen);
+
+      if (read(afd, (char *)cmt, clen) != (int)clen)
+        goto Done;
+    }
+  }
+
+  ZipBaseName((byte *)filename, (word)strlen(filename), name, sizeof name);
+
+  /* Never add a second member with the same name as an existing one */
+
+  if (cdir && ZipHasMember(cdir, csize, n_ent, name))
+    (void)sprintf(name, "%08lx.pkt", get_unique_number());
+
+  nlen=(word)strlen(name);
+
+  if (csize+ZIP_CENTRAL_LEN+nlen > ZMAXCDIR)
+  {
+    S_LogMsg("!Central directory of %s is full", arcname);
+    rc=ZIP_NOTNATIVE;
+    goto Done;
+  }
+  method=(word)(level ? ZIP_METHOD_DEFLATE : ZIP_METHOD_STORE);
+  ZipFileStamp(ifd, &ftime, &fdate);
+
+  /* Write the local header with placeholders for the sizes and CRC,     *
+   * which are filled in once the data has been compressed.              */
+
+  (void)memset(lh, '\0', sizeof lh);
+  ZIP_PUTD(lh, ZIP_LOCAL_SIG);
+  ZIP_PUTW(lh+4, 20);
+  ZIP_PUTW(lh+8, method);
+  ZIP_PUTW(lh+10, ftime);
+  ZIP_PUTW(lh+12, fdate);
+  ZIP_PUTW(lh+26, nlen);
+
+  if (lseek(afd, cofs, SEEK_SET) != cofs ||
+      write(afd, (char *)lh, ZIP_LOCAL_LEN) != ZIP_LOCAL_LEN ||
+      write(afd, name, nlen) != (int)nlen)
+    goto Restore;
+
+  if (ZCompress(ifd, afd, level, &crc, &cmpsize, &isize) != 0)
+    goto Restore;
+
+  pos=lseek(afd, 0L, SEEK_CUR);
+
+  ZIP_PUTD(lh+14, crc);
+  ZIP_PUTD(lh+18, cmpsize);
+  ZIP_PUTD(lh+22, isize);
+
+  if (lseek(afd, cofs, SEEK_SET) != cofs ||
+      write(afd, (char *)lh, ZIP_LOCAL_LEN) != ZIP_LOCAL_LEN ||
+      lseek(afd, pos, SEEK_SET) != pos)
+    goto Restore;
+
+  /* Now the old central directory, our entry and the end record */
+
+  (void)memset(ce, '\0', sizeof ce);
+  ZIP_PUTD(ce, ZIP_CENTRAL_SIG);
+  ZIP_PUTW(ce+4, 20);
+  ZIP_PUTW(ce+6, 20);
+  ZIP_PUTW(ce+10, method);
+  ZIP_PUTW(ce+12, ftime);
+  ZIP_PUTW(ce+14, fdate);
+  ZIP_PUTD(ce+16, crc);
+  ZIP_PUTD(ce+20, cmpsize);
+  ZIP_PUTD(ce+24, isize);
+  ZIP_PUTW(ce+28, nlen);
+  ZIP_PUTD(ce+42, cofs);
+
+  if ((csize && write(afd, (char *)cdir, (unsigned)csize) != (int)csize) ||
+      write(afd, (char *)ce, ZIP_CENTRAL_LEN) != ZIP_CENTRAL_LEN ||
+      write(afd, name, nlen) != (int)nlen)
+    goto Restore;
+
+  if (!ZipWriteEnd(afd, (word)(n_ent+1), csize+ZIP_CENTRAL_LEN+nlen, pos,
+                   cmt, clen))
+    goto Restore;
+
+  (void)ZipTruncate(afd, lseek(afd, 0L, SEEK_CUR));
+  rc=ZIP_OK;
+  goto Done;
+
+Restore:
+
+  /* Put the original central directory back where it was */
+
+  S_LogMsg("!Error adding %s to %s", filename, arcname);
+
+  if (orig_size > 0)
+  {
+    if (lseek(afd, cofs, SEEK_SET)==cofs &&
+        write(afd, (char *)cdir, (unsigned)csize)==(int)csize &&
+        ZipWriteEnd(afd, n_ent, csize, cofs, cmt, clen))
+    {
+      (void)ZipTruncate(afd, cofs+(long)csize+ZIP_END_LEN+clen);
+    }
+  }
+  else (void)ZipTruncate(afd, 0L);
+
+Done:
+
+  if (cmt)
+    free(cmt);
+
+  if (cdir)
+    free(cdir);
+
+  (void)close(afd);
+  (void)close(ifd);
+
+  if (rc != ZIP_OK && orig_size <= 0)
+    (void)unlink(arcname);
+
+  return rc;
+}
+
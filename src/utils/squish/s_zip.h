@@ -0,0 +1,69 @@
+/*
+ * Maximus Version 3.02
+ * Copyright 1989, 2002 by Lanius Corporation.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __S_ZIP_H_DEFINED
+#define __S_ZIP_H_DEFINED
+
+/* Built-in ZIP support, so that the common case of tossing and bundling  *
+ * ZIP-compressed mail doesn't need to spawn an external archiver.        */
+
+#define ZIP_OK          0       /* Archive was processed internally       */
+#define ZIP_ERROR     (-1)      /* Archive is damaged or I/O failed       */
+#define ZIP_NOTNATIVE   1       /* Can't handle it; use external archiver */
+
+#define ZIP_METHOD_STORE    0   /* ZIP compression methods we understand  */
+#define ZIP_METHOD_DEFLATE  8
+
+#define ZIP_LOCAL_SIG   0x04034b50L
+#define ZIP_CENTRAL_SIG 0x02014b50L
+#define ZIP_END_SIG     0x06054b50L
+#define ZIP_SIGSTR      "PK\x03\x04"    /* Local sig as a COMPRESS.CFG Ident  */
+
+#define ZIP_LOCAL_LEN   30      /* Fixed part of a local file header      */
+#define ZIP_CENTRAL_LEN 46      /* Fixed part of a central dir entry      */
+#define ZIP_END_LEN     22      /* Fixed part of end-of-central-dir rec   */
+
+#define ZIP_LEVEL_DEF   6       /* Default deflate level for bundling     */
+
+#define ZMAXCDIR    0x400000L   /* Sanity limit on central directory size */
+
+/* Little-endian field accessors for ZIP headers */
+
+#define ZIP_GETW(p)     ((word)((p)[0] | ((word)(p)[1] << 8)))
+#define ZIP_GETD(p)     ((dword)(p)[0] | ((dword)(p)[1] << 8) | \
+                         ((dword)(p)[2] << 16) | ((dword)(p)[3] << 24))
+
+#define ZIP_PUTW(p, w)  ((p)[0]=(byte)(w), (p)[1]=(byte)((w) >> 8))
+#define ZIP_PUTD(p, d)  (ZIP_PUTW(p, (word)(d)), \
+                         ZIP_PUTW((p)+2, (word)((dword)(d) >> 16)))
+
+/* s_unzip.c */
+
+int ZipIsZip(int fd);
+int ZipFindCentral(int fd, long *pofs, dword *psize, word *pn);
+void ZipBaseName(byte *p, word len, char *out, size_t outlen);
+int ZipExtract(char *arcname, char *get, unsigned *pn_got);
+dword ZipCrc(dword crc, byte *buf, unsigned len);
+
+/* s_zip.c */
+
+int ZipAddFile(char *arcname, char *filename, word level);
+
+#endif /* __S_ZIP_H_DEFINED */
+
@@ -158,6 +158,8 @@ int _stdc main(int argc, char *argv[])
     config.flag &= ~FLAG_ADDMODE;
     HandleAttReqPoll(ar.action, ar.toscan);
   }
+  else if (ar.action==ACTION_ROUTE)
+    Route_Verify((char *)config.routing, (char *)ar.sched, &ar.n);
   else SquishSquashCycle();
 
 #ifdef DJ
@@ -181,7 +183,7 @@ static void near InitializeConfig(void)
 
   /* Turn secure mode on/off */
 
-  if (ar.action==ACTION_RESCAN)
+  if (ar.action==ACTION_RESCAN || ar.action==ACTION_ROUTE)
   {
     (void)SblistToNetaddr(&config.def, &ar.n);
 
@@ -377,7 +379,8 @@ void usage(void)
         "   SQUISH SEND <file> [TO] <node> [flavour]     - Attach file to node\n"
         "   SQUISH GET <file> [FROM] <node> [flavour]    - Request file from node\n"
         "   SQUISH UPDATE <file> [FROM] <node> [flavour] - Upd. request file from node\n"
-        "   SQUISH POLL <node> [flavour]                 - Poll node\n\n");
+        "   SQUISH POLL <node> [flavour]                 - Poll node\n"
+        "   SQUISH ROUTE <node> [-s<tag>]                - Show how node is routed\n\n");
 
   (void)printf("Press <enter> to continue: ");
   (void)fgets(temp, 50, stdin);
@@ -440,6 +443,20 @@ static void near ParseArgs(struct _args *ags, byte *argv[])
         //return;
 	arg += 2;
       }
+      else if (eqstri(*arg, "route"))
+      {
+        if (arg[1]==NULL)
+        {
+          (void)printf("Error!  Format for ROUTE command is:\n\n"
+                       "    SQUISH ROUTE <node> [-s<tag>]\n");
+
+          exit(ERL_ERROR);
+        }
+
+        ags->action=ACTION_ROUTE;
+        ags->toscan=arg+1;
+        arg++;
+      }
 #if 0
       else if (eqstri(*arg, "test"))
       {
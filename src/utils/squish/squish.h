@@ -112,6 +112,7 @@ extern byte *version;
 #define ACTION_SEND   0x03
 #define ACTION_RESCAN 0x04
 #define ACTION_UPDATE 0x05
+#define ACTION_ROUTE  0x06
 
 #define MODE_toss 0x01
 #define MODE_scan 0x02
@@ -301,6 +302,7 @@ struct _tosspath
 #define FLAG2_DHEADER 0x0200    /* Dupecheck using the message header       */
 #define FLAG2_DMSGID  0x0400    /* Dupecheck using the MSGID                */
 #define FLAG2_LONGHDR 0x0800    /* Use the entire subject line for dupe chk */
+#define FLAG2_EXTARC  0x1000    /* Always use external archivers            */
 
 struct _config
 {
@@ -333,6 +335,7 @@ struct _config
   word num_ats;                 /* Number of nodes to add to seenbys        */
   word max_msgs;                /* Max # of msgs to toss before packing     */
   word max_archive;             /* Max size of one ARCmail archive          */
+  word zip_level;               /* Deflate level for built-in ZIP bundles   */
 
   word maxpkt;                  /* Max # of pkts in OUT.SQ at once          */
   word maxattach;               /* Max # of attach msgs in netmail at once  */
@@ -446,6 +449,9 @@ typedef struct _matchout
   sword type;
   byte flavour;
   byte fFromHole;
+
+  word hcur;            /* Current entry in the hashed OUT.SQ chain       */
+  byte hlevel;          /* Which chain we're walking (HL_xxx, s_hole.c)   */
 } MATCHOUT;
 
 
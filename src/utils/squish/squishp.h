@@ -41,6 +41,7 @@ void Hole_Free_Netmail_Area(void);
 word Hole_Add_To_Net(NETADDR *,char *,int );
 MATCHOUT * HoleMatchOutOpen(NETADDR *who,int type,byte flavour);
 int HoleMatchOutNext(MATCHOUT *);
+void HoleMatchOutStart(MATCHOUT *mo);
 void HoleMatchOutClose(MATCHOUT *);
 void Link_Messages(char *etname);
 void cdecl _junk_cdecl_proc(void);
@@ -70,6 +71,7 @@ int CallExtern(char *cmd, word archiver);
 void FloName(byte *out, NETADDR *n, byte flavour, word addmode);
 void Parse_Config(char *cfgname);
 void Munge_Outbound_Area(byte *cfgname,byte *tag);
+void Route_Verify(char *cfgname, char *tag, NETADDR *who);
 int BusyFileExist(NETADDR *n);
 unsigned long get_unique_number(void);
 word Adjust_Pkt_Header(struct _pkthdr *pkt);
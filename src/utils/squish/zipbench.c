@@ -0,0 +1,342 @@
+/*
+ * zipbench.c — Bundling throughput: built-in ZIP against the archiver
+ *
+ * Copyright 2026 by Kevin Morgan.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/* Built on its own with s_zip.c and s_unzip.c ("make bench" in           *
+ * src/utils/squish), not linked into squish.                             *
+ *                                                                        *
+ * Writes N packets and bundles them round-robin to M links, the way      *
+ * squash does for outbound mail: once with ZipAddFile(), and once by     *
+ * running the Add command of the ZIP archiver in COMPRESS.CFG, as        *
+ * CallExtern() would.  Reports packets per second for each, and fails    *
+ * if either leaves a bundle without every packet in it.                  *
+ *                                                                        *
+ *   zipbench [-c compress.cfg] [-n packets] [-m links] [-s size]         *
+ *            [-l level]                                                  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <io.h>
+#include <fcntl.h>
+#include <process.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#define INITSQUISH  /* cantopen, cr3tab and friends live here */
+
+#include "prog.h"
+#include "max.h"
+#include "arc_def.h"
+#include "squish.h"
+#include "s_zip.h"
+
+#define MAX_ARGS 32
+
+static char szDir[]="/tmp/zipbenchXXXXXX";
+
+
+/* What s_zip.c and s_unzip.c use from the rest of Squish */
+
+void _stdc S_LogMsg(char *format,...)
+{
+  va_list va;
+
+  va_start(va, format);
+  vfprintf(stderr, format, va);
+  va_end(va);
+
+  fputc('\n', stderr);
+}
+
+unsigned long get_unique_number(void)
+{
+  static unsigned long n=0x10000000L;
+
+  return n++;
+}
+
+
+static double near NowSec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec/1e9;
+}
+
+/* Write a packet of about 'size' bytes of message text */
+
+static int near MakePacket(char *name, long size, int seed)
+{
+  static const char *words[]={"the", "echomail", "netmail", "area", "sysop",
+                              "node", "point", "Maximus", "Squish", "BBS",
+                              "message", "reply", "FidoNet", "zone", "hub"};
+  FILE *fp;
+  long n;
+  int i;
+
+  if ((fp=fopen(name, "wb"))==NULL)
+    return FALSE;
+
+  /* A packet header, then message text up to the size asked for */
+
+  for (i=0; i < 58; i++)
+    fputc(i==18 ? 2 : 0, fp);
+
+  srand((unsigned)seed);
+
+  for (n=58; n < size; )
+  {
+    n += fprintf(fp, "%s%s", words[rand() % 15], (rand() % 12) ? " " : "\r");
+
+    if (rand() % 300==0)
+      n += fprintf(fp, "\r * Origin: Test system (1:%d/%d)\r",
+                   rand() % 400, rand() % 200);
+  }
+
+  fputc(0, fp);
+  fputc(0, fp);
+  fclose(fp);
+  return TRUE;
+}
+
+/* Run an archiver command, as CallExtern() does with QuietArc */
+
+static int near RunArchiver(char *origcmd)
+{
+  char *args[MAX_ARGS+1];
+  char *cmd, *s;
+  int nargs, save_stdout, nul_file, rc;
+
+  if ((cmd=strdup(origcmd))==NULL)
+    return -1;
+
+  for (nargs=0, s=strtok(cmd, " "); s && *s && nargs < MAX_ARGS;
+       s=strtok(NULL, " "))
+    args[nargs++]=s;
+
+  args[nargs]=NULL;
+
+  (void)fflush(stdout);
+  save_stdout=dup(fileno(stdout));
+
+  if ((nul_file=open("/dev/null", O_WRONLY))!= -1)
+  {
+    (void)dup2(nul_file, fileno(stdout));
+    (void)close(nul_file);
+  }
+
+  rc=spawnvp(P_WAIT, args[0], args);
+
+  (void)dup2(save_stdout, fileno(stdout));
+  (void)close(save_stdout);
+
+  free(cmd);
+  return rc;
+}
+
+/* Count the members of a bundle */
+
+static int near Members(char *name)
+{
+  long ofs;
+  dword size;
+  word n=0;
+  int fd;
+
+  if ((fd=open(name, O_RDONLY | O_BINARY))==-1)
+    return -1;
+
+  if (!ZipIsZip(fd) || !ZipFindCentral(fd, &ofs, &size, &n))
+    n=(word)-1;
+
+  close(fd);
+  return (int)(sword)n;
+}
+
+/* Bundle every packet for its link; returns packets per second, or -1 */
+
+static double near Bundle(struct _arcinfo *ai, int npkt, int nlink,
+                          word level, long *pbytes)
+{
+  char pkt[PATHLEN], arc[PATHLEN], cmd[PATHLEN*2];
+  struct stat st;
+  double t0, t;
+  int i, n;
+
+  for (i=0; i < nlink; i++)
+  {
+    (void)sprintf(arc, "%s/%08x.mo0", szDir, i);
+    (void)unlink(arc);
+  }
+
+  t0=NowSec();
+
+  for (i=0; i < npkt; i++)
+  {
+    (void)sprintf(pkt, "%s/pkt/%08x.pkt", szDir, i);
+    (void)sprintf(arc, "%s/%08x.mo0", szDir, i % nlink);
+
+    if (ai)
+    {
+      Form_Archiver_Cmd(arc, pkt, cmd, ai->add);
+
+      if (RunArchiver(cmd) != 0)
+      {
+        printf("FAILED: %s\n", cmd);
+        return -1.0;
+      }
+    }
+    else if (ZipAddFile(arc, pkt, level) != ZIP_OK)
+    {
+      printf("FAILED: ZipAddFile(%s, %s)\n", arc, pkt);
+      return -1.0;
+    }
+  }
+
+  t=NowSec()-t0;
+
+  for (i=0, *pbytes=0L; i < nlink; i++)
+  {
+    (void)sprintf(arc, "%s/%08x.mo0", szDir, i);
+    n=npkt/nlink + (i < npkt % nlink);
+
+    if (Members(arc) != n || stat(arc, &st) != 0)
+    {
+      printf("FAILED: %s should have %d members, has %d\n",
+             arc, n, Members(arc));
+      return -1.0;
+    }
+
+    *pbytes += (long)st.st_size;
+  }
+
+  return npkt/t;
+}
+
+
+int main(int argc, char *argv[])
+{
+  struct _arcinfo *ar, *ai;
+  char *cfg="compress.cfg";
+  char name[PATHLEN];
+  int npkt=500, nlink=50, level=ZIP_LEVEL_DEF;
+  long size=8192L, bytes;
+  double pps, pps_ext;
+  int i, rc=1;
+
+  for (i=1; i < argc; i++)
+  {
+    if (argv[i][0] != '-' || argv[i][1]=='\0' || i+1 >= argc)
+    {
+      fprintf(stderr, "Usage: zipbench [-c compress.cfg] [-n packets] "
+                      "[-m links] [-s size] [-l level]\n");
+      return 1;
+    }
+
+    switch (argv[i++][1])
+    {
+      case 'c': cfg=argv[i]; break;
+      case 'n': npkt=atoi(argv[i]); break;
+      case 'm': nlink=atoi(argv[i]); break;
+      case 's': size=atol(argv[i]); break;
+      case 'l': level=atoi(argv[i]); break;
+    }
+  }
+
+  if (npkt < 1 || nlink < 1 || level < 0 || level > 9)
+    return 1;
+
+  if ((ar=Parse_Arc_Control_File(cfg))==NULL)
+  {
+    printf("FAILED: can't read %s\n", cfg);
+    return 1;
+  }
+
+  for (ai=ar; ai; ai=ai->next)
+    if (eqstri(ai->arcname, "ZIP"))
+      break;
+
+  if (!ai || !ai->add)
+  {
+    printf("FAILED: %s has no ZIP archiver\n", cfg);
+    return 1;
+  }
+
+  if (mkdtemp(szDir)==NULL)
+  {
+    perror(szDir);
+    return 1;
+  }
+
+  (void)sprintf(name, "%s/pkt", szDir);
+  (void)mkdir(name);
+
+  for (i=0; i < npkt; i++)
+  {
+    (void)sprintf(name, "%s/pkt/%08x.pkt", szDir, i);
+
+    if (!MakePacket(name, size, i))
+    {
+      printf("FAILED: can't write %s\n", name);
+      return 1;
+    }
+  }
+
+  printf("%d packets of %ld bytes to %d links, ZIP level %d\n\n",
+         npkt, size, nlink, level);
+
+  if ((pps=Bundle(NULL, npkt, nlink, (word)level, &bytes)) >= 0)
+  {
+    printf("  built-in ZIP  %9.1f packets/s  %9ld bytes of bundles\n",
+           pps, bytes);
+
+    if ((pps_ext=Bundle(ai, npkt, nlink, (word)level, &bytes)) >= 0)
+    {
+      printf("  archiver      %9.1f packets/s  %9ld bytes of bundles\n",
+             pps_ext, bytes);
+      printf("\n  archiver command: %s\n", ai->add);
+      printf("  built-in is %.1f times as fast\n", pps/pps_ext);
+      rc=0;
+    }
+  }
+
+  /* Clean up */
+
+  for (i=0; i < npkt; i++)
+  {
+    (void)sprintf(name, "%s/pkt/%08x.pkt", szDir, i);
+    (void)unlink(name);
+  }
+
+  for (i=0; i < nlink; i++)
+  {
+    (void)sprintf(name, "%s/%08x.mo0", szDir, i);
+    (void)unlink(name);
+  }
+
+  (void)sprintf(name, "%s/pkt", szDir);
+  (void)rmdir(name);
+  (void)rmdir(szDir);
+
+  return rc;
+}
+
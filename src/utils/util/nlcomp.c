@@ -0,0 +1,822 @@
+/*
+ * Maximus Version 3.02
+ * Copyright 1989, 2002 by Lanius Corporation.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*# name=Nodelist compiler (builds NODELIST.NLX from raw nodelists)
+*/
+
+#define MAX_INCL_VER
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "prog.h"
+#include "max.h"
+#include "msgapi.h"
+#include "nlx.h"
+
+#define NL_LINELEN    512       /* Longest nodelist line we handle        */
+#define NLX_LAMBDA    4         /* Average keys per perfect hash bucket   */
+#define NLX_TRIES     1000000L  /* Displacements to try before resizing   */
+
+/* A nodelist held in memory, one entry per line */
+
+typedef struct
+{
+  char **line;
+  long n, max;
+} NLTEXT;
+
+/* The records being compiled, plus their string pool */
+
+static struct _nlxrec *rec;
+static dword nrec, maxrec;
+
+static char *pool;
+static dword cb_pool, max_pool;
+
+static dword *intern;           /* Open-addressed table of pool offsets */
+static dword max_intern, n_intern;
+
+static dword *disp, *slot, *name_idx;
+static dword nbucket, nslot;
+
+static word def_cost=0;
+static word def_zone=1;
+
+
+static void NlNoMem(void)
+{
+  printf("Error!  Out of memory.\n");
+  exit(1);
+}
+
+
+static void *Grow(void *p, dword *max, dword need, size_t each)
+{
+  if (need <= *max)
+    return p;
+
+  while (*max < need)
+    *max=*max ? *max * 2 : 256;
+
+  if ((p=realloc(p, (size_t)*max * each))==NULL)
+    NlNoMem();
+
+  return p;
+}
+
+
+/****************************************************************************
+                         Reading and diffing nodelists
+ ****************************************************************************/
+
+static void AddLine(NLTEXT *t, char *s)
+{
+  if (t->n >= t->max)
+  {
+    t->max=t->max ? t->max * 2 : 4096;
+
+    if ((t->line=realloc(t->line, t->max * sizeof(char *)))==NULL)
+      NlNoMem();
+  }
+
+  if ((t->line[t->n++]=strdup(s))==NULL)
+    NlNoMem();
+}
+
+
+static void FreeText(NLTEXT *t)
+{
+  long i;
+
+  for (i=0; i < t->n; i++)
+    free(t->line[i]);
+
+  free(t->line);
+  memset(t, 0, sizeof *t);
+}
+
+
+/* Read a nodelist (or nodediff) into memory, stripping line ends */
+
+static int ReadText(char *fname, NLTEXT *t)
+{
+  char line[NL_LINELEN];
+  char *p;
+  FILE *fp;
+
+  if ((fp=fopen(fname, "rb"))==NULL)
+  {
+    printf("Error!  Can't open `%s'.\n", fname);
+    return FALSE;
+  }
+
+  while (fgets(line, NL_LINELEN, fp))
+  {
+    if (*line=='\x1a')
+      break;
+
+    for (p=line+strlen(line); p > line && (p[-1]=='\n' || p[-1]=='\r'); )
+      *--p='\0';
+
+    AddLine(t, line);
+  }
+
+  fclose(fp);
+  return TRUE;
+}
+
+
+/* Apply a nodediff to the nodelist in 'old'.  The first line of the diff *
+ * must match the first line of the nodelist that it applies to, and the  *
+ * rest is a series of Ann (add the next nn lines), Cnn (copy nn lines    *
+ * from the old list) and Dnn (delete nn lines from the old list).        */
+
+static int ApplyDiff(char *fname, NLTEXT *old)
+{
+  NLTEXT diff, out;
+  long d, o, cnt;
+  char cmd;
+
+  memset(&diff, 0, sizeof diff);
+  memset(&out, 0, sizeof out);
+
+  if (!ReadText(fname, &diff))
+    return FALSE;
+
+  if (diff.n==0 || old->n==0 || !eqstr(diff.line[0], old->line[0]))
+  {
+    printf("Error!  `%s' does not apply to this nodelist.\n", fname);
+    FreeText(&diff);
+    return FALSE;
+  }
+
+  for (d=1, o=0; d < diff.n; )
+  {
+    cmd=(char)toupper(*diff.line[d]);
+    cnt=atol(diff.line[d]+1);
+    d++;
+
+    if ((cmd != 'A' && cmd != 'C' && cmd != 'D') || cnt < 0 ||
+        (cmd=='A' && cnt > diff.n - d) ||
+        (cmd != 'A' && cnt > old->n - o))
+    {
+      printf("Error!  Bad command at line %ld of `%s'.\n", d, fname);
+      FreeText(&out);
+      FreeText(&diff);
+      return FALSE;
+    }
+
+    if (cmd=='A')
+      while (cnt--)
+        AddLine(&out, diff.line[d++]);
+    else if (cmd=='C')
+      while (cnt--)
+        AddLine(&out, old->line[o++]);
+    else o += cnt;
+  }
+
+  FreeText(&diff);
+  FreeText(old);
+  *old=out;
+
+  return TRUE;
+}
+
+
+/* A nodediff called NODEDIFF.123 turns NODELIST.nnn into NODELIST.123,   *
+ * so write out the updated list for next week's diff to apply to.        */
+
+static void WriteUpdated(char *nlname, char *diffname, NLTEXT *t)
+{
+  char out[PATHLEN];
+  char *ext, *p;
+  FILE *fp;
+  long i;
+
+  if ((ext=strrchr(diffname, '.'))==NULL || strlen(ext) != 4 ||
+      !isdigit(ext[1]) || !isdigit(ext[2]) || !isdigit(ext[3]))
+    return;
+
+  strnncpy(out, nlname, PATHLEN-4);
+
+  if ((p=strrchr(out, '.')) != NULL && !strpbrk(p, "/\\:"))
+    *p='\0';
+
+  strcat(out, ext);
+
+  if ((fp=fopen(out, "wb"))==NULL)
+  {
+    printf("Warning!  Can't write updated nodelist `%s'.\n", out);
+    return;
+  }
+
+  for (i=0; i < t->n; i++)
+    fprintf(fp, "%s\r\n", t->line[i]);
+
+  fputc('\x1a', fp);
+  fclose(fp);
+
+  printf("Wrote updated nodelist `%s'.\n", out);
+}
+
+
+/****************************************************************************
+                           Compiling the records
+ ****************************************************************************/
+
+static dword StrHash(char *s)
+{
+  dword h=2166136261L;
+
+  while (*s)
+    h=(h ^ (byte)*s++) * 16777619L;
+
+  return h;
+}
+
+
+/* Add a string to the pool, sharing it with an identical earlier string */
+
+static dword PoolAdd(char *s)
+{
+  dword h, i, ofs;
+  size_t len=strlen(s)+1;
+
+  if (n_intern*2 >= max_intern)
+  {
+    dword *old=intern, oldmax=max_intern;
+
+    max_intern=max_intern ? max_intern*2 : 4096;
+
+    if ((intern=malloc(max_intern * sizeof(dword)))==NULL)
+      NlNoMem();
+
+    memset(intern, 0xff, max_intern * sizeof(dword));
+
+    for (i=0; i < oldmax; i++)
+      if (old[i] != NLX_NOREC)
+      {
+        for (h=StrHash(pool+old[i]) & (max_intern-1); intern[h] != NLX_NOREC;
+             h=(h+1) & (max_intern-1))
+          ;
+
+        intern[h]=old[i];
+      }
+
+    free(old);
+  }
+
+  for (h=StrHash(s) & (max_intern-1); intern[h] != NLX_NOREC;
+       h=(h+1) & (max_intern-1))
+  {
+    if (eqstr(pool+intern[h], s))
+      return intern[h];
+  }
+
+  pool=Grow(pool, &max_pool, cb_pool+(dword)len, 1);
+  memcpy(pool+cb_pool, s, len);
+
+  ofs=cb_pool;
+  cb_pool += (dword)len;
+
+  intern[h]=ofs;
+  n_intern++;
+
+  return ofs;
+}
+
+
+/* Copy a nodelist field, turning underscores back into spaces */
+
+static void Field(char *out, char *in, size_t max)
+{
+  size_t i;
+
+  for (i=0; in && *in && i < max-1; in++, i++)
+    out[i]=(char)(*in=='_' ? ' ' : *in);
+
+  out[i]='\0';
+}
+
+
+/* Find a flag in the comma-separated nodelist flags field */
+
+static int HasFlag(char *flags, char *flag)
+{
+  size_t len=strlen(flag);
+  char *p;
+
+  for (p=flags; p && *p; p=strchr(p, ','), p=p ? p+1 : NULL)
+    if (strncmp(p, flag, len)==0 && (p[len]==',' || p[len]=='\0'))
+      return TRUE;
+
+  return FALSE;
+}
+
+
+/* Compile the lines of one nodelist or pointlist into records */
+
+static void Compile(NLTEXT *t)
+{
+  char work[NL_LINELEN];
+  char sname[NL_LINELEN], scity[NL_LINELEN], ssysop[NL_LINELEN];
+  char *fld[8];
+  word zone=def_zone, net=0, node=0, num;
+  struct _nlxrec *r;
+  int nf, i;
+  word flag;
+  long ln;
+  char *p;
+
+  for (ln=0; ln < t->n; ln++)
+  {
+    if (*t->line[ln]==';' || *t->line[ln]=='\0')
+      continue;
+
+    strnncpy(work, t->line[ln], NL_LINELEN);
+
+    /* Split the first seven fields, leaving the flags in the eighth */
+
+    for (nf=0, p=work; nf < 8 && p; nf++)
+    {
+      fld[nf]=p;
+
+      if (nf < 7 && (p=strchr(p, ',')) != NULL)
+        *p++='\0';
+      else p=NULL;
+    }
+
+    for (i=nf; i < 8; i++)
+      fld[i]="";
+
+    num=(word)atoi(fld[1]);
+    flag=0;
+
+    if (eqstri(fld[0], "Boss"))
+    {
+      NETADDR boss;
+
+      /* Pointlists give the address of the boss node for the points    *
+       * that follow it.                                                 */
+
+      boss.zone=zone;
+      boss.net=net;
+      boss.node=node;
+      boss.point=0;
+
+      ParseNN(fld[1], &boss.zone, &boss.net, &boss.node, &boss.point, FALSE);
+
+      zone=boss.zone;
+      net=boss.net;
+      node=boss.node;
+      continue;
+    }
+
+    if (nf < 7)
+    {
+      printf("Warning!  Skipping malformed line: %s\n", t->line[ln]);
+      continue;
+    }
+
+    if (eqstri(fld[0], "Zone"))
+    {
+      zone=net=num;
+      node=0;
+      flag=B_zone;
+    }
+    else if (eqstri(fld[0], "Region"))
+    {
+      net=num;
+      node=0;
+      flag=B_region;
+    }
+    else if (eqstri(fld[0], "Host"))
+    {
+      net=num;
+      node=0;
+      flag=B_host;
+    }
+    else if (eqstri(fld[0], "Point"))
+      flag=B_point;
+    else
+    {
+      node=num;
+
+      if (eqstri(fld[0], "Hub"))
+        flag=B_hub;
+    }
+
+    if (HasFlag(fld[7], "CM"))
+      flag |= B_CM;
+
+    rec=Grow(rec, &maxrec, nrec+1, sizeof(struct _nlxrec));
+    r=rec+nrec++;
+
+    memset(r, 0, sizeof *r);
+    r->zone=zone;
+    r->net=net;
+    r->node=node;
+    r->point=(word)(flag & B_point ? num : 0);
+    r->flag=flag;
+    r->cost=def_cost;
+    r->baud=(word)atoi(fld[6]);
+
+    Field(sname, fld[2], sizeof sname);
+    Field(scity, fld[3], sizeof scity);
+    Field(ssysop, fld[4], sizeof ssysop);
+
+    r->name=PoolAdd(sname);
+    r->city=PoolAdd(scity);
+    r->sysop=PoolAdd(ssysop);
+    r->phone=PoolAdd(fld[5]);
+    r->flags=PoolAdd(fld[7]);
+  }
+}
+
+
+static int AddrCmp(struct _nlxrec *a, struct _nlxrec *b)
+{
+  if (a->zone != b->zone)   return a->zone < b->zone ? -1 : 1;
+  if (a->net != b->net)     return a->net < b->net ? -1 : 1;
+  if (a->node != b->node)   return a->node < b->node ? -1 : 1;
+  if (a->point != b->point) return a->point < b->point ? -1 : 1;
+  return 0;
+}
+
+
+static int _stdc RecAddrCmp(const void *a, const void *b)
+{
+  int d=AddrCmp(rec + *(dword *)a, rec + *(dword *)b);
+
+  if (d)
+    return d;
+
+  return *(dword *)a < *(dword *)b ? -1 : *(dword *)a > *(dword *)b;
+}
+
+
+static int _stdc RecNameCmp(const void *a, const void *b)
+{
+  int d=stricmp(pool + rec[*(dword *)a].sysop, pool + rec[*(dword *)b].sysop);
+
+  return d ? d : RecAddrCmp(a, b);
+}
+
+
+/* Drop all but the first listing of any address that appears twice, so  *
+ * that every key in the perfect hash is unique.                          */
+
+static void DropDupes(void)
+{
+  dword *idx, i, n;
+  char *dup;
+
+  if (nrec < 2)
+    return;
+
+  if ((idx=malloc(nrec * sizeof(dword)))==NULL ||
+      (dup=calloc(nrec, 1))==NULL)
+    NlNoMem();
+
+  for (i=0; i < nrec; i++)
+    idx[i]=i;
+
+  qsort(idx, nrec, sizeof(dword), RecAddrCmp);
+
+  for (i=1; i < nrec; i++)
+    if (AddrCmp(rec+idx[i-1], rec+idx[i])==0)
+    {
+      NETADDR a;
+
+      a.zone=rec[idx[i]].zone;
+      a.net=rec[idx[i]].net;
+      a.node=rec[idx[i]].node;
+      a.point=rec[idx[i]].point;
+
+      printf("Warning!  Duplicate listing for %s ignored.\n", Address(&a));
+      dup[idx[i]]=TRUE;
+    }
+
+  for (i=n=0; i < nrec; i++)
+    if (!dup[i])
+      rec[n++]=rec[i];
+
+  nrec=n;
+
+  free(dup);
+  free(idx);
+}
+
+
+static dword *bstart;          /* First key of each bucket in 'order' */
+
+static int _stdc BucketCmp(const void *a, const void *b)
+{
+  dword na=bstart[*(dword *)a+1]-bstart[*(dword *)a];
+  dword nb=bstart[*(dword *)b+1]-bstart[*(dword *)b];
+
+  return na > nb ? -1 : na < nb;
+}
+
+
+/* Build the perfect hash: each key is placed in a bucket by NlxHash(0),  *
+ * then buckets are processed largest-first, searching for a displacement *
+ * that sends all of the bucket's keys to distinct free slots.            */
+
+static void BuildHash(void)
+{
+  dword *bkt, *order, *border, *tmp;
+  dword i, j, k, b, d, cnt;
+  char *taken;
+
+  nbucket=nrec / NLX_LAMBDA + 1;
+  nslot=nrec + nrec / 4 + 1;
+
+  if ((bkt=malloc(nrec * sizeof(dword)))==NULL ||
+      (bstart=calloc(nbucket+1, sizeof(dword)))==NULL ||
+      (order=malloc(nrec * sizeof(dword)))==NULL ||
+      (border=malloc(nbucket * sizeof(dword)))==NULL ||
+      (tmp=calloc(max(nrec, nbucket), sizeof(dword)))==NULL)
+    NlNoMem();
+
+  /* Bucket the keys with a counting sort */
+
+  for (i=0; i < nrec; i++)
+  {
+    bkt[i]=NlxHash(rec[i].zone, rec[i].net, rec[i].node, rec[i].point, 0) %
+           nbucket;
+    bstart[bkt[i]+1]++;
+  }
+
+  for (b=0; b < nbucket; b++)
+  {
+    bstart[b+1] += bstart[b];
+    border[b]=b;
+  }
+
+  for (i=0; i < nrec; i++)
+    order[bstart[bkt[i]] + tmp[bkt[i]]++]=i;
+
+  /* Biggest buckets first, while there's still lots of room */
+
+  qsort(border, nbucket, sizeof(dword), BucketCmp);
+
+  for (;;)
+  {
+    if ((disp=realloc(disp, nbucket * sizeof(dword)))==NULL ||
+        (slot=realloc(slot, nslot * sizeof(dword)))==NULL ||
+        (taken=calloc(nslot, 1))==NULL)
+      NlNoMem();
+
+    memset(disp, 0, nbucket * sizeof(dword));
+    memset(slot, 0xff, nslot * sizeof(dword));
+
+    for (i=0; i < nbucket; i++)
+    {
+      b=border[i];
+
+      if ((cnt=bstart[b+1]-bstart[b])==0)
+        break;
+
+      for (d=1; d < NLX_TRIES; d++)
+      {
+        for (j=0; j < cnt; j++)
+        {
+          struct _nlxrec *r=rec + order[bstart[b]+j];
+
+          tmp[j]=NlxHash(r->zone, r->net, r->node, r->point, d) % nslot;
+
+          if (taken[tmp[j]])
+            break;
+
+          for (k=0; k < j && tmp[k] != tmp[j]; k++)
+            ;
+
+          if (k < j)
+            break;
+        }
+
+        if (j==cnt)
+          break;
+      }
+
+      if (d==NLX_TRIES)
+        break;
+
+      disp[b]=d;
+
+      for (j=0; j < cnt; j++)
+      {
+        taken[tmp[j]]=TRUE;
+        slot[tmp[j]]=order[bstart[b]+j];
+      }
+    }
+
+    free(taken);
+
+    if (i==nbucket || bstart[border[i]+1]==bstart[border[i]])
+      break;
+
+    /* Couldn't place a bucket, so try again with some more elbow room */
+
+    nslot += nslot / 10 + 1;
+  }
+
+  free(tmp);
+  free(border);
+  free(order);
+  free(bstart);
+  free(bkt);
+}
+
+
+static int WriteIndex(char *fname)
+{
+  struct _nlxhdr h;
+  char tmpname[PATHLEN];
+  dword pad=0;
+  FILE *fp;
+
+  memset(&h, 0, sizeof h);
+  h.id=NLX_ID;
+  h.ver=NLX_VER;
+  h.rec_size=sizeof(struct _nlxrec);
+  h.stamp=(dword)time(NULL);
+  h.nrec=nrec;
+  h.nbucket=nbucket;
+  h.nslot=nslot;
+  h.ofs_rec=sizeof h;
+  h.ofs_disp=h.ofs_rec + nrec * sizeof(struct _nlxrec);
+  h.ofs_slot=h.ofs_disp + nbucket * sizeof(dword);
+  h.ofs_name=h.ofs_slot + nslot * sizeof(dword);
+  h.ofs_str=h.ofs_name + nrec * sizeof(dword);
+  h.cb_str=cb_pool;
+
+  /* Write to a temporary file and rename it over the old index, so that  *
+   * processes which have the old one mapped aren't disturbed.            */
+
+  snprintf(tmpname, sizeof tmpname, "%s.tmp", fname);
+
+  if ((fp=fopen(tmpname, "wb"))==NULL)
+  {
+    printf("Error!  Can't create `%s'.\n", tmpname);
+    return FALSE;
+  }
+
+  if (fwrite(&h, sizeof h, 1, fp) != 1 ||
+      (nrec && fwrite(rec, sizeof(struct _nlxrec), nrec, fp) != nrec) ||
+      fwrite(disp, sizeof(dword), nbucket, fp) != nbucket ||
+      fwrite(slot, sizeof(dword), nslot, fp) != nslot ||
+      (nrec && fwrite(name_idx, sizeof(dword), nrec, fp) != nrec) ||
+      fwrite(pool, 1, cb_pool, fp) != cb_pool ||
+      fwrite(&pad, 1, (4 - cb_pool % 4) % 4, fp) != (4 - cb_pool % 4) % 4 ||
+      fclose(fp) != 0)
+  {
+    printf("Error writing `%s'.\n", tmpname);
+    unlink(tmpname);
+    return FALSE;
+  }
+
+#ifndef UNIX
+  unlink(fname);    /* rename() can't replace an existing file here */
+#endif
+
+  if (rename(tmpname, fname) != 0)
+  {
+    printf("Error!  Can't rename `%s' to `%s'.\n", tmpname, fname);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+static void Usage(void)
+{
+  printf("Format:\n\n");
+  printf("  NLCOMP [-o<index>] [-c<cost>] [-z<zone>] <nodelist> [-d<nodediff>]\n");
+  printf("         [<nodelist> [-d<nodediff>] ...]\n\n");
+  printf("  -o<index>     Write the index to <index> (default: " NLX_NAME ")\n");
+  printf("  -c<cost>      Message cost to assign to every node (default: 0)\n");
+  printf("  -z<zone>      Zone for lists with no Zone line (default: 1)\n");
+  printf("  -d<nodediff>  Apply a nodediff to the preceding nodelist, and write\n");
+  printf("                the updated list next to it (NODEDIFF.123 gives\n");
+  printf("                NODELIST.123)\n\n");
+  printf("Copy the index to the directory named by net_info_path in the\n");
+  printf("Maximus configuration to have it used for all nodelist lookups.\n");
+}
+
+
+int _stdc main(int argc, char *argv[])
+{
+  char *outname=NLX_NAME;
+  char *nlname=NULL;
+  NLTEXT t;
+  int i;
+
+  Hello("NLCOMP", "Maximus Nodelist Compiler", VERSION, THIS_YEAR);
+
+  if (argc < 2)
+  {
+    Usage();
+    return 1;
+  }
+
+  memset(&t, 0, sizeof t);
+  PoolAdd("");
+
+  /* Nodelists are compiled once all of their nodediffs have been seen */
+
+  for (i=1; i <= argc; i++)
+  {
+    char *arg=(i < argc) ? argv[i] : NULL;
+
+    if (arg && *arg=='-' && arg[1]=='d')
+    {
+      if (!nlname)
+      {
+        printf("Error!  -d must follow the nodelist that it applies to.\n");
+        return 1;
+      }
+
+      if (!ApplyDiff(arg+2, &t))
+        return 1;
+
+      printf("Applied nodediff `%s'.\n", arg+2);
+      WriteUpdated(nlname, arg+2, &t);
+      continue;
+    }
+
+    if (arg && *arg=='-')
+    {
+      switch (tolower(arg[1]))
+      {
+        case 'o': outname=arg+2; break;
+        case 'c': def_cost=(word)atoi(arg+2); break;
+        case 'z': def_zone=(word)atoi(arg+2); break;
+        default:
+          printf("Error!  Unknown option `%s'.\n\n", arg);
+          Usage();
+          return 1;
+      }
+
+      continue;
+    }
+
+    if (nlname)
+    {
+      Compile(&t);
+      FreeText(&t);
+    }
+
+    if ((nlname=arg) != NULL && !ReadText(nlname, &t))
+      return 1;
+  }
+
+  if (nrec==0)
+  {
+    printf("Error!  No nodes found.\n");
+    return 1;
+  }
+
+  DropDupes();
+  BuildHash();
+
+  /* Sysop name index */
+
+  if ((name_idx=malloc(nrec * sizeof(dword)))==NULL)
+    NlNoMem();
+
+  for (i=0; i < (int)nrec; i++)
+    name_idx[i]=(dword)i;
+
+  qsort(name_idx, nrec, sizeof(dword), RecNameCmp);
+
+  if (!WriteIndex(outname))
+    return 1;
+
+  printf("Compiled %lu nodes into `%s' (%lu bytes of strings).\n",
+         (unsigned long)nrec, outname, (unsigned long)cb_pool);
+
+  return 0;
+}
+